@@ -0,0 +1,45 @@
+#include <log/binary_log.h>
+#include <log/log.h>
+
+#include <cstdio>
+
+#include "bench_util.h"
+
+// 只格式化不输出的 appender，衡量文本日志调用方线程上的开销
+class NullAppender : public eva::LogAppender {
+public:
+    NullAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override {
+        thread_local eva::LogStream t_stream;
+        t_stream.Clear();
+        GetFormatter()->Format(t_stream, event);
+        eva::bench::DoNotOptimize(t_stream.Size());
+    }
+};
+
+// 对比文本日志与二进制日志在调用方线程上每次调用的开销
+int main() {
+    constexpr size_t kIterations = 1000000;
+    char const* path = "/tmp/eva_bench_binary_log.bin";
+    std::remove(path);
+
+    eva::Logger::ptr text_logger{new eva::Logger{"text"}};
+    text_logger->AddAppender(std::make_shared<NullAppender>());
+    eva::Logger::ptr bin_logger{new eva::Logger{"bin"}};
+
+    int i = 0;
+    eva::bench::Report("EVA_LOG_INFO (format + null appender)",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           EVA_LOG_INFO(text_logger) << "request " << i++ << " took " << 1.5
+                                                     << "ms";
+                       }));
+
+    eva::BinaryLog::Open(path, 16 << 20);
+    eva::bench::Report("EVA_LOG_BIN_INFO", eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           EVA_LOG_BIN_INFO(bin_logger, "request %d took %.1fms", i++, 1.5);
+                       }));
+    eva::BinaryLog::Close();
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <fiber/fiber.h>
+#include <ucontext.h>
+
+#include <vector>
+
+#include "bench_util.h"
+
+// 对比 ucontext(每次 swapcontext 都调用 sigprocmask)与手写汇编的协程切换
+namespace {
+
+ucontext_t g_main_ctx;
+ucontext_t g_fiber_ctx;
+
+void UcontextLoop() {
+    while (true) {
+        swapcontext(&g_fiber_ctx, &g_main_ctx);
+    }
+}
+
+}  // namespace
+
+int main() {
+    constexpr size_t kIterations = 2000000;
+
+    // 一次 Resume + Yield 是两次切换
+    std::vector<char> stack(eva::Fiber::kDefaultStackSize);
+    getcontext(&g_fiber_ctx);
+    g_fiber_ctx.uc_stack.ss_sp = stack.data();
+    g_fiber_ctx.uc_stack.ss_size = stack.size();
+    g_fiber_ctx.uc_link = nullptr;
+    makecontext(&g_fiber_ctx, UcontextLoop, 0);
+    eva::bench::Report("ucontext swapcontext (per switch)",
+                       eva::bench::MeasureNsPerOp(kIterations, [] {
+                           swapcontext(&g_main_ctx, &g_fiber_ctx);
+                       }) / 2);
+
+    eva::Fiber fiber{[] {
+        while (true) {
+            eva::Fiber::Yield();
+        }
+    }};
+    eva::bench::Report("eva::Fiber Resume/Yield (per switch)",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] { fiber.Resume(); }) / 2);
+
+    eva::bench::Report("eva::Fiber create + run + destroy", eva::bench::MeasureNsPerOp(100000, [] {
+                           eva::Fiber f{[] {}};
+                           f.Resume();
+                       }));
+
+    eva::Fiber reused{[] {}};
+    eva::bench::Report("eva::Fiber Reset + run", eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           reused.Resume();
+                           reused.Reset([] {});
+                       }));
+
+    eva::bench::Report("eva::GetFiberId", eva::bench::MeasureNsPerOp(kIterations, [] {
+                           eva::bench::DoNotOptimize(eva::Fiber::GetFiberId());
+                       }));
+    return 0;
+}
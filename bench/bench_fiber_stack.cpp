@@ -0,0 +1,118 @@
+#include <fiber/fiber.h>
+#include <fiber/stack.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "bench_util.h"
+
+// 协程栈：池化独占栈与共享栈的创建/运行/析构开销，大量协程挂起时每个协程的常驻内存，以及切换开销
+namespace {
+
+constexpr size_t kIterations = 200000;
+// 独占栈每个占两个内存映射，vm.max_map_count 默认 65530，挂起的协程数留出余量
+constexpr size_t kSuspended = 20000;
+
+/**
+ * @brief 进程的常驻内存字节数
+ */
+size_t ResidentBytes() {
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int n = std::fscanf(file, "%lu %lu", &size, &resident);
+    std::fclose(file);
+    return n == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+// 挂起时的栈上有几层普通大小的调用帧
+__attribute__((noinline)) void Frames(int depth) {
+    volatile char buf[512];
+    buf[0] = static_cast<char>(depth);
+    if (depth == 0) {
+        eva::Fiber::Yield();
+    } else {
+        Frames(depth - 1);
+    }
+    eva::bench::DoNotOptimize(buf[0]);
+}
+
+/**
+ * @brief 创建、运行到结束、析构一个协程的纳秒数
+ */
+double CreateRunDestroy(bool shared) {
+    return eva::bench::MeasureNsPerOp(kIterations, [shared] {
+        auto fiber{std::make_shared<eva::Fiber>([] {}, eva::Fiber::kDefaultStackSize, shared)};
+        fiber->Resume();
+    });
+}
+
+/**
+ * @brief kSuspended 个协程挂起在几层调用帧中，平均每个协程增加的常驻内存字节数
+ */
+double ResidentPerFiber(bool shared) {
+    size_t before = ResidentBytes();
+    std::vector<eva::Fiber::ptr> fibers;
+    fibers.reserve(kSuspended);
+    for (size_t i = 0; i < kSuspended; ++i) {
+        fibers.push_back(std::make_shared<eva::Fiber>([] { Frames(4); },
+                                                      eva::Fiber::kDefaultStackSize, shared));
+        fibers.back()->Resume();
+    }
+    // 共享栈上最后一个协程的内容还没有拷出，让它也拷出
+    if (shared) {
+        auto last{std::make_shared<eva::Fiber>([] {}, eva::Fiber::kDefaultStackSize, true)};
+        last->Resume();
+    }
+    size_t after = ResidentBytes();
+    for (auto& fiber : fibers) {
+        fiber->Resume();
+    }
+    return static_cast<double>(after - before) / kSuspended;
+}
+
+/**
+ * @brief 两个协程交替 Resume/Yield，每次往返的纳秒数；共享栈模式下每次都要换出换入栈内容
+ */
+double SwitchPair(bool shared) {
+    bool stop = false;
+    auto body = [&stop] {
+        while (!stop) {
+            Frames(4);
+        }
+    };
+    auto a{std::make_shared<eva::Fiber>(body, eva::Fiber::kDefaultStackSize, shared)};
+    auto b{std::make_shared<eva::Fiber>(body, eva::Fiber::kDefaultStackSize, shared)};
+    double ns = eva::bench::MeasureNsPerOp(kIterations, [&] {
+        a->Resume();
+        b->Resume();
+    });
+    stop = true;
+    a->Resume();
+    b->Resume();
+    return ns / 2;
+}
+
+void ReportBytes(char const* name, double bytes) {
+    std::printf("%-40s %10.1f bytes/fiber\n", name, bytes);
+}
+
+}  // namespace
+
+int main() {
+    eva::bench::Report("create+run+destroy, pooled stack", CreateRunDestroy(false));
+    eva::bench::Report("create+run+destroy, shared stack", CreateRunDestroy(true));
+    eva::bench::Report("resume/yield pair, pooled stack", SwitchPair(false));
+    eva::bench::Report("resume/yield pair, shared stack", SwitchPair(true));
+    ReportBytes("RSS per suspended fiber, pooled stack", ResidentPerFiber(false));
+    ReportBytes("RSS per suspended fiber, shared stack", ResidentPerFiber(true));
+    std::printf("%-40s %10zu\n", "mapped stacks", eva::StackAllocator::GetMappedCount());
+    return 0;
+}
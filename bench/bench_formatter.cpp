@@ -0,0 +1,73 @@
+#include <log/log.h>
+#include <log/static_formatter.h>
+
+#include <sstream>
+
+#include "bench_util.h"
+
+// 对比运行时解析(FormatItem 虚函数分派)与编译期特化的格式器，每行日志的格式化开销
+int main() {
+    constexpr size_t kIterations = 1000000;
+
+    EVA_LOG_DEFINE_SITE(site);
+    eva::LogEvent event{"root", eva::LogLevel::Level::INFO, site, 12,
+                        static_cast<uint32_t>(eva::GetThreadId()), eva::GetFiberId(),
+                        eva::GetCurrentTimeNS(), eva::GetThreadName()};
+    event.GetStream() << "benchmark message with some payload " << 42;
+
+    eva::LogFormatter runtime_formatter;
+    eva::DefaultStaticLogFormatter static_formatter;
+    eva::LogStream stream;
+
+    eva::bench::Report("runtime LogFormatter -> LogStream",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           stream.Clear();
+                           runtime_formatter.Format(stream, event);
+                           eva::bench::DoNotOptimize(stream.Size());
+                       }));
+
+    eva::bench::Report("static LogFormatter -> LogStream",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           stream.Clear();
+                           static_formatter.Format(stream, event);
+                           eva::bench::DoNotOptimize(stream.Size());
+                       }));
+
+    eva::bench::Report("runtime LogFormatter -> std::string",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           eva::bench::DoNotOptimize(runtime_formatter.Format(event).size());
+                       }));
+
+    eva::bench::Report("static LogFormatter -> std::string",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           eva::bench::DoNotOptimize(static_formatter.Format(event).size());
+                       }));
+
+    // 带微秒的模板
+    eva::StaticLogFormatter<"%d{%Y-%m-%d %H:%M:%S}.%us [%p] %m%n"> us_formatter;
+    eva::bench::Report("static LogFormatter with %us",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           stream.Clear();
+                           us_formatter.Format(stream, event);
+                           eva::bench::DoNotOptimize(stream.Size());
+                       }));
+
+    // 参考：逐项写入 std::ostream(改造前 FormatItem 的写法)
+    eva::bench::Report("reference: ostream per item",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           std::stringstream ss;
+                           tm tm;
+                           time_t t = event.GetTime();
+                           localtime_r(&t, &tm);
+                           char buf[64];
+                           strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+                           ss << buf << " [" << event.GetElapse() << "ms]" << "\t"
+                              << event.GetThreadId() << "\t" << event.GetThreadName() << "\t"
+                              << event.GetFiberId() << "\t[" << eva::LogLevel::ToString(event.GetLevel())
+                              << "]\t[" << event.GetLoggerName() << "]\t" << event.GetFile() << ":"
+                              << event.GetLine() << "\t" << event.GetContent() << std::endl;
+                           eva::bench::DoNotOptimize(ss.str().size());
+                       }));
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <fiber/io_manager.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+
+// IOManager：epoll 与 io_uring 后端在大量 socketpair 上来回传递小消息的每次往返耗时
+namespace {
+
+using Backend = eva::IOManager::Backend;
+
+/**
+ * @brief pairs 对 socketpair，每对两个协程来回传递 rounds 次 8 字节消息，返回每次往返的纳秒数
+ */
+double PingPong(Backend backend, size_t threads, int pairs, int rounds) {
+    std::vector<int> fds(pairs * 2);
+    for (int i = 0; i < pairs; ++i) {
+        socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, &fds[i * 2]);
+    }
+    eva::IOManager iom{threads, "bench", backend};
+    iom.Start();
+    uint64_t begin = eva::bench::NowNs();
+    for (int i = 0; i < pairs; ++i) {
+        int a = fds[i * 2];
+        int b = fds[i * 2 + 1];
+        iom.Schedule([&iom, a, rounds] {
+            uint64_t value = 0;
+            for (int round = 0; round < rounds; ++round) {
+                iom.Write(a, &value, sizeof(value));
+                iom.Read(a, &value, sizeof(value));
+            }
+        });
+        iom.Schedule([&iom, b, rounds] {
+            uint64_t value = 0;
+            for (int round = 0; round < rounds; ++round) {
+                iom.Read(b, &value, sizeof(value));
+                ++value;
+                iom.Write(b, &value, sizeof(value));
+            }
+        });
+    }
+    iom.Stop();
+    uint64_t ns = eva::bench::NowNs() - begin;
+    for (int fd : fds) {
+        close(fd);
+    }
+    return static_cast<double>(ns) / (static_cast<double>(pairs) * rounds);
+}
+
+}  // namespace
+
+int main() {
+    constexpr int kRoundTrips = 400000;
+    for (Backend backend : {Backend::EPOLL, Backend::IO_URING}) {
+        if (backend == Backend::IO_URING &&
+            eva::IOManager{1, "probe", backend}.GetBackend() != Backend::IO_URING) {
+            std::printf("io_uring is not available\n");
+            continue;
+        }
+        char const* name = backend == Backend::EPOLL ? "epoll" : "io_uring";
+        for (int pairs : {1, 64, 1024}) {
+            for (size_t threads : {1, 4}) {
+                double ns = PingPong(backend, threads, pairs, kRoundTrips / pairs);
+                std::string label = std::string{name} + " " + std::to_string(pairs) +
+                                    " pairs, " + std::to_string(threads) + " threads";
+                eva::bench::Report(label.c_str(), ns);
+            }
+        }
+    }
+    return 0;
+}
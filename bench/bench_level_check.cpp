@@ -0,0 +1,47 @@
+// 编译期丢弃 DEBUG 语句，对比运行时关闭的 INFO 语句
+#define EVA_LOG_MIN_LEVEL 200
+
+#include <log/log.h>
+
+#include <string>
+
+#include "bench_util.h"
+
+static int g_counter = 0;
+
+// 代价很高的参数，只有被求值时才会拖慢基准测试
+static std::string Expensive() { return std::string(256, 'x') + std::to_string(++g_counter); }
+
+// 衡量一条被关闭的日志语句的开销：应当只有一次 relaxed 原子读和一次可预测的分支
+int main() {
+    constexpr size_t kIterations = 20000000;
+
+    eva::Logger::ptr logger{new eva::Logger{"bench"}};
+    logger->SetLevel(eva::LogLevel::Level::ERROR);
+    EVA_LOG_ROOT()->SetLevel(eva::LogLevel::Level::ERROR);
+
+    eva::bench::Report("empty loop", eva::bench::MeasureNsPerOp(kIterations, [] {
+                           eva::bench::DoNotOptimize(g_counter);
+                       }));
+
+    eva::bench::Report("runtime-disabled EVA_LOG_INFO",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           EVA_LOG_INFO(logger) << Expensive();
+                           eva::bench::DoNotOptimize(g_counter);
+                       }));
+
+    eva::bench::Report("runtime-disabled EVA_LOG_INFO(root)",
+                       eva::bench::MeasureNsPerOp(kIterations, [] {
+                           EVA_LOG_INFO(EVA_LOG_ROOT()) << Expensive();
+                           eva::bench::DoNotOptimize(g_counter);
+                       }));
+
+    eva::bench::Report("compiled-out EVA_LOG_DEBUG",
+                       eva::bench::MeasureNsPerOp(kIterations, [&] {
+                           EVA_LOG_DEBUG(logger) << Expensive();
+                           eva::bench::DoNotOptimize(g_counter);
+                       }));
+
+    // 参数从未被求值
+    return g_counter == 0 ? 0 : 1;
+}
@@ -0,0 +1,373 @@
+#include <fcntl.h>
+#include <log/json_formatter.h>
+#include <log/log.h>
+#include <log/rolling_appender.h>
+#include <log/static_formatter.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../test/alloc_counter.h"
+#include "bench_util.h"
+
+namespace {
+
+// 只格式化不输出的 appender，衡量日志路径本身的开销
+class NullAppender : public eva::LogAppender {
+public:
+    NullAppender() : LogAppender(eva::LogFormatter::ptr{new eva::DefaultStaticLogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override {
+        thread_local eva::LogStream t_stream;
+        t_stream.Clear();
+        GetFormatter()->Format(t_stream, event);
+        eva::bench::DoNotOptimize(t_stream.Size());
+    }
+};
+
+// 改造前的 FileLogAppender：std::ofstream，每行 flush 一次(一次 write 系统调用)
+class OfstreamFileAppender : public eva::LogAppender {
+public:
+    explicit OfstreamFileAppender(std::string const& filename)
+        : LogAppender(eva::LogFormatter::ptr{new eva::DefaultStaticLogFormatter}),
+          filestream_(filename, std::ios::app) {}
+
+    void Log(eva::LogEvent const& event) override {
+        std::lock_guard lk{mtx_};
+        GetFormatter()->Format(filestream_, event);
+        filestream_.flush();
+    }
+
+private:
+    std::ofstream filestream_;
+};
+
+/**
+ * @brief 进程累计的写类系统调用次数(/proc/self/io 中的 syscw)，不支持时返回 0
+ */
+uint64_t WriteSyscalls() {
+    std::FILE* f = std::fopen("/proc/self/io", "r");
+    if (!f) {
+        return 0;
+    }
+    char key[32];
+    unsigned long long value = 0;
+    uint64_t syscw = 0;
+    while (std::fscanf(f, "%31s %llu", key, &value) == 2) {
+        if (std::strcmp(key, "syscw:") == 0) {
+            syscw = value;
+            break;
+        }
+    }
+    std::fclose(f);
+    return syscw;
+}
+
+struct Options {
+    int max_threads{static_cast<int>(std::max(4u, std::thread::hardware_concurrency()))};
+    size_t events{200000};  // 每个线程写入的日志条数
+    std::string output;     // JSON 输出文件，为空时输出到标准输出
+    std::string tmpdir;     // 文件类 appender 的输出目录
+};
+
+struct Result {
+    std::string name;
+    int threads{1};
+    uint64_t events{0};
+    double seconds{0};
+    double p50{0};
+    double p99{0};
+    double p999{0};
+    double allocs_per_event{0};
+    double write_syscalls_per_1k{0};
+};
+
+/**
+ * @brief threads 个线程各自调用 fn(i) per_thread 次，统计吞吐、延迟分位数和堆分配次数
+ * @details 每个线程先预热(对象池、线程局部缓冲区)，全部就绪后同时开始；
+ * 单次延迟包含一次 clock_gettime 的开销
+ */
+template <typename F, typename Done>
+Result Run(std::string name, int threads, size_t per_thread, F&& fn, Done&& on_done) {
+    std::vector<std::vector<uint32_t>> latencies(threads, std::vector<uint32_t>(per_thread));
+    std::atomic<int> ready{0};
+    std::atomic<bool> start{false};
+    std::atomic<int> done{0};
+    std::atomic<uint64_t> end_ns{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = 0; i < 1000; ++i) {
+                fn(i);
+            }
+            ready.fetch_add(1);
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            std::vector<uint32_t>& lat = latencies[t];
+            for (size_t i = 0; i < per_thread; ++i) {
+                uint64_t begin = eva::bench::NowNs();
+                fn(i);
+                lat[i] = static_cast<uint32_t>(std::min<uint64_t>(eva::bench::NowNs() - begin,
+                                                                  UINT32_MAX));
+            }
+            if (done.fetch_add(1) + 1 == threads) {
+                end_ns.store(eva::bench::NowNs());
+            }
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    uint64_t allocs_before = g_allocs.load();
+    uint64_t syscalls_before = WriteSyscalls();
+    uint64_t begin_ns = eva::bench::NowNs();
+    start.store(true);
+    while (done.load() < threads) {
+        std::this_thread::yield();
+    }
+    uint64_t allocs = g_allocs.load() - allocs_before;
+    on_done();  // 例如把缓冲区中的数据写出，计入系统调用次数
+    uint64_t syscalls = WriteSyscalls() - syscalls_before;
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    std::vector<uint32_t> all;
+    all.reserve(threads * per_thread);
+    for (auto const& lat : latencies) {
+        all.insert(all.end(), lat.begin(), lat.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) {
+        size_t index = std::min(all.size() - 1, static_cast<size_t>(p * all.size()));
+        return static_cast<double>(all[index]);
+    };
+
+    Result result;
+    result.name = std::move(name);
+    result.threads = threads;
+    result.events = all.size();
+    result.seconds = static_cast<double>(end_ns.load() - begin_ns) / 1e9;
+    result.p50 = percentile(0.50);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    result.allocs_per_event = static_cast<double>(allocs) / all.size();
+    result.write_syscalls_per_1k = static_cast<double>(syscalls) * 1000 / all.size();
+    return result;
+}
+
+template <typename F>
+Result Run(std::string name, int threads, size_t per_thread, F&& fn) {
+    return Run(std::move(name), threads, per_thread, std::forward<F>(fn), [] {});
+}
+
+std::vector<int> ThreadCounts(int max_threads) {
+    std::vector<int> counts;
+    for (int n = 1; n < max_threads; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+eva::Logger::ptr MakeLogger(char const* name, eva::LogAppender::ptr appender) {
+    eva::Logger::ptr logger{new eva::Logger{name}};
+    logger->SetLevel(eva::LogLevel::Level::DEBUG);
+    logger->AddAppender(std::move(appender));
+    return logger;
+}
+
+/**
+ * @brief 临时把标准输出重定向到 /dev/null
+ */
+class StdoutToDevNull {
+public:
+    StdoutToDevNull() {
+        std::cout.flush();
+        std::fflush(stdout);
+        saved_ = dup(STDOUT_FILENO);
+        int fd = open("/dev/null", O_WRONLY);
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+    }
+
+    ~StdoutToDevNull() {
+        std::cout.flush();
+        std::fflush(stdout);
+        dup2(saved_, STDOUT_FILENO);
+        close(saved_);
+    }
+
+private:
+    int saved_;
+};
+
+void WriteJson(std::FILE* out, Options const& options, std::vector<Result> const& results) {
+    std::fprintf(out, "{\n  \"benchmark\": \"eva_log\",\n");
+    std::fprintf(out, "  \"timestamp\": %lld,\n", static_cast<long long>(time(nullptr)));
+    std::fprintf(out, "  \"hardware_concurrency\": %u,\n", std::thread::hardware_concurrency());
+    std::fprintf(out, "  \"events_per_thread\": %zu,\n", options.events);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result const& r = results[i];
+        std::fprintf(out,
+                     "    {\"name\": \"%s\", \"threads\": %d, \"events\": %llu, "
+                     "\"events_per_sec\": %.0f, \"ns_per_event\": %.1f, "
+                     "\"latency_ns\": {\"p50\": %.0f, \"p99\": %.0f, \"p999\": %.0f}, "
+                     "\"allocs_per_event\": %.4f, \"write_syscalls_per_1k\": %.1f}%s\n",
+                     r.name.c_str(), r.threads, static_cast<unsigned long long>(r.events),
+                     r.events / r.seconds, r.seconds * 1e9 / r.events, r.p50, r.p99, r.p999,
+                     r.allocs_per_event, r.write_syscalls_per_1k,
+                     i + 1 == results.size() ? "" : ",");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        if (arg == "--threads") {
+            options.max_threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--events") {
+            options.events = std::max(1L, std::atol(argv[++i]));
+        } else if (arg == "--output") {
+            options.output = argv[++i];
+        } else if (arg == "--tmpdir") {
+            options.tmpdir = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    if (options.tmpdir.empty()) {
+        options.tmpdir = access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp";
+    }
+    return true;
+}
+
+}  // namespace
+
+/**
+ * 日志热路径基准测试，结果以 JSON 输出，便于跨版本跟踪：
+ *   - stream/fmt：EVA_LOG_* 与 EVA_LOG_FMT_* 在 1..N 线程下的吞吐与 p50/p99/p99.9 延迟，
+ *     printf_null 为 vsnprintf 实现的 LogEvent::Printf，作为 {} 格式化的对照
+ *   - json_kv_null：JsonLogFormatter 输出带结构化字段、约 200 字节消息的日志
+ *   - disabled_level：被关闭的日志语句的开销
+ *   - storm_every_sec：每秒限 100 条的调用点在日志风暴中的开销(绝大多数被抑制)
+ *   - stdout_devnull / file_tmpfs / rolling_tmpfs：各 appender 的开销，
+ *     file_ofstream_before 为改造前逐行 flush 的 std::ofstream 实现，作为对照
+ *   - 每条日志的堆分配次数，每 1000 条日志的写系统调用次数
+ *
+ * 用法：bench [--threads N] [--events N] [--output result.json] [--tmpdir dir]
+ */
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "usage: %s [--threads N] [--events N] [--output file] [--tmpdir dir]\n",
+                     argv[0]);
+        return 1;
+    }
+    std::vector<Result> results;
+
+    eva::Logger::ptr null_logger{MakeLogger("bench.null", std::make_shared<NullAppender>())};
+    for (int threads : ThreadCounts(options.max_threads)) {
+        results.push_back(Run("stream_null", threads, options.events, [&](size_t i) {
+            EVA_LOG_INFO(null_logger) << "bench message " << i << " value " << 3.14;
+        }));
+        results.push_back(Run("fmt_null", threads, options.events, [&](size_t i) {
+            EVA_LOG_FMT_INFO(null_logger, "bench message {} value {}", i, 3.14);
+        }));
+        results.push_back(Run("printf_null", threads, options.events, [&](size_t i) {
+            EVA_LOG_DEFINE_SITE(site);
+            eva::LogEventWrap{*null_logger, eva::LogLevel::Level::INFO, site}
+                .GetLogEvent()
+                .Printf("bench message %zu value %g", i, 3.14);
+        }));
+    }
+
+    {
+        auto appender{std::make_shared<NullAppender>()};
+        appender->SetFormatter(std::make_shared<eva::JsonLogFormatter>());
+        eva::Logger::ptr logger{MakeLogger("bench.json", appender)};
+        std::string message(200, 'm');
+        message += " \"quoted\" tail";
+        results.push_back(Run("json_kv_null", 1, options.events, [&](size_t i) {
+            EVA_LOG_KV_INFO(logger, "request_id", i, "path", "/api/v1/items") << message;
+        }));
+    }
+
+    null_logger->SetLevel(eva::LogLevel::Level::ERROR);
+    results.push_back(Run("disabled_level", 1, options.events, [&](size_t i) {
+        EVA_LOG_INFO(null_logger) << "bench message " << i;
+    }));
+    results.push_back(Run("storm_every_sec", 1, options.events, [&](size_t i) {
+        EVA_LOG_EVERY_SEC(null_logger, ERROR, 100) << "bench message " << i;
+    }));
+
+    {
+        StdoutToDevNull redirect;
+        eva::Logger::ptr logger{
+            MakeLogger("bench.stdout", std::make_shared<eva::StdoutLogAppender>())};
+        results.push_back(Run("stdout_devnull", 1, options.events, [&](size_t i) {
+            EVA_LOG_INFO(logger) << "bench message " << i << " value " << 3.14;
+        }));
+    }
+
+    std::string file_path = options.tmpdir + "/eva_bench_file.log";
+    std::string rolling_path = options.tmpdir + "/eva_bench_rolling.log";
+    for (int threads : ThreadCounts(options.max_threads)) {
+        std::remove(file_path.c_str());
+        eva::Logger::ptr ofstream_logger{
+            MakeLogger("bench.ofstream", std::make_shared<OfstreamFileAppender>(file_path))};
+        results.push_back(Run("file_ofstream_before", threads, options.events, [&](size_t i) {
+            EVA_LOG_INFO(ofstream_logger) << "bench message " << i << " value " << 3.14;
+        }));
+        ofstream_logger->ClearAppenders();
+
+        std::remove(file_path.c_str());
+        auto file_appender{std::make_shared<eva::FileLogAppender>(file_path)};
+        eva::Logger::ptr file_logger{MakeLogger("bench.file", file_appender)};
+        results.push_back(Run(
+            "file_tmpfs", threads, options.events,
+            [&](size_t i) {
+                EVA_LOG_INFO(file_logger) << "bench message " << i << " value " << 3.14;
+            },
+            [&] { file_appender->Flush(); }));
+        file_logger->ClearAppenders();
+
+        std::remove(rolling_path.c_str());
+        eva::Logger::ptr rolling_logger{MakeLogger(
+            "bench.rolling", std::make_shared<eva::RollingFileLogAppender>(rolling_path, 0))};
+        results.push_back(Run("rolling_tmpfs", threads, options.events, [&](size_t i) {
+            EVA_LOG_INFO(rolling_logger) << "bench message " << i << " value " << 3.14;
+        }));
+        rolling_logger->ClearAppenders();
+    }
+    std::remove(file_path.c_str());
+    std::remove(rolling_path.c_str());
+
+    std::FILE* out = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot open %s\n", options.output.c_str());
+        return 1;
+    }
+    WriteJson(out, options, results);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <log/log.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+
+// 改造前的实现：全局互斥锁 + std::map，count 和 operator[] 两次查找
+class MutexMapManager {
+public:
+    eva::Logger::ptr GetLogger(std::string const& name) {
+        std::lock_guard lk{mtx_};
+        if (loggers_.count(name)) {
+            return loggers_[name];
+        }
+        eva::Logger::ptr logger{new eva::Logger{name}};
+        loggers_[name] = logger;
+        return logger;
+    }
+
+private:
+    std::mutex mtx_;
+    std::map<std::string, eva::Logger::ptr> loggers_;
+};
+
+static std::vector<std::string> MakeNames() {
+    std::vector<std::string> names;
+    for (int i = 0; i < 64; ++i) {
+        names.push_back("service.module" + std::to_string(i));
+    }
+    return names;
+}
+
+/**
+ * @brief threads 个线程同时查找，返回总吞吐(百万次/秒)
+ */
+template <typename F>
+double MeasureMops(int threads, size_t per_thread, F&& lookup) {
+    std::vector<std::thread> workers;
+    uint64_t begin = eva::bench::NowNs();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([t, per_thread, &lookup] {
+            for (size_t i = 0; i < per_thread; ++i) {
+                lookup((i + t) & 63);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    double seconds = static_cast<double>(eva::bench::NowNs() - begin) / 1e9;
+    return static_cast<double>(threads * per_thread) / seconds / 1e6;
+}
+
+// 多线程竞争下的日志器查找吞吐：旧的 mutex+map、无锁哈希表、调用点缓存
+int main() {
+    constexpr size_t kPerThread = 1000000;
+    std::vector<std::string> const names = MakeNames();
+    MutexMapManager old_manager;
+    for (auto const& name : names) {
+        old_manager.GetLogger(name);
+        EVA_LOG_NAME(name);
+    }
+
+    int max_threads = static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        std::printf("threads=%d\n", threads);
+        std::printf("  %-38s %10.1f Mops/s\n", "mutex + std::map (before)",
+                    MeasureMops(threads, kPerThread, [&](size_t i) {
+                        eva::bench::DoNotOptimize(old_manager.GetLogger(names[i]).get());
+                    }));
+        std::printf("  %-38s %10.1f Mops/s\n", "EVA_LOG_NAME (lock-free)",
+                    MeasureMops(threads, kPerThread, [&](size_t i) {
+                        eva::bench::DoNotOptimize(EVA_LOG_NAME(names[i]).get());
+                    }));
+        std::printf("  %-38s %10.1f Mops/s\n", "EVA_LOGGER (per-site cache)",
+                    MeasureMops(threads, kPerThread, [](size_t) {
+                        eva::bench::DoNotOptimize(EVA_LOGGER("service.module0"));
+                    }));
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <fiber/scheduler.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+
+// 协程调度器：提交速率、协程互相唤醒、让出，以及 fork-join 从 1 到 N 个线程的扩展性
+namespace {
+
+/**
+ * @brief 启动调度器，执行 fn 提交任务，等待所有任务完成，返回耗时(纳秒)
+ */
+template <typename F>
+uint64_t RunScheduler(size_t threads, F&& fn) {
+    eva::Scheduler scheduler{threads, "bench"};
+    scheduler.Start();
+    uint64_t begin = eva::bench::NowNs();
+    fn(scheduler);
+    scheduler.Stop();
+    return eva::bench::NowNs() - begin;
+}
+
+void Spin(int n) {
+    for (int i = 0; i < n; ++i) {
+        asm volatile("");
+    }
+}
+
+void Fork(int depth, int work) {
+    if (depth == 0) {
+        Spin(work);
+        return;
+    }
+    eva::Scheduler* scheduler = eva::Scheduler::GetThis();
+    scheduler->Schedule([depth, work] { Fork(depth - 1, work); });
+    scheduler->Schedule([depth, work] { Fork(depth - 1, work); });
+}
+
+}  // namespace
+
+int main() {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    constexpr size_t kSpawn = 1000000;
+
+    // 提交速率：外部线程提交(全局队列)与工作线程内提交(本地队列)
+    uint64_t ns = RunScheduler(cores, [](eva::Scheduler& scheduler) {
+        for (size_t i = 0; i < kSpawn; ++i) {
+            scheduler.Schedule([] {});
+        }
+    });
+    eva::bench::Report("spawn from outside (per task)", static_cast<double>(ns) / kSpawn);
+
+    ns = RunScheduler(cores, [](eva::Scheduler& scheduler) {
+        scheduler.Schedule([] {
+            for (size_t i = 0; i < kSpawn; ++i) {
+                eva::Scheduler::GetThis()->Schedule([] {});
+            }
+        });
+    });
+    eva::bench::Report("spawn from worker (per task)", static_cast<double>(ns) / kSpawn);
+
+    // 让出：一个协程反复 Scheduler::Yield
+    constexpr size_t kYields = 1000000;
+    ns = RunScheduler(1, [](eva::Scheduler& scheduler) {
+        scheduler.Schedule([] {
+            for (size_t i = 0; i < kYields; ++i) {
+                eva::Scheduler::Yield();
+            }
+        });
+    });
+    eva::bench::Report("Scheduler::Yield (1 thread)", static_cast<double>(ns) / kYields);
+
+    // 互相唤醒：两个协程交替提交对方后挂起
+    constexpr int kRounds = 500000;
+    for (size_t threads : {size_t{1}, cores}) {
+        std::atomic<int> count{0};
+        std::atomic<bool> finished{false};
+        eva::Fiber::ptr ping;
+        eva::Fiber::ptr pong;
+        auto body = [&](eva::Fiber::ptr& peer) {
+            return [&] {
+                while (count.fetch_add(1, std::memory_order_relaxed) < kRounds) {
+                    eva::Scheduler::GetThis()->Schedule(peer);
+                    eva::Fiber::Yield();
+                }
+                if (!finished.exchange(true)) {
+                    eva::Scheduler::GetThis()->Schedule(peer);
+                }
+            };
+        };
+        ping = std::make_shared<eva::Fiber>(body(pong));
+        pong = std::make_shared<eva::Fiber>(body(ping));
+        ns = RunScheduler(threads, [&](eva::Scheduler& scheduler) { scheduler.Schedule(ping); });
+        char name[64];
+        std::snprintf(name, sizeof(name), "ping-pong (%zu threads, per hop)", threads);
+        eva::bench::Report(name, static_cast<double>(ns) / kRounds);
+    }
+
+    // fork-join：2^16 个叶子任务，每个做少量计算
+    constexpr int kDepth = 16;
+    constexpr int kWork = 2000;
+    uint64_t base = 0;
+    for (size_t threads = 1; threads <= cores;
+         threads = threads < cores ? std::min(threads * 2, cores) : cores + 1) {
+        ns = RunScheduler(threads, [](eva::Scheduler& scheduler) {
+            scheduler.Schedule([] { Fork(kDepth, kWork); });
+        });
+        if (threads == 1) {
+            base = ns;
+        }
+        std::printf("fork-join %2zu threads %10.2f ms  speedup %5.2fx\n", threads, ns / 1e6,
+                    static_cast<double>(base) / ns);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <util/util.h>
+
+#include <string>
+
+#include "bench_util.h"
+
+// 对比改造前每次都走系统调用/pthread_getname_np 的实现与线程局部缓存的实现
+int main() {
+    constexpr size_t kIterations = 2000000;
+
+    eva::bench::Report("syscall(SYS_gettid)", eva::bench::MeasureNsPerOp(kIterations, [] {
+                           eva::bench::DoNotOptimize(static_cast<pid_t>(syscall(SYS_gettid)));
+                       }));
+
+    eva::bench::Report("eva::GetThreadId (cached)", eva::bench::MeasureNsPerOp(kIterations, [] {
+                           eva::bench::DoNotOptimize(eva::GetThreadId());
+                       }));
+
+    eva::bench::Report("pthread_getname_np -> std::string",
+                       eva::bench::MeasureNsPerOp(kIterations, [] {
+                           char name[16] = {0};
+                           pthread_getname_np(pthread_self(), name, 16);
+                           eva::bench::DoNotOptimize(std::string(name).size());
+                       }));
+
+    eva::bench::Report("eva::GetThreadName (cached)", eva::bench::MeasureNsPerOp(kIterations, [] {
+                           eva::bench::DoNotOptimize(eva::GetThreadName().size());
+                       }));
+
+    eva::SetThreadName("bench-renamed");
+    eva::bench::Report("eva::GetThreadName after SetThreadName",
+                       eva::bench::MeasureNsPerOp(kIterations, [] {
+                           eva::bench::DoNotOptimize(eva::GetThreadName().size());
+                       }));
+
+    return 0;
+}
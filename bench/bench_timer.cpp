@@ -0,0 +1,151 @@
+#include <fiber/io_manager.h>
+#include <fiber/timer.h>
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "bench_util.h"
+
+// 定时器：百万个未到期定时器下时间轮与有序集合(红黑树)的插入/取消，TimerManager 的添加/取消，
+// 以及大量协程 SleepFor 的开销
+namespace {
+
+constexpr size_t kOutstanding = 1000000;
+
+std::vector<uint64_t> RandomExpiries(size_t n) {
+    std::mt19937_64 rng{1};
+    std::vector<uint64_t> expiries(n);
+    for (auto& expire : expiries) {
+        expire = 1000 + rng() % 3600000;
+    }
+    return expiries;
+}
+
+/**
+ * @brief 时间轮中已有 kOutstanding 个节点时，每次插入再取消一个节点的纳秒数
+ */
+double WheelInsertCancel(std::vector<uint64_t> const& expiries) {
+    eva::TimerWheel wheel{0};
+    std::vector<eva::TimerWheel::Node> nodes(expiries.size());
+    for (size_t i = 0; i < expiries.size(); ++i) {
+        wheel.Insert(&nodes[i], expiries[i]);
+    }
+    eva::TimerWheel::Node extra;
+    size_t i = 0;
+    return eva::bench::MeasureNsPerOp(kOutstanding, [&] {
+        wheel.Insert(&extra, expiries[i++ % expiries.size()]);
+        wheel.Remove(&extra);
+    });
+}
+
+/**
+ * @brief 同样的操作用 std::multiset(按到期时间排序)实现
+ */
+double SetInsertCancel(std::vector<uint64_t> const& expiries) {
+    std::multiset<std::pair<uint64_t, size_t>> timers;
+    for (size_t i = 0; i < expiries.size(); ++i) {
+        timers.emplace(expiries[i], i);
+    }
+    size_t i = 0;
+    return eva::bench::MeasureNsPerOp(kOutstanding, [&] {
+        auto it = timers.emplace(expiries[i % expiries.size()], expiries.size() + i);
+        ++i;
+        timers.erase(it);
+    });
+}
+
+/**
+ * @brief kOutstanding 个节点按到期时间依次推进取出，平均每个节点的纳秒数
+ */
+double WheelExpire(std::vector<uint64_t> const& expiries) {
+    eva::TimerWheel wheel{0};
+    std::vector<eva::TimerWheel::Node> nodes(expiries.size());
+    for (size_t i = 0; i < expiries.size(); ++i) {
+        wheel.Insert(&nodes[i], expiries[i]);
+    }
+    uint64_t begin = eva::bench::NowNs();
+    size_t fired = 0;
+    for (uint64_t now = 0; wheel.Size() != 0; now += 10) {
+        for (auto* node = wheel.Advance(now); node;
+             node = static_cast<eva::TimerWheel::Node*>(node->next)) {
+            ++fired;
+        }
+    }
+    eva::bench::DoNotOptimize(fired);
+    return static_cast<double>(eva::bench::NowNs() - begin) / static_cast<double>(fired);
+}
+
+double SetExpire(std::vector<uint64_t> const& expiries) {
+    std::multiset<std::pair<uint64_t, size_t>> timers;
+    for (size_t i = 0; i < expiries.size(); ++i) {
+        timers.emplace(expiries[i], i);
+    }
+    uint64_t begin = eva::bench::NowNs();
+    size_t fired = 0;
+    for (uint64_t now = 0; !timers.empty(); now += 10) {
+        while (!timers.empty() && timers.begin()->first <= now) {
+            timers.erase(timers.begin());
+            ++fired;
+        }
+    }
+    eva::bench::DoNotOptimize(fired);
+    return static_cast<double>(eva::bench::NowNs() - begin) / static_cast<double>(fired);
+}
+
+/**
+ * @brief IOManager 中已有 kOutstanding 个定时器时，AddTimer + CancelTimer 的纳秒数
+ */
+double ManagerAddCancel(std::vector<uint64_t> const& expiries) {
+    eva::IOManager iom{1, "bench"};
+    iom.Start();
+    std::vector<eva::TimerManager::TimerId> ids;
+    ids.reserve(expiries.size());
+    for (uint64_t expire : expiries) {
+        ids.push_back(iom.AddTimer(expire, [] {}));
+    }
+    size_t i = 0;
+    double ns = eva::bench::MeasureNsPerOp(kOutstanding, [&] {
+        iom.CancelTimer(iom.AddTimer(expiries[i++ % expiries.size()], [] {}));
+    });
+    // 全部取消，Stop 不必等待
+    for (auto id : ids) {
+        iom.CancelTimer(id);
+    }
+    iom.Stop();
+    return ns;
+}
+
+/**
+ * @brief fibers 个协程各 SleepFor(1) rounds 次，返回平均每次休眠的纳秒数
+ * @details 协程足够多时 1 毫秒的等待被摊薄，结果主要是挂起、定时器和重新调度的开销
+ */
+double SleepRoundTrip(size_t fibers, int rounds) {
+    eva::IOManager iom{1, "bench"};
+    iom.Start();
+    uint64_t begin = eva::bench::NowNs();
+    for (size_t i = 0; i < fibers; ++i) {
+        iom.Schedule([rounds] {
+            for (int round = 0; round < rounds; ++round) {
+                eva::IOManager::SleepFor(1);
+            }
+        });
+    }
+    iom.Stop();
+    uint64_t ns = eva::bench::NowNs() - begin;
+    return static_cast<double>(ns) / (static_cast<double>(fibers) * rounds);
+}
+
+}  // namespace
+
+int main() {
+    std::vector<uint64_t> expiries = RandomExpiries(kOutstanding);
+    eva::bench::Report("wheel insert+cancel, 1M outstanding", WheelInsertCancel(expiries));
+    eva::bench::Report("multiset insert+cancel, 1M outstanding", SetInsertCancel(expiries));
+    eva::bench::Report("wheel expire, per timer", WheelExpire(expiries));
+    eva::bench::Report("multiset expire, per timer", SetExpire(expiries));
+    eva::bench::Report("TimerManager add+cancel, 1M outstanding", ManagerAddCancel(expiries));
+    eva::bench::Report("SleepFor(1), 100000 fibers", SleepRoundTrip(100000, 10));
+    return 0;
+}
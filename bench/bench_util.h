@@ -0,0 +1,50 @@
+#pragma once
+
+#include <time.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace eva::bench {
+
+/**
+ * @brief 单调时钟纳秒数
+ */
+inline uint64_t NowNs() {
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief 阻止编译器把基准测试中的计算结果优化掉
+ */
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief 先预热再计时，返回每次调用的平均纳秒数
+ */
+template <typename F>
+double MeasureNsPerOp(size_t iterations, F&& fn) {
+    for (size_t i = 0; i < iterations / 10 + 1; ++i) {
+        fn();
+    }
+    uint64_t begin = NowNs();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return static_cast<double>(NowNs() - begin) / iterations;
+}
+
+/**
+ * @brief 输出一行结果
+ */
+inline void Report(char const* name, double ns_per_op) {
+    std::printf("%-40s %10.1f ns/op\n", name, ns_per_op);
+}
+
+}  // namespace eva::bench
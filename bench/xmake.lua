@@ -0,0 +1,66 @@
+-- 日志热路径基准测试套件，结果以 JSON 输出：xmake run bench --output result.json
+target("bench", function()
+    set_kind("binary")
+    add_files("bench_log.cpp")
+    add_deps("log")
+end)
+
+target("bench_formatter", function()
+    set_kind("binary")
+    add_files("bench_formatter.cpp")
+    add_deps("log")
+end)
+
+target("bench_thread_id", function()
+    set_kind("binary")
+    add_files("bench_thread_id.cpp")
+    add_deps("util")
+end)
+
+target("bench_binary_log", function()
+    set_kind("binary")
+    add_files("bench_binary_log.cpp")
+    add_deps("log")
+end)
+
+target("bench_level_check", function()
+    set_kind("binary")
+    add_files("bench_level_check.cpp")
+    add_deps("log")
+end)
+
+target("bench_logger_lookup", function()
+    set_kind("binary")
+    add_files("bench_logger_lookup.cpp")
+    add_deps("log")
+end)
+
+target("bench_fiber", function()
+    set_kind("binary")
+    add_files("bench_fiber.cpp")
+    add_deps("fiber")
+end)
+
+target("bench_scheduler", function()
+    set_kind("binary")
+    add_files("bench_scheduler.cpp")
+    add_deps("fiber")
+end)
+
+target("bench_io_manager", function()
+    set_kind("binary")
+    add_files("bench_io_manager.cpp")
+    add_deps("fiber")
+end)
+
+target("bench_timer", function()
+    set_kind("binary")
+    add_files("bench_timer.cpp")
+    add_deps("fiber")
+end)
+
+target("bench_fiber_stack", function()
+    set_kind("binary")
+    add_files("bench_fiber_stack.cpp")
+    add_deps("fiber")
+end)
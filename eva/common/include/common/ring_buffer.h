@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace eva {
+
+/**
+ * @brief 有界无锁环形队列(多生产者多消费者)
+ * @details 参考 Dmitry Vyukov 的 bounded MPMC queue：每个槽位带一个序号，
+ * 生产者/消费者各自 CAS 推进 enqueue_pos_/dequeue_pos_，槽位序号用于判断该槽是否可写/可读。
+ * 因为支持多消费者，生产者也可以在队列满时自己弹出最旧元素(丢弃最旧策略)。
+ * @note 容量会向上取整为 2 的幂
+ */
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(RingBuffer const&) = delete;
+    RingBuffer& operator=(RingBuffer const&) = delete;
+
+public:
+    /**
+     * @brief 尝试入队，队列满时返回 false 且不修改 value
+     * @details 传入左值时拷贝赋值进槽位，传入右值时移动赋值，槽位对象本身一直复用
+     */
+    template <typename U>
+    bool TryPush(U&& value) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 满
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 尝试出队，队列空时返回 false
+     */
+    bool TryPop(T& value) {
+        Cell* cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 空
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 队列中元素个数的近似值(并发下仅供参考)
+     */
+    size_t SizeApprox() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t deq = dequeue_pos_.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief 入队位置：此前成功入队的元素都占用了小于它的位置
+     */
+    size_t EnqueuePos() const { return enqueue_pos_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 出队位置：小于它的位置都已被取出(元素可能还在被出队方移走)，按位置顺序出队
+     */
+    size_t DequeuePos() const { return dequeue_pos_.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    static constexpr size_t kCacheLine = 64;
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_{0};
+    alignas(kCacheLine) std::atomic<size_t> enqueue_pos_{0};  // 生产者位置(独占缓存行)
+    alignas(kCacheLine) std::atomic<size_t> dequeue_pos_{0};  // 消费者位置(独占缓存行)
+};
+
+}  // namespace eva
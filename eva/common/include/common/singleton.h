@@ -6,6 +6,11 @@
 
 namespace eva {
 
+/**
+ * @brief 单例
+ * @details 首次调用时构造(函数内静态变量，C++11 起线程安全)，之后每次获取只是读一个指针，
+ * 不再拷贝 shared_ptr。实例故意不析构，保证静态析构阶段(其他全局对象的析构函数中)仍然可用
+ */
 template <typename T>
 class Singleton {
 private:
@@ -13,15 +18,11 @@ private:
     Singleton(Singleton<T> const&) = delete;
     Singleton& operator=(Singleton<T> const&) = delete;
 
-    inline static std::shared_ptr<T> instance_{nullptr};
-
 public:
     ~Singleton() = default;
-    static std::shared_ptr<T> GetInstance() {
-        if (!instance_) {
-            instance_ = std::shared_ptr<T>{new T};
-        }
-        return instance_;
+    static T* GetInstance() {
+        static T* instance{new T};
+        return instance;
     }
 };
 
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+namespace eva {
+
+/**
+ * @brief 保存的执行上下文，只是一个栈指针
+ * @details 切换时被调用者保存的寄存器压在切出方自己的栈上，栈指针就是全部状态；
+ * 调用者保存的寄存器已经由编译器在调用 eva_swap_context 前处理，不需要保存
+ */
+using FiberContext = void*;
+
+/**
+ * @brief 在一段新栈上构造初始上下文
+ * @details 第一次切换到返回的上下文时，在这段栈上调用 entry(arg)；entry 不能返回，
+ * 结束时必须切换到其他上下文
+ * @param[in] stack 栈的最低地址
+ * @param[in] size 栈大小
+ */
+FiberContext MakeFiberContext(void* stack, size_t size, void (*entry)(void*), void* arg);
+
+/**
+ * @brief 把当前上下文保存到 *from，切换到 to
+ * @details 手写汇编(context.S)，只保存被调用者保存的寄存器和浮点控制字，不像 swapcontext
+ * 那样每次切换都调用 sigprocmask；从 to 切换回来时返回
+ */
+extern "C" void eva_swap_context(FiberContext* from, FiberContext to);
+
+}  // namespace eva
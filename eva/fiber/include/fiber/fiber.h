@@ -1,12 +1,181 @@
 #pragma once
 
+#include <fiber/context.h>
+#include <fiber/stack.h>
+
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
 
 namespace eva {
 
-class Fiber {
+/**
+ * @brief 有栈协程
+ * @details 非对称协程：Resume 从当前协程切换到目标协程并记下调用方，Yield 切换回调用方。
+ * 每个线程第一次使用协程时创建一个主协程代表线程本身(使用线程栈)，协程可以嵌套 Resume。
+ * 协程可以在一个线程上让出、在另一个线程上恢复，但同一时刻只能被一个线程 Resume
+ *
+ * 栈由 StackAllocator 分配，带保护页，溢出时输出指明协程 id 的 FATAL 信息后以 SIGSEGV 终止。
+ * 共享栈模式的协程没有自己的栈，运行在线程的共享栈上：切换到另一个共享栈协程时才把原协程
+ * 栈上实际使用的部分拷出，内存占用与实际栈深度成正比，代价是切换时的拷贝。共享栈协程第一次
+ * 运行后固定在那个线程上(栈中有指向自身的指针，不能换地址)，不能 Resume 同一线程上的其他
+ * 共享栈协程
+ *
+ * 用法：
+ *   auto fiber{std::make_shared<eva::Fiber>([] {
+ *       step1();
+ *       eva::Fiber::Yield();  // 回到 Resume 的调用方
+ *       step2();
+ *   })};
+ *   fiber->Resume();  // 执行 step1
+ *   fiber->Resume();  // 执行 step2，之后状态为 TERM
+ *
+ * @note 不要在 catch 块中 Yield：C++ 运行时按线程记录正在处理的异常，跨协程切换会错乱
+ */
+class Fiber : public std::enable_shared_from_this<Fiber> {
+public:
+    using ptr = std::shared_ptr<Fiber>;
+
+    enum class State {
+        READY,      // 已创建或已 Reset，尚未运行
+        RUNNING,    // 正在运行(或正在等待它 Resume 的协程让出)
+        SUSPENDED,  // 已让出，等待 Resume
+        TERM,       // 正常结束
+        EXCEPT      // 抛出异常结束
+    };
+
+    static constexpr size_t kDefaultStackSize = 128 * 1024;
+    // 每个线程共享栈的大小，共享栈协程的最大栈深度
+    static constexpr size_t kSharedStackSize = 1024 * 1024;
+
+    /**
+     * @brief 构造函数
+     * @param[in] cb 协程执行的函数
+     * @param[in] stack_size 栈大小，共享栈模式下忽略
+     * @param[in] shared_stack 是否使用共享栈模式
+     */
+    explicit Fiber(std::function<void()> cb, size_t stack_size = kDefaultStackSize,
+                   bool shared_stack = false);
+
+    /**
+     * @brief 析构函数
+     * @details 不能析构正在运行的协程；析构处于 SUSPENDED 的协程时，其栈上的对象不会析构
+     */
+    ~Fiber();
+
+    Fiber(Fiber const&) = delete;
+    Fiber& operator=(Fiber const&) = delete;
+
 public:
+    /**
+     * @brief 复用协程栈执行新的函数，只能在 READY、TERM 或 EXCEPT 状态下调用
+     */
+    void Reset(std::function<void()> cb);
+
+    /**
+     * @brief 从当前协程切换到本协程，本协程让出或结束时返回
+     * @details 只能在 READY 或 SUSPENDED 状态下调用；协程函数抛出的异常在这里重新抛出
+     */
+    void Resume();
+
+    /**
+     * @brief 当前协程让出，切换回 Resume 它的协程；不能在主协程中调用
+     */
+    static void Yield();
+
+public:
+    uint64_t GetId() const { return id_; }
+
+    bool IsSharedStack() const { return shared_; }
+
+    /**
+     * @brief 协程只能在哪个工作线程上恢复，-1 表示不限
+     * @details 由调度器维护：共享栈协程第一次运行时固定到当时的工作线程
+     */
+    int GetAffinity() const { return affinity_; }
+
+    void SetAffinity(int affinity) { affinity_ = affinity; }
+
+    /**
+     * @brief 协程状态
+     * @details 让出或结束后的状态在切换完成、上下文已保存之后才发布，
+     * 其他线程看到 SUSPENDED 时可以立即 Resume
+     */
+    State GetState() const { return state_.load(std::memory_order_acquire); }
+
+public:
+    /**
+     * @brief 获取当前协程，线程中还没有协程时创建主协程
+     */
+    static Fiber* GetThis();
+
+    /**
+     * @brief 获取当前协程 id，读取线程局部指针；线程从未使用协程时返回 0，不创建主协程
+     */
     static uint64_t GetFiberId();
+
+    /**
+     * @brief 存活的协程数(含主协程)
+     */
+    static uint64_t TotalFibers();
+
+    /**
+     * @brief 出错地址是否落在当前协程栈的保护页上，是则给出协程 id 和栈大小
+     * @details 异步信号安全，供 SIGSEGV 的处理函数使用
+     */
+    static bool IsStackOverflow(void const* addr, uint64_t* id, size_t* stack_size) noexcept;
+
+private:
+    struct SharedStack;
+
+    /**
+     * @brief 当前线程的共享栈，第一次调用时分配
+     */
+    static std::shared_ptr<SharedStack> const& GetSharedStack();
+
+    /**
+     * @brief 主协程构造函数，代表线程本身，没有独立的栈
+     */
+    Fiber();
+
+    /**
+     * @brief 协程入口，执行协程函数后切换回调用方，不会返回
+     */
+    static void MainFunc(void* arg);
+
+    /**
+     * @brief 切换回调用方，切换完成后由调用方把状态发布为 next
+     */
+    void SwitchToCaller(State next);
+
+    /**
+     * @brief Resume 前把本协程的栈内容换到共享栈上，先拷出原占用者的栈内容
+     */
+    void SwapInSharedStack();
+
+    /**
+     * @brief 拷出共享栈上实际使用的部分；调用者持有共享栈的锁
+     */
+    void SaveStack();
+
+private:
+    uint64_t id_;                        // 协程 id
+    std::atomic<State> state_;           // 协程状态
+    State next_state_;                   // 切出后要发布的状态
+    FiberContext ctx_{nullptr};          // 切出时保存的上下文
+    FiberStack stack_;                   // 协程栈，主协程和共享栈协程为空
+    bool shared_{false};                 // 是否使用共享栈
+    int affinity_{-1};                   // 固定的工作线程
+    std::shared_ptr<SharedStack> home_;  // 共享栈协程第一次运行时绑定的共享栈
+    std::unique_ptr<char[]> saved_;      // 从共享栈拷出的栈内容
+    size_t saved_size_{0};               // saved_ 中有效的字节数
+    size_t saved_capacity_{0};           // saved_ 的容量
+    Fiber* caller_{nullptr};             // Resume 本协程的协程
+    std::function<void()> cb_;           // 协程执行的函数
+    std::exception_ptr exception_;       // 协程函数抛出的异常，由 Resume 重新抛出
 };
 
 }  // namespace eva
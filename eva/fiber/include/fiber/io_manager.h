@@ -0,0 +1,240 @@
+#pragma once
+
+#include <fiber/poller.h>
+#include <fiber/scheduler.h>
+#include <fiber/timer.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief 支持 IO 事件的协程调度器
+ * @details 等待 fd 就绪的协程挂起，不占用工作线程，就绪后重新提交到调度器。空闲的工作线程中
+ * 同一时刻只有一个在 Poller::Wait 上等待事件，其他的在 futex 上休眠；一直忙碌的工作线程
+ * 每调度 61 次非阻塞地收集一次事件。
+ *
+ * 后端可以选择 epoll 或 io_uring，默认内核支持时使用 io_uring。io_uring 后端中 Read/Write/
+ * Accept/Connect 直接提交请求，完成后唤醒协程，不需要先等待就绪再调用；请求先放进提交队列，
+ * 工作线程休眠或收集事件时一次系统调用批量提交。
+ *
+ * 定时器到期时提交回调或重新调度协程，等待事件的线程按最近的到期时间设置超时；SleepFor 只挂起
+ * 当前协程。Read/Write/Accept/Connect 可以指定超时，超时以 ETIMEDOUT 失败。
+ *
+ * fd 需要设置 O_NONBLOCK。Stop 会等待所有等待中的事件、请求和定时器完成，停止前先 CancelAll，
+ * 并取消周期定时器。
+ *
+ * 用法：
+ *   eva::IOManager iom{4};
+ *   iom.Start();
+ *   iom.Schedule([&] { ssize_t n = iom.Read(fd, buf, sizeof(buf)); ... });
+ *   iom.Stop();
+ */
+class IOManager : public Scheduler, public TimerManager {
+public:
+    using ptr = std::shared_ptr<IOManager>;
+
+    enum Event : uint32_t {
+        NONE = 0x0,
+        READ = EPOLLIN,
+        WRITE = EPOLLOUT,
+    };
+
+    enum class Backend {
+        AUTO,      // 支持时用 io_uring，否则 epoll
+        EPOLL,     // epoll
+        IO_URING,  // io_uring，不支持时退回 epoll
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] threads 工作线程数，0 表示 CPU 核数
+     * @param[in] name 调度器名称
+     * @param[in] backend 事件后端
+     */
+    explicit IOManager(size_t threads = 0, std::string const& name = "io",
+                       Backend backend = Backend::AUTO);
+
+    ~IOManager() override;
+
+public:
+    /**
+     * @brief 等待 fd 上的事件，就绪后执行 cb，cb 为空时重新调度当前协程
+     * @details 每个 fd 的每种事件同一时刻只能有一个等待者；就绪可能是虚假的，调用者应重试 IO
+     * @return 已有等待者或后端注册失败时返回 false
+     */
+    bool AddEvent(int fd, Event event, std::function<void()> cb = nullptr);
+
+    /**
+     * @brief 删除等待的事件，不触发
+     */
+    bool DelEvent(int fd, Event event);
+
+    /**
+     * @brief 删除等待的事件，并触发一次
+     */
+    bool CancelEvent(int fd, Event event);
+
+    /**
+     * @brief 触发 fd 上所有等待的事件，并取消 fd 上未完成的请求(以 ECANCELED 失败)
+     * @details 关闭 fd 前调用，io_uring 的请求持有文件的引用，不会因为 close 而结束
+     */
+    bool CancelAll(int fd);
+
+    /**
+     * @brief 和 read/write/accept4/connect 相同，但在本调度器的协程中调用时阻塞的是协程而不是线程
+     * @details 不在本调度器的工作线程中调用时直接执行系统调用，忽略超时。Accept 返回的 fd 设置了
+     * SOCK_NONBLOCK | SOCK_CLOEXEC
+     * @param[in] timeout_ms 超时时间(毫秒)，超时返回 -1，errno 为 ETIMEDOUT
+     */
+    ssize_t Read(int fd, void* buf, size_t len, uint64_t timeout_ms = kNoTimeout);
+    ssize_t Write(int fd, void const* buf, size_t len, uint64_t timeout_ms = kNoTimeout);
+    int Accept(int fd, sockaddr* addr = nullptr, socklen_t* addrlen = nullptr,
+               uint64_t timeout_ms = kNoTimeout);
+    int Connect(int fd, sockaddr const* addr, socklen_t addrlen, uint64_t timeout_ms = kNoTimeout);
+
+    Backend GetBackend() const { return backend_; }
+
+    /**
+     * @brief 等待中的事件和请求数
+     */
+    size_t GetPendingCount() const;
+
+public:
+    /**
+     * @brief 当前线程所属的 IOManager，非 IOManager 的工作线程返回 nullptr
+     */
+    static IOManager* GetThis();
+
+    /**
+     * @brief 挂起当前协程 ms 毫秒，工作线程继续执行其他协程
+     * @details 不在 IOManager 的工作线程中调用时让线程休眠
+     */
+    static void SleepFor(uint64_t ms);
+
+protected:
+    void Park(size_t index) override;
+
+    void Unpark(size_t index) override;
+
+    bool HasPendingWork() const override {
+        // 先看定时器数再看批次数：取出定时器前已计入批次，两者不会同时读到 0
+        return GetPendingCount() != 0 || GetTimerCount() != 0 || expiring_.load() != 0;
+    }
+
+    void Poll(size_t index) override;
+
+    void OnTimerInsertedAtFront() override;
+
+private:
+    /**
+     * @brief fd 上等待的事件
+     */
+    struct FdContext {
+        struct Waiter {
+            Fiber::ptr fiber;
+            std::function<void()> cb;
+            int* error{nullptr};  // 被取消或超时时写入 ECANCELED/ETIMEDOUT，在等待的协程栈上
+        };
+
+        std::mutex mtx;
+        uint32_t events{NONE};     // 等待中的事件
+        uint64_t poll_state{0};    // 后端状态
+        Waiter read;
+        Waiter write;
+
+        Waiter& GetWaiter(Event event) { return event == READ ? read : write; }
+    };
+
+    /**
+     * @brief 提交给后端的请求，在发起请求的协程栈上
+     */
+    struct Completion {
+        Fiber::ptr fiber;
+        int32_t result{0};
+        IOManager* iom{nullptr};
+        bool timed_out{false};  // 超时后取消了请求
+    };
+
+    /**
+     * @brief 等待就绪超时的定时器参数，在等待的协程栈上
+     */
+    struct WaitTimeout {
+        IOManager* iom;
+        int fd;
+        Event event;
+        int* error;
+    };
+
+    FdContext* GetFdContext(int fd, bool create);
+
+    bool Register(int fd, Event event, std::function<void()> cb, int* error);
+
+    /**
+     * @brief 调度等待者并清空，error 非 0 时写给等待者；调用者持有 ctx.mtx
+     */
+    void Trigger(FdContext::Waiter& waiter, int error);
+
+    /**
+     * @brief 处理后端返回的事件，不持有任何锁
+     */
+    void Dispatch(Poller::Event const* events, size_t n);
+
+    void OnReady(Poller::Event const& event);
+
+    /**
+     * @brief 提交请求并挂起当前协程，返回请求的结果，超时返回 -ETIMEDOUT
+     */
+    int SubmitAndWait(Poller::Request const& request, uint64_t timeout_ms);
+
+    /**
+     * @brief 挂起当前协程直到 fd 上的事件就绪，被取消或超时返回 false，errno 为 ECANCELED/ETIMEDOUT
+     */
+    bool WaitEvent(int fd, Event event, uint64_t timeout_ms);
+
+    /**
+     * @brief 超时的定时器动作，在 TakeExpired 中调用
+     */
+    static void OnWaitTimeout(void* arg);
+    static void OnRequestTimeout(void* arg);
+
+    /**
+     * @brief 调度到期的定时器
+     */
+    void ProcessTimers();
+
+    /**
+     * @brief 在工作线程之外修改了提交队列时立即提交，没有工作线程会替它提交
+     */
+    void FlushIfExternal();
+
+    template <typename Syscall>
+    ssize_t DoIo(int fd, Event event, Poller::Request const& request, uint64_t timeout_ms,
+                 Syscall syscall);
+
+private:
+    static constexpr size_t kNoPoller = static_cast<size_t>(-1);
+
+    Backend backend_;
+    std::unique_ptr<Poller> poller_;
+    std::mutex poll_mtx_;                          // 持有者负责等待后端的事件
+    std::atomic<size_t> polling_{kNoPoller};       // 在 Poller::Wait 中阻塞的工作线程
+    std::shared_mutex fd_mtx_;                     // 保护 fd_contexts_ 的扩容
+    std::vector<std::unique_ptr<FdContext>> fd_contexts_;
+    std::atomic<size_t> pending_events_{0};        // 等待中的事件数
+    std::atomic<size_t> pending_requests_{0};      // 未完成的请求数
+    std::atomic<size_t> expiring_{0};              // 已从时间轮取出、还没有调度的定时器批次
+};
+
+}  // namespace eva
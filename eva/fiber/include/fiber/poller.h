@@ -0,0 +1,110 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace eva {
+
+/**
+ * @brief IOManager 的事件后端：epoll 或 io_uring
+ * @details 两种后端都支持监听 fd 的读写就绪；io_uring 还支持提交读、写、accept、connect，
+ * 完成后直接返回结果。提交的请求先放进提交队列，Flush 或 Wait 时一次系统调用批量提交。
+ *
+ * 每个 fd 的后端状态由调用者保存(初始为 0)，Update 和 Accept 都要在持有该 fd 的锁时调用；
+ * Wait 同一时刻只能有一个线程调用，其他方法是线程安全的
+ */
+class Poller {
+public:
+    /**
+     * @brief 就绪的 fd 事件或完成的请求
+     */
+    struct Event {
+        int fd;           // 就绪的 fd，-1 表示完成的请求
+        uint32_t events;  // 就绪的事件(EPOLLIN/EPOLLOUT/EPOLLERR/EPOLLHUP)
+        uint64_t data;    // 后端内部数据；完成的请求为 Submit 时传入的 data
+        int32_t result;   // 请求的结果，失败为 -errno
+    };
+
+    /**
+     * @brief 提交给 io_uring 的请求
+     */
+    struct Request {
+        enum Op : uint8_t { READ, WRITE, ACCEPT, CONNECT };
+
+        Op op;
+        int fd;
+        void* buf{nullptr};           // READ/WRITE 的缓冲区，ACCEPT/CONNECT 的地址
+        uint32_t len{0};              // READ/WRITE 的长度，CONNECT 的地址长度
+        socklen_t* addrlen{nullptr};  // ACCEPT 的地址长度
+        int flags{0};                 // ACCEPT 的 flags
+    };
+
+    virtual ~Poller() = default;
+
+    virtual char const* GetName() const = 0;
+
+    /**
+     * @brief 把 fd 在内核中监听的事件改为 events(EPOLLIN/EPOLLOUT 的组合，0 表示不再监听)
+     * @param[in,out] state fd 的后端状态
+     */
+    virtual bool Update(int fd, uint64_t& state, uint32_t events) = 0;
+
+    /**
+     * @brief 处理 Wait 返回的就绪事件，返回仍然有效的事件(过期或已取消的事件返回 0)
+     * @details 只报告一次的后端(io_uring)中这些事件不再被监听，调用者需要时重新 Update
+     */
+    virtual uint32_t Accept(uint64_t& state, Event const& event) = 0;
+
+    /**
+     * @brief 等待就绪的事件和完成的请求，最多 max 个
+     * @param[in] timeout_ms 超时时间，-1 表示一直等待，0 表示不等待
+     * @return 事件数，被 Wakeup 唤醒或超时返回 0
+     */
+    virtual size_t Wait(Event* events, size_t max, int timeout_ms) = 0;
+
+    /**
+     * @brief 唤醒 Wait 中的线程；没有线程在 Wait 时，下一次 Wait 立即返回
+     */
+    virtual void Wakeup() = 0;
+
+    /**
+     * @brief 是否支持 Submit
+     */
+    virtual bool SupportsRequests() const { return false; }
+
+    /**
+     * @brief 提交请求，完成后 Wait 返回 fd 为 -1、data 为 data 的事件；请求用到的内存要保持到完成
+     */
+    virtual bool Submit(Request const& /*request*/, uint64_t /*data*/) { return false; }
+
+    /**
+     * @brief 取消 fd 上所有未完成的请求和监听，被取消的请求以 -ECANCELED 完成
+     */
+    virtual void Cancel(int /*fd*/) {}
+
+    /**
+     * @brief 取消 Submit 时数据为 data 的请求，请求还没完成时以 -ECANCELED 完成
+     */
+    virtual void CancelRequest(uint64_t /*data*/) {}
+
+    /**
+     * @brief 提交队列中的请求
+     */
+    virtual void Flush() {}
+};
+
+/**
+ * @brief 创建 epoll 后端，失败返回 nullptr
+ */
+std::unique_ptr<Poller> CreateEpollPoller();
+
+/**
+ * @brief 创建 io_uring 后端，内核不支持(或被禁用)时返回 nullptr
+ * @param[in] entries 提交队列的大小
+ */
+std::unique_ptr<Poller> CreateUringPoller(unsigned entries = 4096);
+
+}  // namespace eva
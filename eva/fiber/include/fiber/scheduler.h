@@ -0,0 +1,227 @@
+#pragma once
+
+#include <fiber/fiber.h>
+#include <fiber/work_steal_deque.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief M:N 协程调度器
+ * @details 每个工作线程拥有一个 WorkStealDeque：工作线程里提交的任务压入自己的队列(无锁、
+ * 无原子读改写)，空闲时依次查看固定到自己的任务、全局队列，再从随机的其他工作线程窃取，
+ * 仍然没有任务就在 futex 上休眠。非工作线程提交的任务进入全局队列；固定到某个工作线程的任务
+ * 进入该线程的收件箱，不会被窃取。
+ *
+ * 任务可以是协程，也可以是普通函数：普通函数在工作线程复用的协程上执行，函数让出时该协程
+ * 脱离工作线程，由持有它的人(如 Scheduler::Yield、IO 或定时器)重新提交。
+ * 协程里调用 Fiber::Yield 只是挂起，不会被自动重新调度；Scheduler::Yield 让出后排到全局队列末尾
+ *
+ * 用法：
+ *   eva::Scheduler scheduler{4};
+ *   scheduler.Start();
+ *   scheduler.Schedule([] { ... });
+ *   scheduler.Stop();  // 等待所有任务完成
+ */
+class Scheduler {
+public:
+    using ptr = std::shared_ptr<Scheduler>;
+
+    /**
+     * @brief 构造函数
+     * @param[in] threads 工作线程数，0 表示 CPU 核数
+     * @param[in] name 调度器名称，工作线程命名为 name_<序号>
+     */
+    explicit Scheduler(size_t threads = 0, std::string const& name = "worker");
+
+    /**
+     * @brief 析构函数，未停止时先 Stop
+     */
+    virtual ~Scheduler();
+
+    Scheduler(Scheduler const&) = delete;
+    Scheduler& operator=(Scheduler const&) = delete;
+
+public:
+    /**
+     * @brief 启动工作线程
+     */
+    void Start();
+
+    /**
+     * @brief 等待所有已提交的任务(及其提交的任务)完成后停止工作线程
+     * @details 不能在工作线程中调用；停止期间和停止后不能再从外部提交任务
+     */
+    void Stop();
+
+    /**
+     * @brief 普通函数是否在共享栈模式的协程上执行，在 Start 之前设置
+     * @details 大量协程同时挂起时内存占用与实际栈深度成正比；代价是切换时拷贝栈内容，
+     * 且协程第一次运行后固定在那个工作线程上，不再被窃取
+     */
+    void SetSharedStack(bool enable) { shared_stack_ = enable; }
+
+    /**
+     * @brief 提交协程
+     * @param[in] thread 固定到该序号的工作线程执行，-1 表示协程固定的线程(GetAffinity)或任意线程
+     */
+    void Schedule(Fiber::ptr fiber, int thread = -1);
+
+    /**
+     * @brief 提交普通函数
+     * @param[in] thread 固定到该序号的工作线程执行，-1 表示任意线程
+     */
+    void Schedule(std::function<void()> cb, int thread = -1);
+
+    size_t GetThreadCount() const { return workers_.size(); }
+
+    std::string const& GetName() const { return name_; }
+
+public:
+    /**
+     * @brief 当前线程所属的调度器，非工作线程返回 nullptr
+     */
+    static Scheduler* GetThis();
+
+    /**
+     * @brief 当前工作线程的序号，非工作线程返回 -1
+     */
+    static int GetWorkerIndex();
+
+    /**
+     * @brief 当前协程让出，并排到全局队列(固定的协程排到所在线程的收件箱)末尾等待再次执行；
+     * 只能在调度器的协程中调用
+     */
+    static void Yield();
+
+protected:
+    /**
+     * @brief 工作线程没有任务时调用，直到 Unpark 后返回(可能提前返回)
+     * @details 默认在 futex 上休眠；派生类可以改为等待 IO 事件，返回前处理就绪的事件
+     */
+    virtual void Park(size_t index);
+
+    /**
+     * @brief 唤醒在 Park 中休眠的工作线程；对没有休眠的线程调用时，其下一次 Park 立即返回
+     */
+    virtual void Unpark(size_t index);
+
+    /**
+     * @brief 所有已提交的任务完成后，是否还有其他原因阻止停止(如等待中的 IO 事件)
+     */
+    virtual bool HasPendingWork() const { return false; }
+
+    /**
+     * @brief 工作线程一直有任务时每调度 61 次调用一次，派生类可以非阻塞地收集就绪的事件
+     */
+    virtual void Poll(size_t /*index*/) {}
+
+    /**
+     * @brief 工作线程的唤醒信号，默认的 Park/Unpark 在它上面用 futex 休眠和唤醒
+     * @details PostSignal 置位，返回之前是否未置位(需要唤醒)；TakeSignal 取走信号，返回之前
+     * 是否置位。派生类的 Park 改为等待其他事件时，先公布自己的等待方式再 TakeSignal；Unpark 先
+     * PostSignal 再查看等待方式，两边至少有一边能看到对方
+     */
+    bool PostSignal(size_t index);
+    bool TakeSignal(size_t index);
+
+    /**
+     * @brief 在 futex 上休眠直到取走唤醒信号 / 唤醒在 WaitSignal 中休眠的线程
+     */
+    void WaitSignal(size_t index);
+    void WakeSignal(size_t index);
+
+private:
+    /**
+     * @brief 一个待执行的任务：协程或普通函数
+     */
+    struct Task {
+        Fiber::ptr fiber;
+        std::function<void()> cb;
+    };
+
+    static constexpr size_t kCacheLine = 64;
+
+    /**
+     * @brief 工作线程的状态，独占缓存行
+     */
+    struct alignas(kCacheLine) Worker {
+        WorkStealDeque<Task*> deque;       // 本地队列
+        std::mutex inbox_mtx;              // 保护 inbox
+        std::deque<Task*> inbox;           // 固定到本线程的任务
+        std::atomic<size_t> inbox_size{0};  // inbox 的大小，空时不加锁
+        std::atomic<uint32_t> signal{0};   // futex 字：1 表示有唤醒
+        bool woken{false};                 // 由 WakeOne 唤醒，由 idle_mtx_ 保护
+        Fiber::ptr cb_fiber;               // 执行普通函数的协程，复用
+        uint64_t rand{0};                  // 选择窃取对象的随机数状态
+        uint32_t tick{0};                  // 调度次数，用于定期查看全局队列
+        std::thread thread;                // 工作线程
+    };
+
+    void Submit(Task* task, int thread);
+
+    void Run(size_t index);
+
+    Task* FindTask(Worker& worker);
+
+    /**
+     * @brief 是否有本线程可以取到的任务，只查看不取出
+     */
+    bool HasQueuedTask(Worker const& worker) const;
+
+    Task* PopGlobal(Worker& worker);
+
+    Task* Steal(Worker& worker);
+
+    void RunTask(Worker& worker, Task* task);
+
+    /**
+     * @brief 把工作线程登记为空闲 / 从空闲列表中移除，返回是否由 WakeOne 唤醒
+     */
+    void EnterIdle(size_t index);
+    bool LeaveIdle(size_t index);
+
+    /**
+     * @brief 停止时，空闲的工作线程在其他线程都空闲或已退出、所有队列都为空时退出
+     */
+    bool TryExit(size_t index);
+
+    /**
+     * @brief 有空闲工作线程且没有正在被唤醒的线程时，唤醒一个空闲线程
+     */
+    void WakeOne();
+
+    /**
+     * @brief 唤醒指定的工作线程(提交了固定任务)
+     */
+    void WakeWorker(size_t index);
+
+    void WakeAll();
+
+private:
+    std::string name_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex global_mtx_;                   // 保护 global_
+    std::deque<Task*> global_;                // 外部提交和 Yield 的任务
+    std::atomic<size_t> global_size_{0};      // global_ 的大小，空时不加锁
+    std::mutex idle_mtx_;                     // 保护 idle_
+    std::vector<size_t> idle_;                // 空闲的工作线程
+    std::atomic<size_t> idle_count_{0};       // idle_ 的大小
+    std::atomic<bool> waking_{false};         // 有线程被 WakeOne 唤醒、尚未找到任务
+    size_t exited_{0};                        // 已退出的工作线程数，由 idle_mtx_ 保护
+    std::atomic<bool> stopping_{false};       // 正在停止
+    bool started_{false};                     // 已启动
+    bool shared_stack_{false};                // 普通函数使用共享栈协程
+};
+
+}  // namespace eva
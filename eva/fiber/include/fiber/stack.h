@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eva {
+
+/**
+ * @brief 栈内存的来源，决定释放方式
+ */
+enum class StackSource : uint8_t {
+    MAPPED,  // 单独映射，通常带保护页，池满时解除映射
+    SLAB,    // 从大块映射中切出，没有保护页，永不单独解除映射
+    HEAP,    // 映射失败时从堆上分配，没有保护页，池满时释放回堆
+};
+
+/**
+ * @brief 一段协程栈
+ */
+struct FiberStack {
+    void* base{nullptr};                      // 可用区域的最低地址
+    size_t size{0};                           // 可用区域的大小
+    size_t guard{0};                          // base 之下保护页的大小，0 表示没有保护页
+    StackSource source{StackSource::MAPPED};  // 内存来源
+};
+
+/**
+ * @brief 协程栈分配器
+ * @details 栈用 mmap 分配，最低处是一页 PROT_NONE 的保护页，栈溢出时触发 SIGSEGV 而不是
+ * 悄悄改写相邻的内存。释放的栈先放进当前线程的空闲链表：最近释放的少量栈保留物理页，直接复用；
+ * 其余的先 madvise(MADV_DONTNEED) 归还物理页，只保留地址空间；线程缓存满了放进全局池，
+ * 全局池也满了才 munmap。内存紧张时调用 Trim 归还当前线程缓存中所有栈的物理页。
+ *
+ * 每个带保护页的栈占两个内存映射，vm.max_map_count(默认 65530)限制了同时存在的栈数。
+ * 带保护页的栈最多占用 vm.max_map_count 的 3/4，给进程的其他映射留出余量；超出后(或映射
+ * 仍然失败时)新栈从一次映射 64 个栈的大块中切出，没有保护页，输出一次警告。大块中的栈释放后
+ * 只归还物理页，留在池中复用。连大块也映射不了时从堆上分配，只有内存真正耗尽才抛出
+ * std::bad_alloc。需要大量协程且要保留溢出检测时使用共享栈模式
+ */
+class StackAllocator {
+public:
+    /**
+     * @brief 分配可用大小不小于 size 的栈(按页向上取整)，失败抛出 std::bad_alloc
+     */
+    static FiberStack Allocate(size_t size);
+
+    /**
+     * @brief 释放栈，可以在任何线程调用
+     */
+    static void Deallocate(FiberStack const& stack);
+
+    /**
+     * @brief 归还当前线程缓存中所有栈的物理页，地址空间保留以便复用
+     */
+    static void Trim();
+
+    /**
+     * @brief 已分配(使用中和缓存中)的栈数，包括大块中切出的栈
+     */
+    static size_t GetMappedCount();
+};
+
+/**
+ * @brief 为当前线程设置备用信号栈，已有则不变
+ * @details 协程栈溢出时 SIGSEGV 的处理函数不能运行在已经溢出的栈上。线程第一次使用协程时调用
+ */
+void EnsureSignalStack();
+
+}  // namespace eva
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <fiber/fiber.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief 分层时间轮，插入和删除 O(1)
+ * @details 每毫秒一个刻度，6 层、每层 64 个槽，第 l 层的一个槽跨 64^l 毫秒，覆盖约 795 天，
+ * 更远的定时器先放在最远的槽里，级联时重新放置。节点是侵入式的，由调用者分配，时间轮本身
+ * 不分配内存。每层用一个 64 位图记录非空的槽，推进时跳过空槽，查找最近到期时间只看位图。
+ *
+ * 线程不安全，由调用者加锁
+ */
+class TimerWheel {
+public:
+    static constexpr uint64_t kNever = ~0ULL;
+    static constexpr uint32_t kNoSlot = ~0U;
+
+    /**
+     * @brief 双向链表的链接
+     */
+    struct Link {
+        Link* prev{nullptr};
+        Link* next{nullptr};
+    };
+
+    /**
+     * @brief 时间轮中的节点
+     */
+    struct Node : Link {
+        uint64_t expire{0};      // 到期时间(毫秒)
+        uint32_t slot{kNoSlot};  // 所在的槽，kNoSlot 表示不在时间轮中
+    };
+
+    explicit TimerWheel(uint64_t now = 0);
+
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+
+    /**
+     * @brief 插入节点，expire 不晚于当前时间的节点在下一次 Advance 时到期
+     */
+    void Insert(Node* node, uint64_t expire);
+
+    /**
+     * @brief 删除还在时间轮中的节点
+     */
+    void Remove(Node* node);
+
+    static bool IsLinked(Node const* node) { return node->slot != kNoSlot; }
+
+    /**
+     * @brief 推进到 now，返回到期的节点，按到期时间排序，用 next 串成单链表
+     * @details 返回的节点已经移出时间轮，可以重新 Insert(先取出 next)。now 早于当前时间时只返回
+     * 已经到期的节点
+     */
+    Node* Advance(uint64_t now);
+
+    /**
+     * @brief 最近的到期时间，只是下界：高层的槽返回级联的时间；没有节点返回 kNever
+     */
+    uint64_t NextExpiry() const;
+
+    uint64_t GetNow() const { return now_; }
+
+    size_t Size() const { return size_; }
+
+private:
+    static constexpr int kLevelBits = 6;
+    static constexpr uint32_t kSlots = 1U << kLevelBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr int kLevels = 6;
+    static constexpr uint32_t kDueSlot = kLevels * kSlots;  // 已到期、等待下一次 Advance 的节点
+
+    /**
+     * @brief 按到期时间放进对应的槽
+     */
+    void Place(Node* node);
+
+    void Unlink(Node* node);
+
+    /**
+     * @brief 到达第 1 层的槽边界时，把高层当前槽里的节点重新放置到低层
+     */
+    void Cascade();
+
+    /**
+     * @brief 把槽里的节点全部移到到期链表末尾
+     */
+    void Take(uint32_t slot, Link**& tail);
+
+private:
+    uint64_t now_;
+    size_t size_{0};
+    uint64_t occupied_[kLevels] = {};  // 每层非空的槽
+    Link heads_[kDueSlot + 1];         // 每个槽的循环链表头
+};
+
+/**
+ * @brief 定时器管理，基于 TimerWheel，线程安全
+ * @details 支持一次性、周期和条件定时器(条件对象失效后不再触发)。定时器节点从按块分配的池中取，
+ * 添加和取消定时器不为每个定时器分配内存(回调本身超出 std::function 的小对象缓冲时除外)。
+ * 定时器 id 带有节点的代数，节点复用后旧 id 失效，重复取消是安全的。
+ *
+ * 到期的回调由派生类(IOManager)提交到调度器执行，不在持有锁时执行
+ */
+class TimerManager {
+public:
+    using TimerId = uint64_t;
+
+    static constexpr uint64_t kNoTimeout = ~0ULL;
+
+    TimerManager();
+
+    virtual ~TimerManager();
+
+    TimerManager(TimerManager const&) = delete;
+    TimerManager& operator=(TimerManager const&) = delete;
+
+public:
+    /**
+     * @brief 添加定时器
+     * @param[in] ms 多少毫秒后到期
+     * @param[in] recurring 是否每隔 ms 毫秒重复
+     * @return 定时器 id，不会为 0
+     */
+    TimerId AddTimer(uint64_t ms, std::function<void()> cb, bool recurring = false);
+
+    /**
+     * @brief 添加条件定时器，到期时 cond 已经失效则不执行回调，并删除定时器
+     */
+    TimerId AddConditionTimer(uint64_t ms, std::function<void()> cb, std::weak_ptr<void> cond,
+                              bool recurring = false);
+
+    /**
+     * @brief 取消定时器，已到期(一次性)或已取消时返回 false
+     */
+    bool CancelTimer(TimerId id);
+
+    /**
+     * @brief 从现在开始重新计时，ms 为新的间隔
+     */
+    bool ResetTimer(TimerId id, uint64_t ms);
+
+    /**
+     * @brief 距离最近的定时器到期的毫秒数，可能提前；没有定时器返回 kNoTimeout
+     */
+    uint64_t GetNextTimeout();
+
+    size_t GetTimerCount() const { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 单调时钟的毫秒数
+     */
+    static uint64_t NowMs();
+
+protected:
+    /**
+     * @brief 到期的协程或回调
+     */
+    struct Expired {
+        Fiber::ptr fiber;
+        std::function<void()> cb;
+    };
+
+    /**
+     * @brief 添加的定时器比上次 GetNextTimeout 给出的时间更早到期，等待的线程需要提前醒来
+     */
+    virtual void OnTimerInsertedAtFront() = 0;
+
+    /**
+     * @brief 到期时重新调度 fiber 的定时器
+     */
+    TimerId AddFiberTimer(uint64_t ms, Fiber::ptr fiber);
+
+    /**
+     * @brief 到期时在 TakeExpired 中、持有锁时直接调用 action(arg) 的定时器
+     * @details 用于 IO 超时：CancelTimer 和 action 互斥，CancelTimer 返回后 arg 不会再被访问
+     */
+    TimerId AddActionTimer(uint64_t ms, void (*action)(void*), void* arg);
+
+    /**
+     * @brief 推进到当前时间，执行到期的 action，把到期的协程和回调追加到 expired
+     * @return 是否有定时器到期
+     */
+    bool TakeExpired(std::vector<Expired>& expired);
+
+private:
+    /**
+     * @brief 池中的定时器节点
+     */
+    struct Timer : TimerWheel::Node {
+        uint32_t index{0};               // 在池中的序号
+        uint32_t gen{0};                 // 代数，每次释放加一
+        uint64_t period{0};              // 周期，0 表示一次性
+        Fiber::ptr fiber;                // 到期时调度的协程
+        std::function<void()> cb;        // 到期时调度的回调
+        std::weak_ptr<void> cond;        // 条件
+        bool has_cond{false};            // 是否是条件定时器
+        void (*action)(void*){nullptr};  // 到期时直接调用
+        void* arg{nullptr};              // action 的参数
+    };
+
+    static constexpr uint32_t kChunkBits = 10;
+    static constexpr uint32_t kChunkSize = 1U << kChunkBits;
+
+    /**
+     * @brief 从池中取节点 / 放回池中；调用者持有 mtx_
+     */
+    Timer* Alloc();
+    void Free(Timer* timer);
+
+    /**
+     * @brief 由 id 找到还在时间轮中的节点；调用者持有 mtx_
+     */
+    Timer* Find(TimerId id);
+
+    /**
+     * @brief 从池中取节点，移入 init 中的回调后放进时间轮；调用者未持有 mtx_
+     */
+    TimerId Add(uint64_t ms, Timer&& init);
+
+    /**
+     * @brief 从现在起 ms 毫秒后到期，返回是否早于 wakeup_at_；调用者持有 mtx_
+     */
+    bool Insert(Timer* timer, uint64_t ms);
+
+    static TimerId MakeId(Timer const* timer) {
+        return (static_cast<uint64_t>(timer->gen) << 32) | (timer->index + 1);
+    }
+
+private:
+    mutable std::mutex mtx_;                        // 保护以下除 count_ 外的成员
+    TimerWheel wheel_;                              // 时间轮
+    std::vector<std::unique_ptr<Timer[]>> chunks_;  // 节点池
+    Timer* free_{nullptr};                          // 空闲节点，用 next 串起来
+    uint64_t wakeup_at_{TimerWheel::kNever};        // 等待的线程最迟在这个时间醒来
+    std::atomic<size_t> count_{0};                  // 时间轮中的定时器数
+};
+
+}  // namespace eva
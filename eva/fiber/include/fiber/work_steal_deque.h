@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief 无锁工作窃取双端队列(单生产者，单个所有者 + 多个窃取者)
+ * @details Chase-Lev 队列，内存序参考 Lê 等人的 "Correct and Efficient Work-Stealing for Weak
+ * Memory Models"(PPoPP 2013)。所有者在底部 Push/Pop(后进先出，缓存友好)，其他线程从顶部 Steal
+ * (先进先出，拿走最早的任务)。Push 没有原子读改写，Pop 只在队列只剩一个元素时才 CAS。
+ * 数组满时容量翻倍，旧数组可能仍被窃取者读取，保留到队列析构时才释放
+ * @note T 必须可平凡复制，通常是指针
+ */
+template <typename T>
+class WorkStealDeque {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WorkStealDeque stores trivially copyable values");
+
+public:
+    explicit WorkStealDeque(size_t capacity = 256) {
+        size_t cap = 2;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        arrays_.emplace_back(new Array{cap});
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealDeque(WorkStealDeque const&) = delete;
+    WorkStealDeque& operator=(WorkStealDeque const&) = delete;
+
+public:
+    /**
+     * @brief 在底部压入，只能由所有者调用
+     */
+    void Push(T value) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->mask)) {
+            a = Grow(a, t, b);
+        }
+        a->Put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 从底部弹出，只能由所有者调用，队列空时返回 false
+     */
+    bool Pop(T& value) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;  // 空
+        }
+        value = a->Get(b);
+        if (t == b) {
+            // 最后一个元素，与窃取者竞争
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 从顶部窃取，任意线程可调用；队列空或与其他线程竞争失败时返回 false
+     */
+    bool Steal(T& value) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array* a = array_.load(std::memory_order_acquire);
+        value = a->Get(t);
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 元素个数的近似值(并发下仅供参考)
+     */
+    size_t SizeApprox() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(size_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+
+        T Get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+
+        void Put(int64_t i, T value) { slots[i & mask].store(value, std::memory_order_relaxed); }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Array* Grow(Array* old, int64_t t, int64_t b) {
+        arrays_.emplace_back(new Array{(old->mask + 1) * 2});
+        Array* a = arrays_.back().get();
+        for (int64_t i = t; i < b; ++i) {
+            a->Put(i, old->Get(i));
+        }
+        array_.store(a, std::memory_order_release);
+        return a;
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    alignas(kCacheLine) std::atomic<int64_t> top_{0};     // 窃取端(独占缓存行)
+    alignas(kCacheLine) std::atomic<int64_t> bottom_{0};  // 所有者端(独占缓存行)
+    std::atomic<Array*> array_;                           // 当前数组
+    std::vector<std::unique_ptr<Array>> arrays_;          // 所有数组(含已被替换的)，只由所有者修改
+};
+
+}  // namespace eva
@@ -0,0 +1,40 @@
+#include <fiber/context.h>
+
+#include <cstdint>
+#include <cstring>
+
+extern "C" void eva_fiber_trampoline();
+
+namespace eva {
+
+FiberContext MakeFiberContext(void* stack, size_t size, void (*entry)(void*), void* arg) {
+    // 栈顶按 16 字节对齐，并留出一个空槽，栈回溯到这里结束
+    uintptr_t top = (reinterpret_cast<uintptr_t>(stack) + size) & ~uintptr_t{15};
+    top -= 16;
+    std::memset(reinterpret_cast<void*>(top), 0, 16);
+
+#if defined(__x86_64__)
+    // 与 context.S 中弹出的顺序一致，ret 之后 rsp = top，调用 entry 前 16 字节对齐
+    auto* frame = reinterpret_cast<uint64_t*>(top) - 8;
+    constexpr uint64_t kMxcsr = 0x1F80;  // 屏蔽所有浮点异常，就近舍入
+    constexpr uint64_t kFpuCw = 0x037F;  // x87 默认控制字
+    frame[0] = kMxcsr | (kFpuCw << 32);
+    frame[1] = 0;                                                 // r15
+    frame[2] = 0;                                                 // r14
+    frame[3] = reinterpret_cast<uint64_t>(entry);                 // r13
+    frame[4] = reinterpret_cast<uint64_t>(arg);                   // r12
+    frame[5] = 0;                                                 // rbx
+    frame[6] = 0;                                                 // rbp，栈回溯的终点
+    frame[7] = reinterpret_cast<uint64_t>(eva_fiber_trampoline);  // 返回地址
+#elif defined(__aarch64__)
+    // d8-d15, x19-x28, x29, x30，共 20 个槽
+    auto* frame = reinterpret_cast<uint64_t*>(top) - 20;
+    std::memset(frame, 0, 20 * sizeof(uint64_t));
+    frame[8] = reinterpret_cast<uint64_t>(arg);                    // x19
+    frame[9] = reinterpret_cast<uint64_t>(entry);                  // x20
+    frame[19] = reinterpret_cast<uint64_t>(eva_fiber_trampoline);  // x30
+#endif
+    return frame;
+}
+
+}  // namespace eva
@@ -0,0 +1,142 @@
+#include <fiber/poller.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+
+namespace eva {
+
+namespace {
+
+// eventfd 的 epoll data，不会和 fd 冲突
+constexpr uint64_t kWakeupData = ~0ULL;
+// 一次 epoll_wait 最多返回的事件数
+constexpr size_t kMaxEpollEvents = 256;
+
+// fd 已加入 epoll，和已启用的事件一起保存在后端状态中
+constexpr uint64_t kRegistered = 1ULL << 32;
+
+/**
+ * @brief epoll 后端：EPOLLONESHOT，fd 第一次等待时加入 epoll，之后一直保留
+ * @details 事件触发后整个注册失效，下次等待时 EPOLL_CTL_MOD 重新启用，每次等待一次系统调用。
+ * 不再等待任何事件时不删除注册，只记为未启用：之后触发的事件被忽略，再次等待时重新启用。
+ * fd 关闭时内核自动移除注册，fd 号复用后 MOD 返回 ENOENT，改为 ADD
+ */
+class EpollPoller : public Poller {
+public:
+    EpollPoller(int epfd, int wake_fd) : epfd_(epfd), wake_fd_(wake_fd) {}
+
+    ~EpollPoller() override {
+        close(wake_fd_);
+        close(epfd_);
+    }
+
+    char const* GetName() const override { return "epoll"; }
+
+    bool Update(int fd, uint64_t& state, uint32_t events) override {
+        uint32_t armed = static_cast<uint32_t>(state);
+        if (events == armed) {
+            return true;
+        }
+        if (events == 0) {
+            state &= kRegistered;
+            return true;
+        }
+        epoll_event event{};
+        event.events = EPOLLONESHOT | events;
+        event.data.u64 = static_cast<uint64_t>(fd);
+        int op = (state & kRegistered) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        int rt = epoll_ctl(epfd_, op, fd, &event);
+        if (rt != 0 && op == EPOLL_CTL_ADD && errno == EEXIST) {
+            rt = epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &event);
+        } else if (rt != 0 && op == EPOLL_CTL_MOD && errno == ENOENT) {
+            // 关闭 fd 时内核已经移除了注册，fd 号被复用
+            rt = epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &event);
+        }
+        if (rt != 0) {
+            return false;
+        }
+        state = kRegistered | events;
+        return true;
+    }
+
+    uint32_t Accept(uint64_t& state, Event const& event) override {
+        uint32_t events = event.events;
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            // 出错或挂断时读写都唤醒，由读写调用返回错误
+            events |= EPOLLIN | EPOLLOUT;
+        }
+        uint32_t fired = events & static_cast<uint32_t>(state);
+        if (fired != 0) {
+            // 触发后整个注册失效。没有交集的是重新启用之前触发的旧事件，现在的注册仍然有效
+            state &= kRegistered;
+        }
+        return fired;
+    }
+
+    size_t Wait(Event* events, size_t max, int timeout_ms) override {
+        epoll_event ready[kMaxEpollEvents];
+        int n = epoll_wait(epfd_, ready, static_cast<int>(std::min(max, kMaxEpollEvents)),
+                           timeout_ms);
+        if (n < 0) {
+            if (errno != EINTR) {
+                std::cout << "[ERROR] epoll_wait error: " << strerror(errno) << std::endl;
+            }
+            return 0;
+        }
+        size_t count = 0;
+        for (int i = 0; i < n; ++i) {
+            if (ready[i].data.u64 == kWakeupData) {
+                uint64_t value;
+                while (read(wake_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+                }
+                continue;
+            }
+            events[count++] = Event{static_cast<int>(ready[i].data.u64), ready[i].events, 0, 0};
+        }
+        return count;
+    }
+
+    void Wakeup() override {
+        uint64_t one = 1;
+        while (write(wake_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+
+private:
+    int epfd_;
+    int wake_fd_;
+};
+
+}  // namespace
+
+std::unique_ptr<Poller> CreateEpollPoller() {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        std::cout << "[ERROR] epoll_create1 error: " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+    int wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        std::cout << "[ERROR] eventfd error: " << strerror(errno) << std::endl;
+        close(epfd);
+        return nullptr;
+    }
+    // 水平触发：Wakeup 之后一直就绪，直到 Wait 读走计数
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeupData;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, wake_fd, &event) != 0) {
+        std::cout << "[ERROR] epoll_ctl error: " << strerror(errno) << std::endl;
+        close(wake_fd);
+        close(epfd);
+        return nullptr;
+    }
+    return std::make_unique<EpollPoller>(epfd, wake_fd);
+}
+
+}  // namespace eva
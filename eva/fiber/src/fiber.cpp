@@ -1,7 +1,296 @@
 #include <fiber/fiber.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <utility>
 
 namespace eva {
 
-uint64_t Fiber::GetFiberId() { return 1314; }
+namespace {
+
+std::atomic<uint64_t> s_fiber_id{0};     // 最近分配的协程 id
+std::atomic<uint64_t> s_fiber_count{0};  // 存活的协程数
+
+// 当前协程，平凡类型，访问时无需构造检查
+thread_local Fiber* t_fiber = nullptr;
+// 线程的主协程，线程退出时释放
+thread_local std::unique_ptr<Fiber> t_main_fiber;
+
+/**
+ * @brief 信号处理函数中使用的整数格式化，不分配内存
+ */
+size_t FormatUint(char* buf, uint64_t value, unsigned base) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    char tmp[24];
+    size_t n = 0;
+    do {
+        tmp[n++] = kDigits[value % base];
+        value /= base;
+    } while (value != 0);
+    for (size_t i = 0; i < n; ++i) {
+        buf[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+size_t Append(char* buf, size_t pos, char const* str) {
+    size_t len = strlen(str);
+    memcpy(buf + pos, str, len);
+    return pos + len;
+}
+
+/**
+ * @brief 没有其他 SIGSEGV 处理函数(如日志的崩溃处理)时使用：栈溢出时写出 FATAL 行，
+ * 然后恢复默认处理方式，返回后重新执行出错指令，以默认方式终止
+ */
+void StackOverflowHandler(int sig, siginfo_t* info, void*) {
+    uint64_t id = 0;
+    size_t size = 0;
+    if (Fiber::IsStackOverflow(info->si_addr, &id, &size)) {
+        char buf[160];
+        size_t pos = Append(buf, 0, "[FATAL] fiber ");
+        pos += FormatUint(buf + pos, id, 10);
+        pos = Append(buf, pos, " stack overflow (");
+        pos += FormatUint(buf + pos, size, 10);
+        pos = Append(buf, pos, " byte stack), fault address 0x");
+        pos += FormatUint(buf + pos, reinterpret_cast<uintptr_t>(info->si_addr), 16);
+        buf[pos++] = '\n';
+        ssize_t n = ::write(STDERR_FILENO, buf, pos);
+        static_cast<void>(n);
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_DFL;
+    sigemptyset(&action.sa_mask);
+    sigaction(sig, &action, nullptr);
+}
+
+void InstallStackOverflowHandler() {
+    static std::atomic<bool> installed{false};
+    if (installed.exchange(true)) {
+        return;
+    }
+    struct sigaction old;
+    if (sigaction(SIGSEGV, nullptr, &old) != 0 || (old.sa_flags & SA_SIGINFO) ||
+        old.sa_handler != SIG_DFL) {
+        // 已有处理函数，由它报告
+        return;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = StackOverflowHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, nullptr);
+}
+
+}  // namespace
+
+/**
+ * @brief 线程的共享栈
+ */
+struct Fiber::SharedStack {
+    FiberStack stack;
+    std::mutex mtx;            // 保护 occupant 和栈内容的换入换出，协程可能在其他线程析构
+    Fiber* occupant{nullptr};  // 栈上现在是哪个协程的内容
+
+    SharedStack() : stack(StackAllocator::Allocate(kSharedStackSize)) {}
+
+    ~SharedStack() { StackAllocator::Deallocate(stack); }
+};
+
+Fiber::Fiber() : id_(++s_fiber_id), state_(State::RUNNING), next_state_(State::RUNNING) {
+    ++s_fiber_count;
+}
+
+Fiber::Fiber(std::function<void()> cb, size_t stack_size, bool shared_stack)
+    : id_(++s_fiber_id),
+      state_(State::READY),
+      next_state_(State::READY),
+      shared_(shared_stack),
+      cb_(std::move(cb)) {
+    // 共享栈协程在第一次 Resume 时才在共享栈上构造上下文
+    if (!shared_) {
+        stack_ = StackAllocator::Allocate(stack_size);
+        ctx_ = MakeFiberContext(stack_.base, stack_.size, &Fiber::MainFunc, this);
+    }
+    ++s_fiber_count;
+}
+
+Fiber::~Fiber() {
+    --s_fiber_count;
+    if (shared_) {
+        assert(GetState() != State::RUNNING);
+        if (home_) {
+            std::lock_guard lk{home_->mtx};
+            if (home_->occupant == this) {
+                home_->occupant = nullptr;
+            }
+        }
+    } else if (stack_.base) {
+        assert(GetState() != State::RUNNING);
+        StackAllocator::Deallocate(stack_);
+    } else if (t_fiber == this) {
+        // 主协程随线程退出析构
+        t_fiber = nullptr;
+    }
+}
+
+void Fiber::Reset(std::function<void()> cb) {
+    assert(stack_.base || shared_);
+    State state = GetState();
+    assert(state == State::READY || state == State::TERM || state == State::EXCEPT);
+    cb_ = std::move(cb);
+    exception_ = nullptr;
+    if (shared_) {
+        saved_size_ = 0;
+    } else {
+        ctx_ = MakeFiberContext(stack_.base, stack_.size, &Fiber::MainFunc, this);
+    }
+    state_.store(State::READY, std::memory_order_relaxed);
+}
+
+void Fiber::Resume() {
+    assert(GetState() == State::READY || GetState() == State::SUSPENDED);
+    Fiber* current = GetThis();
+    if (shared_) {
+        SwapInSharedStack();
+    }
+    caller_ = current;
+    state_.store(State::RUNNING, std::memory_order_relaxed);
+    t_fiber = this;
+    eva_swap_context(&current->ctx_, ctx_);
+    // NOTE: 切换回来后不再访问线程局部变量，编译器可能缓存了切换前的地址
+    // 发布状态后其他线程可以 Resume 或 Reset 本协程，之后不能再访问成员
+    std::exception_ptr exception = std::exchange(exception_, nullptr);
+    state_.store(next_state_, std::memory_order_release);
+    if (exception) [[unlikely]] {
+        std::rethrow_exception(std::move(exception));
+    }
+}
+
+void Fiber::SwapInSharedStack() {
+    std::shared_ptr<SharedStack> const& local = GetSharedStack();
+    if (!home_) {
+        home_ = local;
+    } else if (home_ != local) [[unlikely]] {
+        // 栈上保存着指向栈内的指针，换到其他线程的共享栈上会错乱
+        std::cout << "[ERROR] shared-stack fiber " << id_ << " resumed on another thread"
+                  << std::endl;
+        std::abort();
+    }
+    std::lock_guard lk{home_->mtx};
+    Fiber* occupant = home_->occupant;
+    if (occupant != this) {
+        if (occupant) {
+            State state = occupant->GetState();
+            if (state == State::RUNNING) [[unlikely]] {
+                // 占用者在 Resume 链上，拷入本协程会改写它正在使用的栈
+                std::cout << "[ERROR] shared-stack fiber " << occupant->id_
+                          << " cannot resume shared-stack fiber " << id_ << std::endl;
+                std::abort();
+            }
+            if (state == State::SUSPENDED) {
+                occupant->SaveStack();
+            }
+        }
+        home_->occupant = this;
+        if (GetState() == State::SUSPENDED) {
+            memcpy(ctx_, saved_.get(), saved_size_);
+        }
+    }
+    if (GetState() == State::READY) {
+        ctx_ = MakeFiberContext(home_->stack.base, home_->stack.size, &Fiber::MainFunc, this);
+    }
+}
+
+void Fiber::SaveStack() {
+    char* top = static_cast<char*>(home_->stack.base) + home_->stack.size;
+    size_t size = static_cast<size_t>(top - static_cast<char*>(ctx_));
+    if (size > saved_capacity_) {
+        saved_.reset(new char[size]);
+        saved_capacity_ = size;
+    }
+    memcpy(saved_.get(), ctx_, size);
+    saved_size_ = size;
+}
+
+std::shared_ptr<Fiber::SharedStack> const& Fiber::GetSharedStack() {
+    // 线程退出后，固定在本线程上的协程还持有它，由最后一个析构的释放
+    thread_local std::shared_ptr<SharedStack> stack = std::make_shared<SharedStack>();
+    return stack;
+}
+
+void Fiber::Yield() {
+    Fiber* current = t_fiber;
+    assert(current && current->caller_);
+    current->SwitchToCaller(State::SUSPENDED);
+}
+
+void Fiber::SwitchToCaller(State next) {
+    next_state_ = next;
+    Fiber* caller = std::exchange(caller_, nullptr);
+    t_fiber = caller;
+    eva_swap_context(&ctx_, caller->ctx_);
+}
+
+void Fiber::MainFunc(void* arg) {
+    Fiber* fiber = static_cast<Fiber*>(arg);
+    State next = State::TERM;
+    try {
+        fiber->cb_();
+    } catch (...) {
+        fiber->exception_ = std::current_exception();
+        next = State::EXCEPT;
+    }
+    // 释放捕获的对象，不再持有外部资源
+    fiber->cb_ = nullptr;
+    fiber->SwitchToCaller(next);
+    __builtin_unreachable();
+}
+
+Fiber* Fiber::GetThis() {
+    if (__builtin_expect(t_fiber == nullptr, 0)) {
+        // 协程栈溢出时信号处理函数要运行在备用信号栈上
+        EnsureSignalStack();
+        InstallStackOverflowHandler();
+        t_main_fiber.reset(new Fiber);
+        t_fiber = t_main_fiber.get();
+    }
+    return t_fiber;
+}
+
+uint64_t Fiber::GetFiberId() { return t_fiber ? t_fiber->id_ : 0; }
+
+uint64_t Fiber::TotalFibers() { return s_fiber_count.load(std::memory_order_relaxed); }
+
+bool Fiber::IsStackOverflow(void const* addr, uint64_t* id, size_t* stack_size) noexcept {
+    Fiber const* fiber = t_fiber;
+    if (!fiber) {
+        return false;
+    }
+    FiberStack const* stack = &fiber->stack_;
+    if (fiber->shared_) {
+        if (!fiber->home_) {
+            return false;
+        }
+        stack = &fiber->home_->stack;
+    }
+    auto fault = reinterpret_cast<uintptr_t>(addr);
+    auto base = reinterpret_cast<uintptr_t>(stack->base);
+    if (stack->guard == 0 || fault < base - stack->guard || fault >= base) {
+        return false;
+    }
+    *id = fiber->id_;
+    *stack_size = stack->size;
+    return true;
+}
 
 }  // namespace eva
@@ -0,0 +1,523 @@
+#include <fiber/io_manager.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace eva {
+
+namespace {
+
+// 一次 Poller::Wait 最多处理的事件数
+constexpr size_t kMaxEvents = 256;
+// fd_contexts_ 的初始大小
+constexpr size_t kInitialFdCount = 64;
+
+uint64_t GetDeadline(uint64_t timeout_ms) {
+    if (timeout_ms == TimerManager::kNoTimeout) {
+        return TimerManager::kNoTimeout;
+    }
+    return TimerManager::NowMs() + std::min(timeout_ms, TimerManager::kNoTimeout / 2);
+}
+
+/**
+ * @brief 距离 deadline 的毫秒数，已经过了返回 0
+ */
+uint64_t GetRemaining(uint64_t deadline) {
+    if (deadline == TimerManager::kNoTimeout) {
+        return TimerManager::kNoTimeout;
+    }
+    uint64_t now = TimerManager::NowMs();
+    return deadline > now ? deadline - now : 0;
+}
+
+}  // namespace
+
+IOManager::IOManager(size_t threads, std::string const& name, Backend backend)
+    : Scheduler(threads, name), backend_(Backend::EPOLL) {
+    if (backend != Backend::EPOLL) {
+        poller_ = CreateUringPoller();
+        if (poller_) {
+            backend_ = Backend::IO_URING;
+        } else if (backend == Backend::IO_URING) {
+            std::cout << "[WARN] io_uring is not available, fall back to epoll" << std::endl;
+        }
+    }
+    if (!poller_) {
+        poller_ = CreateEpollPoller();
+    }
+    if (!poller_) {
+        throw std::runtime_error{"IOManager: create poller failed"};
+    }
+    fd_contexts_.resize(kInitialFdCount);
+    for (auto& ctx : fd_contexts_) {
+        ctx = std::make_unique<FdContext>();
+    }
+}
+
+IOManager::~IOManager() {
+    // 先于 poller_ 析构停止，工作线程还在使用它
+    Stop();
+}
+
+IOManager* IOManager::GetThis() { return dynamic_cast<IOManager*>(Scheduler::GetThis()); }
+
+void IOManager::SleepFor(uint64_t ms) {
+    IOManager* iom = GetThis();
+    if (!iom) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ms});
+        return;
+    }
+    iom->AddFiberTimer(ms, Fiber::GetThis()->shared_from_this());
+    Fiber::Yield();
+}
+
+size_t IOManager::GetPendingCount() const {
+    return pending_events_.load(std::memory_order_acquire) +
+           pending_requests_.load(std::memory_order_acquire);
+}
+
+IOManager::FdContext* IOManager::GetFdContext(int fd, bool create) {
+    if (fd < 0) {
+        return nullptr;
+    }
+    size_t index = static_cast<size_t>(fd);
+    {
+        std::shared_lock lk{fd_mtx_};
+        if (index < fd_contexts_.size()) {
+            return fd_contexts_[index].get();
+        }
+    }
+    if (!create) {
+        return nullptr;
+    }
+    std::unique_lock lk{fd_mtx_};
+    size_t size = fd_contexts_.size();
+    if (index >= size) {
+        fd_contexts_.resize(std::max(index + 1, size + size / 2));
+        for (size_t i = size; i < fd_contexts_.size(); ++i) {
+            fd_contexts_[i] = std::make_unique<FdContext>();
+        }
+    }
+    return fd_contexts_[index].get();
+}
+
+bool IOManager::AddEvent(int fd, Event event, std::function<void()> cb) {
+    return Register(fd, event, std::move(cb), nullptr);
+}
+
+bool IOManager::Register(int fd, Event event, std::function<void()> cb, int* error) {
+    assert(event == READ || event == WRITE);
+    assert(cb || Scheduler::GetThis() == this);  // 挂起的是本调度器的协程
+    FdContext* ctx = GetFdContext(fd, true);
+    if (!ctx) {
+        errno = EBADF;
+        return false;
+    }
+    {
+        std::lock_guard lk{ctx->mtx};
+        if (ctx->events & event) {
+            errno = EEXIST;
+            return false;
+        }
+        uint32_t events = ctx->events | event;
+        if (!poller_->Update(fd, ctx->poll_state, events)) {
+            return false;
+        }
+        ctx->events = events;
+        pending_events_.fetch_add(1);
+        FdContext::Waiter& waiter = ctx->GetWaiter(event);
+        if (cb) {
+            waiter.cb = std::move(cb);
+        } else {
+            waiter.fiber = Fiber::GetThis()->shared_from_this();
+        }
+        waiter.error = error;
+    }
+    FlushIfExternal();
+    return true;
+}
+
+bool IOManager::DelEvent(int fd, Event event) {
+    FdContext* ctx = GetFdContext(fd, false);
+    if (!ctx) {
+        return false;
+    }
+    {
+        std::lock_guard lk{ctx->mtx};
+        if (!(ctx->events & event)) {
+            return false;
+        }
+        uint32_t events = ctx->events & ~event;
+        poller_->Update(fd, ctx->poll_state, events);
+        ctx->events = events;
+        FdContext::Waiter& waiter = ctx->GetWaiter(event);
+        waiter.fiber.reset();
+        waiter.cb = nullptr;
+        waiter.error = nullptr;
+        pending_events_.fetch_sub(1);
+    }
+    FlushIfExternal();
+    return true;
+}
+
+bool IOManager::CancelEvent(int fd, Event event) {
+    FdContext* ctx = GetFdContext(fd, false);
+    if (!ctx) {
+        return false;
+    }
+    {
+        std::lock_guard lk{ctx->mtx};
+        if (!(ctx->events & event)) {
+            return false;
+        }
+        uint32_t events = ctx->events & ~event;
+        poller_->Update(fd, ctx->poll_state, events);
+        ctx->events = events;
+        Trigger(ctx->GetWaiter(event), ECANCELED);
+    }
+    FlushIfExternal();
+    return true;
+}
+
+bool IOManager::CancelAll(int fd) {
+    FdContext* ctx = GetFdContext(fd, false);
+    bool cancelled = false;
+    if (ctx) {
+        std::lock_guard lk{ctx->mtx};
+        if (ctx->events != NONE) {
+            poller_->Update(fd, ctx->poll_state, NONE);
+            if (ctx->events & READ) {
+                Trigger(ctx->read, ECANCELED);
+            }
+            if (ctx->events & WRITE) {
+                Trigger(ctx->write, ECANCELED);
+            }
+            ctx->events = NONE;
+            cancelled = true;
+        }
+    }
+    if (poller_->SupportsRequests()) {
+        poller_->Cancel(fd);
+    }
+    FlushIfExternal();
+    return cancelled;
+}
+
+void IOManager::Trigger(FdContext::Waiter& waiter, int error) {
+    if (waiter.error) {
+        if (error != 0) {
+            *waiter.error = error;
+        }
+        waiter.error = nullptr;
+    }
+    if (waiter.cb) {
+        Schedule(std::move(waiter.cb));
+        waiter.cb = nullptr;
+    } else {
+        Schedule(std::move(waiter.fiber));
+    }
+    // 调度之后再减少计数，停止时不会在任务提交前就认为没有等待中的事件
+    pending_events_.fetch_sub(1);
+}
+
+void IOManager::FlushIfExternal() {
+    if (Scheduler::GetThis() != this) {
+        poller_->Flush();
+    }
+}
+
+ssize_t IOManager::Read(int fd, void* buf, size_t len, uint64_t timeout_ms) {
+    Poller::Request request{Poller::Request::READ, fd, buf,
+                            static_cast<uint32_t>(std::min<size_t>(len, UINT32_MAX))};
+    return DoIo(fd, READ, request, timeout_ms, [&] { return ::read(fd, buf, len); });
+}
+
+ssize_t IOManager::Write(int fd, void const* buf, size_t len, uint64_t timeout_ms) {
+    Poller::Request request{Poller::Request::WRITE, fd, const_cast<void*>(buf),
+                            static_cast<uint32_t>(std::min<size_t>(len, UINT32_MAX))};
+    return DoIo(fd, WRITE, request, timeout_ms, [&] { return ::write(fd, buf, len); });
+}
+
+int IOManager::Accept(int fd, sockaddr* addr, socklen_t* addrlen, uint64_t timeout_ms) {
+    constexpr int kFlags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    Poller::Request request{Poller::Request::ACCEPT, fd, addr, 0, addrlen, kFlags};
+    return static_cast<int>(DoIo(fd, READ, request, timeout_ms,
+                                 [&] { return ::accept4(fd, addr, addrlen, kFlags); }));
+}
+
+int IOManager::Connect(int fd, sockaddr const* addr, socklen_t addrlen, uint64_t timeout_ms) {
+    if (Scheduler::GetThis() != this) {
+        return ::connect(fd, addr, addrlen);
+    }
+    uint64_t deadline = GetDeadline(timeout_ms);
+    int rt;
+    if (poller_->SupportsRequests()) {
+        Poller::Request request{Poller::Request::CONNECT, fd, const_cast<sockaddr*>(addr),
+                                addrlen};
+        rt = SubmitAndWait(request, GetRemaining(deadline));
+        if (rt == 0) {
+            return 0;
+        }
+        errno = -rt;
+        rt = -1;
+    } else {
+        rt = ::connect(fd, addr, addrlen);
+    }
+    if (rt == 0 || (errno != EINPROGRESS && errno != EAGAIN)) {
+        return rt;
+    }
+    // 非阻塞连接：等待可写后取连接的结果
+    if (!WaitEvent(fd, WRITE, GetRemaining(deadline))) {
+        return -1;
+    }
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+        return -1;
+    }
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
+
+template <typename Syscall>
+ssize_t IOManager::DoIo(int fd, Event event, Poller::Request const& request, uint64_t timeout_ms,
+                        Syscall syscall) {
+    if (Scheduler::GetThis() != this) {
+        return syscall();
+    }
+    // 虚假的就绪会重试，超时按总时间算
+    uint64_t deadline = GetDeadline(timeout_ms);
+    while (true) {
+        if (poller_->SupportsRequests()) {
+            int rt = SubmitAndWait(request, GetRemaining(deadline));
+            if (rt >= 0) {
+                return rt;
+            }
+            if (rt != -EAGAIN) {
+                errno = -rt;
+                return -1;
+            }
+        } else {
+            ssize_t n;
+            do {
+                n = syscall();
+            } while (n < 0 && errno == EINTR);
+            if (n >= 0 || errno != EAGAIN) {
+                return n;
+            }
+        }
+        // 没有就绪(io_uring 对部分文件也会返回 EAGAIN)，等待就绪后重试
+        if (!WaitEvent(fd, event, GetRemaining(deadline))) {
+            return -1;
+        }
+    }
+}
+
+bool IOManager::WaitEvent(int fd, Event event, uint64_t timeout_ms) {
+    int error = 0;
+    if (!Register(fd, event, nullptr, &error)) {
+        return false;
+    }
+    WaitTimeout wait{this, fd, event, &error};
+    TimerId timer = 0;
+    if (timeout_ms != kNoTimeout) {
+        timer = AddActionTimer(timeout_ms, &IOManager::OnWaitTimeout, &wait);
+    }
+    Fiber::Yield();
+    // 和定时器的动作互斥，取消之后 wait 不会再被访问
+    if (timer != 0) {
+        CancelTimer(timer);
+    }
+    if (error != 0) {
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+void IOManager::OnWaitTimeout(void* arg) {
+    auto* wait = static_cast<WaitTimeout*>(arg);
+    FdContext* ctx = wait->iom->GetFdContext(wait->fd, false);
+    if (!ctx) {
+        return;
+    }
+    std::lock_guard lk{ctx->mtx};
+    FdContext::Waiter& waiter = ctx->GetWaiter(wait->event);
+    // 已经就绪的等待者正在被调度，不能误伤同一个 fd 上之后的等待者
+    if (!(ctx->events & wait->event) || waiter.error != wait->error) {
+        return;
+    }
+    uint32_t events = ctx->events & ~wait->event;
+    wait->iom->poller_->Update(wait->fd, ctx->poll_state, events);
+    ctx->events = events;
+    wait->iom->Trigger(waiter, ETIMEDOUT);
+}
+
+int IOManager::SubmitAndWait(Poller::Request const& request, uint64_t timeout_ms) {
+    Completion completion{Fiber::GetThis()->shared_from_this(), 0, this};
+    pending_requests_.fetch_add(1);
+    if (!poller_->Submit(request, reinterpret_cast<uint64_t>(&completion))) {
+        pending_requests_.fetch_sub(1);
+        return -EINVAL;
+    }
+    TimerId timer = 0;
+    if (timeout_ms != kNoTimeout) {
+        timer = AddActionTimer(timeout_ms, &IOManager::OnRequestTimeout, &completion);
+    }
+    // 完成时协程可能还没切出，RunTask 会等待切换完成
+    Fiber::Yield();
+    if (timer != 0) {
+        CancelTimer(timer);
+    }
+    // 取消请求时请求可能已经完成了，只有被取消掉的才算超时
+    if (completion.timed_out && completion.result == -ECANCELED) {
+        return -ETIMEDOUT;
+    }
+    return completion.result;
+}
+
+void IOManager::OnRequestTimeout(void* arg) {
+    auto* completion = static_cast<Completion*>(arg);
+    completion->timed_out = true;
+    completion->iom->poller_->CancelRequest(reinterpret_cast<uint64_t>(completion));
+}
+
+void IOManager::ProcessTimers() {
+    thread_local std::vector<Expired> expired;
+    // 到期的协程调度到固定的线程之前，不让那个线程以为没有事情可做而退出
+    expiring_.fetch_add(1);
+    if (!TakeExpired(expired)) {
+        expiring_.fetch_sub(1);
+        return;
+    }
+    // 超时的动作可能放进了取消请求
+    poller_->Flush();
+    for (Expired& timer : expired) {
+        if (timer.fiber) {
+            Schedule(std::move(timer.fiber));
+        } else {
+            Schedule(std::move(timer.cb));
+        }
+    }
+    expired.clear();
+    expiring_.fetch_sub(1);
+}
+
+void IOManager::Dispatch(Poller::Event const* events, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (events[i].fd >= 0) {
+            OnReady(events[i]);
+            continue;
+        }
+        auto* completion = reinterpret_cast<Completion*>(events[i].data);
+        completion->result = events[i].result;
+        // 调度之后 completion 随时可能失效
+        Schedule(std::move(completion->fiber));
+        pending_requests_.fetch_sub(1);
+    }
+}
+
+void IOManager::OnReady(Poller::Event const& event) {
+    FdContext* ctx = GetFdContext(event.fd, false);
+    if (!ctx) {
+        return;
+    }
+    std::lock_guard lk{ctx->mtx};
+    uint32_t fired = poller_->Accept(ctx->poll_state, event) & ctx->events;
+    if (fired == NONE) {
+        return;
+    }
+    uint32_t events = ctx->events & ~fired;
+    poller_->Update(event.fd, ctx->poll_state, events);
+    ctx->events = events;
+    if (fired & READ) {
+        Trigger(ctx->read, 0);
+    }
+    if (fired & WRITE) {
+        Trigger(ctx->write, 0);
+    }
+}
+
+void IOManager::Park(size_t index) {
+    std::unique_lock lk{poll_mtx_, std::defer_lock};
+    while (!lk.try_lock()) {
+        if (polling_.load() != kNoPoller) {
+            // 已经有线程在等待事件，提交本线程批量的请求后休眠
+            poller_->Flush();
+            WaitSignal(index);
+            return;
+        }
+        // 锁只是被忙碌线程的 Poll 短暂持有，不能因此没有线程等待事件和定时器
+        std::this_thread::yield();
+    }
+    Poller::Event events[kMaxEvents];
+    size_t n = 0;
+    // 先公布自己在等待事件再查看唤醒信号，和 Unpark 的顺序相反
+    polling_.store(index);
+    while (n == 0 && !TakeSignal(index)) {
+        // 之后添加的更早到期的定时器会通过 OnTimerInsertedAtFront 唤醒
+        uint64_t timeout = GetNextTimeout();
+        if (timeout == 0) {
+            break;
+        }
+        int timeout_ms = timeout == kNoTimeout
+                             ? -1
+                             : static_cast<int>(std::min<uint64_t>(timeout, INT_MAX));
+        n = poller_->Wait(events, kMaxEvents, timeout_ms);
+    }
+    polling_.store(kNoPoller);
+    // 处理事件前释放，被唤醒去执行协程的线程如果没有任务可以接替等待
+    lk.unlock();
+    Dispatch(events, n);
+    ProcessTimers();
+}
+
+void IOManager::Unpark(size_t index) {
+    if (!PostSignal(index)) {
+        return;
+    }
+    if (polling_.load() == index) {
+        poller_->Wakeup();
+    } else {
+        WakeSignal(index);
+    }
+}
+
+void IOManager::Poll(size_t) {
+    if (GetPendingCount() != 0) {
+        std::unique_lock lk{poll_mtx_, std::try_to_lock};
+        if (lk.owns_lock()) {
+            Poller::Event events[kMaxEvents];
+            size_t n = poller_->Wait(events, kMaxEvents, 0);
+            lk.unlock();
+            Dispatch(events, n);
+        } else {
+            // 持有锁的线程阻塞在 Wait 中，不会替忙碌的本线程提交批量的请求
+            poller_->Flush();
+        }
+    }
+    if (GetTimerCount() != 0) {
+        ProcessTimers();
+    }
+}
+
+void IOManager::OnTimerInsertedAtFront() {
+    // 没有线程在等待时，下一个等待的线程会重新计算超时
+    if (polling_.load() != kNoPoller) {
+        poller_->Wakeup();
+    }
+}
+
+}  // namespace eva
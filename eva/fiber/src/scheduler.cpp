@@ -0,0 +1,445 @@
+#include <fiber/scheduler.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace eva {
+
+namespace {
+
+// 每调度这么多次先查看一次全局队列和收件箱，本地队列一直有任务时它们也不会饿死
+constexpr uint32_t kGlobalCheckInterval = 61;
+// 从全局队列一次最多搬到本地队列的任务数
+constexpr size_t kGlobalBatch = 32;
+// 等待协程切换完成时先自旋这么多次，再让出 CPU(切出的线程可能被抢占了)
+constexpr int kSpinCount = 64;
+
+// 当前线程所属的调度器和工作线程序号，平凡类型，访问时无需构造检查
+thread_local Scheduler* t_scheduler = nullptr;
+thread_local int t_worker_index = -1;
+
+void CpuRelax() {
+#if defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+uint64_t NextRandom(uint64_t& state) {
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+long Futex(std::atomic<uint32_t>& word, int op, uint32_t value) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, value, nullptr, nullptr, 0);
+}
+
+}  // namespace
+
+Scheduler::Scheduler(size_t threads, std::string const& name) : name_(name) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(new Worker);
+        workers_.back()->rand = (i + 1) * 0x9E3779B97F4A7C15ULL;
+    }
+    idle_.reserve(threads);
+}
+
+Scheduler::~Scheduler() {
+    Stop();
+    // 启动前或停止后提交、没有执行的任务
+    for (Task* task : global_) {
+        delete task;
+    }
+    for (auto& worker : workers_) {
+        for (Task* task : worker->inbox) {
+            delete task;
+        }
+        Task* task;
+        while (worker->deque.Pop(task)) {
+            delete task;
+        }
+    }
+}
+
+void Scheduler::Start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+    stopping_ = false;
+    exited_ = 0;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread{&Scheduler::Run, this, i};
+    }
+}
+
+void Scheduler::Stop() {
+    if (!started_) {
+        return;
+    }
+    assert(t_scheduler != this);  // 工作线程中调用会等待自己
+    stopping_ = true;
+    WakeAll();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+    started_ = false;
+}
+
+void Scheduler::Schedule(Fiber::ptr fiber, int thread) {
+    if (thread < 0) {
+        thread = fiber->GetAffinity();
+    }
+    Submit(new Task{std::move(fiber), nullptr}, thread);
+}
+
+void Scheduler::Schedule(std::function<void()> cb, int thread) {
+    Submit(new Task{nullptr, std::move(cb)}, thread);
+}
+
+void Scheduler::Submit(Task* task, int thread) {
+    if (thread >= 0) {
+        size_t index = static_cast<size_t>(thread) % workers_.size();
+        Worker& worker = *workers_[index];
+        {
+            std::lock_guard lk{worker.inbox_mtx};
+            worker.inbox.push_back(task);
+            worker.inbox_size.fetch_add(1, std::memory_order_release);
+        }
+        if (t_scheduler != this || static_cast<size_t>(t_worker_index) != index) {
+            WakeWorker(index);
+        }
+        return;
+    }
+    if (t_scheduler == this) {
+        // 快速路径：压入本地队列，不加锁，也没有原子读改写。
+        // 本线程稍后一定会处理这个任务，唤醒只是让空闲线程来分担，
+        // 读到旧值也不会丢任务，不需要全序栅栏
+        workers_[t_worker_index]->deque.Push(task);
+        if (idle_count_.load(std::memory_order_relaxed) != 0 &&
+            !waking_.load(std::memory_order_relaxed)) {
+            WakeOne();
+        }
+        return;
+    }
+    {
+        std::lock_guard lk{global_mtx_};
+        global_.push_back(task);
+        global_size_.fetch_add(1, std::memory_order_release);
+    }
+    // 与 EnterIdle 之后的再次查找配对：要么这里看到空闲线程，要么空闲线程看到这个任务
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idle_count_.load(std::memory_order_relaxed) != 0) {
+        WakeOne();
+    }
+}
+
+Scheduler* Scheduler::GetThis() { return t_scheduler; }
+
+int Scheduler::GetWorkerIndex() { return t_worker_index; }
+
+void Scheduler::Yield() {
+    Scheduler* scheduler = t_scheduler;
+    assert(scheduler);
+    Fiber* fiber = Fiber::GetThis();
+    if (int affinity = fiber->GetAffinity(); affinity >= 0) {
+        // 固定的协程排到它所在工作线程的收件箱末尾
+        scheduler->Submit(new Task{fiber->shared_from_this(), nullptr}, affinity);
+    } else {
+        std::lock_guard lk{scheduler->global_mtx_};
+        scheduler->global_.push_back(new Task{fiber->shared_from_this(), nullptr});
+        scheduler->global_size_.fetch_add(1, std::memory_order_release);
+    }
+    // 其他线程可能在切换完成前取到本协程，RunTask 会等待切换完成
+    Fiber::Yield();
+}
+
+void Scheduler::Run(size_t index) {
+    t_scheduler = this;
+    t_worker_index = static_cast<int>(index);
+    std::string thread_name = name_ + "_" + std::to_string(index);
+    pthread_setname_np(pthread_self(), thread_name.substr(0, 15).c_str());
+    Fiber::GetThis();  // 创建主协程
+
+    Worker& worker = *workers_[index];
+    while (true) {
+        Task* task = FindTask(worker);
+        if (task) {
+            RunTask(worker, task);
+            continue;
+        }
+
+        EnterIdle(index);
+        // 登记为空闲后再看一次，不会错过登记之前提交、没有看到本线程空闲的任务。
+        // 只看不取，先离开空闲列表再取任务：TryExit 数到的空闲线程手里都没有任务
+        bool has_task = HasQueuedTask(worker);
+        if (!has_task && stopping_.load() && TryExit(index)) {
+            WakeAll();
+            break;
+        }
+        if (!has_task) {
+            Park(index);
+        }
+        bool woken = LeaveIdle(index);
+        task = FindTask(worker);
+        if (woken) {
+            waking_.store(false);
+            if (task) {
+                // 找到了任务，可能还有更多，接力唤醒下一个空闲线程
+                WakeOne();
+            }
+        }
+        if (task) {
+            RunTask(worker, task);
+        }
+    }
+    t_scheduler = nullptr;
+    t_worker_index = -1;
+}
+
+Scheduler::Task* Scheduler::FindTask(Worker& worker) {
+    Task* task = nullptr;
+    if (++worker.tick % kGlobalCheckInterval == 0) {
+        Poll(static_cast<size_t>(t_worker_index));
+        if (worker.inbox_size.load(std::memory_order_acquire) != 0) {
+            std::lock_guard lk{worker.inbox_mtx};
+            if (!worker.inbox.empty()) {
+                task = worker.inbox.front();
+                worker.inbox.pop_front();
+                worker.inbox_size.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        if ((task = PopGlobal(worker))) {
+            return task;
+        }
+    }
+    if (worker.deque.Pop(task)) {
+        return task;
+    }
+    if (worker.inbox_size.load(std::memory_order_acquire) != 0) {
+        std::lock_guard lk{worker.inbox_mtx};
+        if (!worker.inbox.empty()) {
+            task = worker.inbox.front();
+            worker.inbox.pop_front();
+            worker.inbox_size.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    if ((task = PopGlobal(worker))) {
+        return task;
+    }
+    return Steal(worker);
+}
+
+bool Scheduler::HasQueuedTask(Worker const& worker) const {
+    if (worker.inbox_size.load(std::memory_order_acquire) != 0 ||
+        global_size_.load(std::memory_order_acquire) != 0) {
+        return true;
+    }
+    // 自己的本地队列和可以窃取的其他线程的本地队列
+    for (auto const& other : workers_) {
+        if (other->deque.SizeApprox() != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Scheduler::Task* Scheduler::PopGlobal(Worker& worker) {
+    if (global_size_.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    std::lock_guard lk{global_mtx_};
+    if (global_.empty()) {
+        return nullptr;
+    }
+    // 按线程数均分，多拿的放进本地队列，减少全局锁的争用，其他线程可以再窃取
+    size_t n = std::min({global_.size() / workers_.size() + 1, global_.size(), kGlobalBatch});
+    Task* task = global_.front();
+    global_.pop_front();
+    for (size_t i = 1; i < n; ++i) {
+        worker.deque.Push(global_.front());
+        global_.pop_front();
+    }
+    global_size_.fetch_sub(n, std::memory_order_relaxed);
+    return task;
+}
+
+Scheduler::Task* Scheduler::Steal(Worker& worker) {
+    size_t n = workers_.size();
+    if (n < 2) {
+        return nullptr;
+    }
+    size_t start = NextRandom(worker.rand) % n;
+    for (size_t i = 0; i < n; ++i) {
+        Worker& victim = *workers_[(start + i) % n];
+        Task* task;
+        if (&victim != &worker && victim.deque.Steal(task)) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void Scheduler::RunTask(Worker& worker, Task* task) {
+    Fiber::ptr fiber;
+    if (task->fiber) {
+        fiber = std::move(task->fiber);
+    } else {
+        if (worker.cb_fiber) {
+            worker.cb_fiber->Reset(std::move(task->cb));
+        } else {
+            worker.cb_fiber = std::make_shared<Fiber>(std::move(task->cb),
+                                                      Fiber::kDefaultStackSize, shared_stack_);
+        }
+        fiber = worker.cb_fiber;
+    }
+    delete task;
+    if (fiber->IsSharedStack() && fiber->GetAffinity() < 0) {
+        // 共享栈协程的栈内容只能换回本线程的共享栈，之后都在本线程上恢复
+        fiber->SetAffinity(t_worker_index);
+    }
+
+    // 协程可能在其他线程上让出之前就被重新提交，等它切换完成
+    for (int spin = 0; fiber->GetState() == Fiber::State::RUNNING; ++spin) {
+        if (spin < kSpinCount) {
+            CpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    try {
+        fiber->Resume();
+    } catch (std::exception const& e) {
+        std::cout << "[ERROR] fiber " << fiber->GetId() << " exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cout << "[ERROR] fiber " << fiber->GetId() << " unknown exception" << std::endl;
+    }
+
+    Fiber::State state = fiber->GetState();
+    if (fiber == worker.cb_fiber && state != Fiber::State::TERM &&
+        state != Fiber::State::EXCEPT) {
+        // 普通函数让出了，协程脱离本线程，由持有它的人重新提交
+        worker.cb_fiber.reset();
+    }
+}
+
+void Scheduler::EnterIdle(size_t index) {
+    std::lock_guard lk{idle_mtx_};
+    idle_.push_back(index);
+    idle_count_.fetch_add(1);
+}
+
+bool Scheduler::TryExit(size_t index) {
+    std::lock_guard lk{idle_mtx_};
+    // 其他线程都已空闲或退出，没有正在执行的任务，也就不会再有新任务；
+    // 空闲线程取任务前要先拿这把锁离开空闲列表，这里看到的队列为空之后不会再有线程取到任务
+    if (idle_.size() + exited_ != workers_.size() || HasPendingWork() ||
+        global_size_.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    for (auto const& worker : workers_) {
+        if (worker->inbox_size.load(std::memory_order_acquire) != 0 ||
+            worker->deque.SizeApprox() != 0) {
+            return false;
+        }
+    }
+    idle_.erase(std::find(idle_.begin(), idle_.end(), index));
+    idle_count_.fetch_sub(1);
+    ++exited_;
+    return true;
+}
+
+bool Scheduler::LeaveIdle(size_t index) {
+    std::lock_guard lk{idle_mtx_};
+    auto it = std::find(idle_.begin(), idle_.end(), index);
+    if (it != idle_.end()) {
+        idle_.erase(it);
+        idle_count_.fetch_sub(1);
+    }
+    return std::exchange(workers_[index]->woken, false);
+}
+
+void Scheduler::WakeOne() {
+    // 同一时刻只有一个线程在被唤醒的路上，避免提交一批任务时把所有空闲线程都唤醒
+    if (waking_.exchange(true)) {
+        return;
+    }
+    size_t index;
+    {
+        std::lock_guard lk{idle_mtx_};
+        auto it = idle_.end();
+        // 调用者自己还登记为空闲时(如 Park 中处理完事件)不唤醒自己，它本来就会去找任务
+        if (it != idle_.begin() && t_scheduler == this &&
+            *(it - 1) == static_cast<size_t>(t_worker_index)) {
+            --it;
+        }
+        if (it == idle_.begin()) {
+            waking_.store(false);
+            return;
+        }
+        --it;
+        index = *it;
+        idle_.erase(it);
+        idle_count_.fetch_sub(1);
+        workers_[index]->woken = true;
+    }
+    Unpark(index);
+}
+
+void Scheduler::WakeWorker(size_t index) {
+    {
+        std::lock_guard lk{idle_mtx_};
+        auto it = std::find(idle_.begin(), idle_.end(), index);
+        if (it != idle_.end()) {
+            idle_.erase(it);
+            idle_count_.fetch_sub(1);
+        }
+    }
+    Unpark(index);
+}
+
+void Scheduler::WakeAll() {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        Unpark(i);
+    }
+}
+
+void Scheduler::Park(size_t index) { WaitSignal(index); }
+
+void Scheduler::Unpark(size_t index) {
+    if (PostSignal(index)) {
+        WakeSignal(index);
+    }
+}
+
+bool Scheduler::PostSignal(size_t index) { return workers_[index]->signal.exchange(1) == 0; }
+
+bool Scheduler::TakeSignal(size_t index) { return workers_[index]->signal.exchange(0) != 0; }
+
+void Scheduler::WaitSignal(size_t index) {
+    while (!TakeSignal(index)) {
+        Futex(workers_[index]->signal, FUTEX_WAIT_PRIVATE, 0);
+    }
+}
+
+void Scheduler::WakeSignal(size_t index) {
+    Futex(workers_[index]->signal, FUTEX_WAKE_PRIVATE, 1);
+}
+
+}  // namespace eva
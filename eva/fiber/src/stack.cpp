@@ -0,0 +1,351 @@
+#include <fiber/stack.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace eva {
+
+namespace {
+
+// 每个线程缓存中保留物理页、可以直接复用的栈数
+constexpr size_t kHotStacks = 16;
+// 每个线程缓存中已归还物理页、只保留地址空间的栈数
+constexpr size_t kColdStacks = 64;
+// 全局池的栈数，线程缓存满了或线程退出时放到这里
+constexpr size_t kGlobalStacks = 1024;
+// 没有保护页时一次映射的栈数
+constexpr size_t kSlabStacks = 64;
+// 备用信号栈大小
+constexpr size_t kSignalStackSize = 64 * 1024;
+
+std::atomic<size_t> g_mapped{0};          // 已分配的栈数
+std::atomic<size_t> g_guarded{0};         // 带保护页的栈数
+std::atomic<bool> g_guard_warned{false};  // 已经警告过保护页不可用
+
+size_t PageSize() {
+    static size_t const size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+/**
+ * @brief 全局池，函数内静态变量，线程退出时也可以安全使用
+ */
+struct GlobalPool {
+    std::mutex mtx;
+    std::vector<FiberStack> stacks;  // 都已归还物理页
+};
+
+GlobalPool& GetGlobalPool() {
+    static GlobalPool* pool = new GlobalPool;  // 不析构，其他静态对象析构时可能还在释放栈
+    return *pool;
+}
+
+/**
+ * @brief 正在切分的大块，每种栈大小一个
+ */
+struct Slab {
+    size_t size;  // 栈大小
+    char* next;   // 下一个栈的起始地址
+    char* end;    // 大块的结束地址
+};
+
+struct SlabArena {
+    std::mutex mtx;
+    std::vector<Slab> slabs;
+};
+
+SlabArena& GetSlabArena() {
+    static SlabArena* arena = new SlabArena;  // 不析构，理由同全局池
+    return *arena;
+}
+
+/**
+ * @brief 带保护页的栈数上限：留出 vm.max_map_count 的 1/4 给进程的其他映射，
+ * 其余每个栈占两个映射
+ */
+size_t GuardBudget() {
+    static size_t const budget = [] {
+        unsigned long max_maps = 65530;
+        if (FILE* file = std::fopen("/proc/sys/vm/max_map_count", "r")) {
+            unsigned long value = 0;
+            if (std::fscanf(file, "%lu", &value) == 1 && value != 0) {
+                max_maps = value;
+            }
+            std::fclose(file);
+        }
+        return static_cast<size_t>(max_maps / 4 * 3 / 2);
+    }();
+    return budget;
+}
+
+/**
+ * @brief 线程的空闲链表
+ */
+struct ThreadCache {
+    std::vector<FiberStack> hot;   // 保留物理页
+    std::vector<FiberStack> cold;  // 已归还物理页
+};
+
+/**
+ * @brief 线程退出时把缓存交给全局池；之后本线程释放的栈直接进全局池
+ */
+struct ThreadCacheHolder {
+    ThreadCache* cache{nullptr};
+    ~ThreadCacheHolder();
+};
+
+thread_local ThreadCacheHolder t_cache_holder;
+thread_local bool t_cache_destroyed = false;
+
+ThreadCache* GetThreadCache() {
+    if (t_cache_destroyed) [[unlikely]] {
+        return nullptr;
+    }
+    ThreadCacheHolder& holder = t_cache_holder;
+    if (!holder.cache) {
+        holder.cache = new ThreadCache;
+    }
+    return holder.cache;
+}
+
+void ReleasePages(FiberStack const& stack) { madvise(stack.base, stack.size, MADV_DONTNEED); }
+
+/**
+ * @brief 释放单独映射或堆上分配的栈
+ */
+void Unmap(FiberStack const& stack) {
+    if (stack.source == StackSource::HEAP) {
+        std::free(stack.base);
+    } else {
+        munmap(static_cast<char*>(stack.base) - stack.guard, stack.size + stack.guard);
+        g_guarded.fetch_sub(1, std::memory_order_relaxed);
+    }
+    g_mapped.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 放进全局池，池满时释放；大块中切出的栈不能单独解除映射，总是放进池中；
+ * stack 已归还物理页
+ */
+void PutGlobal(FiberStack const& stack) {
+    GlobalPool& pool = GetGlobalPool();
+    {
+        std::lock_guard lk{pool.mtx};
+        if (pool.stacks.size() < kGlobalStacks || stack.source == StackSource::SLAB) {
+            pool.stacks.push_back(stack);
+            return;
+        }
+    }
+    Unmap(stack);
+}
+
+/**
+ * @brief 从 stacks 中取出一个可用大小为 size 的栈
+ */
+bool TakeMatching(std::vector<FiberStack>& stacks, size_t size, FiberStack& stack) {
+    for (size_t i = stacks.size(); i-- > 0;) {
+        if (stacks[i].size == size) {
+            stack = stacks[i];
+            stacks[i] = stacks.back();
+            stacks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 从大块中切出一个没有保护页的栈，当前大块用完时映射新的大块
+ */
+bool CarveSlab(size_t size, FiberStack& stack) {
+    SlabArena& arena = GetSlabArena();
+    std::lock_guard lk{arena.mtx};
+    auto it = std::find_if(arena.slabs.begin(), arena.slabs.end(),
+                           [size](Slab const& slab) { return slab.size == size; });
+    if (it == arena.slabs.end() || it->next == it->end) {
+        void* mem = mmap(nullptr, size * kSlabStacks, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (mem == MAP_FAILED) {
+            return false;
+        }
+        Slab slab{size, static_cast<char*>(mem), static_cast<char*>(mem) + size * kSlabStacks};
+        if (it == arena.slabs.end()) {
+            it = arena.slabs.insert(it, slab);
+        } else {
+            *it = slab;
+        }
+    }
+    stack = FiberStack{it->next, size, 0, StackSource::SLAB};
+    it->next += size;
+    return true;
+}
+
+FiberStack Map(size_t size) {
+    if (g_guarded.load(std::memory_order_relaxed) < GuardBudget()) {
+        size_t guard = PageSize();
+        void* mem = mmap(nullptr, size + guard, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (mem != MAP_FAILED) {
+            // 保护页把映射一分为二，映射数用尽时 mprotect 以 ENOMEM 失败
+            if (mprotect(mem, guard, PROT_NONE) == 0) {
+                g_guarded.fetch_add(1, std::memory_order_relaxed);
+                g_mapped.fetch_add(1, std::memory_order_relaxed);
+                return FiberStack{static_cast<char*>(mem) + guard, size, guard};
+            }
+            munmap(mem, size + guard);
+        }
+    }
+    // 保护页的预算用完，或者进程的其他映射比预留的多：每个新映射都可能因映射数失败，
+    // 改为一次映射多个栈，实在映射不了再用堆
+    if (!g_guard_warned.exchange(true)) {
+        std::cout << "[WARN] fiber stack guard pages disabled: too many memory mappings "
+                     "(vm.max_map_count), new stacks are carved from unguarded slabs"
+                  << std::endl;
+    }
+    FiberStack stack;
+    if (!CarveSlab(size, stack)) {
+        void* mem = std::aligned_alloc(PageSize(), size);
+        if (!mem) {
+            throw std::bad_alloc{};
+        }
+        stack = FiberStack{mem, size, 0, StackSource::HEAP};
+    }
+    g_mapped.fetch_add(1, std::memory_order_relaxed);
+    return stack;
+}
+
+ThreadCacheHolder::~ThreadCacheHolder() {
+    t_cache_destroyed = true;
+    if (!cache) {
+        return;
+    }
+    for (FiberStack const& stack : cache->hot) {
+        ReleasePages(stack);
+        PutGlobal(stack);
+    }
+    for (FiberStack const& stack : cache->cold) {
+        PutGlobal(stack);
+    }
+    delete cache;
+    cache = nullptr;
+}
+
+/**
+ * @brief 本模块设置的备用信号栈，线程退出时撤销并解除映射
+ */
+struct SignalStack {
+    void* mem{nullptr};
+    bool checked{false};
+
+    ~SignalStack() {
+        if (!mem) {
+            return;
+        }
+        stack_t current;
+        // 备用信号栈被别人换掉了就不动它
+        if (sigaltstack(nullptr, &current) == 0 && current.ss_sp == mem) {
+            stack_t disable;
+            memset(&disable, 0, sizeof(disable));
+            disable.ss_flags = SS_DISABLE;
+            sigaltstack(&disable, nullptr);
+        }
+        munmap(mem, kSignalStackSize);
+    }
+};
+
+thread_local SignalStack t_signal_stack;
+
+}  // namespace
+
+FiberStack StackAllocator::Allocate(size_t size) {
+    size_t page = PageSize();
+    size = (std::max(size, page) + page - 1) / page * page;
+    FiberStack stack;
+    if (ThreadCache* cache = GetThreadCache()) {
+        if (TakeMatching(cache->hot, size, stack) || TakeMatching(cache->cold, size, stack)) {
+            return stack;
+        }
+    }
+    GlobalPool& pool = GetGlobalPool();
+    {
+        std::lock_guard lk{pool.mtx};
+        if (TakeMatching(pool.stacks, size, stack)) {
+            return stack;
+        }
+    }
+    return Map(size);
+}
+
+void StackAllocator::Deallocate(FiberStack const& stack) {
+    if (!stack.base) {
+        return;
+    }
+    ThreadCache* cache = GetThreadCache();
+    if (cache && cache->hot.size() < kHotStacks) {
+        cache->hot.push_back(stack);
+        return;
+    }
+    // 超出保留的数量，归还物理页，只保留地址空间
+    ReleasePages(stack);
+    if (cache && cache->cold.size() < kColdStacks) {
+        cache->cold.push_back(stack);
+        return;
+    }
+    PutGlobal(stack);
+}
+
+void StackAllocator::Trim() {
+    ThreadCache* cache = GetThreadCache();
+    if (!cache) {
+        return;
+    }
+    for (FiberStack const& stack : cache->hot) {
+        ReleasePages(stack);
+        if (cache->cold.size() < kColdStacks) {
+            cache->cold.push_back(stack);
+        } else {
+            PutGlobal(stack);
+        }
+    }
+    cache->hot.clear();
+}
+
+size_t StackAllocator::GetMappedCount() { return g_mapped.load(std::memory_order_relaxed); }
+
+void EnsureSignalStack() {
+    SignalStack& signal_stack = t_signal_stack;
+    if (signal_stack.checked) {
+        return;
+    }
+    signal_stack.checked = true;
+    stack_t current;
+    if (sigaltstack(nullptr, &current) == 0 && !(current.ss_flags & SS_DISABLE)) {
+        return;
+    }
+    void* mem = mmap(nullptr, kSignalStackSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return;
+    }
+    stack_t stack;
+    memset(&stack, 0, sizeof(stack));
+    stack.ss_sp = mem;
+    stack.ss_size = kSignalStackSize;
+    if (sigaltstack(&stack, nullptr) != 0) {
+        munmap(mem, kSignalStackSize);
+        return;
+    }
+    signal_stack.mem = mem;
+}
+
+}  // namespace eva
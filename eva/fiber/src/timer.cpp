@@ -0,0 +1,356 @@
+#include <fiber/timer.h>
+#include <time.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
+namespace eva {
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {
+    for (Link& head : heads_) {
+        head.prev = &head;
+        head.next = &head;
+    }
+}
+
+void TimerWheel::Insert(Node* node, uint64_t expire) {
+    assert(!IsLinked(node));
+    node->expire = expire;
+    Place(node);
+    ++size_;
+}
+
+void TimerWheel::Remove(Node* node) {
+    assert(IsLinked(node));
+    Unlink(node);
+    node->slot = kNoSlot;
+    --size_;
+}
+
+void TimerWheel::Place(Node* node) {
+    uint32_t slot = kDueSlot;
+    if (node->expire > now_) {
+        uint64_t delta = node->expire - now_;
+        int level = (std::bit_width(delta) - 1) / kLevelBits;
+        uint64_t expire = node->expire;
+        if (level >= kLevels) {
+            // 超出范围，放在最远的槽，级联时按真实的到期时间重新放置
+            level = kLevels - 1;
+            expire = now_ + (1ULL << (kLevelBits * kLevels)) - 1;
+        }
+        uint32_t index = static_cast<uint32_t>((expire >> (kLevelBits * level)) & kSlotMask);
+        slot = static_cast<uint32_t>(level) * kSlots + index;
+        occupied_[level] |= 1ULL << index;
+    }
+    Link* head = &heads_[slot];
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+    node->slot = slot;
+}
+
+void TimerWheel::Unlink(Node* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    uint32_t slot = node->slot;
+    if (slot != kDueSlot && heads_[slot].next == &heads_[slot]) {
+        occupied_[slot / kSlots] &= ~(1ULL << (slot % kSlots));
+    }
+}
+
+void TimerWheel::Take(uint32_t slot, Link**& tail) {
+    Link* head = &heads_[slot];
+    if (head->next == head) {
+        return;
+    }
+    for (Link* link = head->next; link != head; link = link->next) {
+        static_cast<Node*>(link)->slot = kNoSlot;
+        --size_;
+    }
+    // 整个链表接到到期链表末尾
+    *tail = head->next;
+    tail = &head->prev->next;
+    *tail = nullptr;
+    head->prev = head;
+    head->next = head;
+    if (slot != kDueSlot) {
+        occupied_[slot / kSlots] &= ~(1ULL << (slot % kSlots));
+    }
+}
+
+void TimerWheel::Cascade() {
+    for (int level = 1; level < kLevels; ++level) {
+        uint32_t index = static_cast<uint32_t>((now_ >> (kLevelBits * level)) & kSlotMask);
+        uint32_t slot = static_cast<uint32_t>(level) * kSlots + index;
+        if (occupied_[level] & (1ULL << index)) {
+            // 先摘下整个链表，重新放置的节点可能回到同一层
+            Link* head = &heads_[slot];
+            Link* link = head->next;
+            head->prev->next = nullptr;
+            head->prev = head;
+            head->next = head;
+            occupied_[level] &= ~(1ULL << index);
+            while (link) {
+                auto* node = static_cast<Node*>(link);
+                link = link->next;
+                Place(node);
+            }
+        }
+        // 这一层没有回绕，更高层也没有到边界
+        if (index != 0) {
+            break;
+        }
+    }
+}
+
+TimerWheel::Node* TimerWheel::Advance(uint64_t now) {
+    Link* head = nullptr;
+    Link** tail = &head;
+    Take(kDueSlot, tail);
+    while (now_ < now) {
+        // 跳到第 0 层下一个非空的槽或下一个边界，中间的刻度没有节点；第 0 层为空时
+        // 直接跳到高层下一个非空槽的级联时间
+        uint64_t next;
+        if (occupied_[0] != 0) {
+            uint64_t index = now_ & kSlotMask;
+            uint64_t later = index == kSlotMask ? 0 : occupied_[0] & (~0ULL << (index + 1));
+            next = later ? (now_ & ~kSlotMask) + std::countr_zero(later) : (now_ | kSlotMask) + 1;
+        } else {
+            next = NextExpiry();
+        }
+        now_ = std::min(next, now);
+        if ((now_ & kSlotMask) == 0) {
+            Cascade();
+            // 级联时恰好在此刻到期的节点
+            Take(kDueSlot, tail);
+        }
+        uint32_t slot = static_cast<uint32_t>(now_ & kSlotMask);
+        if (occupied_[0] & (1ULL << slot)) {
+            Take(slot, tail);
+        }
+    }
+    return static_cast<Node*>(head);
+}
+
+uint64_t TimerWheel::NextExpiry() const {
+    if (heads_[kDueSlot].next != &heads_[kDueSlot]) {
+        return now_;
+    }
+    uint64_t next = kNever;
+    for (int level = 0; level < kLevels; ++level) {
+        uint64_t bits = occupied_[level];
+        if (bits == 0) {
+            continue;
+        }
+        int shift = kLevelBits * level;
+        uint64_t index = (now_ >> shift) & kSlotMask;
+        // 当前槽之后的槽属于这一圈，之前的(含当前槽)属于下一圈
+        uint64_t later = index == kSlotMask ? 0 : bits & (~0ULL << (index + 1));
+        uint64_t distance = later ? std::countr_zero(later) - index
+                                  : kSlots - index + std::countr_zero(bits);
+        next = std::min(next, ((now_ >> shift) + distance) << shift);
+    }
+    return next;
+}
+
+TimerManager::TimerManager() : wheel_(NowMs()) {}
+
+TimerManager::~TimerManager() = default;
+
+uint64_t TimerManager::NowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+}
+
+TimerManager::Timer* TimerManager::Alloc() {
+    if (!free_) {
+        // 按块分配，块内的节点串进空闲链表
+        uint32_t base = static_cast<uint32_t>(chunks_.size()) << kChunkBits;
+        auto chunk = std::make_unique<Timer[]>(kChunkSize);
+        for (uint32_t i = kChunkSize; i-- > 0;) {
+            chunk[i].index = base + i;
+            chunk[i].next = free_;
+            free_ = &chunk[i];
+        }
+        chunks_.push_back(std::move(chunk));
+    }
+    Timer* timer = free_;
+    free_ = static_cast<Timer*>(timer->next);
+    return timer;
+}
+
+void TimerManager::Free(Timer* timer) {
+    ++timer->gen;
+    timer->period = 0;
+    timer->fiber.reset();
+    timer->cb = nullptr;
+    timer->cond.reset();
+    timer->has_cond = false;
+    timer->action = nullptr;
+    timer->arg = nullptr;
+    timer->next = free_;
+    free_ = timer;
+}
+
+TimerManager::Timer* TimerManager::Find(TimerId id) {
+    uint64_t index = (id & 0xffffffffULL) - 1;
+    if (id == 0 || (index >> kChunkBits) >= chunks_.size()) {
+        return nullptr;
+    }
+    Timer* timer = &chunks_[index >> kChunkBits][index & (kChunkSize - 1)];
+    if (timer->gen != static_cast<uint32_t>(id >> 32) || !TimerWheel::IsLinked(timer)) {
+        return nullptr;
+    }
+    return timer;
+}
+
+bool TimerManager::Insert(Timer* timer, uint64_t ms) {
+    // NowMs 向下取整，多加一个刻度，保证至少过了 ms 毫秒
+    uint64_t expire = NowMs() + std::min(ms, kNoTimeout / 2) + 1;
+    wheel_.Insert(timer, expire);
+    count_.store(wheel_.Size(), std::memory_order_relaxed);
+    if (expire >= wakeup_at_) {
+        return false;
+    }
+    // 只通知一次，等待的线程醒来后重新计算
+    wakeup_at_ = expire;
+    return true;
+}
+
+TimerManager::TimerId TimerManager::Add(uint64_t ms, Timer&& init) {
+    TimerId id;
+    bool front;
+    {
+        std::lock_guard lk{mtx_};
+        Timer* timer = Alloc();
+        timer->period = init.period;
+        timer->fiber = std::move(init.fiber);
+        timer->cb = std::move(init.cb);
+        timer->cond = std::move(init.cond);
+        timer->has_cond = init.has_cond;
+        timer->action = init.action;
+        timer->arg = init.arg;
+        front = Insert(timer, ms);
+        id = MakeId(timer);
+    }
+    if (front) {
+        OnTimerInsertedAtFront();
+    }
+    return id;
+}
+
+TimerManager::TimerId TimerManager::AddTimer(uint64_t ms, std::function<void()> cb,
+                                             bool recurring) {
+    Timer init;
+    init.period = recurring ? std::max<uint64_t>(ms, 1) : 0;
+    init.cb = std::move(cb);
+    return Add(ms, std::move(init));
+}
+
+TimerManager::TimerId TimerManager::AddConditionTimer(uint64_t ms, std::function<void()> cb,
+                                                      std::weak_ptr<void> cond, bool recurring) {
+    Timer init;
+    init.period = recurring ? std::max<uint64_t>(ms, 1) : 0;
+    init.cb = std::move(cb);
+    init.cond = std::move(cond);
+    init.has_cond = true;
+    return Add(ms, std::move(init));
+}
+
+TimerManager::TimerId TimerManager::AddFiberTimer(uint64_t ms, Fiber::ptr fiber) {
+    Timer init;
+    init.fiber = std::move(fiber);
+    return Add(ms, std::move(init));
+}
+
+TimerManager::TimerId TimerManager::AddActionTimer(uint64_t ms, void (*action)(void*),
+                                                   void* arg) {
+    Timer init;
+    init.action = action;
+    init.arg = arg;
+    return Add(ms, std::move(init));
+}
+
+bool TimerManager::CancelTimer(TimerId id) {
+    std::lock_guard lk{mtx_};
+    Timer* timer = Find(id);
+    if (!timer) {
+        return false;
+    }
+    wheel_.Remove(timer);
+    count_.store(wheel_.Size(), std::memory_order_relaxed);
+    Free(timer);
+    return true;
+}
+
+bool TimerManager::ResetTimer(TimerId id, uint64_t ms) {
+    bool front;
+    {
+        std::lock_guard lk{mtx_};
+        Timer* timer = Find(id);
+        if (!timer) {
+            return false;
+        }
+        wheel_.Remove(timer);
+        if (timer->period != 0) {
+            timer->period = std::max<uint64_t>(ms, 1);
+        }
+        front = Insert(timer, ms);
+    }
+    if (front) {
+        OnTimerInsertedAtFront();
+    }
+    return true;
+}
+
+uint64_t TimerManager::GetNextTimeout() {
+    uint64_t next;
+    {
+        std::lock_guard lk{mtx_};
+        next = wheel_.NextExpiry();
+        wakeup_at_ = next;
+    }
+    if (next == TimerWheel::kNever) {
+        return kNoTimeout;
+    }
+    uint64_t now = NowMs();
+    return next > now ? next - now : 0;
+}
+
+bool TimerManager::TakeExpired(std::vector<Expired>& expired) {
+    uint64_t now = NowMs();
+    std::lock_guard lk{mtx_};
+    TimerWheel::Node* node = wheel_.Advance(now);
+    if (!node) {
+        return false;
+    }
+    while (node) {
+        auto* timer = static_cast<Timer*>(node);
+        // 周期定时器会重新插入，先取出下一个
+        node = static_cast<TimerWheel::Node*>(node->next);
+        if (timer->action) {
+            timer->action(timer->arg);
+        } else if (timer->fiber) {
+            expired.push_back({std::move(timer->fiber), nullptr});
+        } else if (timer->has_cond && timer->cond.expired()) {
+            // 条件失效，周期定时器也不再重复
+        } else if (timer->period != 0) {
+            expired.push_back({nullptr, timer->cb});
+            wheel_.Insert(timer, now + timer->period);
+            continue;
+        } else {
+            expired.push_back({nullptr, std::move(timer->cb)});
+        }
+        Free(timer);
+    }
+    count_.store(wheel_.Size(), std::memory_order_relaxed);
+    // 下一次插入的定时器都要通知，此时没有线程按之前算出的时间等待
+    wakeup_at_ = TimerWheel::kNever;
+    return true;
+}
+
+}  // namespace eva
@@ -0,0 +1,422 @@
+#include <fiber/poller.h>
+#include <linux/io_uring.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace eva {
+
+namespace {
+
+// user_data 的低 2 位区分 CQE 的来源；请求的 data 是对齐的指针，低 2 位为 0
+constexpr uint64_t kTagRequest = 0;
+constexpr uint64_t kTagPoll = 1;
+constexpr uint64_t kTagWakeup = 2;
+constexpr uint64_t kTagIgnore = 3;  // 删除监听、取消请求的结果
+constexpr uint64_t kTagMask = 3;
+
+// 监听的 user_data：| 代数 16 | fd 32 | 写 1 | tag 2 |
+uint64_t PollData(int fd, bool write, uint32_t gen) {
+    return (static_cast<uint64_t>(gen & 0xffff) << 35) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 3) |
+           (static_cast<uint64_t>(write) << 2) | kTagPoll;
+}
+
+// fd 的后端状态：| 写的代数 16 | 读的代数 16 | 已提交的监听 32 |
+// 每次提交监听代数加一，删除后又重新监听时，旧监听迟到的结果不会被当成新监听的
+uint32_t Gen(uint64_t state, bool write) {
+    return static_cast<uint32_t>(state >> (write ? 48 : 32)) & 0xffff;
+}
+
+void SetGen(uint64_t& state, bool write, uint32_t gen) {
+    int shift = write ? 48 : 32;
+    state = (state & ~(0xffffULL << shift)) | (static_cast<uint64_t>(gen & 0xffff) << shift);
+}
+
+int Enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+          void* arg = nullptr, size_t arg_size = 0) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+/**
+ * @brief io_uring 后端：监听用一次性的 POLL_ADD，读写等请求直接提交
+ * @details 提交队列由 sq_mtx_ 保护，任何线程都可以填写 SQE；io_uring_enter 可以并发调用，
+ * 不需要加锁。完成队列只由 Wait 的线程读取
+ */
+class UringPoller : public Poller {
+public:
+    ~UringPoller() override {
+        if (sqes_ != MAP_FAILED) {
+            munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            munmap(sq_ring_, sq_ring_size_);
+        }
+        if (wake_fd_ >= 0) {
+            close(wake_fd_);
+        }
+        if (ring_fd_ >= 0) {
+            close(ring_fd_);
+        }
+    }
+
+    bool Init(unsigned entries);
+
+    char const* GetName() const override { return "io_uring"; }
+
+    bool Update(int fd, uint64_t& state, uint32_t events) override {
+        uint32_t armed = static_cast<uint32_t>(state);
+        uint32_t add = events & ~armed;
+        uint32_t remove = armed & ~events;
+        if (add == 0 && remove == 0) {
+            return true;
+        }
+        std::lock_guard lk{sq_mtx_};
+        for (bool write : {false, true}) {
+            uint32_t bit = write ? EPOLLOUT : EPOLLIN;
+            if (remove & bit) {
+                io_uring_sqe* sqe = GetSqe();
+                sqe->opcode = IORING_OP_POLL_REMOVE;
+                sqe->fd = -1;
+                sqe->addr = PollData(fd, write, Gen(state, write));
+                sqe->user_data = kTagIgnore;
+                Publish();
+            }
+            if (add & bit) {
+                uint32_t gen = Gen(state, write) + 1;
+                SetGen(state, write, gen);
+                io_uring_sqe* sqe = GetSqe();
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->fd = fd;
+                sqe->poll32_events = bit;
+                sqe->user_data = PollData(fd, write, gen);
+                Publish();
+            }
+        }
+        state = (state & ~0xffffffffULL) | events;
+        return true;
+    }
+
+    uint32_t Accept(uint64_t& state, Event const& event) override {
+        bool write = (event.data >> 2) & 1;
+        uint32_t bit = write ? EPOLLOUT : EPOLLIN;
+        uint32_t gen = static_cast<uint32_t>(event.data >> 35) & 0xffff;
+        if ((state & bit) == 0 || Gen(state, write) != gen) {
+            return 0;
+        }
+        state &= ~static_cast<uint64_t>(bit);
+        return bit;
+    }
+
+    size_t Wait(Event* events, size_t max, int timeout_ms) override {
+        ArmWakeup();
+        bool woken = false;
+        if (timeout_ms == 0) {
+            Flush();
+            return Reap(events, max, woken);
+        }
+        size_t n = Reap(events, max, woken);
+        if (n != 0 || woken) {
+            Flush();
+            return n;
+        }
+        // 提交和等待合并成一次系统调用
+        unsigned flags = IORING_ENTER_GETEVENTS;
+        io_uring_getevents_arg arg{};
+        __kernel_timespec ts{};
+        if (timeout_ms > 0) {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+        int rt = Enter(ring_fd_, Unsubmitted(), 1, flags, timeout_ms > 0 ? &arg : nullptr,
+                       timeout_ms > 0 ? sizeof(arg) : 0);
+        if (rt < 0 && errno != EINTR && errno != ETIME && errno != EBUSY && errno != EAGAIN) {
+            std::cout << "[ERROR] io_uring_enter error: " << strerror(errno) << std::endl;
+        }
+        return Reap(events, max, woken);
+    }
+
+    void Wakeup() override {
+        uint64_t one = 1;
+        while (write(wake_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+
+    bool SupportsRequests() const override { return true; }
+
+    bool Submit(Request const& request, uint64_t data) override {
+        assert((data & kTagMask) == kTagRequest);
+        std::lock_guard lk{sq_mtx_};
+        io_uring_sqe* sqe = GetSqe();
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(request.buf);
+        switch (request.op) {
+            case Request::READ:
+                sqe->opcode = IORING_OP_READ;
+                sqe->len = request.len;
+                sqe->off = static_cast<uint64_t>(-1);  // 当前文件位置
+                break;
+            case Request::WRITE:
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->len = request.len;
+                sqe->off = static_cast<uint64_t>(-1);
+                break;
+            case Request::ACCEPT:
+                sqe->opcode = IORING_OP_ACCEPT;
+                sqe->addr2 = reinterpret_cast<uint64_t>(request.addrlen);
+                sqe->accept_flags = static_cast<uint32_t>(request.flags);
+                break;
+            case Request::CONNECT:
+                sqe->opcode = IORING_OP_CONNECT;
+                sqe->off = request.len;
+                break;
+        }
+        sqe->user_data = data;
+        Publish();
+        return true;
+    }
+
+    void Cancel(int fd) override {
+#ifdef IORING_ASYNC_CANCEL_FD
+        std::lock_guard lk{sq_mtx_};
+        io_uring_sqe* sqe = GetSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = kTagIgnore;
+        Publish();
+#else
+        (void)fd;
+#endif
+    }
+
+    void CancelRequest(uint64_t data) override {
+        std::lock_guard lk{sq_mtx_};
+        io_uring_sqe* sqe = GetSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = data;
+        sqe->user_data = kTagIgnore;
+        Publish();
+    }
+
+    void Flush() override {
+        unsigned n = Unsubmitted();
+        if (n != 0) {
+            Enter(ring_fd_, n, 0, 0);
+        }
+    }
+
+private:
+    unsigned Unsubmitted() const {
+        return __atomic_load_n(sq_tail_, __ATOMIC_ACQUIRE) -
+               __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    }
+
+    /**
+     * @brief 取一个空闲的 SQE，队列满时先提交；调用者持有 sq_mtx_
+     */
+    io_uring_sqe* GetSqe() {
+        while (sq_tail_value_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+            if (Enter(ring_fd_, sq_entries_, 0, 0) < 0 && (errno == EBUSY || errno == EAGAIN)) {
+                // 完成队列积压，等 Wait 的线程取走一些
+                std::this_thread::yield();
+            }
+        }
+        io_uring_sqe* sqe = &sqes_[sq_tail_value_ & sq_mask_];
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    /**
+     * @brief 发布填好的 SQE，内核在下一次 io_uring_enter 时看到；调用者持有 sq_mtx_
+     */
+    void Publish() { __atomic_store_n(sq_tail_, ++sq_tail_value_, __ATOMIC_RELEASE); }
+
+    /**
+     * @brief 监听 eventfd，Wakeup 写入后 Wait 返回；只在 Wait 的线程调用
+     */
+    void ArmWakeup() {
+        if (wake_armed_) {
+            return;
+        }
+        std::lock_guard lk{sq_mtx_};
+        io_uring_sqe* sqe = GetSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = wake_fd_;
+        sqe->poll32_events = EPOLLIN;
+        sqe->user_data = kTagWakeup;
+        Publish();
+        wake_armed_ = true;
+    }
+
+    size_t Reap(Event* events, size_t max, bool& woken) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        size_t count = 0;
+        for (; head != tail && count < max; ++head) {
+            io_uring_cqe const& cqe = cqes_[head & cq_mask_];
+            switch (cqe.user_data & kTagMask) {
+                case kTagRequest:
+                    events[count++] = Event{-1, 0, cqe.user_data, cqe.res};
+                    break;
+                case kTagPoll: {
+                    if (cqe.res == -ECANCELED) {
+                        break;  // 已删除的监听
+                    }
+                    bool write = (cqe.user_data >> 2) & 1;
+                    uint32_t bit = write ? EPOLLOUT : EPOLLIN;
+                    int fd = static_cast<int>(static_cast<uint32_t>(cqe.user_data >> 3));
+                    events[count++] = Event{fd, cqe.res < 0 ? bit | EPOLLERR : bit,
+                                            cqe.user_data, cqe.res};
+                    break;
+                }
+                case kTagWakeup: {
+                    uint64_t value;
+                    while (read(wake_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+                    }
+                    wake_armed_ = false;
+                    woken = true;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+    int ring_fd_{-1};
+    int wake_fd_{-1};
+    bool wake_armed_{false};  // eventfd 的监听已提交，只在 Wait 的线程访问
+
+    void* sq_ring_{MAP_FAILED};
+    size_t sq_ring_size_{0};
+    void* cq_ring_{MAP_FAILED};
+    size_t cq_ring_size_{0};
+    io_uring_sqe* sqes_{static_cast<io_uring_sqe*>(MAP_FAILED)};
+    size_t sqes_size_{0};
+
+    std::mutex sq_mtx_;            // 保护提交队列的填写
+    unsigned* sq_head_{nullptr};   // 内核更新
+    unsigned* sq_tail_{nullptr};   // 用户更新
+    unsigned sq_tail_value_{0};    // sq_tail_ 的本地副本，由 sq_mtx_ 保护
+    unsigned sq_mask_{0};
+    unsigned sq_entries_{0};
+
+    unsigned* cq_head_{nullptr};   // 用户更新
+    unsigned* cq_tail_{nullptr};   // 内核更新
+    unsigned cq_mask_{0};
+    io_uring_cqe* cqes_{nullptr};
+};
+
+bool UringPoller::Init(unsigned entries) {
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CLAMP | IORING_SETUP_CQSIZE;
+    // 监听和请求可以远多于提交队列的大小，完成队列留足空间
+    params.cq_entries = entries * 8;
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0) {
+        return false;
+    }
+    // 不丢弃完成事件；Wait 的超时需要 EXT_ARG
+    if (!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_
+                           : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+        return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                                            MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                            IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_tail_value_ = *sq_tail_;
+    // SQE 按顺序使用，索引数组固定为恒等映射
+    unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        array[i] = i;
+    }
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // 确认用到的操作都支持
+    size_t probe_size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    auto* probe = static_cast<io_uring_probe*>(calloc(1, probe_size));
+    if (!probe) {
+        return false;
+    }
+    bool supported =
+        syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PROBE, probe, 256) == 0;
+    for (int op : {IORING_OP_POLL_ADD, IORING_OP_POLL_REMOVE, IORING_OP_ASYNC_CANCEL,
+                   IORING_OP_READ, IORING_OP_WRITE, IORING_OP_ACCEPT, IORING_OP_CONNECT}) {
+        supported = supported && op < probe->ops_len &&
+                    (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    if (!supported) {
+        return false;
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return wake_fd_ >= 0;
+}
+
+}  // namespace
+
+std::unique_ptr<Poller> CreateUringPoller(unsigned entries) {
+    auto poller = std::make_unique<UringPoller>();
+    if (!poller->Init(entries)) {
+        return nullptr;
+    }
+    return poller;
+}
+
+}  // namespace eva
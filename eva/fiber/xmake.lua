@@ -1,6 +1,6 @@
 target("fiber", function()
     set_kind("static")
     set_encodings("source:utf-8")
-    add_files("src/*.cpp")
+    add_files("src/*.cpp", "src/*.S")
     add_includedirs("include", { public = true })
 end)
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <common/ring_buffer.h>
+#include <log/log.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief 异步日志输出地
+ * @details 包装若干个下游 LogAppender。生产者线程调用 Log 时只把日志事件拷贝进无锁环形队列，
+ * 由一个专用后台线程批量取出事件，再交给下游 appender 格式化并写出，
+ * 这样业务线程不再承担格式化和文件 I/O 的开销。
+ *
+ * 用法：
+ *   auto async = std::make_shared<eva::AsyncLogAppender>();
+ *   async->AddAppender(std::make_shared<eva::FileLogAppender>("app.log"));
+ *   logger->AddAppender(async);
+ */
+class AsyncLogAppender : public LogAppender, public CrashFlushable {
+public:
+    using ptr = std::shared_ptr<AsyncLogAppender>;
+
+    /**
+     * @brief 队列满时的处理策略
+     */
+    enum class OverflowPolicy {
+        BLOCK,        // 阻塞(自旋让出 CPU)直到队列有空位
+        DROP_NEWEST,  // 丢弃当前(最新)事件
+        DROP_OLDEST   // 丢弃队列中最旧的事件，为当前事件腾出位置
+    };
+
+    /**
+     * @brief 构造函数，同时启动后台线程
+     * @param[in] capacity 环形队列容量(向上取整为 2 的幂)
+     * @param[in] policy 队列满时的处理策略
+     * @param[in] batch_size 后台线程每批最多处理的事件数
+     */
+    AsyncLogAppender(size_t capacity = 8192, OverflowPolicy policy = OverflowPolicy::BLOCK,
+                     size_t batch_size = 256);
+
+    /**
+     * @brief 析构函数
+     * @details 停止后台线程，退出前会把队列中剩余的事件全部写出
+     */
+    ~AsyncLogAppender() override;
+
+public:
+    /**
+     * @brief 写入日志(仅入队，不做格式化和 I/O)
+     */
+    void Log(LogEvent const& event) override;
+
+    /**
+     * @brief 阻塞等待，直到调用前已入队的事件全部被后台线程写出
+     */
+    void Flush();
+
+    /**
+     * @brief 崩溃时等待后台线程把已入队的事件交给下游 appender，由下游在第二阶段写出
+     * @details 只读队列位置并 nanosleep；崩溃的正是后台线程时不等待
+     */
+    void OnCrashDrain(uint64_t deadline_ns) noexcept override;
+
+public:
+    void AddAppender(LogAppender::ptr appender);
+
+    void DelAppender(LogAppender::ptr appender);
+
+    void ClearAppenders();
+
+public:
+    OverflowPolicy GetOverflowPolicy() const { return policy_; }
+
+    /**
+     * @brief 因队列满而被丢弃的事件总数
+     */
+    uint64_t GetDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief BLOCK 策略下生产者因队列满而等待的次数
+     */
+    uint64_t GetBlockedCount() const { return blocked_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief 后台线程主循环
+     */
+    void Run();
+
+    /**
+     * @brief 取出一批事件并交给下游 appender，返回处理的事件数
+     */
+    size_t Drain();
+
+    /**
+     * @brief 入队成功后，如后台线程在睡眠则唤醒它
+     */
+    void Notify();
+
+    /**
+     * @brief 队列中位置小于 pos 的事件是否都已写出(或被丢弃)
+     */
+    bool IsDrainedTo(size_t pos) const;
+
+    static constexpr size_t kIdle = SIZE_MAX;  // 后台线程手上没有取出未写完的事件
+
+private:
+    RingBuffer<LogEvent> queue_;            // 事件队列(按值拷贝，入队不分配内存)
+    OverflowPolicy policy_;                 // 溢出策略
+    size_t batch_size_;                     // 每批最多处理的事件数
+    LogEvent current_;                      // 出队的事件(仅后台线程使用，缓冲区复用)
+    std::vector<LogAppender::ptr> sinks_;   // 下游 appender
+    std::mutex sinks_mtx_;                  // 保护 sinks_
+    std::mutex wait_mtx_;                   // 配合 cv_ 使用
+    std::condition_variable cv_;            // 后台线程睡眠/唤醒
+    std::atomic<bool> sleeping_{false};     // 后台线程是否在睡眠
+    std::atomic<bool> stop_{false};         // 停止标识
+    std::atomic<size_t> draining_{kIdle};   // 后台线程正在处理的批次不早于这个队列位置
+    std::atomic<uint64_t> dropped_{0};      // 丢弃计数
+    std::atomic<uint64_t> blocked_{0};      // 阻塞计数
+    std::atomic<pid_t> thread_tid_{0};      // 后台线程的线程 id
+    std::thread thread_;                    // 后台线程
+};
+
+}  // namespace eva
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <log/log.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 使用二进制(延迟格式化)方式将日志级别level的日志写入二进制日志文件
+ * @details 每个调用点首次执行时注册一次静态元数据(格式串、文件、行号、级别)，
+ * 之后每次调用只把调用点id、时间戳和参数的原始字节拷贝进线程局部缓冲区，
+ * 由后台线程写入文件，格式化推迟到离线解码(eva_logdecode)时进行。
+ * 格式串为 C printf 风格(由解码器离线渲染)。需先调用 eva::BinaryLog::Open 打开文件。
+ */
+#define EVA_LOG_BIN_LEVEL(logger, level, fmt, ...)                                          \
+    if (auto&& eva_log_logger = (logger); !eva_log_logger->IsEnabled(level)) {              \
+    } else if (static uint32_t const eva_bin_site_id =                                      \
+                   eva::BinaryLog::RegisterSite(level, fmt, __FILE__, __LINE__);            \
+               true) {                                                                      \
+        eva::BinaryLog::Write(eva_bin_site_id, *eva_log_logger __VA_OPT__(, ) __VA_ARGS__); \
+    } else                                                                                  \
+        static_cast<void>(0)
+
+#define EVA_LOG_BIN_FATAL(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::FATAL) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::FATAL, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_ALERT(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ALERT) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::ALERT, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_CRIT(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::CRIT) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::CRIT, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_ERROR(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ERROR) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::ERROR, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_WARN(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::WARN) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::WARN, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_NOTICE(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::NOTICE) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::NOTICE, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_INFO(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::INFO) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::INFO, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_BIN_DEBUG(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::DEBUG) \
+    EVA_LOG_BIN_LEVEL(logger, eva::LogLevel::Level::DEBUG, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+namespace eva {
+
+namespace detail {
+
+/**
+ * @brief 二进制日志文件中的记录类型
+ * @details 文件由文件头和一串记录组成，每条记录以 1 字节类型开头；
+ * 字典类记录(调用点/日志器/线程)在某个线程第一次用到时写入，解码时重复出现的字典记录直接覆盖
+ */
+enum class BinaryRecordType : uint8_t {
+    PAD = 0,     // 填充字节(线程缓冲区回绕时产生)，解码时跳过
+    EVENT = 1,   // 日志事件
+    SITE = 2,    // 调用点元数据
+    LOGGER = 3,  // 日志器名称
+    THREAD = 4,  // 线程名称
+};
+
+/**
+ * @brief 参数类型标签
+ */
+enum class BinaryArgType : uint8_t {
+    I64 = 1,
+    U64 = 2,
+    F64 = 3,
+    STR = 4,
+    CHAR = 5,
+    BOOL = 6,
+    PTR = 7,
+};
+
+/**
+ * @brief 单个字符串参数的最大长度，超出部分截断
+ */
+inline constexpr size_t kMaxBinaryStringArg = 4096;
+
+template <typename T>
+inline constexpr bool kIsBinaryString =
+    std::is_same_v<T, char const*> || std::is_same_v<T, char*> ||
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+template <typename T>
+std::string_view BinaryStringArg(T const& v) {
+    if constexpr (std::is_pointer_v<T>) {
+        return v ? std::string_view{v} : std::string_view{"(null)"};
+    } else {
+        return std::string_view{v};
+    }
+}
+
+/**
+ * @brief 参数编码后的字节数(含类型标签)
+ */
+template <typename Arg>
+size_t BinaryArgSize(Arg const& v) {
+    using T = std::decay_t<Arg const&>;
+    if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+        return 2;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return 9;
+    } else if constexpr (kIsBinaryString<T>) {
+        return 5 + std::min(BinaryStringArg<T>(v).size(), kMaxBinaryStringArg);
+    } else if constexpr (std::is_pointer_v<T>) {
+        return 9;
+    } else {
+        static_assert(!sizeof(T), "unsupported argument type for binary log");
+    }
+}
+
+/**
+ * @brief 编码一个参数，返回写入后的位置
+ */
+template <typename Arg>
+char* EncodeBinaryArg(char* p, Arg const& v) {
+    using T = std::decay_t<Arg const&>;
+    auto put = [&p](auto value) {
+        std::memcpy(p, &value, sizeof(value));
+        p += sizeof(value);
+    };
+    if constexpr (std::is_same_v<T, bool>) {
+        put(BinaryArgType::BOOL);
+        put(static_cast<uint8_t>(v));
+    } else if constexpr (std::is_same_v<T, char>) {
+        put(BinaryArgType::CHAR);
+        put(v);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        put(BinaryArgType::F64);
+        put(static_cast<double>(v));
+    } else if constexpr (std::is_signed_v<T>) {
+        put(BinaryArgType::I64);
+        put(static_cast<int64_t>(v));
+    } else if constexpr (std::is_unsigned_v<T>) {
+        put(BinaryArgType::U64);
+        put(static_cast<uint64_t>(v));
+    } else if constexpr (kIsBinaryString<T>) {
+        std::string_view str = BinaryStringArg<T>(v);
+        uint32_t len = std::min(str.size(), kMaxBinaryStringArg);
+        put(BinaryArgType::STR);
+        put(len);
+        std::memcpy(p, str.data(), len);
+        p += len;
+    } else {
+        put(BinaryArgType::PTR);
+        put(reinterpret_cast<uint64_t>(v));
+    }
+    return p;
+}
+
+/**
+ * @brief 线程局部的二进制日志缓冲区(单生产者单消费者字节环)
+ * @details 所属线程写入并以 release 语义发布写位置，后台写线程读取并推进读位置；
+ * 记录总是连续存放，尾部放不下时用 PAD 字节填满再回绕到开头
+ */
+class BinaryLogBuffer {
+public:
+    explicit BinaryLogBuffer(size_t capacity);
+    ~BinaryLogBuffer();
+
+    BinaryLogBuffer(BinaryLogBuffer const&) = delete;
+    BinaryLogBuffer& operator=(BinaryLogBuffer const&) = delete;
+
+public:
+    /**
+     * @brief 写入事件头(必要时先写入字典记录)，返回参数区的写入位置；
+     * 记录过大或日志已关闭时丢弃并计数，返回 nullptr
+     */
+    char* BeginEvent(uint32_t site_id, Logger const& logger, size_t payload);
+
+    /**
+     * @brief 发布已写入的记录
+     */
+    void Commit() { head_pub_.store(head_, std::memory_order_release); }
+
+    /**
+     * @brief 把已发布的数据写入 fd(仅后台写线程调用)，返回写出的字节数
+     */
+    size_t DrainTo(int fd);
+
+    bool Empty() const {
+        return tail_.load(std::memory_order_acquire) == head_pub_.load(std::memory_order_acquire);
+    }
+
+    void Retire() { retired_.store(true, std::memory_order_release); }
+
+    bool IsRetired() const { return retired_.load(std::memory_order_acquire); }
+
+private:
+    /**
+     * @brief 预留 len 字节，缓冲区满时等待后台线程写出；等待中日志被关闭时返回 nullptr
+     */
+    char* Reserve(size_t len);
+
+private:
+    char* data_;                                     // 环形缓冲区
+    size_t capacity_;                                // 容量
+    uint64_t head_{0};                               // 写位置(生产者私有)
+    std::vector<uint8_t> seen_sites_;                // 本线程已写过字典的调用点
+    std::vector<std::string const*> seen_loggers_;   // 本线程已写过字典的日志器
+    alignas(64) std::atomic<uint64_t> head_pub_{0};  // 已发布的写位置
+    alignas(64) std::atomic<uint64_t> tail_{0};      // 读位置
+    std::atomic<bool> retired_{false};               // 所属线程已退出
+};
+
+}  // namespace detail
+
+/**
+ * @brief 二进制日志
+ * @details 进程内唯一的二进制日志文件，对外只提供静态接口。
+ */
+class BinaryLog {
+public:
+    /**
+     * @brief 打开二进制日志文件(追加写)并启动后台写线程
+     * @param[in] filename 文件路径
+     * @param[in] buffer_size 每个线程的缓冲区大小
+     */
+    static bool Open(std::string const& filename, size_t buffer_size = 1 << 20);
+
+    /**
+     * @brief 写完所有线程缓冲区中的数据后关闭文件
+     */
+    static void Close();
+
+    /**
+     * @brief 阻塞直到调用前已写入的数据全部落到文件
+     */
+    static void Flush();
+
+    /**
+     * @brief 注册调用点，返回调用点id
+     */
+    static uint32_t RegisterSite(LogLevel::Level level, char const* fmt, char const* file,
+                                 int32_t line);
+
+    /**
+     * @brief 因记录过大被丢弃的事件数
+     */
+    static uint64_t GetDroppedCount();
+
+    /**
+     * @brief 写入一条事件：只拷贝调用点id、时间戳和参数原始字节
+     */
+    template <typename... Args>
+    static void Write(uint32_t site_id, Logger const& logger, Args const&... args) {
+        detail::BinaryLogBuffer* buffer = LocalBuffer();
+        if (!buffer) {
+            return;
+        }
+        size_t payload = (size_t{0} + ... + detail::BinaryArgSize(args));
+        char* p = buffer->BeginEvent(site_id, logger, payload);
+        if (!p) {
+            return;
+        }
+        ((p = detail::EncodeBinaryArg(p, args)), ...);
+        buffer->Commit();
+    }
+
+private:
+    /**
+     * @brief 当前线程的缓冲区，二进制日志未打开时返回 nullptr
+     */
+    static detail::BinaryLogBuffer* LocalBuffer();
+};
+
+/**
+ * @brief 二进制日志解码器
+ * @details 读取二进制日志文件，把每条事件还原为 LogEvent(消息按 printf 格式渲染)，
+ * 再交给 LogFormatter 即可得到与文本日志相同的输出
+ */
+class BinaryLogReader {
+public:
+    /**
+     * @brief 读入整个文件，校验文件头
+     */
+    bool Open(std::string const& filename);
+
+    /**
+     * @brief 解码下一条事件，文件结束或数据损坏时返回 false
+     * @details event 中的日志器名称/文件名指向解码器内部的字典，解码器析构前有效
+     */
+    bool Next(LogEvent& event);
+
+    bool IsCorrupted() const { return corrupted_; }
+
+private:
+    struct Site {
+        LogLevel::Level level;
+        int32_t line;
+        std::string fmt;
+        std::string file;
+        LogSite site{kUnknownLogSite};  // 事件指向的调用点描述符，指向本结构中的 file
+    };
+
+    bool ReadDictionary(detail::BinaryRecordType type);
+
+    bool ReadEvent(LogEvent& event);
+
+    /**
+     * @brief 按 printf 格式串渲染参数
+     */
+    bool RenderMessage(std::string const& fmt, char const* args, char const* end,
+                       LogEvent::MessageStream& out);
+
+    template <typename T>
+    bool Read(T& value) {
+        if (pos_ + sizeof(T) > data_.size()) {
+            return false;
+        }
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& str);
+
+private:
+    std::string data_;                                          // 文件内容
+    size_t pos_{0};                                             // 解码位置
+    bool corrupted_{false};                                     // 数据是否损坏
+    std::unordered_map<uint32_t, Site> sites_;                  // 调用点字典
+    std::unordered_map<uint64_t, std::string> loggers_;         // 日志器字典
+    std::unordered_map<uint32_t, std::string> threads_;         // 线程字典
+};
+
+}  // namespace eva
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace eva {
+
+/**
+ * @brief 进程崩溃时需要紧急写出数据的对象(带缓冲的 appender、二进制日志等)
+ * @details 两个回调都在信号处理函数中调用，只能使用异步信号安全的操作：
+ * 原子变量、write/fsync/ftruncate/nanosleep 等系统调用；不能分配内存，不能阻塞加锁。
+ * 处理函数先依次调用所有对象的 OnCrashDrain，再依次调用 OnCrashFlush
+ */
+class CrashFlushable {
+public:
+    virtual ~CrashFlushable() = default;
+
+    /**
+     * @brief 第一阶段：等待后台线程把已入队的数据交给下游(如异步 appender)
+     * @param[in] deadline_ns 截止时间(CLOCK_MONOTONIC 纳秒)，到期后不再等待
+     */
+    virtual void OnCrashDrain(uint64_t deadline_ns) noexcept {}
+
+    /**
+     * @brief 第二阶段：写出缓冲区中的数据，追加崩溃报告并落盘
+     * @param[in] report 崩溃报告(FATAL 行和符号化的调用栈)，以换行结尾
+     */
+    virtual void OnCrashFlush(char const* report, size_t len) noexcept {}
+};
+
+/**
+ * @brief 注册/注销崩溃时需要写出数据的对象
+ * @details 注册表是固定大小的原子指针数组，信号处理函数中无锁遍历；
+ * 对象析构前必须注销。注册表已满时 Register 返回 false
+ */
+bool RegisterCrashFlushable(CrashFlushable* target);
+
+void UnregisterCrashFlushable(CrashFlushable* target);
+
+/**
+ * @brief 在崩溃回调中尝试获得互斥锁，最多重试 timeout_ms 毫秒
+ * @details pthread_mutex_trylock 不在 POSIX 的异步信号安全列表中，但它只做一次原子比较交换，
+ * 不会阻塞。持锁的可能正是崩溃的线程，超时返回 false 后调用方应当不加锁尽力写出
+ */
+bool CrashTryLock(std::mutex& mtx, uint32_t timeout_ms);
+
+/**
+ * @brief 崩溃处理配置
+ */
+struct CrashHandlerOptions {
+    bool handle_signals{true};        // 处理 SIGSEGV、SIGABRT、SIGBUS、SIGFPE
+    bool handle_terminate{true};      // 设置 std::terminate 处理函数
+    bool write_stderr{true};          // 崩溃报告同时写到标准错误
+    uint32_t drain_timeout_ms{1000};  // 等待异步 appender 交出数据的最长时间
+};
+
+/**
+ * @brief 安装崩溃处理函数
+ * @details 进程收到致命信号或调用 std::terminate 时：
+ *   1. 生成一条 FATAL 报告：UTC 时间、线程 id、信号名和出错地址(或未捕获异常的 what())，
+ *      以及 backtrace_symbols_fd 符号化的调用栈；出错地址在协程栈的保护页上时注明协程 id
+ *   2. 等待异步 appender 的后台线程把已入队事件交给下游(有超时)
+ *   3. 所有已注册对象写出缓冲区、追加报告并 fsync
+ *   4. 恢复默认处理方式后重新触发信号，保留原有的退出码和 core dump
+ * 处理函数只使用异步信号安全的操作；backtrace 在安装时预先调用一次，避免在信号中加载 libgcc。
+ * 处理函数运行在备用信号栈上(本函数为调用线程设置，使用协程的线程由协程库设置)，
+ * 栈溢出引起的 SIGSEGV 也能处理。
+ * 正常写日志的路径不受影响：注册只发生在 appender 构造时，安装后没有任何额外检查。
+ * 多次调用只有第一次生效
+ */
+void InstallCrashHandler(CrashHandlerOptions const& options = {});
+
+/**
+ * @brief 获取当前线程的调用栈，每帧一行(最后一行不带换行符)，符号名已还原(demangle)
+ * @details 会分配内存，不能在信号处理函数中使用；FATAL 级别的日志事件用它附加调用栈
+ * @param[in] skip 跳过最内层的帧数(不含本函数)
+ */
+std::string FormatBacktrace(int skip = 0);
+
+}  // namespace eva
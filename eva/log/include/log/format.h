@@ -0,0 +1,362 @@
+#pragma once
+
+#include <log/log_stream.h>
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace eva {
+
+/**
+ * @brief 单个占位符的格式说明，写法为 {:[.精度][类型]}
+ * @details 类型：
+ *   整数/字符/布尔：d 十进制、x/X 十六进制、o 八进制、b 二进制、c 字符(整数)、s 文本(布尔)
+ *   浮点：f/F 定点、e/E 科学计数、g/G 通用，不写类型时按最短表示输出
+ *   字符串：s，精度表示最多输出多少个字符
+ *   指针：p
+ */
+struct FormatSpec {
+    int precision{-1};  // 精度，-1 表示未指定
+    char type{0};       // 类型，0 表示未指定
+};
+
+/**
+ * @brief 用户类型格式化扩展点
+ * @details 为自定义类型特化 Formatter 并提供静态的 Format 函数即可用于 {} 占位符：
+ *
+ *   template <>
+ *   struct eva::Formatter<Point> {
+ *       template <typename Stream>
+ *       static void Format(Stream& out, Point const& p, eva::FormatSpec const& spec) {
+ *           out << '(' << p.x << ", " << p.y << ')';
+ *       }
+ *   };
+ *
+ * 没有特化 Formatter 的类型退回到 LogStream 的 operator<<(包括 std::ostream 兜底)
+ */
+template <typename T>
+struct Formatter;
+
+namespace detail {
+
+/**
+ * @brief 参数类别，用于编译期检查占位符的类型说明
+ */
+enum class FormatArgKind { INT, CHAR, BOOL, FLOAT, STRING, POINTER, CUSTOM };
+
+template <typename Arg>
+consteval FormatArgKind GetFormatArgKind() {
+    using T = std::decay_t<Arg>;
+    if constexpr (std::is_same_v<T, bool>) {
+        return FormatArgKind::BOOL;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return FormatArgKind::CHAR;
+    } else if constexpr (std::is_integral_v<T>) {
+        return FormatArgKind::INT;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return FormatArgKind::FLOAT;
+    } else if constexpr (std::is_same_v<T, char*> || std::is_same_v<T, char const*> ||
+                         std::is_convertible_v<T const&, std::string_view>) {
+        return FormatArgKind::STRING;
+    } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+        return FormatArgKind::POINTER;
+    } else {
+        return FormatArgKind::CUSTOM;
+    }
+}
+
+constexpr bool IsFormatDigit(char c) { return c >= '0' && c <= '9'; }
+
+/**
+ * @brief 解析占位符，pos 指向 '{' 之后，返回 '}' 之后的位置
+ * @details 格式串已在编译期校验过，运行时调用不会出错；编译期调用时格式非法直接编译报错
+ */
+constexpr size_t ParseFormatSpec(std::string_view fmt, size_t pos, FormatSpec& spec) {
+    spec = FormatSpec{};
+    if (pos < fmt.size() && fmt[pos] == ':') {
+        ++pos;
+        if (pos < fmt.size() && fmt[pos] == '.') {
+            ++pos;
+            if (pos >= fmt.size() || !IsFormatDigit(fmt[pos])) {
+                throw "format string: precision expects digits";
+            }
+            spec.precision = 0;
+            while (pos < fmt.size() && IsFormatDigit(fmt[pos])) {
+                spec.precision = spec.precision * 10 + (fmt[pos++] - '0');
+                if (spec.precision > 100) {
+                    throw "format string: precision too large";
+                }
+            }
+        }
+        if (pos < fmt.size() && fmt[pos] != '}') {
+            spec.type = fmt[pos++];
+        }
+    }
+    if (pos >= fmt.size() || fmt[pos] != '}') {
+        throw "format string: '{' not closed or invalid format spec";
+    }
+    return pos + 1;
+}
+
+constexpr bool IsFormatTypeOneOf(char type, std::string_view allowed) {
+    return type == 0 || allowed.find(type) != std::string_view::npos;
+}
+
+/**
+ * @brief 检查格式说明是否适用于该类别的参数
+ */
+constexpr void CheckFormatSpec(FormatArgKind kind, FormatSpec const& spec) {
+    switch (kind) {
+        case FormatArgKind::INT:
+        case FormatArgKind::CHAR:
+            if (!IsFormatTypeOneOf(spec.type, "dxXobc") || spec.precision >= 0) {
+                throw "format string: invalid spec for an integer or char argument";
+            }
+            break;
+        case FormatArgKind::BOOL:
+            if (!IsFormatTypeOneOf(spec.type, "sdxXob") || spec.precision >= 0) {
+                throw "format string: invalid spec for a bool argument";
+            }
+            break;
+        case FormatArgKind::FLOAT:
+            if (!IsFormatTypeOneOf(spec.type, "fFeEgG")) {
+                throw "format string: invalid spec for a floating-point argument";
+            }
+            break;
+        case FormatArgKind::STRING:
+            if (!IsFormatTypeOneOf(spec.type, "s")) {
+                throw "format string: invalid spec for a string argument";
+            }
+            break;
+        case FormatArgKind::POINTER:
+            if (!IsFormatTypeOneOf(spec.type, "p") || spec.precision >= 0) {
+                throw "format string: invalid spec for a pointer argument";
+            }
+            break;
+        case FormatArgKind::CUSTOM:
+            break;
+    }
+}
+
+/**
+ * @brief 校验格式串：占位符个数与参数个数一致、每个占位符的说明适用于对应参数、花括号配对
+ */
+template <typename... Args>
+consteval void CheckFormatString(std::string_view fmt) {
+    constexpr FormatArgKind kinds[] = {GetFormatArgKind<Args>()..., FormatArgKind::CUSTOM};
+    size_t count = 0;
+    for (size_t pos = 0; pos < fmt.size(); ++pos) {
+        if (fmt[pos] == '}') {
+            if (pos + 1 >= fmt.size() || fmt[pos + 1] != '}') {
+                throw "format string: unmatched '}'";
+            }
+            ++pos;
+        } else if (fmt[pos] == '{') {
+            if (pos + 1 < fmt.size() && fmt[pos + 1] == '{') {
+                ++pos;
+                continue;
+            }
+            FormatSpec spec;
+            pos = ParseFormatSpec(fmt, pos + 1, spec) - 1;
+            if (count >= sizeof...(Args)) {
+                throw "format string: more placeholders than arguments";
+            }
+            CheckFormatSpec(kinds[count++], spec);
+        }
+    }
+    if (count != sizeof...(Args)) {
+        throw "format string: fewer placeholders than arguments";
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief 编译期校验过的格式串
+ * @details 构造函数是 consteval 的，格式串必须是常量表达式，格式错误或与参数不匹配时直接编译报错
+ */
+template <typename... Args>
+class BasicFormatString {
+public:
+    template <typename S>
+        requires std::is_convertible_v<S const&, std::string_view>
+    consteval BasicFormatString(S const& str) : str_(str) {
+        detail::CheckFormatString<Args...>(str_);
+    }
+
+    constexpr std::string_view Get() const { return str_; }
+
+private:
+    std::string_view str_;
+};
+
+/**
+ * @brief 参数类型不参与推导，由后面的实参决定
+ */
+template <typename... Args>
+using FormatString = BasicFormatString<std::type_identity_t<Args>...>;
+
+namespace detail {
+
+template <typename Stream>
+void FormatInteger(Stream& out, auto value, FormatSpec const& spec) {
+    int base = 10;
+    switch (spec.type) {
+        case 'x':
+        case 'X':
+            base = 16;
+            break;
+        case 'o':
+            base = 8;
+            break;
+        case 'b':
+            base = 2;
+            break;
+        case 'c':
+            out << static_cast<char>(value);
+            return;
+        default:
+            break;
+    }
+    char* p = out.Reserve(72);
+    char* end = std::to_chars(p, p + 72, value, base).ptr;
+    if (spec.type == 'X') {
+        for (char* c = p; c != end; ++c) {
+            if (*c >= 'a' && *c <= 'f') {
+                *c = static_cast<char>(*c - 'a' + 'A');
+            }
+        }
+    }
+    out.Commit(end - p);
+}
+
+template <typename Stream>
+void FormatFloat(Stream& out, double value, FormatSpec const& spec) {
+    std::chars_format format = std::chars_format::general;
+    switch (spec.type) {
+        case 'f':
+        case 'F':
+            format = std::chars_format::fixed;
+            break;
+        case 'e':
+        case 'E':
+            format = std::chars_format::scientific;
+            break;
+        default:
+            break;
+    }
+    bool shortest = spec.type == 0 && spec.precision < 0;
+    int precision = spec.precision < 0 ? 6 : spec.precision;
+    // 定点格式下很大的数可能有 300 多位
+    for (size_t capacity : {size_t{64}, size_t{400} + precision}) {
+        char* p = out.Reserve(capacity);
+        std::to_chars_result result = shortest ? std::to_chars(p, p + capacity, value)
+                                               : std::to_chars(p, p + capacity, value, format,
+                                                               precision);
+        if (result.ec == std::errc{}) {
+            if (spec.type == 'F' || spec.type == 'E' || spec.type == 'G') {
+                for (char* c = p; c != result.ptr; ++c) {
+                    if (*c >= 'a' && *c <= 'z') {
+                        *c = static_cast<char>(*c - 'a' + 'A');
+                    }
+                }
+            }
+            out.Commit(result.ptr - p);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 格式化单个参数
+ */
+template <typename Stream, typename T>
+void FormatValue(Stream& out, T const& value, FormatSpec const& spec) {
+    constexpr FormatArgKind kind = GetFormatArgKind<T>();
+    if constexpr (requires { Formatter<T>::Format(out, value, spec); }) {
+        Formatter<T>::Format(out, value, spec);
+    } else if constexpr (kind == FormatArgKind::BOOL) {
+        if (spec.type == 0 || spec.type == 's') {
+            out << (value ? std::string_view{"true"} : std::string_view{"false"});
+        } else {
+            FormatInteger(out, static_cast<int>(value), spec);
+        }
+    } else if constexpr (kind == FormatArgKind::CHAR) {
+        if (spec.type == 0 || spec.type == 'c') {
+            out << value;
+        } else {
+            FormatInteger(out, static_cast<int>(static_cast<unsigned char>(value)), spec);
+        }
+    } else if constexpr (kind == FormatArgKind::INT) {
+        FormatInteger(out, value, spec);
+    } else if constexpr (kind == FormatArgKind::FLOAT) {
+        FormatFloat(out, static_cast<double>(value), spec);
+    } else if constexpr (kind == FormatArgKind::STRING) {
+        std::string_view str;
+        if constexpr (std::is_pointer_v<T>) {
+            str = value ? std::string_view{value} : std::string_view{"(null)"};
+        } else {
+            str = std::string_view{value};
+        }
+        if (spec.precision >= 0 && str.size() > static_cast<size_t>(spec.precision)) {
+            str = str.substr(0, spec.precision);
+        }
+        out << str;
+    } else if constexpr (kind == FormatArgKind::POINTER) {
+        out << static_cast<void const*>(value);
+    } else {
+        out << value;
+    }
+}
+
+/**
+ * @brief 输出 [pos, 下一个占位符) 之间的字面量(处理 {{ 和 }} 转义)，返回占位符 '{' 之后的位置；
+ * 没有占位符时输出到末尾并返回 npos
+ */
+template <typename Stream>
+size_t AppendFormatLiteral(Stream& out, std::string_view fmt, size_t pos) {
+    while (pos < fmt.size()) {
+        // 手写扫描，string_view::find_first_of 对每个字符都要查一遍字符集
+        size_t brace = pos;
+        while (brace < fmt.size() && fmt[brace] != '{' && fmt[brace] != '}') {
+            ++brace;
+        }
+        out.Append(fmt.data() + pos, brace - pos);
+        if (brace == fmt.size()) {
+            return std::string_view::npos;
+        }
+        if (fmt[brace] == '{' && fmt[brace + 1] != '{') {
+            return brace + 1;
+        }
+        out.Append(fmt[brace]);  // {{ 或 }}
+        pos = brace + 2;
+    }
+    return std::string_view::npos;
+}
+
+template <typename Stream, typename T>
+size_t FormatNext(Stream& out, std::string_view fmt, size_t pos, T const& value) {
+    FormatSpec spec;
+    pos = ParseFormatSpec(fmt, AppendFormatLiteral(out, fmt, pos), spec);
+    FormatValue(out, value, spec);
+    return pos;
+}
+
+}  // namespace detail
+
+/**
+ * @brief 按 {} 占位符把参数直接格式化进 out(LogStream 等)，不经过临时 std::string
+ */
+template <typename Stream, typename... Args>
+void FormatTo(Stream& out, FormatString<Args...> fmt, Args const&... args) {
+    std::string_view str = fmt.Get();
+    size_t pos = 0;
+    ((pos = detail::FormatNext(out, str, pos, args)), ...);
+    detail::AppendFormatLiteral(out, str, pos);
+}
+
+}  // namespace eva
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <log/log.h>
+
+#include <string_view>
+
+namespace eva {
+
+/**
+ * @brief 结构化 JSON 日志格式器，每个事件输出一行 JSON 对象
+ * @details 字段依次为：
+ *   time(UTC，ISO 8601，微秒)、level、logger、file、line、thread_id、thread_name、
+ *   fiber_id、elapse_ms、message，之后是调用点附加的结构化字段(LogEvent::With)
+ * 例如：
+ *   {"time":"2024-05-01T08:00:00.123456Z","level":"INFO","logger":"root","file":"main.cpp",
+ *    "line":12,"thread_id":4242,"thread_name":"main","fiber_id":0,"elapse_ms":3,
+ *    "message":"login ok","user":"eva","cost_ms":1.5}
+ * 有限的数值和布尔字段原样输出，其余字段值作为 JSON 字符串输出。
+ * 字符串转义先用 SIMD(AVX2/SSE2，运行时按 CPU 选择，其他平台用查表)成块扫描需要转义的字符，
+ * 不需要转义的片段整段拷贝，长消息不会逐字节处理。
+ *
+ * 用法：
+ *   appender->SetFormatter(std::make_shared<eva::JsonLogFormatter>());
+ *   EVA_LOG_KV_INFO(logger, "user", name, "cost_ms", cost) << "login ok";
+ */
+class JsonLogFormatter : public LogFormatter {
+public:
+    using ptr = std::shared_ptr<JsonLogFormatter>;
+
+    JsonLogFormatter() : LogFormatter("json", NoInit{}) {}
+
+public:
+    using LogFormatter::Format;
+
+    void Format(LogStream& stream, LogEvent const& event) override;
+};
+
+/**
+ * @brief 按 JSON 字符串的规则转义 str 并追加到 stream(不含两侧引号)
+ * @details 转义 '"'、'\\' 和 0x00-0x1F 的控制字符，其余字节(包括 UTF-8 多字节序列)原样输出
+ */
+void AppendJsonEscaped(LogStream& stream, std::string_view str);
+
+}  // namespace eva
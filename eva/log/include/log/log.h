@@ -1,21 +1,31 @@
 #pragma once
 
 #include <common/singleton.h>
+#include <log/crash_handler.h>
+#include <log/format.h>
+#include <log/log_stream.h>
+#include <sys/uio.h>
 #include <util/util.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <functional>
 #include <iostream>
-#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <sstream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -25,6 +35,16 @@
 // 为什么新版在 LogAppender.Log 中删除了 LogLevel::Level level
 // 貌似很多函数都删除了这个 level 形参
 
+/**
+ * @brief 编译期最低日志级别
+ * @details 低于该级别的 EVA_LOG_<级别> / EVA_LOG_FMT_<级别> 语句在编译期被整体丢弃，
+ * 不生成任何代码，参数表达式也不会被求值。取值与 LogLevel::Level 相同(如 200 表示 INFO)，
+ * 可通过 xmake f --log_min_level=info 或 -DEVA_LOG_MIN_LEVEL=200 设置，默认保留所有级别
+ */
+#ifndef EVA_LOG_MIN_LEVEL
+#define EVA_LOG_MIN_LEVEL 0
+#endif
+
 /**
  * @brief 获取root日志器
  */
@@ -32,78 +52,212 @@
 
 /**
  * @brief 获取指定名称的日志器
+ * @details 每次调用都做一次无锁哈希查找；频繁使用时推荐 EVA_LOGGER
  */
 #define EVA_LOG_NAME(name) eva::LoggerMgr::GetInstance()->GetLogger(name)
 
+/**
+ * @brief 获取指定名称的日志器，结果缓存在调用点的函数内静态变量中
+ * @details 每个调用点只查找一次，之后只是读一个指针。name 必须是字符串字面量等常量表达式，
+ * 日志器在进程生命周期内不会被销毁，缓存的指针始终有效
+ *
+ * 用法：
+ *   EVA_LOG_INFO(EVA_LOGGER("db")) << "connected";
+ */
+#define EVA_LOGGER(name)                                           \
+    ([]() -> eva::Logger* {                                        \
+        static eva::Logger* const eva_cached_logger{               \
+            eva::LoggerMgr::GetInstance()->GetLogger(name).get()}; \
+        return eva_cached_logger;                                  \
+    }())
+
+/**
+ * @brief 在调用点定义名为 name 的 static constexpr 调用点描述符(eva::LogSite)
+ * @details 文件名、不含目录的短文件名(编译期计算)、函数名和行号只在只读数据段中存一份，
+ * 日志事件只保存指向它的指针
+ */
+#define EVA_LOG_DEFINE_SITE(name)       \
+    static constexpr eva::LogSite name{ \
+        __FILE__, eva::LogSite::Basename(__FILE__), __func__, __LINE__}
+
+/**
+ * @brief 级别低于编译期最低级别时丢弃后面的整条语句
+ */
+#define EVA_LOG_IF_COMPILED_IN(level)                    \
+    if constexpr (!eva::LogLevel::IsCompiledIn(level)) { \
+    } else
+
 /**
  * @brief 使用流式方式将日志级别level的日志写入到logger
  * @details 构造一个LogEventWrap对象，包裹包含日志器和日志事件，在对象析构时调用日志器写日志事件
- * TODO: 协程id未实现，暂时写0
+ * 日志事件取自线程局部对象池，消息写入事件内联缓冲区，稳态下每条日志没有堆分配
+ * logger 表达式只求值一次(以引用绑定，不拷贝 shared_ptr)；级别未开启时只有一次原子读和一次比较，
+ * 后面的 << 参数不会被求值。if-else 形式保证宏用在不带花括号的 if 语句中时不会吞掉外层的 else
+ * 日志器设置了限流策略(Logger::SetLimitPolicy)时按调用点限流，见 EVA_LOG_LIMIT_LEVEL
  */
-#define EVA_LOG_LEVEL(logger, level)                                                            \
-    if (level >= logger->GetLevel())                                                            \
-    eva::LogEventWrap{                                                                          \
-        logger, std::make_shared<eva::LogEvent>(logger->GetName(), level, __FILE__, __LINE__,   \
-                                                eva::GetElapsedMS() - logger->GetCreateTime(),  \
-                                                eva::GetThreadId(), eva::GetFiberId(), time(0), \
-                                                eva::GetThreadName())}                          \
-        .GetLogEvent()                                                                          \
-        ->GetSs()
+#define EVA_LOG_LEVEL(logger, level) \
+    EVA_LOG_LIMIT_LEVEL(logger, level, eva_log_logger->GetLimitPolicy())
 
-#define EVA_LOG_FATAL(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::FATAL)
+#define EVA_LOG_FATAL(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::FATAL) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::FATAL)
 
-#define EVA_LOG_ALERT(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::ALERT)
+#define EVA_LOG_ALERT(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ALERT) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::ALERT)
 
-#define EVA_LOG_CRIT(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::CRIT)
+#define EVA_LOG_CRIT(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::CRIT) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::CRIT)
 
-#define EVA_LOG_ERROR(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::ERROR)
+#define EVA_LOG_ERROR(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ERROR) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::ERROR)
 
-#define EVA_LOG_WARN(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::WARN)
+#define EVA_LOG_WARN(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::WARN) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::WARN)
 
-#define EVA_LOG_NOTICE(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::NOTICE)
+#define EVA_LOG_NOTICE(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::NOTICE) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::NOTICE)
 
-#define EVA_LOG_INFO(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::INFO)
+#define EVA_LOG_INFO(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::INFO) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::INFO)
 
-#define EVA_LOG_DEBUG(logger) EVA_LOG_LEVEL(logger, eva::LogLevel::Level::DEBUG)
+#define EVA_LOG_DEBUG(logger)                           \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::DEBUG) \
+    EVA_LOG_LEVEL(logger, eva::LogLevel::Level::DEBUG)
 
 /**
- * @brief 使用C printf方式将日志级别level的日志写入到logger
- * @details 构造一个LogEventWrap对象，包裹包含日志器和日志事件，在对象析构时调用日志器写日志事件
- * @todo 协程id未实现，暂时写0
+ * @brief 按限流策略 policy 将日志级别level的日志写入到logger
+ * @details 每个调用点有一个函数内静态的 LogLimiter(常量初始化，没有构造开销和线程安全守卫)，
+ * 在构造 LogEvent 之前判断是否放行，被抑制的语句不取事件、不求值 << 参数；
+ * 被抑制之后再次放行时，先以同一级别输出一行汇总，说明期间抑制了多少条
  */
-#define EVA_LOG_FMT_LEVEL(logger, level, fmt, ...)                                                 \
-    if (level >= logger->GetLevel()) {                                                             \
-        eva::LogEventWrap{                                                                         \
-            logger, std::make_shared<eva::LogEvent>(logger->GetName(), level, __FILE__, __LINE__,  \
-                                                    eva::GetElapsedMS() - logger->GetCreateTime(), \
-                                                    eva::GetThreadId(), eva::GetFiberId(),         \
-                                                    time(0), eva::GetThreadName())}                \
-            .GetLogEvent()                                                                         \
-            ->Printf(fmt __VA_OPT__(, ) __VA_ARGS__);                                              \
-    }
+#define EVA_LOG_LIMIT_LEVEL(logger, level, policy)                                     \
+    if (auto&& eva_log_logger = (logger); !eva_log_logger->IsEnabled(level)) {         \
+    } else if (EVA_LOG_DEFINE_SITE(eva_log_site); false) {                             \
+    } else if (static eva::LogLimiter eva_log_limiter;                                 \
+               !eva_log_limiter.Allow(policy, *eva_log_logger, level, eva_log_site)) { \
+    } else                                                                             \
+        eva::LogEventWrap{*eva_log_logger, level, eva_log_site}.GetStream()
+
+/**
+ * @brief 调用点限流的便捷写法，level 为级别名，例如：
+ *   EVA_LOG_EVERY_SEC(logger, ERROR, 10) << "connect failed";  // 每秒最多 10 条
+ *   EVA_LOG_EVERY_N(logger, WARN, 100) << "queue full";         // 每 100 次输出 1 次
+ *   EVA_LOG_BACKOFF(logger, ERROR, 5) << "retry";               // 前 5 次，之后指数退避
+ */
+#define EVA_LOG_EVERY_SEC(logger, level, n)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::level) \
+    EVA_LOG_LIMIT_LEVEL(logger, eva::LogLevel::Level::level, eva::LogLimitPolicy::EverySecond(n))
+
+#define EVA_LOG_EVERY_N(logger, level, n)               \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::level) \
+    EVA_LOG_LIMIT_LEVEL(logger, eva::LogLevel::Level::level, eva::LogLimitPolicy::EveryN(n))
+
+#define EVA_LOG_BACKOFF(logger, level, n)               \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::level) \
+    EVA_LOG_LIMIT_LEVEL(logger, eva::LogLevel::Level::level, eva::LogLimitPolicy::Backoff(n))
+
+/**
+ * @brief 附带结构化字段将日志级别level的日志写入到logger，字段参数为 key1, value1, key2, value2...
+ * @details 字段由 JsonLogFormatter 输出为独立的 JSON 字段，文本模板用 %k 输出；
+ * 与 EVA_LOG_LEVEL 一样遵循日志器的限流策略，例如
+ *   EVA_LOG_KV_INFO(logger, "user", name, "cost_ms", cost) << "login ok";
+ */
+#define EVA_LOG_KV_LEVEL(logger, level, ...)                                             \
+    if (auto&& eva_log_logger = (logger); !eva_log_logger->IsEnabled(level)) {           \
+    } else if (EVA_LOG_DEFINE_SITE(eva_log_site); false) {                               \
+    } else if (static eva::LogLimiter eva_log_limiter;                                   \
+               !eva_log_limiter.Allow(eva_log_logger->GetLimitPolicy(), *eva_log_logger, \
+                                      level, eva_log_site)) {                            \
+    } else                                                                               \
+        eva::LogEventWrap{*eva_log_logger, level, eva_log_site}                          \
+            .GetLogEvent()                                                               \
+            .WithFields(__VA_ARGS__)                                                     \
+            .GetStream()
+
+#define EVA_LOG_KV_FATAL(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::FATAL) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::FATAL, __VA_ARGS__)
+
+#define EVA_LOG_KV_ALERT(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ALERT) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::ALERT, __VA_ARGS__)
+
+#define EVA_LOG_KV_CRIT(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::CRIT) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::CRIT, __VA_ARGS__)
+
+#define EVA_LOG_KV_ERROR(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ERROR) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::ERROR, __VA_ARGS__)
+
+#define EVA_LOG_KV_WARN(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::WARN) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::WARN, __VA_ARGS__)
+
+#define EVA_LOG_KV_NOTICE(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::NOTICE) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::NOTICE, __VA_ARGS__)
+
+#define EVA_LOG_KV_INFO(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::INFO) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::INFO, __VA_ARGS__)
+
+#define EVA_LOG_KV_DEBUG(logger, ...)                   \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::DEBUG) \
+    EVA_LOG_KV_LEVEL(logger, eva::LogLevel::Level::DEBUG, __VA_ARGS__)
 
-#define EVA_LOG_FMT_FATAL(logger, fmt, ...) \
+/**
+ * @brief 使用 {} 占位符格式串将日志级别level的日志写入到logger
+ * @details 构造一个LogEventWrap对象，包裹包含日志器和日志事件，在对象析构时调用日志器写日志事件
+ * 格式串在编译期校验(占位符个数、类型说明与参数是否匹配)，参数直接格式化进事件的消息缓冲区，
+ * 例如 EVA_LOG_FMT_INFO(logger, "user {} cost {:.2f}ms", name, cost)。与 EVA_LOG_LEVEL 一样遵循日志器的限流策略
+ */
+#define EVA_LOG_FMT_LEVEL(logger, level, fmt, ...)                                        \
+    if (auto&& eva_log_logger = (logger); !eva_log_logger->IsEnabled(level)) {            \
+    } else if (EVA_LOG_DEFINE_SITE(eva_log_site); false) {                                \
+    } else if (static eva::LogLimiter eva_log_limiter;                                    \
+               !eva_log_limiter.Allow(eva_log_logger->GetLimitPolicy(), *eva_log_logger,  \
+                                      level, eva_log_site)) {                             \
+    } else                                                                                \
+        eva::LogEventWrap{*eva_log_logger, level, eva_log_site}.GetLogEvent().Format(     \
+            fmt __VA_OPT__(, ) __VA_ARGS__)
+
+#define EVA_LOG_FMT_FATAL(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::FATAL) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::FATAL, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_ALERT(logger, fmt, ...) \
+#define EVA_LOG_FMT_ALERT(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ALERT) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::ALERT, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_CRIT(logger, fmt, ...) \
+#define EVA_LOG_FMT_CRIT(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::CRIT) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::CRIT, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_ERROR(logger, fmt, ...) \
+#define EVA_LOG_FMT_ERROR(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::ERROR) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::ERROR, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_WARN(logger, fmt, ...) \
+#define EVA_LOG_FMT_WARN(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::WARN) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::WARN, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_NOTICE(logger, fmt, ...) \
+#define EVA_LOG_FMT_NOTICE(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::NOTICE) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::NOTICE, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_INFO(logger, fmt, ...) \
+#define EVA_LOG_FMT_INFO(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::INFO) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::INFO, fmt __VA_OPT__(, ) __VA_ARGS__)
 
-#define EVA_LOG_FMT_DEBUG(logger, fmt, ...) \
+#define EVA_LOG_FMT_DEBUG(logger, fmt, ...)             \
+    EVA_LOG_IF_COMPILED_IN(eva::LogLevel::Level::DEBUG) \
     EVA_LOG_FMT_LEVEL(logger, eva::LogLevel::Level::DEBUG, fmt __VA_OPT__(, ) __VA_ARGS__)
 
 namespace eva {
@@ -124,6 +278,13 @@ public:
     };
 
     static std::string ToString(LogLevel::Level const& level) {
+        return std::string{ToStringView(level)};
+    }
+
+    /**
+     * @brief 日志级别转字符串，返回静态字符串，不分配内存
+     */
+    static constexpr std::string_view ToStringView(LogLevel::Level level) {
         switch (level) {
 #define XX(name)                \
     case LogLevel::Level::name: \
@@ -142,6 +303,13 @@ public:
         }
     }
 
+    /**
+     * @brief 该级别的日志语句是否被编译进来(不低于 EVA_LOG_MIN_LEVEL)
+     */
+    static constexpr bool IsCompiledIn(LogLevel::Level level) {
+        return static_cast<int>(level) >= EVA_LOG_MIN_LEVEL;
+    }
+
     static LogLevel::Level FromString(std::string const& str) {
 #define XX(level, v)                   \
     if (str == #v) {                   \
@@ -169,33 +337,171 @@ public:
     }
 };
 
+/**
+ * @brief 日志调用点描述符
+ * @details 由日志宏在每个调用点生成一个 static constexpr 对象(见 EVA_LOG_DEFINE_SITE)，
+ * 这些字段对同一调用点的所有事件都相同，事件中只保存一个指针，格式器从这里读取
+ */
+struct LogSite {
+    char const* file;      // 文件路径(__FILE__)
+    char const* basename;  // 文件名，不含目录
+    char const* function;  // 函数名(__func__)
+    int32_t line;          // 行号
+
+    /**
+     * @brief 路径中最后一个 '/' 之后的部分，用在常量表达式中时在编译期计算
+     */
+    static constexpr char const* Basename(char const* path) {
+        char const* base = path;
+        for (char const* p = path; *p; ++p) {
+            if (*p == '/') {
+                base = p + 1;
+            }
+        }
+        return base;
+    }
+};
+
+/**
+ * @brief 未知调用点，默认构造的事件指向它，各字段都是空串
+ */
+inline constexpr LogSite kUnknownLogSite{"", "", "", 0};
+
+class LogEventPool;
+
 // 日志事件
 class LogEvent {
 public:
     using ptr = std::shared_ptr<LogEvent>;
 
+    /**
+     * @brief 消息内联缓冲区大小，超出部分溢出到堆上(溢出的内存随事件对象复用)
+     */
+    static constexpr size_t kInlineMessageSize = 256;
+
+    using MessageStream = BasicLogStream<kInlineMessageSize>;
+
+    /**
+     * @brief 结构化字段内联缓冲区大小，超出部分溢出到堆上
+     */
+    static constexpr size_t kInlineFieldsSize = 128;
+
+    /**
+     * @brief 结构化字段(键值对)
+     * @details quoted 为 false 时 value 是数值或 true/false，可以原样作为 JSON 值输出
+     */
+    struct Field {
+        std::string_view key;
+        std::string_view value;
+        bool quoted;
+    };
+
 public:
+    LogEvent() = default;
+
     /**
      * @brief 构造函数
-     * @param[in] logger_name 日志器名称
+     * @param[in] logger_name 日志器名称，需在事件生命周期内有效(Logger 的名称是驻留的)
      * @param[in] level 日志级别
-     * @param[in] file 文件名
-     * @param[in] line 行号
+     * @param[in] site 调用点描述符，需在事件生命周期内有效(日志宏生成的是静态对象)
      * @param[in] elapse 从日志器创建开始到当前的累计运行毫秒
      * @param[in] thead_id 线程id
      * @param[in] fiber_id 协程id
-     * @param[in] time UTC时间
-     * @param[in] thread_name 线程名称
+     * @param[in] time_ns UTC时间(纳秒)
+     * @param[in] thread_name 线程名称，需在事件生命周期内有效(GetThreadName 返回的是驻留的)
      */
-    LogEvent(const std::string& logger_name, LogLevel::Level level, const char* file, int32_t line,
-             int64_t elapse, uint32_t thread_id, uint64_t fiber_id, uint64_t time,
-             const std::string& thread_name);
+    LogEvent(std::string_view logger_name, LogLevel::Level level, LogSite const& site,
+             int64_t elapse, uint32_t thread_id, uint64_t fiber_id, uint64_t time_ns,
+             std::string_view thread_name);
+
+    /**
+     * @brief 重新填充事件字段并清空消息，供对象池复用
+     */
+    void Reset(std::string_view logger_name, LogLevel::Level level, LogSite const& site,
+               int64_t elapse, uint32_t thread_id, uint64_t fiber_id, uint64_t time_ns,
+               std::string_view thread_name);
 
 public:
     /**
-     * @brief C prinf风格写入日志
+     * @brief {} 占位符风格写入日志，格式串在编译期校验，参数直接写入消息缓冲区
      */
-    void Printf(const char* fmt, ...);
+    template <typename... Args>
+    void Format(FormatString<Args...> fmt, Args const&... args) {
+        FormatTo(ss_, fmt, args...);
+    }
+
+    /**
+     * @brief 附加一个结构化字段，JsonLogFormatter 输出为独立的 JSON 字段，文本模板用 %k 输出
+     * @details 有限的数值和布尔值原样保存，其余类型按 {} 的规则(Formatter 特化或 operator<<)
+     * 格式化后作为字符串保存。字段编码为 [类型][键长][键][值长][值]，写入事件的字段缓冲区，
+     * 与消息一样随事件对象复用，稳态下没有堆分配
+     */
+    template <typename T>
+    LogEvent& With(std::string_view key, T const& value) {
+        using Value = std::decay_t<T>;
+        bool quoted = true;
+        if constexpr (std::is_same_v<Value, bool>) {
+            quoted = false;
+        } else if constexpr (std::is_floating_point_v<Value>) {
+            quoted = !std::isfinite(value);  // NaN 和无穷不是合法的 JSON 数值
+        } else if constexpr (std::is_arithmetic_v<Value> && !std::is_same_v<Value, char>) {
+            quoted = false;
+        }
+        uint32_t key_len = static_cast<uint32_t>(key.size());
+        fields_.Append(quoted ? 's' : 'r');
+        fields_.Append(reinterpret_cast<char const*>(&key_len), sizeof(key_len));
+        fields_.Append(key);
+        size_t len_pos = fields_.Size();
+        fields_.Reserve(sizeof(uint32_t));  // 值长度占位，格式化完值之后回填
+        fields_.Commit(sizeof(uint32_t));
+        detail::FormatValue(fields_, value, FormatSpec{});
+        uint32_t value_len = static_cast<uint32_t>(fields_.Size() - len_pos - sizeof(uint32_t));
+        std::memcpy(fields_.Data() + len_pos, &value_len, sizeof(value_len));
+        return *this;
+    }
+
+    /**
+     * @brief 依次附加多个字段，参数为 key1, value1, key2, value2, ...
+     */
+    template <typename K, typename V, typename... Rest>
+    LogEvent& WithFields(K const& key, V const& value, Rest const&... rest) {
+        static_assert(sizeof...(Rest) % 2 == 0, "WithFields expects key, value pairs");
+        With(std::string_view{key}, value);
+        if constexpr (sizeof...(Rest) > 0) {
+            WithFields(rest...);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 按附加顺序遍历结构化字段，fn 的参数为 Field const&
+     */
+    template <typename F>
+    void ForEachField(F&& fn) const {
+        char const* p = fields_.Data();
+        char const* end = p + fields_.Size();
+        while (p < end) {
+            Field field;
+            field.quoted = *p++ == 's';
+            uint32_t len;
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            field.key = std::string_view{p, len};
+            p += len;
+            std::memcpy(&len, p, sizeof(len));
+            p += sizeof(len);
+            field.value = std::string_view{p, len};
+            p += len;
+            fn(field);
+        }
+    }
+
+    bool HasFields() const { return !fields_.Empty(); }
+
+    /**
+     * @brief C prinf风格写入日志(经 vsnprintf，保留兼容，新代码请用 Format)
+     */
+    void Printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
 
     /**
      * @brief C vprintf风格写入日志
@@ -206,39 +512,56 @@ public:
     // Get 方法
     LogLevel::Level GetLevel() const { return level_; }
 
-    std::string GetContent() const { return ss_.str(); }
+    std::string_view GetContent() const { return ss_.View(); }
 
     // WARN: 返回引用不能加 const
-    std::stringstream& GetSs() { return ss_; }
+    MessageStream& GetStream() { return ss_; }
+
+    LogSite const& GetSite() const { return *site_; }
 
-    char const* GetFile() const { return file_; }
+    char const* GetFile() const { return site_->file; }
 
-    int32_t GetLine() const { return line_; }
+    char const* GetBasename() const { return site_->basename; }
+
+    char const* GetFunction() const { return site_->function; }
+
+    int32_t GetLine() const { return site_->line; }
 
     int64_t GetElapse() const { return elapse_; }
 
     uint32_t GetThreadId() const { return thread_id_; }
 
-    uint32_t GetFiberId() const { return fiber_id_; }
+    uint64_t GetFiberId() const { return fiber_id_; }
 
-    uint64_t GetTime() const { return time_; }
+    /**
+     * @brief UTC时间(秒)
+     */
+    uint64_t GetTime() const { return time_ns_ / 1000000000ULL; }
 
-    std::string GetThreadName() const { return thread_name_; }
+    /**
+     * @brief UTC时间(纳秒)
+     */
+    uint64_t GetTimeNs() const { return time_ns_; }
 
-    std::string GetLoggerName() const { return logger_name_; }
+    std::string_view GetThreadName() const { return thread_name_; }
+
+    std::string_view GetLoggerName() const { return logger_name_; }
 
 private:
+    friend class LogEventPool;
+
     // 内存对齐
-    LogLevel::Level level_;      // 日志级别
-    std::stringstream ss_;       // 日志内容(流式写入日志)
-    const char* file_{nullptr};  // 文件名
-    int32_t line_{0};            // 行号
-    uint32_t elapse_{0};         // 程序启动开始到现在的毫秒数
-    uint32_t thread_id_{0};      // 线程 id
-    uint32_t fiber_id_{0};       // 协程 id
-    uint64_t time_{0};           // 时间戳
-    std::string thread_name_;    // 线程名称
-    std::string logger_name_;    // 日志器名称
+    LogSite const* site_{&kUnknownLogSite};           // 调用点(文件、行号、函数)
+    LogLevel::Level level_{LogLevel::Level::NOTSET};  // 日志级别
+    uint32_t elapse_{0};                              // 程序启动开始到现在的毫秒数
+    uint32_t thread_id_{0};                           // 线程 id
+    uint64_t time_ns_{0};                             // 时间戳(纳秒)
+    uint64_t fiber_id_{0};                            // 协程 id
+    std::string_view logger_name_;                    // 日志器名称(驻留字符串)
+    std::string_view thread_name_;                    // 线程名称(驻留字符串)
+    MessageStream ss_;                                // 日志内容(流式写入日志)
+    BasicLogStream<kInlineFieldsSize> fields_;        // 结构化字段(编码见 With)
+    LogEvent* pool_next_{nullptr};                    // 对象池空闲链表指针
 };
 
 // 日志格式器
@@ -254,12 +577,17 @@ public:
      * - %%c 日志器名称
      * - %%d 日期时间，后面可跟一对括号指定时间格式，
          比如%%d{%%Y-%%m-%%d%%H:%%M:%%S}，这里的格式字符与C语言strftime一致
+     * - %%ms 时间戳的毫秒部分(3位)，%%us 微秒部分(6位)，%%ns 纳秒部分(9位)，
+         例如%%d{%%H:%%M:%%S}.%%us；两字符模板项优先匹配，即 %%ms 不会被解析为 %%m 加字符 s
      * - %%r 该日志器创建后的累计运行毫秒数
      * - %%f 文件名
+     * - %%b 不含目录的文件名(编译期计算)
+     * - %%M 函数名
      * - %%l 行号
      * - %%t 线程id
      * - %%F 协程id
      * - %%N 线程名称
+     * - %%k 结构化字段，key=value 以空格分隔(见 LogEvent::With)
      * - %%% 百分号
      * - %%T 制表符
      * - %%n 换行
@@ -269,29 +597,56 @@ public:
      * 默认格式描述：年-月-日 时:分:秒 [累计运行毫秒数] \\t 线程id \\t 线程名称 \\t 协程id \\t
      * [日志级别] \\t [日志器名称] \\t 文件名:行号 \\t 日志消息 换行符
      */
-    LogFormatter(std::string const& pattern =
-                     "%d{%Y-%m-%d %H:%M:%S} [%rms]%T%t%T%N%T%F%T[%p]%T[%c]%T%f:%l%T%m%n");
+    LogFormatter(std::string const& pattern = kDefaultPattern);
+
+    virtual ~LogFormatter() {}
+
+protected:
+    /**
+     * @brief 供派生类使用的构造函数，只记录模板，不做运行时解析
+     */
+    struct NoInit {};
+    LogFormatter(std::string const& pattern, NoInit) : pattern_(pattern) {}
 
 public:
+    /**
+     * @brief 默认格式模板
+     */
+    static constexpr char kDefaultPattern[] =
+        "%d{%Y-%m-%d %H:%M:%S} [%rms]%T%t%T%N%T%F%T[%p]%T[%c]%T%f:%l%T%m%n";
+
     /**
      * @brief 初始化，解析格式模板，提取模板项
      */
     void Init();
 
+    /**
+     * @brief 对日志事件进行格式化，追加到字符缓冲区
+     * @param[in] stream 日志缓冲区
+     * @param[in] event 日志事件
+     */
+    virtual void Format(LogStream& stream, LogEvent const& event);
+
     /**
      * @brief 对日志事件进行格式化，返回格式化日志文本
      * @param[in] event 日志事件
      * @return 格式化日志字符串
      */
-    std::string Format(LogEvent::ptr event);
+    std::string Format(LogEvent const& event);
 
     /**
      * @brief 对日志事件进行格式化，返回格式化日志流
+     * @details 先格式化到线程局部缓冲区，再一次性写入输出流
      * @param[in] event 日志事件
      * @param[in] os 日志输出流
      * @return 格式化日志流
      */
-    std::ostream& Format(std::ostream& os, LogEvent::ptr event);
+    std::ostream& Format(std::ostream& os, LogEvent const& event);
+
+public:
+    std::string const& GetPattern() const { return pattern_; }
+
+    bool IsError() const { return error_; }
 
 public:
     /**
@@ -306,13 +661,13 @@ public:
         /**
          * @brief 格式化日志事件
          */
-        virtual void Format(std::ostream& os, LogEvent::ptr event) = 0;
+        virtual void Format(LogStream& os, LogEvent const& event) = 0;
     };
 
 private:
     std::string pattern_;                 // 日志格式模板
     std::vector<FormatItem::ptr> items_;  // 解析后的格式模板数组
-    bool error_;                          // 是否出错
+    bool error_{false};                   // 是否出错
 };
 
 // 日志输出地(纯虚基类)
@@ -332,29 +687,71 @@ public:
     /**
      * @brief 写入日志
      */
-    virtual void Log(LogEvent::ptr event) = 0;
+    virtual void Log(LogEvent const& event) = 0;
 
 public:
     /**
-     * @brief 获取日志格式器
+     * @brief 获取日志格式器(未设置时为默认格式器)
      */
     LogFormatter::ptr GetFormatter() const {
-        // 这里需要加锁？
+        std::lock_guard lk{formatter_mtx_};
         return formatter_ ? formatter_ : default_formatter_;
     }
 
     /**
-     * @brief 设置日志格式器
+     * @brief 设置日志格式器，可以在其他线程写日志时调用
+     * @details 正在写的事件用旧格式器或新格式器完整地格式化，不会看到中间状态。
+     * 被替换的格式器保留到 appender 析构，写日志的路径只读一个原子指针，不加锁也不改引用计数
      */
-    void SetFormatter(LogFormatter::ptr formatter) {
-        // 这里需要加锁？
-        formatter_ = formatter;
-    };
+    void SetFormatter(LogFormatter::ptr formatter);
+
+protected:
+    /**
+     * @brief 当前生效的格式器，派生类在 Log 中用它格式化事件
+     */
+    LogFormatter& ActiveFormatter() const {
+        return *active_formatter_.load(std::memory_order_acquire);
+    }
 
 protected:
     std::mutex mtx_;
-    LogFormatter::ptr formatter_;          // 日志格式器
     LogFormatter::ptr default_formatter_;  // 默认日志格式器
+
+private:
+    mutable std::mutex formatter_mtx_;                   // 串行化 SetFormatter
+    LogFormatter::ptr formatter_;                        // 日志格式器
+    std::vector<LogFormatter::ptr> retired_formatters_;  // 被替换的格式器
+    std::atomic<LogFormatter*> active_formatter_;        // 当前生效的格式器
+};
+
+/**
+ * @brief 调用点限流策略
+ * @details n 最小为 1
+ *   EVERY_SEC：令牌桶，每个调用点每秒最多 n 条，允许 n 条的突发
+ *   EVERY_N：每 n 次输出 1 次(第 1、n+1、2n+1... 次)
+ *   BACKOFF：前 n 次都输出，之后只在第 2n、4n、8n... 次(从 0 计)输出，间隔逐次翻倍
+ */
+struct LogLimitPolicy {
+    enum class Kind : uint32_t { NONE, EVERY_SEC, EVERY_N, BACKOFF };
+
+    Kind kind{Kind::NONE};
+    uint32_t n{0};
+
+    static constexpr LogLimitPolicy None() { return {}; }
+
+    static constexpr LogLimitPolicy EverySecond(uint32_t n) {
+        return {Kind::EVERY_SEC, std::max<uint32_t>(n, 1)};
+    }
+
+    static constexpr LogLimitPolicy EveryN(uint32_t n) {
+        return {Kind::EVERY_N, std::max<uint32_t>(n, 1)};
+    }
+
+    static constexpr LogLimitPolicy Backoff(uint32_t n) {
+        return {Kind::BACKOFF, std::max<uint32_t>(n, 1)};
+    }
+
+    bool operator==(LogLimitPolicy const&) const = default;
 };
 
 /**
@@ -363,14 +760,47 @@ protected:
  * 一个Logger包含多个LogAppender和一个日志级别，提供log方法，传入日志事件，
  * 判断该日志事件的级别高于日志器本身的级别之后调用LogAppender将日志进行输出，否则该日志被抛弃。
  *
+ * 日志器按名称中的 '.' 组成树：net.http 的父日志器是 net，net 的父日志器是 root。
+ * 没有设置级别的日志器继承最近的设置了级别的祖先；additive(默认)的日志器除了自己的 appender，
+ * 还输出到父日志器的全部有效 appender。有效级别和有效 appender 集合在树发生变化时立即算好，
+ * 作为一份不可变的有效状态整体发布，Log 只原子地取一次自己的有效状态，开销与树的深度无关
  */
 class Logger {
 public:
     using ptr = std::shared_ptr<Logger>;
-    Logger(std::string const& name = "default");
+
+    /**
+     * @brief Appender 集合的不可变快照
+     * @details 写者(Add/Del/Clear)复制当前快照、修改后整体原子替换，
+     * 读者(Log)只原子地取一次快照，不加锁；旧快照在最后一个读者释放后销毁
+     */
+    using AppenderList = std::vector<LogAppender::ptr>;
+    using AppenderSnapshot = std::shared_ptr<AppenderList const>;
+
+    /**
+     * @brief 日志器自己的完整设置，供 Reconfigure 整体替换
+     */
+    struct Settings {
+        std::optional<LogLevel::Level> level;          // 为空时继承父日志器
+        bool additive{true};                           // 是否输出到父日志器的 appender
+        LogLimitPolicy limit{LogLimitPolicy::None()};  // 调用点限流策略
+        AppenderList appenders;                        // 自己的 appender
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 日志器名称
+     * @param[in] parent 父日志器，为空时没有父日志器；父日志器必须比子日志器活得久
+     */
+    Logger(std::string const& name = "default", Logger* parent = nullptr);
+
+    ~Logger();
+
+    Logger(Logger const&) = delete;
+    Logger& operator=(Logger const&) = delete;
 
 public:
-    void Log(LogEvent::ptr event);
+    void Log(LogEvent const& event);
 
 public:
     void AddAppender(LogAppender::ptr appender);
@@ -379,21 +809,184 @@ public:
 
     void ClearAppenders();
 
+    /**
+     * @brief 整体替换 Appender 集合，一次原子替换，读者看到的是旧集合或新集合
+     */
+    void SetAppenders(AppenderList appenders);
+
+    /**
+     * @brief 获取自己的 Appender 快照，不含继承的 appender
+     */
+    AppenderSnapshot GetAppenders() const { return appenders_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 获取有效 Appender 快照：自己的 appender 在前，additive 时接着是父日志器的有效 appender，
+     * 同一个 appender 只出现一次
+     */
+    AppenderSnapshot GetEffectiveAppenders() const {
+        return state_.load(std::memory_order_acquire)->appenders;
+    }
+
+    /**
+     * @brief 是否输出到父日志器的 appender，默认是
+     */
+    bool IsAdditive() const { return state_.load(std::memory_order_acquire)->additive; }
+
+    void SetAdditive(bool additive);
+
 public:
-    std::string GetName() const { return name_; }
+    /**
+     * @brief 日志器名称，驻留在全局字符串表中，在进程生命周期内有效
+     */
+    std::string const& GetName() const { return *name_; }
 
     uint64_t GetCreateTime() const { return create_time_; }
 
-    LogLevel::Level GetLevel() const { return level_; };
+    /**
+     * @brief 父日志器，根日志器和单独创建的日志器为空
+     */
+    Logger* GetParent() const { return parent_; }
+
+    /**
+     * @brief 有效日志级别：自己设置的级别，没有设置时继承父日志器，都没有时为 INFO
+     * @details 读的是随有效状态一起发布的 relaxed 缓存，供宏在构造日志事件之前快速过滤；
+     * 运行时调整级别不需要加锁，其他线程最终会看到新级别
+     */
+    LogLevel::Level GetLevel() const { return effective_level_.load(std::memory_order_relaxed); }
 
-    void SetLevel(LogLevel::Level level) { level_ = level; };
+    /**
+     * @brief 设置级别，同时更新所有继承该级别的子孙日志器
+     */
+    void SetLevel(LogLevel::Level level);
+
+    /**
+     * @brief 清除自己设置的级别，改为继承父日志器
+     */
+    void ClearLevel();
+
+    /**
+     * @brief 是否设置了自己的级别
+     */
+    bool HasLevel() const;
+
+    /**
+     * @brief 级别为 level 的日志是否需要输出
+     */
+    bool IsEnabled(LogLevel::Level level) const {
+        return level >= effective_level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 日志器级别的限流策略，作用于 EVA_LOG_<级别> / EVA_LOG_FMT_<级别> 的每个调用点，
+     * 默认不限流。与级别一样读的是 relaxed 缓存，可在运行时调整
+     */
+    LogLimitPolicy GetLimitPolicy() const {
+        return effective_limit_.load(std::memory_order_relaxed);
+    }
+
+    void SetLimitPolicy(LogLimitPolicy policy);
+
+public:
+    /**
+     * @brief 整体替换一组日志器的设置
+     * @details 持有 TreeMutex 写入所有设置，先在一旁算好受影响的每个日志器的新有效状态，
+     * 再逐个日志器用一次原子替换发布。写日志的线程不加锁、不等待，
+     * 同一个日志器的级别、additive、限流策略和有效 appender 总是来自同一次发布
+     */
+    static void Reconfigure(std::vector<std::pair<Logger*, Settings>> const& batch);
 
 private:
-    std::mutex mtx_;
-    std::string name_;                       // 日志器名称
-    LogLevel::Level level_;                  // 日志器级别
-    std::list<LogAppender::ptr> appenders_;  // Appender 集合（链表）
-    uint64_t create_time_;                   // 创建时间(毫秒)
+    /**
+     * @brief 有效状态的不可变快照，整体原子替换
+     */
+    struct State {
+        LogLevel::Level level;       // 有效级别
+        bool additive;               // 是否输出到父日志器的 appender
+        LogLimitPolicy limit;        // 调用点限流策略
+        AppenderSnapshot appenders;  // 有效 appender
+    };
+    using StateSnapshot = std::shared_ptr<State const>;
+    using StateBatch = std::vector<std::pair<Logger*, StateSnapshot>>;
+
+    /**
+     * @brief 重新计算并发布自己和所有子孙的有效状态，调用方持有 TreeMutex
+     */
+    void Refresh();
+
+    /**
+     * @brief 由父日志器的新有效状态算出自己和所有子孙的有效状态，追加到 out，不发布
+     */
+    void Resolve(State const* parent, StateBatch& out);
+
+    /**
+     * @brief 逐个日志器发布算好的有效状态，调用方持有 TreeMutex
+     */
+    static void Publish(StateBatch const& batch);
+
+    /**
+     * @brief 串行化所有日志器的写者和树结构的修改，写日志时不涉及
+     */
+    static std::mutex& TreeMutex();
+
+private:
+    std::string const* name_;                            // 日志器名称(驻留字符串)
+    Logger* const parent_;                               // 父日志器
+    std::vector<Logger*> children_;                      // 子日志器，由 TreeMutex 保护
+    std::optional<LogLevel::Level> level_;               // 自己设置的级别，由 TreeMutex 保护
+    bool additive_{true};                                // 是否继承父日志器的 appender，同上
+    LogLimitPolicy limit_;                               // 调用点限流策略，同上
+    std::atomic<AppenderSnapshot> appenders_;            // 自己的 Appender 集合（不可变快照）
+    std::atomic<StateSnapshot> state_;                   // 有效状态(不可变快照)
+    std::atomic<LogLevel::Level> effective_level_;       // 有效级别(state_ 的缓存)
+    std::atomic<LogLimitPolicy> effective_limit_;        // 限流策略(state_ 的缓存)
+    uint64_t create_time_;                               // 创建时间(毫秒)
+};
+
+/**
+ * @brief 单个调用点的限流状态，由限流宏定义为函数内静态变量
+ * @details 所有状态都是原子变量，多线程同时命中同一调用点时不加锁；
+ * 构造函数是 constexpr 的，静态变量常量初始化，没有线程安全守卫的开销
+ */
+class LogLimiter {
+public:
+    constexpr LogLimiter() = default;
+
+    LogLimiter(LogLimiter const&) = delete;
+    LogLimiter& operator=(LogLimiter const&) = delete;
+
+public:
+    /**
+     * @brief 按 policy 判断本次是否放行
+     * @details 不限流时只有一次比较；放行且之前有被抑制的日志时，先输出一行汇总
+     */
+    bool Allow(LogLimitPolicy policy, Logger& logger, LogLevel::Level level, LogSite const& site) {
+        if (policy.kind == LogLimitPolicy::Kind::NONE) {
+            return true;
+        }
+        if (!Admit(policy)) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (suppressed_.load(std::memory_order_relaxed) != 0) {
+            ReportSuppressed(logger, level, site);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 尚未汇总输出的被抑制条数
+     */
+    uint64_t GetSuppressedCount() const { return suppressed_.load(std::memory_order_relaxed); }
+
+private:
+    bool Admit(LogLimitPolicy policy);
+
+    void ReportSuppressed(Logger& logger, LogLevel::Level level, LogSite const& site);
+
+private:
+    std::atomic<uint64_t> count_{0};       // EVERY_N / BACKOFF：命中次数
+    std::atomic<int64_t> next_ns_{0};      // EVERY_SEC：令牌桶的理论到达时间(单调时钟纳秒)
+    std::atomic<uint64_t> suppressed_{0};  // 被抑制、尚未汇总的条数
 };
 
 /**
@@ -402,42 +995,117 @@ private:
 class LogEventWrap {
 public:
     /**
-     * @brief 构造函数
+     * @brief 构造函数，从线程局部对象池取出一个日志事件并填充
      * @param[in] logger 日志器
-     * @param[in] event 日志事件
+     * @param[in] level 日志级别
+     * @param[in] site 调用点描述符(静态对象)
      */
-    LogEventWrap(Logger::ptr logger, LogEvent::ptr event);
+    LogEventWrap(Logger& logger, LogLevel::Level level, LogSite const& site);
 
     /**
      * @brief 析构函数
-     * @details NOTE: 日志事件在析构时由日志器进行输出
+     * @details NOTE: 日志事件在析构时由日志器进行输出，然后归还对象池
      */
     ~LogEventWrap();
 
+    LogEventWrap(LogEventWrap const&) = delete;
+    LogEventWrap& operator=(LogEventWrap const&) = delete;
+
 public:
-    LogEvent::ptr GetLogEvent() const { return event_; }
+    LogEvent& GetLogEvent() const { return *event_; }
+
+    LogEvent::MessageStream& GetStream() const { return event_->GetStream(); }
 
 private:
-    Logger::ptr logger_;   // 日志器
-    LogEvent::ptr event_;  // 日志事件
+    Logger& logger_;   // 日志器
+    LogEvent* event_;  // 日志事件(来自对象池)
 };
 
+struct LogConfig;
+
 /**
  * @brief 日志器管理类
+ * @details 日志器保存在固定桶数的哈希表中，每个桶是只增不删的单链表：
+ * 读路径只做 acquire 读和字符串比较，不加锁；创建新日志器时按分片加锁并头插发布。
+ * 日志器一经创建就不会被移除或替换，重新配置只修改日志器本身(级别、appender)，
+ * 因此 GetLogger 返回的引用和 EVA_LOGGER 缓存的指针始终有效
  */
 class LoggerManager {
 public:
     LoggerManager();
 
 public:
+    /**
+     * @brief 初始化：设置了环境变量 EVA_LOG_CONFIG 时，从该 TOML 文件加载配置并监视其变化
+     */
     void Init();
-    Logger::ptr GetLogger(std::string const& name);
-    Logger::ptr GetRoot() { return root_; }
+
+    /**
+     * @brief 从 TOML 文件加载日志配置(格式见 log_config.h)
+     * @return 文件无法读取或配置有误时返回 false，当前配置保持不变
+     */
+    bool LoadConfig(std::string const& path);
+
+    /**
+     * @brief 应用日志配置
+     * @details 先构建好所有 appender 和格式器，全部成功后再逐个日志器原子替换，
+     * 写日志的线程不加锁、不等待；任何一处出错都整体放弃，当前配置保持不变
+     */
+    bool ApplyConfig(LogConfig const& config);
+
+    /**
+     * @brief 加载配置文件，并用 inotify 监视其变化，文件内容改变后自动重新加载
+     * @details 后台线程监视文件所在目录，能处理原地写入和重命名替换两种更新方式；
+     * 再次调用会先停止之前的监视
+     */
+    bool WatchConfig(std::string const& path);
+
+    /**
+     * @brief 停止监视配置文件
+     */
+    void StopWatching();
+
+    /**
+     * @brief 获取指定名称的日志器，不存在时连同缺少的祖先一起创建
+     * @details 新日志器不带自己的 appender，也不设置级别，从父日志器继承(见 Logger)。
+     * 返回的引用在进程生命周期内有效，查找已有日志器时不加锁、不拷贝 shared_ptr
+     */
+    Logger::ptr const& GetLogger(std::string_view name);
+
+    Logger::ptr const& GetRoot() const { return root_; }
 
 private:
-    std::mutex mtx_;
-    std::map<std::string, Logger::ptr> loggers_;  // 日志器集合
+    /**
+     * @brief 哈希桶中的节点，创建后不可变、不释放
+     */
+    struct Node {
+        size_t hash;         // 名称的哈希值
+        Logger::ptr logger;  // 日志器
+        Node* next;          // 同一个桶中的下一个节点
+    };
+
+    static constexpr size_t kBucketCount = 1024;  // 桶数(2 的幂)
+    static constexpr size_t kShardCount = 16;     // 写锁分片数
+
+    Node const* Find(size_t hash, std::string_view name) const;
+
+    /**
+     * @brief 配置加载与监视的状态，定义在 log_config.cpp 中
+     */
+    struct ConfigState;
+
+    /**
+     * @brief 获取配置状态，首次调用时创建
+     */
+    ConfigState& GetConfigState();
+
+private:
+    std::mutex mtx_[kShardCount];                 // 串行化同一分片内的创建
+    std::atomic<Node*> buckets_[kBucketCount]{};  // 哈希桶
     Logger::ptr root_;                            // 默认 root 日志器
+    std::mutex config_mtx_;                       // 串行化配置的应用，写日志时不涉及
+    std::once_flag config_once_;                  // 创建配置状态
+    ConfigState* config_state_{nullptr};          // 配置状态(不释放)
 };
 
 using LoggerMgr = Singleton<LoggerManager>;
@@ -452,25 +1120,101 @@ public:
     StdoutLogAppender();
 
 public:
-    void Log(LogEvent::ptr event) override;
+    void Log(LogEvent const& event) override;
+};
+
+/**
+ * @brief 文件输出地的持久化策略
+ */
+struct FileDurabilityPolicy {
+    size_t flush_bytes{64 * 1024};     // 缓冲区累积到该大小时提交一次
+    uint32_t flush_interval_ms{1000};  // 数据在缓冲区中的最长停留时间，0 表示只按大小提交
+    uint32_t fsync_interval_ms{0};     // 每隔多少毫秒落盘一次，0 表示不定期落盘
+
+    // 该级别及以上的事件立即提交并落盘，FATAL 总是如此；设为 ERROR 即"错误及以上同步落盘"
+    LogLevel::Level sync_level{LogLevel::Level::FATAL};
+
+    bool operator==(FileDurabilityPolicy const&) const = default;
 };
 
-// 日志输出：文件
-class FileLogAppender : public LogAppender {
+/**
+ * @brief 日志输出：文件
+ * @details 格式化好的日志行先追加到内存缓冲区，缓冲区写满时交给后台线程，
+ * 由后台线程把所有待提交的缓冲区用一次 writev 写出(组提交)；
+ * 后台线程还负责按时间间隔提交、定期 fdatasync 以及检测文件被外部移走后重新打开。
+ * 级别不低于 sync_level 的事件由调用线程立即提交并 fdatasync 后才返回，FATAL 总是如此
+ */
+class FileLogAppender : public LogAppender, public CrashFlushable {
 public:
     using ptr = std::shared_ptr<FileLogAppender>;
 
-    FileLogAppender(std::string const& filename);
+    FileLogAppender(std::string const& filename, FileDurabilityPolicy policy = {});
+
+    /**
+     * @brief 析构函数，停止后台线程，写出剩余数据后关闭文件
+     */
+    ~FileLogAppender() override;
 
 public:
-    void Log(LogEvent::ptr event) override;
+    void Log(LogEvent const& event) override;
+
+    /**
+     * @brief 立即提交缓冲区中的所有数据
+     * @param[in] sync 是否同时 fdatasync
+     */
+    void Flush(bool sync = false);
+
+    /**
+     * @brief 提交缓冲区中的数据后重新打开文件
+     */
     bool Reopen();
 
+    /**
+     * @brief 崩溃时写出正在写出的批次、待提交和正在追加的缓冲区，再追加崩溃报告并 fsync
+     */
+    void OnCrashFlush(char const* report, size_t len) noexcept override;
+
+private:
+    /**
+     * @brief 把待提交的缓冲区和当前缓冲区按顺序写出，lk 持有 mtx_，返回时仍持有
+     */
+    void Commit(std::unique_lock<std::mutex>& lk, bool sync);
+
+    /**
+     * @brief 打开文件并记录 inode，调用方持有 io_mtx_
+     */
+    bool OpenFile();
+
+    /**
+     * @brief 取一个空闲缓冲区，调用方持有 mtx_
+     */
+    std::string TakeBuffer();
+
+    /**
+     * @brief 后台线程
+     */
+    void Run();
+
 private:
-    std::string filename_;      // 文件路径
-    std::ofstream filestream_;  // 文件流
-    uint64_t last_time_;        // 上次重打开时间(与当前时间戳比较)
-    bool reopen_error_{false};  // 文件打开错误标识
+    static constexpr size_t kMaxPendingBuffers = 16;  // 待提交缓冲区上限，超过后调用方直接提交
+
+    std::string filename_;               // 文件路径
+    FileDurabilityPolicy policy_;        // 持久化策略
+    std::string current_;                // 正在追加的缓冲区
+    std::vector<std::string> pending_;   // 已写满、等待提交的缓冲区
+    std::vector<std::string> spare_;     // 空闲缓冲区
+    std::mutex io_mtx_;                  // 串行化文件写入，加锁顺序：mtx_ -> io_mtx_
+    // Commit 正在写出、尚未写完的 iovec，供崩溃时写出；由 io_mtx_ 保护，崩溃时不加锁读取
+    std::atomic<struct iovec const*> inflight_{nullptr};
+    std::atomic<size_t> inflight_count_{0};
+    int fd_{-1};                         // 文件描述符
+    uint64_t dev_{0};                    // 已打开文件的设备号
+    uint64_t ino_{0};                    // 已打开文件的 inode
+    bool dirty_{false};                  // 上次落盘后是否写过数据
+    bool reopen_error_{false};           // 文件打开错误标识
+    std::condition_variable cv_;         // 唤醒后台线程
+    bool stop_{false};                   // 是否停止后台线程
+    std::thread thread_;                 // 后台线程
 };
 
 // ------------------- 继承自 LogFormatter::FormatItem -------------------
@@ -478,92 +1222,173 @@ private:
 class MessageFormatItem : public LogFormatter::FormatItem {
 public:
     MessageFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetContent(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetContent(); }
 };
 
 class LevelFormatItem : public LogFormatter::FormatItem {
 public:
     LevelFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override {
-        os << LogLevel::ToString(event->GetLevel());
+    void Format(LogStream& os, LogEvent const& event) override {
+        os << LogLevel::ToStringView(event.GetLevel());
     }
 };
 
 class ElapseFormatItem : public LogFormatter::FormatItem {
 public:
     ElapseFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetElapse(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetElapse(); }
 };
 
 class LoggerNameFormatItem : public LogFormatter::FormatItem {
 public:
     LoggerNameFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetLoggerName(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetLoggerName(); }
 };
 
 class ThreadIdFormatItem : public LogFormatter::FormatItem {
 public:
     ThreadIdFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetThreadId(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetThreadId(); }
 };
 
 class FiberIdFormatItem : public LogFormatter::FormatItem {
 public:
     FiberIdFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetFiberId(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetFiberId(); }
 };
 
 class ThreadNameFormatItem : public LogFormatter::FormatItem {
 public:
     ThreadNameFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetThreadName(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetThreadName(); }
 };
 
+class FieldsFormatItem : public LogFormatter::FormatItem {
+public:
+    FieldsFormatItem(const std::string& str) {}
+    void Format(LogStream& os, LogEvent const& event) override { Append(os, event); }
+
+    /**
+     * @brief 以 key=value 的形式追加结构化字段，字段之间以空格分隔
+     */
+    static void Append(LogStream& os, LogEvent const& event) {
+        bool first = true;
+        event.ForEachField([&](LogEvent::Field const& field) {
+            if (!first) {
+                os << ' ';
+            }
+            first = false;
+            os << field.key << '=' << field.value;
+        });
+    }
+};
+
+/**
+ * @brief 按秒缓存的日期时间渲染
+ * @details 每个线程缓存最近渲染过的几组(格式, 秒)结果，同一秒内的日志直接拷贝缓存，
+ * 只有秒数变化时才调用 localtime_r/strftime
+ * @param[in] stream 日志缓冲区
+ * @param[in] key 格式的唯一标识，同一个 key 必须始终对应同一个格式
+ * @param[in] format strftime 格式
+ * @param[in] seconds UTC时间(秒)
+ */
+void AppendCachedDateTime(LogStream& stream, uintptr_t key, char const* format, time_t seconds);
+
 class DateTimeFormatItem : public LogFormatter::FormatItem {
 public:
-    DateTimeFormatItem(std::string const& format = "%Y-%m-%d %H:%M:%S") : format_(format) {
+    DateTimeFormatItem(std::string const& format = "%Y-%m-%d %H:%M:%S")
+        : format_(format), key_(NextKey()) {
         // 防止传入空字符串
         if (format_.empty()) {
             format_ = "%Y-%m-%d %H:%M:%S";
         }
     }
 
-    void Format(std::ostream& os, LogEvent::ptr event) override {
-        // 将 UTC 时间转为字符串
-        tm tm;
-        time_t time = event->GetTime();
-        localtime_r(&time, &tm);
-        char buf[64];
-        strftime(buf, sizeof(buf), format_.c_str(), &tm);
-        os << buf;
+    void Format(LogStream& os, LogEvent const& event) override {
+        // 将 UTC 时间转为字符串(同一秒内命中线程缓存)
+        AppendCachedDateTime(os, key_, format_.c_str(), event.GetTime());
+    }
+
+private:
+    /**
+     * @brief 每个格式项一个唯一 key，不用 this 指针，避免对象销毁后地址复用命中旧缓存
+     */
+    static uintptr_t NextKey() {
+        static std::atomic<uintptr_t> s_next_key{1};
+        return s_next_key.fetch_add(1, std::memory_order_relaxed);
     }
 
 private:
     std::string format_;
+    uintptr_t key_;
+};
+
+class SubSecondFormatItem : public LogFormatter::FormatItem {
+public:
+    /**
+     * @param[in] str "ms"/"us"/"ns"，分别输出 3/6/9 位小数秒
+     */
+    SubSecondFormatItem(const std::string& str)
+        : digits_(str == "ms" ? 3 : (str == "us" ? 6 : 9)) {}
+
+    void Format(LogStream& os, LogEvent const& event) override {
+        Append(os, event.GetTimeNs(), digits_);
+    }
+
+    /**
+     * @brief 以定宽补零的形式追加时间戳的小数秒部分
+     */
+    static void Append(LogStream& os, uint64_t time_ns, int digits) {
+        uint32_t frac = time_ns % 1000000000ULL;
+        for (int i = digits; i < 9; ++i) {
+            frac /= 10;
+        }
+        char* p = os.Reserve(9);
+        for (int i = digits - 1; i >= 0; --i) {
+            p[i] = static_cast<char>('0' + frac % 10);
+            frac /= 10;
+        }
+        os.Commit(digits);
+    }
+
+private:
+    int digits_;
 };
 
 class FileNameFormatItem : public LogFormatter::FormatItem {
 public:
     FileNameFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetFile(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetFile(); }
+};
+
+class BasenameFormatItem : public LogFormatter::FormatItem {
+public:
+    BasenameFormatItem(const std::string& str) {}
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetBasename(); }
+};
+
+class FunctionFormatItem : public LogFormatter::FormatItem {
+public:
+    FunctionFormatItem(const std::string& str) {}
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetFunction(); }
 };
 
 class LineFormatItem : public LogFormatter::FormatItem {
 public:
     LineFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << event->GetLine(); }
+    void Format(LogStream& os, LogEvent const& event) override { os << event.GetLine(); }
 };
 
 class NewLineFormatItem : public LogFormatter::FormatItem {
 public:
     NewLineFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << std::endl; }
+    void Format(LogStream& os, LogEvent const& event) override { os << '\n'; }
 };
 
 class StringFormatItem : public LogFormatter::FormatItem {
 public:
     StringFormatItem(std::string const& str) : str_(str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << str_; }
+    void Format(LogStream& os, LogEvent const& event) override { os << str_; }
 
 private:
     std::string str_;
@@ -572,13 +1397,13 @@ private:
 class TabFormatItem : public LogFormatter::FormatItem {
 public:
     TabFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << "\t"; }
+    void Format(LogStream& os, LogEvent const& event) override { os << '\t'; }
 };
 
 class PercentSignFormatItem : public LogFormatter::FormatItem {
 public:
     PercentSignFormatItem(const std::string& str) {}
-    void Format(std::ostream& os, LogEvent::ptr event) override { os << "%"; }
+    void Format(LogStream& os, LogEvent const& event) override { os << '%'; }
 };
 
 };  // namespace eva
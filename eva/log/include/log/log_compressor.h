@@ -0,0 +1,163 @@
+#pragma once
+
+#include <log/log.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief 分块压缩日志文件(.zlog)中一个数据块的索引项
+ * @details 文件布局：
+ *   文件头：magic "EVAZ"、version(u32)、block_size(u32)
+ *   数据块：每块是一段独立的 zlib 流，可以单独解压；块边界落在行尾，一行不会跨块
+ *   索引：每块一个 LogArchiveBlock
+ *   文件尾：index_offset(u64)、block_count(u32)、magic "EVAX"
+ * 工具按时间范围读取时只需读文件尾和索引，再解压时间上有交集的块
+ */
+struct LogArchiveBlock {
+    uint64_t offset{0};           // 压缩数据在文件中的偏移
+    uint64_t raw_offset{0};       // 原始数据在源文件中的偏移
+    uint32_t compressed_size{0};  // 压缩后字节数
+    uint32_t raw_size{0};         // 原始字节数
+    int64_t first_time{0};        // 块内第一行的时间(UTC 秒)，无法解析时为 0
+    int64_t last_time{0};         // 块内最后一行的时间(UTC 秒)，无法解析时为 0
+};
+
+/**
+ * @brief 压缩器配置
+ */
+struct LogCompressorOptions {
+    int level{6};                 // zlib 压缩级别，1(最快) ~ 9(最小)
+    size_t block_size{1 << 20};   // 每块原始数据的目标大小，实际按行尾对齐
+    size_t threads{1};            // 压缩线程数
+    double cpu_limit{0.5};        // 每个压缩线程最多占用一个 CPU 的比例，(0, 1]，1 表示不限制
+    bool idle_priority{true};     // 压缩线程使用 SCHED_IDLE 调度和 idle 级 IO 优先级
+    std::vector<int> cpus;        // 压缩线程绑定的 CPU 编号，为空时不绑定
+    std::string suffix{".zlog"};  // 压缩文件后缀
+};
+
+/**
+ * @brief 后台日志压缩器
+ * @details 已关闭(滚动或外部轮转)的日志文件提交给后台线程，按块压缩为 .zlog 文件。
+ * 压缩线程不与写日志的线程争抢 CPU：
+ *   - 默认使用 SCHED_IDLE 调度策略，只在 CPU 空闲时运行，IO 优先级为 idle
+ *   - 每压缩完一块按 cpu_limit 休眠，限制单个线程的 CPU 占用比例
+ *   - 可以绑定到指定的 CPU 上
+ * 写日志的线程只在提交时打开一次源文件，不做任何压缩工作。
+ *
+ * 用法：
+ *   auto compressor = std::make_shared<eva::LogCompressor>();
+ *   rolling_appender->SetCompressor(compressor);  // 滚动出的历史文件自动压缩
+ *   compressor->Submit("app.log.old");            // 或手动提交任意已关闭的文件
+ */
+class LogCompressor {
+public:
+    using ptr = std::shared_ptr<LogCompressor>;
+
+    /**
+     * @brief 压缩完成回调
+     * @param[in] output 压缩结果所在的临时文件
+     * @param[in] ok 是否成功，失败时临时文件已删除
+     */
+    using Callback = std::function<void(std::string const& output, bool ok)>;
+
+    explicit LogCompressor(LogCompressorOptions const& options = {});
+
+    /**
+     * @brief 析构函数，处理完已提交的任务后退出
+     */
+    ~LogCompressor();
+
+    LogCompressor(LogCompressor const&) = delete;
+    LogCompressor& operator=(LogCompressor const&) = delete;
+
+public:
+    /**
+     * @brief 提交一个已关闭的日志文件
+     * @details 在调用线程中打开源文件，之后源文件被改名也不影响压缩。
+     * 压缩结果先写入同目录下的临时文件并落盘，完成后调用 done；
+     * 不传 done 时，成功后把临时文件改名为 path + suffix 并删除源文件
+     * @return 源文件无法打开时返回 false
+     */
+    bool Submit(std::string const& path, Callback done = {});
+
+    /**
+     * @brief 等待已提交的任务全部完成
+     */
+    void Wait();
+
+    std::string const& GetSuffix() const { return options_.suffix; }
+
+private:
+    struct Job {
+        int fd;              // 源文件
+        std::string output;  // 临时输出文件
+        Callback done;
+    };
+
+    void Run();
+
+    /**
+     * @brief 把 fd 的内容按块压缩写入 output
+     */
+    bool Compress(int fd, std::string const& output);
+
+private:
+    LogCompressorOptions options_;
+    std::mutex mtx_;
+    std::condition_variable cv_;       // 有新任务或停止
+    std::condition_variable idle_cv_;  // 任务全部完成
+    std::deque<Job> jobs_;             // 待压缩的任务
+    size_t running_{0};                // 正在压缩的任务数
+    uint64_t next_id_{0};              // 临时文件编号
+    bool stop_{false};
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * @brief .zlog 文件读取器
+ * @details Open 只读取文件尾和索引，数据块按需解压
+ */
+class LogArchiveReader {
+public:
+    LogArchiveReader() = default;
+
+    ~LogArchiveReader();
+
+    LogArchiveReader(LogArchiveReader const&) = delete;
+    LogArchiveReader& operator=(LogArchiveReader const&) = delete;
+
+public:
+    /**
+     * @brief 打开文件，校验文件头、文件尾并读入索引
+     */
+    bool Open(std::string const& filename);
+
+    std::vector<LogArchiveBlock> const& GetBlocks() const { return blocks_; }
+
+    /**
+     * @brief 解压第 index 块，追加到 out
+     */
+    bool ReadBlock(size_t index, std::string& out);
+
+    /**
+     * @brief 解压与时间范围 [from, to](UTC 秒)有交集的块，追加到 out
+     * @details 时间无法解析的块总是包含在内；结果以块为粒度，首尾块中可能有范围外的行
+     */
+    bool ReadRange(int64_t from, int64_t to, std::string& out);
+
+private:
+    int fd_{-1};
+    std::vector<LogArchiveBlock> blocks_;
+};
+
+}  // namespace eva
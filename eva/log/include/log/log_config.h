@@ -0,0 +1,127 @@
+#pragma once
+
+#include <log/async_appender.h>
+#include <log/log.h>
+#include <log/rolling_appender.h>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace eva {
+
+/**
+ * @brief 一个 appender 的配置
+ */
+struct LogAppenderConfig {
+    enum class Type {
+        STDOUT,   // StdoutLogAppender
+        FILE,     // FileLogAppender
+        ROLLING,  // RollingFileLogAppender
+        ASYNC     // AsyncLogAppender，包装 sinks 中的 appender
+    };
+
+    Type type{Type::STDOUT};
+    std::string pattern;  // 格式模板，"json" 表示 JsonLogFormatter，空表示 appender 的默认格式
+
+    // FILE / ROLLING
+    std::string path;                 // 文件路径
+    FileDurabilityPolicy durability;  // FILE 的持久化策略
+    uint64_t max_size{64 << 20};      // ROLLING 单个文件的最大字节数
+    RollingFileLogAppender::RollInterval interval{RollingFileLogAppender::RollInterval::NONE};
+    size_t max_files{7};              // ROLLING 保留的历史文件个数
+    bool compress{false};             // ROLLING 是否压缩历史文件
+
+    // ASYNC
+    size_t capacity{8192};  // 队列容量
+    AsyncLogAppender::OverflowPolicy overflow{AsyncLogAppender::OverflowPolicy::BLOCK};
+    size_t batch_size{256};          // 后台线程每批最多处理的事件数
+    std::vector<std::string> sinks;  // 下游 appender 的名称
+
+    /**
+     * @brief 除格式和压缩以外的配置是否相同
+     * @details 只有格式或压缩不同时，重新加载复用原 appender 并原地替换格式器/压缩器，
+     * 否则需要新建 appender
+     */
+    bool SameOutput(LogAppenderConfig const& other) const;
+
+    bool operator==(LogAppenderConfig const&) const = default;
+};
+
+/**
+ * @brief 一个日志器的配置
+ */
+struct LoggerConfig {
+    std::optional<LogLevel::Level> level;  // 日志器级别，为空时继承父日志器
+    bool additive{true};                   // 是否同时输出到父日志器的 appender
+    LogLimitPolicy limit;                  // 调用点限流策略
+    std::vector<std::string> appenders;    // appender 的名称
+
+    bool operator==(LoggerConfig const&) const = default;
+};
+
+/**
+ * @brief 日志系统的完整配置：具名的 appender 和引用它们的日志器
+ * @details 日志器按名称中的 '.' 继承父日志器的级别和 appender(见 Logger)，
+ * 通常只需配置 root 和少数需要单独调整的模块。TOML 格式：
+ *
+ *   [appenders.console]
+ *   type = "stdout"                 # stdout | file | rolling | async
+ *   pattern = "%d [%p] %c %m%n"     # 可选，"json" 表示 JSON 格式
+ *
+ *   [appenders.app]
+ *   type = "rolling"
+ *   path = "logs/app.log"
+ *   max_size = 67108864             # 可选，默认 64MB
+ *   interval = "daily"              # 可选，none | hourly | daily
+ *   max_files = 7                   # 可选
+ *   compress = true                 # 可选，压缩历史文件
+ *
+ *   [appenders.audit]
+ *   type = "file"
+ *   path = "logs/audit.log"
+ *   flush_bytes = 65536             # 可选，以下同 FileDurabilityPolicy
+ *   flush_interval_ms = 1000
+ *   fsync_interval_ms = 0
+ *   sync_level = "error"
+ *
+ *   [appenders.async]
+ *   type = "async"
+ *   capacity = 8192                 # 可选
+ *   overflow = "drop_oldest"        # 可选，block | drop_newest | drop_oldest
+ *   batch_size = 256                # 可选
+ *   sinks = ["app"]
+ *
+  *   [loggers.root]
+ *   level = "info"                  # 可选，不设置时继承父日志器，root 为 info
+ *   appenders = ["console", "async"]
+ *
+ *   [loggers."db.pool"]
+ *   level = "debug"
+ *   appenders = ["audit"]
+ *   additive = false                # 可选，默认 true；false 时不输出到父日志器的 appender
+ *   limit = "every_sec"             # 可选，none | every_sec | every_n | backoff
+ *   limit_n = 100
+ *
+ * 未知的键、类型不符的值和无法识别的枚举值都视为错误
+ */
+struct LogConfig {
+    std::map<std::string, LogAppenderConfig> appenders;  // 名称 -> appender 配置
+    std::map<std::string, LoggerConfig> loggers;         // 日志器名称 -> 日志器配置
+
+    bool operator==(LogConfig const&) const = default;
+};
+
+/**
+ * @brief 解析 TOML 格式的日志配置
+ * @param[in] text 配置文本
+ * @param[out] config 解析结果
+ * @param[out] error 出错时的错误描述(含行号或配置项位置)
+ * @return 语法或取值有误时返回 false；引用关系等语义检查在 LoggerManager::ApplyConfig 中进行
+ */
+bool ParseLogConfig(std::string_view text, LogConfig& config, std::string& error);
+
+}  // namespace eva
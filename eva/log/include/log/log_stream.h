@@ -0,0 +1,254 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace eva {
+
+namespace detail {
+
+/**
+ * @brief 把 std::ostream 的输出转接到 BasicLogStream 的 streambuf
+ */
+template <typename Stream>
+class LogStreamBuf : public std::streambuf {
+public:
+    explicit LogStreamBuf(Stream& stream) : stream_(stream) {}
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            stream_.Append(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(char const* str, std::streamsize len) override {
+        stream_.Append(str, static_cast<size_t>(len));
+        return len;
+    }
+
+private:
+    Stream& stream_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief 轻量日志写入缓冲区
+ * @details 直接向字符缓冲区追加内容，前 N 字节使用内联存储，超出后溢出到堆上；
+ * 整数和浮点数通过 std::to_chars 格式化，不经过 std::ostream 的 locale/虚函数开销。
+ * Clear 只重置长度，不释放已溢出的堆内存，因此反复复用同一个对象不会再分配。
+ * @tparam N 内联存储字节数
+ */
+template <size_t N>
+class BasicLogStream {
+public:
+    BasicLogStream() = default;
+
+    ~BasicLogStream() {
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+    }
+
+    BasicLogStream(BasicLogStream const& other) { Append(other.data_, other.size_); }
+
+    BasicLogStream& operator=(BasicLogStream const& other) {
+        if (this != &other) {
+            size_ = 0;
+            Append(other.data_, other.size_);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 移动时若对方使用堆内存则交换缓冲区，这样缓冲区在对象间流转，不会反复分配
+     */
+    BasicLogStream(BasicLogStream&& other) noexcept { *this = std::move(other); }
+
+    BasicLogStream& operator=(BasicLogStream&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.data_ == other.inline_) {
+            size_ = 0;
+            Append(other.data_, other.size_);
+        } else if (data_ == inline_) {
+            // 接管对方的堆内存，对方退回内联存储
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_;
+            other.capacity_ = N;
+        } else {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+        }
+        other.size_ = 0;
+        return *this;
+    }
+
+public:
+    void Append(char const* str, size_t len) {
+        if (size_ + len > capacity_) {
+            Grow(size_ + len);
+        }
+        std::memcpy(data_ + size_, str, len);
+        size_ += len;
+    }
+
+    void Append(std::string_view str) { Append(str.data(), str.size()); }
+
+    void Append(char c) {
+        if (size_ + 1 > capacity_) {
+            Grow(size_ + 1);
+        }
+        data_[size_++] = c;
+    }
+
+    /**
+     * @brief 预留 len 字节的可写空间并返回写入位置，写完后需调用 Commit 提交实际长度
+     */
+    char* Reserve(size_t len) {
+        if (size_ + len > capacity_) {
+            Grow(size_ + len);
+        }
+        return data_ + size_;
+    }
+
+    void Commit(size_t len) { size_ += len; }
+
+    void Clear() { size_ = 0; }
+
+public:
+    char const* Data() const { return data_; }
+
+    char* Data() { return data_; }
+
+    size_t Size() const { return size_; }
+
+    bool Empty() const { return size_ == 0; }
+
+    std::string_view View() const { return {data_, size_}; }
+
+    std::string Str() const { return std::string(data_, size_); }
+
+public:
+    BasicLogStream& operator<<(std::string_view str) {
+        Append(str);
+        return *this;
+    }
+
+    BasicLogStream& operator<<(std::string const& str) {
+        Append(str.data(), str.size());
+        return *this;
+    }
+
+    BasicLogStream& operator<<(char const* str) {
+        if (str) {
+            Append(str, std::strlen(str));
+        } else {
+            Append("(null)", 6);
+        }
+        return *this;
+    }
+
+    BasicLogStream& operator<<(char c) {
+        Append(c);
+        return *this;
+    }
+
+    BasicLogStream& operator<<(bool v) {
+        if (v) {
+            Append("true", 4);
+        } else {
+            Append("false", 5);
+        }
+        return *this;
+    }
+
+    template <typename T>
+        requires(std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>)
+    BasicLogStream& operator<<(T v) {
+        char* p = Reserve(24);
+        Commit(std::to_chars(p, p + 24, v).ptr - p);
+        return *this;
+    }
+
+    template <typename T>
+        requires std::is_floating_point_v<T>
+    BasicLogStream& operator<<(T v) {
+        char* p = Reserve(32);
+        Commit(std::to_chars(p, p + 32, v).ptr - p);
+        return *this;
+    }
+
+    BasicLogStream& operator<<(void const* ptr) {
+        Append("0x", 2);
+        char* p = Reserve(16);
+        Commit(std::to_chars(p, p + 16, reinterpret_cast<uintptr_t>(ptr), 16).ptr - p);
+        return *this;
+    }
+
+    /**
+     * @brief 兜底：其余只提供了 operator<<(std::ostream&, T) 的类型经由临时 ostream 写入
+     */
+    template <typename T>
+        requires(!std::is_arithmetic_v<T> && !std::is_pointer_v<T> &&
+                 !std::is_convertible_v<T const&, std::string_view> &&
+                 requires(std::ostream& os, T const& v) { os << v; })
+    BasicLogStream& operator<<(T const& v) {
+        detail::LogStreamBuf<BasicLogStream> buf{*this};
+        std::ostream os{&buf};
+        os << v;
+        return *this;
+    }
+
+    /**
+     * @brief 支持 std::endl 等 ostream 操纵符
+     */
+    BasicLogStream& operator<<(std::ostream& (*manip)(std::ostream&)) {
+        detail::LogStreamBuf<BasicLogStream> buf{*this};
+        std::ostream os{&buf};
+        manip(os);
+        return *this;
+    }
+
+private:
+    void Grow(size_t need) {
+        size_t cap = capacity_ * 2;
+        while (cap < need) {
+            cap *= 2;
+        }
+        char* buf = new char[cap];
+        std::memcpy(buf, data_, size_);
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+        data_ = buf;
+        capacity_ = cap;
+    }
+
+private:
+    char* data_{inline_};  // 当前存储(内联或堆)
+    size_t size_{0};       // 已写入字节数
+    size_t capacity_{N};   // 当前容量
+    char inline_[N];       // 内联存储
+};
+
+/**
+ * @brief 格式化一整行日志时使用的缓冲区
+ */
+using LogStream = BasicLogStream<4096>;
+
+}  // namespace eva
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <log/log.h>
+#include <log/log_compressor.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace eva {
+
+/**
+ * @brief 基于内存映射的滚动文件输出地
+ * @details 文件按 chunk_size 预分配并映射一段窗口，写日志只是把格式化好的文本
+ * memcpy 到映射区并推进写游标，窗口写满时才映射下一段，平时没有逐行的系统调用。
+ *
+ * 滚动规则：
+ *   - 按大小：当前文件写入量即将超过 max_file_size 时滚动(0 表示不限制)
+ *   - 按时间：跨过整点(HOURLY)或本地零点(DAILY)时滚动
+ * 滚动时当前文件重命名为 filename.1，原 filename.1 变为 filename.2，依此类推，
+ * 只保留最近 max_files 个历史文件。
+ *
+ * 设置 LogCompressor 后，滚动出的历史文件交给后台线程压缩为 filename.N + 后缀(默认 .zlog)，
+ * 轮换和保留规则同样作用于压缩后的文件。
+ *
+ * 外部轮转(如 logrotate 把文件移走)通过比较路径与已打开文件的 inode 检测，
+ * 每秒最多检查一次，不再定期关闭重开文件。
+ * 关闭文件时把预分配但未写入的尾部截掉；进程崩溃后再次打开时，
+ * 会去掉文件末尾残留的零字节再继续追加，保证文件内容干净；
+ * 安装了崩溃处理函数(InstallCrashHandler)时，崩溃现场就会截掉尾部并追加崩溃报告。
+ *
+ * 用法：
+ *   auto appender = std::make_shared<eva::RollingFileLogAppender>(
+ *       "app.log", 64 << 20, eva::RollingFileLogAppender::RollInterval::DAILY, 7);
+ *   logger->AddAppender(appender);
+ */
+class RollingFileLogAppender : public LogAppender, public CrashFlushable {
+public:
+    using ptr = std::shared_ptr<RollingFileLogAppender>;
+
+    /**
+     * @brief 按时间滚动的周期
+     */
+    enum class RollInterval {
+        NONE,    // 不按时间滚动
+        HOURLY,  // 每个整点
+        DAILY    // 每天本地零点
+    };
+
+    /**
+     * @brief 构造函数，打开(或恢复)日志文件
+     * @param[in] filename 文件路径
+     * @param[in] max_file_size 单个文件的最大字节数，0 表示不按大小滚动
+     * @param[in] interval 按时间滚动的周期
+     * @param[in] max_files 保留的历史文件个数
+     * @param[in] chunk_size 每次预分配并映射的字节数(向上取整为页大小的整数倍)
+     */
+    RollingFileLogAppender(std::string const& filename, uint64_t max_file_size = 64 << 20,
+                           RollInterval interval = RollInterval::NONE, size_t max_files = 7,
+                           size_t chunk_size = 4 << 20);
+
+    /**
+     * @brief 析构函数，截掉未写入的尾部并关闭文件
+     */
+    ~RollingFileLogAppender() override;
+
+public:
+    void Log(LogEvent const& event) override;
+
+    /**
+     * @brief 把映射区中已写入的数据异步刷回磁盘(msync MS_ASYNC)
+     */
+    void Flush();
+
+    /**
+     * @brief 当前文件已写入的字节数
+     */
+    uint64_t GetWrittenSize();
+
+    /**
+     * @brief 因文件无法打开或空间不足而丢弃的日志条数
+     */
+    uint64_t GetDroppedCount();
+
+    /**
+     * @brief 设置历史文件的后台压缩器，nullptr 表示不压缩
+     * @details 原子替换，不与写日志的线程争锁，从下一次滚动开始生效
+     */
+    void SetCompressor(LogCompressor::ptr compressor);
+
+    /**
+     * @brief 崩溃时截掉预分配的尾部，在写游标处追加崩溃报告并 fsync
+     * @details 映射区中的数据已经在页缓存里，进程退出不会丢失，只需落盘
+     */
+    void OnCrashFlush(char const* report, size_t len) noexcept override;
+
+private:
+    /**
+     * @brief 打开 filename_，恢复写游标并映射第一段窗口
+     * @param[in] now 当前时间，用于计算下一次按时间滚动的时刻
+     */
+    bool OpenFile(time_t now);
+
+    /**
+     * @brief 解除映射，截掉未写入的尾部并关闭文件
+     */
+    void CloseFile();
+
+    /**
+     * @brief 关闭当前文件，轮换历史文件后打开新文件
+     */
+    void Roll(time_t now);
+
+    /**
+     * @brief 把刚滚动出的 filename.1 提交给压缩器
+     */
+    void SubmitArchive(LogCompressor& compressor);
+
+    /**
+     * @brief 文件被外部移走或删除时重新打开
+     */
+    void CheckExternalRotation(time_t now);
+
+    /**
+     * @brief 为文件预分配磁盘块直到 end
+     */
+    bool Allocate(uint64_t end);
+
+    /**
+     * @brief 预分配并映射从 offset 开始的窗口
+     */
+    bool MapWindow(uint64_t offset);
+
+    /**
+     * @brief 把数据拷贝进映射区，跨窗口时依次映射下一段
+     * @details 要么整行写入，要么一个字节都不算写入：失败时 written_ 回到行首
+     */
+    bool Write(char const* data, size_t len);
+
+private:
+    std::string filename_;           // 文件路径
+    uint64_t max_file_size_;         // 单个文件最大字节数
+    RollInterval interval_;          // 按时间滚动的周期
+    size_t max_files_;               // 保留的历史文件个数
+    size_t chunk_size_;              // 每段映射窗口的大小
+    int fd_{-1};                     // 文件描述符
+    uint64_t dev_{0};                // 已打开文件的设备号
+    uint64_t ino_{0};                // 已打开文件的 inode
+    char* map_{nullptr};             // 当前映射窗口
+    uint64_t map_offset_{0};         // 窗口在文件中的起始偏移
+    uint64_t allocated_{0};          // 文件已预分配的大小
+    uint64_t written_{0};            // 写游标(文件中有效数据的长度)
+    time_t next_roll_time_{0};       // 下一次按时间滚动的时刻
+    time_t last_check_time_{0};      // 上次检查外部轮转的时间(秒)
+    uint64_t dropped_{0};            // 丢弃的日志条数
+
+    /**
+     * @brief 历史文件集合，与压缩完成回调共享，回调在压缩线程中把结果放到源文件当前的序号上
+     */
+    struct ArchiveSet;
+    std::shared_ptr<ArchiveSet> archives_;        // 历史文件集合
+    std::atomic<LogCompressor::ptr> compressor_;  // 历史文件压缩器(原子替换)
+};
+
+}  // namespace eva
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <log/log.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace eva {
+
+/**
+ * @brief 可作为模板参数的编译期字符串
+ */
+template <size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(char const (&str)[N]) { std::copy_n(str, N, data); }
+
+    constexpr size_t size() const { return N - 1; }
+
+    constexpr char operator[](size_t i) const { return data[i]; }
+};
+
+namespace detail {
+
+/**
+ * @brief 编译期解析出的模板项类型
+ * @details %T %n %% 在编译期直接合并进相邻的常规字符串
+ */
+enum class PatternTokenKind : char {
+    LITERAL,      // 常规字符串
+    DATE_TIME,    // d
+    SUB_SECOND,   // ms/us/ns，len 为小数位数
+    MESSAGE,      // m
+    LEVEL,        // p
+    LOGGER_NAME,  // c
+    ELAPSE,       // r
+    FILE_NAME,    // f
+    BASENAME,     // b
+    FUNCTION,     // M
+    LINE,         // l
+    THREAD_ID,    // t
+    FIBER_ID,     // F
+    THREAD_NAME,  // N
+    FIELDS,       // k
+};
+
+struct PatternToken {
+    PatternTokenKind kind{PatternTokenKind::LITERAL};
+    size_t pos{0};  // 在 pool 中的起始位置(常规字符串/日期格式)
+    size_t len{0};  // 长度
+};
+
+/**
+ * @brief 编译期解析结果
+ * @details pool 中存放转义后的常规字符串和以 '\0' 结尾的日期格式
+ */
+template <size_t N>
+struct ParsedPattern {
+    PatternToken tokens[N]{};
+    size_t count{0};
+    char pool[2 * N + 1]{};
+    size_t pool_size{0};
+
+    constexpr void AppendLiteral(char c) {
+        if (count == 0 || tokens[count - 1].kind != PatternTokenKind::LITERAL) {
+            tokens[count++] = PatternToken{PatternTokenKind::LITERAL, pool_size, 0};
+        }
+        pool[pool_size++] = c;
+        ++tokens[count - 1].len;
+    }
+
+    constexpr void AppendField(PatternTokenKind kind) { tokens[count++] = PatternToken{kind, 0, 0}; }
+};
+
+/**
+ * @brief 编译期解析格式模板，语法与 LogFormatter::Init 一致
+ * @details 模板非法(未知模板项、%d 的大括号未闭合)时，consteval 求值失败，直接编译报错
+ */
+template <size_t N>
+consteval ParsedPattern<N> ParsePattern(FixedString<N> const& pattern) {
+    ParsedPattern<N> parsed;
+    size_t const size = pattern.size();
+    size_t i = 0;
+    while (i < size) {
+        char c = pattern[i++];
+        if (c != '%') {
+            parsed.AppendLiteral(c);
+            continue;
+        }
+        if (i >= size) {
+            break;  // 结尾处单独的 %，与运行时解析一致，直接忽略
+        }
+        c = pattern[i++];
+        // %ms %us %ns 是两个字符的模板项，优先匹配
+        if ((c == 'm' || c == 'u' || c == 'n') && i < size && pattern[i] == 's') {
+            ++i;
+            size_t digits = c == 'm' ? 3 : (c == 'u' ? 6 : 9);
+            parsed.tokens[parsed.count++] = PatternToken{PatternTokenKind::SUB_SECOND, 0, digits};
+            continue;
+        }
+        switch (c) {
+            case '%':
+                parsed.AppendLiteral('%');
+                break;
+            case 'T':
+                parsed.AppendLiteral('\t');
+                break;
+            case 'n':
+                parsed.AppendLiteral('\n');
+                break;
+            case 'd': {
+                PatternToken tok{PatternTokenKind::DATE_TIME, parsed.pool_size, 0};
+                if (i < size && pattern[i] == '{') {
+                    ++i;
+                    while (i < size && pattern[i] != '}') {
+                        parsed.pool[parsed.pool_size++] = pattern[i++];
+                    }
+                    if (i >= size) {
+                        throw "LogFormatter pattern: '{' not closed";
+                    }
+                    ++i;
+                }
+                tok.len = parsed.pool_size - tok.pos;
+                if (tok.len == 0) {
+                    // 空日期格式，使用默认格式
+                    for (char ch : "%Y-%m-%d %H:%M:%S") {
+                        if (ch) {
+                            parsed.pool[parsed.pool_size++] = ch;
+                        }
+                    }
+                    tok.len = parsed.pool_size - tok.pos;
+                }
+                parsed.pool[parsed.pool_size++] = '\0';
+                parsed.tokens[parsed.count++] = tok;
+                break;
+            }
+            case 'm':
+                parsed.AppendField(PatternTokenKind::MESSAGE);
+                break;
+            case 'p':
+                parsed.AppendField(PatternTokenKind::LEVEL);
+                break;
+            case 'c':
+                parsed.AppendField(PatternTokenKind::LOGGER_NAME);
+                break;
+            case 'r':
+                parsed.AppendField(PatternTokenKind::ELAPSE);
+                break;
+            case 'f':
+                parsed.AppendField(PatternTokenKind::FILE_NAME);
+                break;
+            case 'b':
+                parsed.AppendField(PatternTokenKind::BASENAME);
+                break;
+            case 'M':
+                parsed.AppendField(PatternTokenKind::FUNCTION);
+                break;
+            case 'l':
+                parsed.AppendField(PatternTokenKind::LINE);
+                break;
+            case 't':
+                parsed.AppendField(PatternTokenKind::THREAD_ID);
+                break;
+            case 'F':
+                parsed.AppendField(PatternTokenKind::FIBER_ID);
+                break;
+            case 'N':
+                parsed.AppendField(PatternTokenKind::THREAD_NAME);
+                break;
+            case 'k':
+                parsed.AppendField(PatternTokenKind::FIELDS);
+                break;
+            default:
+                throw "LogFormatter pattern: unknown format item";
+        }
+    }
+    return parsed;
+}
+
+}  // namespace detail
+
+/**
+ * @brief 编译期特化的日志格式器
+ * @details 格式模板为字面量时，在编译期完成解析，为每个模板项展开一段直线式的格式化代码，
+ * 直接写入字符缓冲区，没有 FormatItem 的堆分配和虚函数调用。
+ * 从配置加载的模板仍然使用运行时解析的 LogFormatter。
+ *
+ * 用法：
+ *   appender->SetFormatter(std::make_shared<eva::StaticLogFormatter<"%d [%p] %m%n">>());
+ */
+template <FixedString Pattern>
+class StaticLogFormatter : public LogFormatter {
+public:
+    using ptr = std::shared_ptr<StaticLogFormatter>;
+
+    StaticLogFormatter() : LogFormatter(Pattern.data, NoInit{}) {}
+
+public:
+    using LogFormatter::Format;
+
+    void Format(LogStream& stream, LogEvent const& event) override {
+        FormatImpl(stream, event, std::make_index_sequence<kParsed.count>{});
+    }
+
+private:
+    static constexpr detail::ParsedPattern<sizeof(Pattern.data)> kParsed =
+        detail::ParsePattern(Pattern);
+
+    template <size_t... I>
+    static void FormatImpl(LogStream& stream, LogEvent const& event, std::index_sequence<I...>) {
+        (FormatToken<I>(stream, event), ...);
+    }
+
+    template <size_t I>
+    static void FormatToken(LogStream& stream, LogEvent const& event) {
+        using Kind = detail::PatternTokenKind;
+        constexpr detail::PatternToken tok = kParsed.tokens[I];
+
+        if constexpr (tok.kind == Kind::LITERAL) {
+            stream.Append(kParsed.pool + tok.pos, tok.len);
+        } else if constexpr (tok.kind == Kind::DATE_TIME) {
+            // 日期格式位于静态存储中，地址唯一，直接作为缓存 key
+            char const* format = kParsed.pool + tok.pos;
+            AppendCachedDateTime(stream, reinterpret_cast<uintptr_t>(format), format,
+                                 event.GetTime());
+        } else if constexpr (tok.kind == Kind::SUB_SECOND) {
+            SubSecondFormatItem::Append(stream, event.GetTimeNs(), tok.len);
+        } else if constexpr (tok.kind == Kind::MESSAGE) {
+            stream << event.GetContent();
+        } else if constexpr (tok.kind == Kind::LEVEL) {
+            stream << LogLevel::ToStringView(event.GetLevel());
+        } else if constexpr (tok.kind == Kind::LOGGER_NAME) {
+            stream << event.GetLoggerName();
+        } else if constexpr (tok.kind == Kind::ELAPSE) {
+            stream << event.GetElapse();
+        } else if constexpr (tok.kind == Kind::FILE_NAME) {
+            stream << event.GetFile();
+        } else if constexpr (tok.kind == Kind::BASENAME) {
+            stream << event.GetBasename();
+        } else if constexpr (tok.kind == Kind::FUNCTION) {
+            stream << event.GetFunction();
+        } else if constexpr (tok.kind == Kind::LINE) {
+            stream << event.GetLine();
+        } else if constexpr (tok.kind == Kind::THREAD_ID) {
+            stream << event.GetThreadId();
+        } else if constexpr (tok.kind == Kind::FIBER_ID) {
+            stream << event.GetFiberId();
+        } else if constexpr (tok.kind == Kind::THREAD_NAME) {
+            stream << event.GetThreadName();
+        } else if constexpr (tok.kind == Kind::FIELDS) {
+            FieldsFormatItem::Append(stream, event);
+        }
+    }
+};
+
+/**
+ * @brief 默认格式模板对应的编译期格式器
+ */
+using DefaultStaticLogFormatter = StaticLogFormatter<LogFormatter::kDefaultPattern>;
+
+}  // namespace eva
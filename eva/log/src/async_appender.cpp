@@ -0,0 +1,170 @@
+#include <log/async_appender.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace eva {
+
+// ---------------- AsyncLogAppender 类 ----------------
+
+AsyncLogAppender::AsyncLogAppender(size_t capacity, OverflowPolicy policy, size_t batch_size)
+    : LogAppender(LogFormatter::ptr{new LogFormatter}),
+      queue_(capacity),
+      policy_(policy),
+      batch_size_(batch_size ? batch_size : 1) {
+    thread_ = std::thread{[this] { Run(); }};
+    RegisterCrashFlushable(this);
+}
+
+AsyncLogAppender::~AsyncLogAppender() {
+    UnregisterCrashFlushable(this);
+    stop_.store(true);
+    {
+        std::lock_guard lk{wait_mtx_};
+        cv_.notify_one();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AsyncLogAppender::Log(LogEvent const& event) {
+    if (queue_.TryPush(event)) {
+        Notify();
+        return;
+    }
+
+    // 队列已满
+    switch (policy_) {
+        case OverflowPolicy::DROP_NEWEST:
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+
+        case OverflowPolicy::DROP_OLDEST:
+            // 生产者自己弹出最旧的事件丢弃，再重试入队
+            do {
+                thread_local LogEvent t_oldest;
+                if (queue_.TryPop(t_oldest)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+            } while (!queue_.TryPush(event));
+            break;
+
+        case OverflowPolicy::BLOCK:
+            blocked_.fetch_add(1, std::memory_order_relaxed);
+            do {
+                Notify();
+                std::this_thread::yield();
+            } while (!queue_.TryPush(event));
+            break;
+    }
+    Notify();
+}
+
+void AsyncLogAppender::Flush() {
+    // 调用前入队的事件位置都小于它，按位置顺序出队，等到这个前缀全部写出
+    size_t target = queue_.EnqueuePos();
+    while (!IsDrainedTo(target)) {
+        Notify();
+        std::this_thread::yield();
+    }
+}
+
+void AsyncLogAppender::OnCrashDrain(uint64_t deadline_ns) noexcept {
+    if (static_cast<pid_t>(::syscall(SYS_gettid)) == thread_tid_.load()) {
+        return;
+    }
+    // 不能在信号处理函数中唤醒条件变量，后台线程睡眠最多 100ms 后会自己醒来
+    size_t target = queue_.EnqueuePos();
+    while (!IsDrainedTo(target)) {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (static_cast<uint64_t>(now.tv_sec) * 1000000000ULL +
+                static_cast<uint64_t>(now.tv_nsec) >=
+            deadline_ns) {
+            break;
+        }
+        timespec pause{0, 1000000};
+        nanosleep(&pause, nullptr);
+    }
+}
+
+void AsyncLogAppender::AddAppender(LogAppender::ptr appender) {
+    std::lock_guard lk{sinks_mtx_};  // NOTE: 加锁
+    sinks_.push_back(appender);
+}
+
+void AsyncLogAppender::DelAppender(LogAppender::ptr appender) {
+    std::lock_guard lk{sinks_mtx_};  // NOTE: 加锁
+    if (auto it{std::find(sinks_.begin(), sinks_.end(), appender)}; it != sinks_.end()) {
+        sinks_.erase(it);
+    }
+}
+
+void AsyncLogAppender::ClearAppenders() {
+    std::lock_guard lk{sinks_mtx_};  // NOTE: 加锁
+    sinks_.clear();
+}
+
+void AsyncLogAppender::Notify() {
+    // 只有后台线程真的在睡眠时才需要走一次系统调用
+    if (sleeping_.load()) {
+        std::lock_guard lk{wait_mtx_};
+        cv_.notify_one();
+    }
+}
+
+bool AsyncLogAppender::IsDrainedTo(size_t pos) const {
+    if (queue_.DequeuePos() < pos) {
+        return false;
+    }
+    // 与 Drain 中的栅栏配对：看到了后台线程取出的位置，也就看到它公布的批次起点
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return draining_.load(std::memory_order_acquire) >= pos;
+}
+
+size_t AsyncLogAppender::Drain() {
+    size_t n = 0;
+    {
+        // 一批事件只加一次锁
+        std::lock_guard lk{sinks_mtx_};
+        // 取出之前公布批次的起点，Flush 不会在这一批写完之前认为它前面的事件都已写出
+        draining_.store(queue_.DequeuePos(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (n < batch_size_ && queue_.TryPop(current_)) {
+            for (auto const& sink : sinks_) {
+                sink->Log(current_);
+            }
+            ++n;
+        }
+    }
+    draining_.store(kIdle, std::memory_order_release);
+    return n;
+}
+
+void AsyncLogAppender::Run() {
+    thread_tid_.store(GetThreadId());
+    while (true) {
+        if (Drain() > 0) {
+            continue;
+        }
+        if (stop_.load()) {
+            // 退出前把剩余事件写完
+            while (Drain() > 0) {
+            }
+            break;
+        }
+
+        // 队列为空，进入睡眠。先声明自己要睡了，再检查一次队列，避免丢失唤醒
+        std::unique_lock lk{wait_mtx_};
+        sleeping_.store(true);
+        if (queue_.SizeApprox() == 0 && !stop_.load()) {
+            // 超时兜底，即使唤醒丢失也能继续工作
+            cv_.wait_for(lk, std::chrono::milliseconds(100));
+        }
+        sleeping_.store(false);
+    }
+}
+
+}  // namespace eva
@@ -0,0 +1,648 @@
+#include <fcntl.h>
+#include <log/binary_log.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace eva {
+
+namespace detail {
+
+namespace {
+
+/**
+ * @brief 文件头记录，同时也是字典重置点(追加写入时每次 Open 都会写一个)
+ */
+constexpr uint8_t kFileHeaderType = 5;
+constexpr char kMagic[7] = {'E', 'V', 'A', 'B', 'L', 'O', 'G'};
+constexpr uint32_t kVersion = 2;
+
+/**
+ * @brief 事件记录固定部分：类型 + 调用点id + 日志器key + 时间戳 + 累计毫秒 + 线程id + 协程id +
+ * 参数长度
+ */
+constexpr size_t kEventHeaderSize = 1 + 4 + 8 + 8 + 4 + 4 + 8 + 4;
+
+struct SiteInfo {
+    LogLevel::Level level;
+    int32_t line;
+    std::string fmt;
+    std::string file;
+};
+
+/**
+ * @brief 二进制日志的全局状态，故意泄漏，保证静态析构阶段仍然可用
+ */
+struct BinaryLogState {
+    std::mutex mtx;                                       // 保护以下非原子成员
+    int fd{-1};                                           // 文件描述符
+    size_t buffer_size{1 << 20};                          // 每线程缓冲区大小
+    std::vector<std::shared_ptr<BinaryLogBuffer>> buffers;  // 所有线程缓冲区
+    std::deque<SiteInfo> sites;                           // 调用点注册表(下标即id)
+    std::thread writer;                                   // 后台写线程
+    std::atomic<bool> running{false};                     // 是否已打开
+    std::atomic<uint64_t> generation{0};                  // 每次 Open 加一，使旧的线程缓冲区失效
+    std::atomic<uint64_t> dropped{0};                     // 丢弃计数
+};
+
+BinaryLogState& State() {
+    static auto* state = new BinaryLogState;
+    return *state;
+}
+
+/**
+ * @brief 线程退出时标记缓冲区退役，由后台写线程写完后回收
+ */
+struct LocalBufferHolder {
+    std::shared_ptr<BinaryLogBuffer> buffer;
+
+    ~LocalBufferHolder() {
+        if (buffer) {
+            buffer->Retire();
+        }
+    }
+};
+
+thread_local BinaryLogBuffer* t_buffer = nullptr;
+thread_local uint64_t t_generation = 0;
+thread_local LocalBufferHolder t_holder;
+
+template <typename T>
+char* Put(char* p, T const& value) {
+    std::memcpy(p, &value, sizeof(T));
+    return p + sizeof(T);
+}
+
+char* PutString(char* p, std::string_view str) {
+    p = Put(p, static_cast<uint16_t>(str.size()));
+    std::memcpy(p, str.data(), str.size());
+    return p + str.size();
+}
+
+bool WriteAll(int fd, char const* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+}  // namespace
+
+// ---------------- BinaryLogBuffer 类 ----------------
+
+BinaryLogBuffer::BinaryLogBuffer(size_t capacity) : data_(new char[capacity]), capacity_(capacity) {}
+
+BinaryLogBuffer::~BinaryLogBuffer() { delete[] data_; }
+
+char* BinaryLogBuffer::Reserve(size_t len) {
+    size_t offset = head_ % capacity_;
+    size_t pad = offset + len > capacity_ ? capacity_ - offset : 0;
+    // 缓冲区满时等待后台线程写出(无损)；日志已关闭时不会再有人写出，放弃
+    while (head_ + pad + len - tail_.load(std::memory_order_acquire) > capacity_) {
+        if (IsRetired() || !State().running.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        std::this_thread::yield();
+    }
+    if (pad) {
+        std::memset(data_ + offset, static_cast<int>(BinaryRecordType::PAD), pad);
+        head_ += pad;
+    }
+    char* p = data_ + head_ % capacity_;
+    head_ += len;
+    return p;
+}
+
+char* BinaryLogBuffer::BeginEvent(uint32_t site_id, Logger const& logger, size_t payload) {
+    auto drop = []() -> char* {
+        State().dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    };
+    // 单条记录最多占缓冲区的 1/4，保证 Reserve 一定能等到足够空间
+    if (kEventHeaderSize + payload > capacity_ / 4) {
+        return drop();
+    }
+
+    // 本线程第一次写入：线程字典
+    if (head_ == 0) {
+        std::string_view name = GetThreadName();
+        char* p = Reserve(1 + 4 + 2 + name.size());
+        if (!p) {
+            return drop();
+        }
+        p = Put(p, BinaryRecordType::THREAD);
+        p = Put(p, static_cast<uint32_t>(GetThreadId()));
+        PutString(p, name);
+        Commit();
+    }
+
+    // 本线程第一次用到该调用点：调用点字典
+    if (site_id >= seen_sites_.size() || !seen_sites_[site_id]) {
+        SiteInfo site;
+        {
+            std::lock_guard lk{State().mtx};
+            site = State().sites[site_id];
+        }
+        std::string_view fmt{site.fmt.data(), std::min<size_t>(site.fmt.size(), UINT16_MAX)};
+        std::string_view file{site.file.data(), std::min<size_t>(site.file.size(), UINT16_MAX)};
+        char* p = Reserve(1 + 4 + 4 + 4 + 2 + fmt.size() + 2 + file.size());
+        if (!p) {
+            return drop();
+        }
+        p = Put(p, BinaryRecordType::SITE);
+        p = Put(p, site_id);
+        p = Put(p, static_cast<int32_t>(site.level));
+        p = Put(p, site.line);
+        p = PutString(p, fmt);
+        PutString(p, file);
+        Commit();
+        if (site_id >= seen_sites_.size()) {
+            seen_sites_.resize(site_id + 1, 0);
+        }
+        seen_sites_[site_id] = 1;
+    }
+
+    // 本线程第一次用到该日志器：日志器字典(以驻留名称的地址作为 key)
+    std::string const* name = &logger.GetName();
+    if (std::find(seen_loggers_.begin(), seen_loggers_.end(), name) == seen_loggers_.end()) {
+        std::string_view sv{name->data(), std::min<size_t>(name->size(), UINT16_MAX)};
+        char* p = Reserve(1 + 8 + 2 + sv.size());
+        if (!p) {
+            return drop();
+        }
+        p = Put(p, BinaryRecordType::LOGGER);
+        p = Put(p, reinterpret_cast<uint64_t>(name));
+        PutString(p, sv);
+        Commit();
+        seen_loggers_.push_back(name);
+    }
+
+    char* p = Reserve(kEventHeaderSize + payload);
+    if (!p) {
+        return drop();
+    }
+    p = Put(p, BinaryRecordType::EVENT);
+    p = Put(p, site_id);
+    p = Put(p, reinterpret_cast<uint64_t>(name));
+    p = Put(p, GetCurrentTimeNS());
+    p = Put(p, static_cast<uint32_t>(GetElapsedMS() - logger.GetCreateTime()));
+    p = Put(p, static_cast<uint32_t>(GetThreadId()));
+    p = Put(p, static_cast<uint64_t>(GetFiberId()));
+    p = Put(p, static_cast<uint32_t>(payload));
+    return p;
+}
+
+size_t BinaryLogBuffer::DrainTo(int fd) {
+    uint64_t head = head_pub_.load(std::memory_order_acquire);
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    size_t total = 0;
+    while (tail < head) {
+        size_t offset = tail % capacity_;
+        size_t len = std::min<uint64_t>(head - tail, capacity_ - offset);
+        WriteAll(fd, data_ + offset, len);
+        tail += len;
+        total += len;
+    }
+    tail_.store(tail, std::memory_order_release);
+    return total;
+}
+
+}  // namespace detail
+
+// ---------------- BinaryLog 类 ----------------
+
+namespace {
+
+/**
+ * @brief 把所有线程缓冲区写到文件，并回收已退出线程的缓冲区(调用方持有 mtx)
+ */
+size_t DrainAllLocked(detail::BinaryLogState& state) {
+    size_t total = 0;
+    auto& buffers = state.buffers;
+    for (auto it = buffers.begin(); it != buffers.end();) {
+        // 先读退役标记再写出，保证退役前发布的数据都已写完
+        bool retired = (*it)->IsRetired();
+        total += (*it)->DrainTo(state.fd);
+        if (retired && (*it)->Empty()) {
+            it = buffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return total;
+}
+
+void WriterLoop() {
+    auto& state = detail::State();
+    while (state.running.load(std::memory_order_acquire)) {
+        size_t n;
+        {
+            std::lock_guard lk{state.mtx};
+            n = DrainAllLocked(state);
+        }
+        if (n == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+/**
+ * @brief 崩溃时把各线程缓冲区中已发布的数据写出并落盘
+ * @details 只写出不回收(回收会释放内存)；拿不到锁时不写，避免和写线程同时推进读位置
+ */
+class BinaryLogCrashFlusher : public CrashFlushable {
+public:
+    void OnCrashFlush(char const* report, size_t len) noexcept override {
+        auto& state = detail::State();
+        if (!state.running.load(std::memory_order_acquire) || !CrashTryLock(state.mtx, 100)) {
+            return;
+        }
+        for (auto& buffer : state.buffers) {
+            buffer->DrainTo(state.fd);
+        }
+        ::fsync(state.fd);
+        state.mtx.unlock();
+    }
+};
+
+}  // namespace
+
+bool BinaryLog::Open(std::string const& filename, size_t buffer_size) {
+    Close();
+    auto& state = detail::State();
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cout << "[ERROR] BinaryLog::Open() open file " << filename << " error" << std::endl;
+        return false;
+    }
+    char header[1 + sizeof(detail::kMagic) + sizeof(detail::kVersion)];
+    char* p = detail::Put(header, detail::kFileHeaderType);
+    std::memcpy(p, detail::kMagic, sizeof(detail::kMagic));
+    detail::Put(p + sizeof(detail::kMagic), detail::kVersion);
+    detail::WriteAll(fd, header, sizeof(header));
+
+    std::lock_guard lk{state.mtx};
+    state.fd = fd;
+    state.buffer_size = std::max<size_t>(buffer_size, 4096);
+    state.generation.fetch_add(1, std::memory_order_relaxed);
+    state.running.store(true, std::memory_order_release);
+    state.writer = std::thread{WriterLoop};
+    // 故意泄漏，只注册一次
+    static auto* crash_flusher = [] {
+        auto* flusher = new BinaryLogCrashFlusher;
+        RegisterCrashFlushable(flusher);
+        return flusher;
+    }();
+    static_cast<void>(crash_flusher);
+    return true;
+}
+
+void BinaryLog::Close() {
+    auto& state = detail::State();
+    if (!state.running.exchange(false)) {
+        return;
+    }
+    if (state.writer.joinable()) {
+        state.writer.join();
+    }
+    std::lock_guard lk{state.mtx};
+    DrainAllLocked(state);
+    for (auto& buffer : state.buffers) {
+        buffer->Retire();
+    }
+    state.buffers.clear();
+    ::close(state.fd);
+    state.fd = -1;
+}
+
+void BinaryLog::Flush() {
+    auto& state = detail::State();
+    if (!state.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard lk{state.mtx};
+    DrainAllLocked(state);
+    ::fdatasync(state.fd);
+}
+
+uint32_t BinaryLog::RegisterSite(LogLevel::Level level, char const* fmt, char const* file,
+                                 int32_t line) {
+    auto& state = detail::State();
+    std::lock_guard lk{state.mtx};
+    state.sites.push_back(detail::SiteInfo{level, line, fmt ? fmt : "", file ? file : ""});
+    return static_cast<uint32_t>(state.sites.size() - 1);
+}
+
+uint64_t BinaryLog::GetDroppedCount() {
+    return detail::State().dropped.load(std::memory_order_relaxed);
+}
+
+detail::BinaryLogBuffer* BinaryLog::LocalBuffer() {
+    auto& state = detail::State();
+    if (!state.running.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    uint64_t generation = state.generation.load(std::memory_order_relaxed);
+    if (detail::t_buffer && detail::t_generation == generation) {
+        return detail::t_buffer;
+    }
+
+    // 慢路径：本线程第一次写入(或重新 Open 之后)，创建并登记缓冲区
+    std::shared_ptr<detail::BinaryLogBuffer> buffer;
+    {
+        std::lock_guard lk{state.mtx};
+        if (!state.running.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        buffer = std::make_shared<detail::BinaryLogBuffer>(state.buffer_size);
+        state.buffers.push_back(buffer);
+    }
+    if (detail::t_holder.buffer) {
+        detail::t_holder.buffer->Retire();
+    }
+    detail::t_holder.buffer = buffer;
+    detail::t_buffer = buffer.get();
+    detail::t_generation = generation;
+    return detail::t_buffer;
+}
+
+// ---------------- BinaryLogReader 类 ----------------
+
+bool BinaryLogReader::Open(std::string const& filename) {
+    std::ifstream in{filename, std::ios::binary};
+    if (!in) {
+        return false;
+    }
+    data_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    pos_ = 0;
+    corrupted_ = false;
+    // 文件必须以文件头开始
+    return !data_.empty() && static_cast<uint8_t>(data_[0]) == detail::kFileHeaderType;
+}
+
+bool BinaryLogReader::ReadString(std::string& str) {
+    uint16_t len;
+    if (!Read(len) || pos_ + len > data_.size()) {
+        return false;
+    }
+    str.assign(data_.data() + pos_, len);
+    pos_ += len;
+    return true;
+}
+
+bool BinaryLogReader::Next(LogEvent& event) {
+    while (pos_ < data_.size()) {
+        uint8_t type = static_cast<uint8_t>(data_[pos_++]);
+        bool ok = true;
+        switch (type) {
+            case static_cast<uint8_t>(detail::BinaryRecordType::PAD):
+                break;
+            case static_cast<uint8_t>(detail::BinaryRecordType::EVENT):
+                if (ReadEvent(event)) {
+                    return true;
+                }
+                ok = false;
+                break;
+            case static_cast<uint8_t>(detail::BinaryRecordType::SITE):
+            case static_cast<uint8_t>(detail::BinaryRecordType::LOGGER):
+            case static_cast<uint8_t>(detail::BinaryRecordType::THREAD):
+                ok = ReadDictionary(static_cast<detail::BinaryRecordType>(type));
+                break;
+            case detail::kFileHeaderType: {
+                uint32_t version;
+                ok = pos_ + sizeof(detail::kMagic) <= data_.size() &&
+                     std::memcmp(data_.data() + pos_, detail::kMagic, sizeof(detail::kMagic)) ==
+                         0;
+                pos_ += sizeof(detail::kMagic);
+                ok = ok && Read(version) && version == detail::kVersion;
+                // 新的一次 Open(可能来自另一个进程)，字典重新开始
+                sites_.clear();
+                loggers_.clear();
+                threads_.clear();
+                break;
+            }
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok) {
+            corrupted_ = true;
+            return false;
+        }
+    }
+    return false;
+}
+
+bool BinaryLogReader::ReadDictionary(detail::BinaryRecordType type) {
+    if (type == detail::BinaryRecordType::SITE) {
+        uint32_t id;
+        int32_t level;
+        Site site;
+        if (!Read(id) || !Read(level) || !Read(site.line) || !ReadString(site.fmt) ||
+            !ReadString(site.file)) {
+            return false;
+        }
+        site.level = static_cast<LogLevel::Level>(level);
+        Site& stored = sites_[id] = std::move(site);
+        // 字符串移动后地址可能变化，存入字典后再指向
+        stored.site = LogSite{stored.file.c_str(), LogSite::Basename(stored.file.c_str()), "",
+                              stored.line};
+    } else if (type == detail::BinaryRecordType::LOGGER) {
+        uint64_t key;
+        std::string name;
+        if (!Read(key) || !ReadString(name)) {
+            return false;
+        }
+        loggers_[key] = std::move(name);
+    } else {
+        uint32_t tid;
+        std::string name;
+        if (!Read(tid) || !ReadString(name)) {
+            return false;
+        }
+        threads_[tid] = std::move(name);
+    }
+    return true;
+}
+
+bool BinaryLogReader::ReadEvent(LogEvent& event) {
+    uint32_t site_id, elapse, tid, payload;
+    uint64_t logger_key, time_ns, fiber_id;
+    if (!Read(site_id) || !Read(logger_key) || !Read(time_ns) || !Read(elapse) || !Read(tid) ||
+        !Read(fiber_id) || !Read(payload) || pos_ + payload > data_.size()) {
+        return false;
+    }
+    char const* args = data_.data() + pos_;
+    pos_ += payload;
+
+    auto site = sites_.find(site_id);
+    auto logger = loggers_.find(logger_key);
+    if (site == sites_.end() || logger == loggers_.end()) {
+        return false;
+    }
+    auto thread = threads_.find(tid);
+    std::string_view thread_name = thread == threads_.end() ? "" : thread->second;
+
+    event.Reset(logger->second, site->second.level, site->second.site, elapse, tid, fiber_id,
+                time_ns, thread_name);
+    return RenderMessage(site->second.fmt, args, args + payload, event.GetStream());
+}
+
+bool BinaryLogReader::RenderMessage(std::string const& fmt, char const* args, char const* end,
+                                    LogEvent::MessageStream& out) {
+    struct Arg {
+        detail::BinaryArgType type;
+        int64_t i{0};
+        uint64_t u{0};
+        double f{0};
+        std::string_view s;
+    };
+
+    // 先解出全部参数
+    std::vector<Arg> values;
+    while (args < end) {
+        Arg arg;
+        arg.type = static_cast<detail::BinaryArgType>(*args++);
+        auto get = [&](auto& v) {
+            if (args + sizeof(v) > end) {
+                return false;
+            }
+            std::memcpy(&v, args, sizeof(v));
+            args += sizeof(v);
+            return true;
+        };
+        bool ok = true;
+        switch (arg.type) {
+            case detail::BinaryArgType::I64:
+                ok = get(arg.i);
+                arg.u = arg.i;
+                arg.f = arg.i;
+                break;
+            case detail::BinaryArgType::U64:
+            case detail::BinaryArgType::PTR:
+                ok = get(arg.u);
+                arg.i = arg.u;
+                arg.f = arg.u;
+                break;
+            case detail::BinaryArgType::F64:
+                ok = get(arg.f);
+                arg.i = static_cast<int64_t>(arg.f);
+                arg.u = arg.i;
+                break;
+            case detail::BinaryArgType::CHAR:
+            case detail::BinaryArgType::BOOL: {
+                uint8_t c;
+                ok = get(c);
+                arg.i = arg.u = c;
+                arg.f = c;
+                break;
+            }
+            case detail::BinaryArgType::STR: {
+                uint32_t len;
+                ok = get(len) && args + len <= end;
+                if (ok) {
+                    arg.s = std::string_view{args, len};
+                    args += len;
+                }
+                break;
+            }
+            default:
+                ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+        values.push_back(arg);
+    }
+
+    // 再按格式串逐个渲染：保留标志/宽度/精度，长度修饰符按实际参数类型重写
+    size_t next = 0;
+    char buf[512];
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] != '%') {
+            out << fmt[i];
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '%') {
+            out << '%';
+            ++i;
+            continue;
+        }
+        std::string spec{"%"};
+        size_t j = i + 1;
+        for (; j < fmt.size() && std::strchr("-+ #0123456789.*", fmt[j]); ++j) {
+            if (fmt[j] == '*') {
+                // 宽度/精度由参数给出
+                spec += next < values.size() ? std::to_string(values[next++].i) : "0";
+            } else {
+                spec += fmt[j];
+            }
+        }
+        while (j < fmt.size() && std::strchr("hlLqjzt", fmt[j])) {
+            ++j;
+        }
+        if (j >= fmt.size()) {
+            break;
+        }
+        char conv = fmt[j];
+        i = j;
+        if (next >= values.size()) {
+            out << "<missing>";
+            continue;
+        }
+        Arg const& arg = values[next++];
+
+        int n = 0;
+        if (arg.type == detail::BinaryArgType::STR) {
+            std::string str{arg.s};
+            n = std::snprintf(buf, sizeof(buf), (spec + 's').c_str(), str.c_str());
+            if (n >= static_cast<int>(sizeof(buf))) {
+                // 超长字符串直接输出
+                out << str;
+                continue;
+            }
+        } else if (std::strchr("diouxXc", conv)) {
+            if (conv == 'c') {
+                n = std::snprintf(buf, sizeof(buf), (spec + 'c').c_str(), static_cast<int>(arg.i));
+            } else if (conv == 'd' || conv == 'i') {
+                n = std::snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(),
+                                  static_cast<long long>(arg.i));
+            } else {
+                n = std::snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(),
+                                  static_cast<unsigned long long>(arg.u));
+            }
+        } else if (std::strchr("eEfFgGaA", conv)) {
+            n = std::snprintf(buf, sizeof(buf), (spec + conv).c_str(), arg.f);
+        } else if (conv == 'p') {
+            n = std::snprintf(buf, sizeof(buf), (spec + 'p').c_str(),
+                              reinterpret_cast<void*>(arg.u));
+        } else {
+            // %s 之类但参数不是字符串：按参数自身类型输出
+            if (arg.type == detail::BinaryArgType::F64) {
+                out << arg.f;
+            } else if (arg.type == detail::BinaryArgType::U64) {
+                out << arg.u;
+            } else {
+                out << arg.i;
+            }
+            continue;
+        }
+        out.Append(buf, std::min<size_t>(std::max(n, 0), sizeof(buf) - 1));
+    }
+    return true;
+}
+
+}  // namespace eva
@@ -0,0 +1,460 @@
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <fiber/fiber.h>
+#include <log/crash_handler.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <typeinfo>
+
+namespace eva {
+
+namespace {
+
+constexpr size_t kMaxCrashTargets = 64;   // 注册表容量
+constexpr int kMaxFrames = 64;            // 调用栈最大帧数
+constexpr size_t kAltStackSize = 1 << 16;  // 备用信号栈大小
+constexpr int kCrashSignals[] = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE};
+
+std::atomic<CrashFlushable*> g_targets[kMaxCrashTargets];
+std::atomic<bool> g_installed{false};
+std::atomic<pid_t> g_crash_tid{0};  // 正在处理崩溃的线程，0 表示没有
+CrashHandlerOptions g_options;
+int g_pipe[2] = {-1, -1};  // backtrace_symbols_fd 写入、再读回报告缓冲区
+alignas(16) char g_alt_stack[kAltStackSize];
+
+/**
+ * @brief 崩溃报告缓冲区，静态分配，信号处理函数中只做拷贝和整数转换
+ */
+class CrashReport {
+public:
+    void Append(char const* str, size_t len) {
+        len = std::min(len, sizeof(data_) - len_);
+        std::memcpy(data_ + len_, str, len);
+        len_ += len;
+    }
+
+    void Append(char const* str) { Append(str, strlen(str)); }
+
+    void AppendDec(uint64_t value, int width = 0) {
+        char buf[24];
+        int n = 0;
+        do {
+            buf[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0 || n < width);
+        while (n > 0) {
+            Append(&buf[--n], 1);
+        }
+    }
+
+    void AppendHex(uint64_t value) {
+        static constexpr char kHex[] = "0123456789abcdef";
+        char buf[18];
+        int n = 0;
+        do {
+            buf[n++] = kHex[value & 0xF];
+            value >>= 4;
+        } while (value != 0);
+        Append("0x", 2);
+        while (n > 0) {
+            Append(&buf[--n], 1);
+        }
+    }
+
+    /**
+     * @brief 读出管道中当前的全部数据
+     */
+    void AppendFrom(int fd) {
+        while (len_ < sizeof(data_)) {
+            ssize_t n = ::read(fd, data_ + len_, sizeof(data_) - len_);
+            if (n > 0) {
+                len_ += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                break;
+            }
+        }
+    }
+
+    char const* Data() const { return data_; }
+
+    size_t Size() const { return len_; }
+
+    void Clear() { len_ = 0; }
+
+private:
+    char data_[16384];
+    size_t len_{0};
+};
+
+CrashReport g_report;
+
+uint64_t ClockNS(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void SleepMS(uint32_t ms) {
+    timespec ts{static_cast<time_t>(ms / 1000), static_cast<long>(ms % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+void WriteAll(int fd, char const* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+/**
+ * @brief 追加 "YYYY-MM-DD HH:MM:SS.uuuuuu UTC"
+ * @details localtime_r/strftime 不是异步信号安全的，这里按公历规则自己换算(days_from_civil 的逆运算)
+ */
+void AppendUtcTime(CrashReport& report, uint64_t ns) {
+    int64_t seconds = static_cast<int64_t>(ns / 1000000000ULL);
+    int64_t days = seconds / 86400;
+    int64_t rem = seconds % 86400;
+
+    int64_t z = days + 719468;
+    int64_t era = z / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = yoe + era * 400 + (month <= 2);
+
+    report.AppendDec(static_cast<uint64_t>(year), 4);
+    report.Append("-");
+    report.AppendDec(static_cast<uint64_t>(month), 2);
+    report.Append("-");
+    report.AppendDec(static_cast<uint64_t>(day), 2);
+    report.Append(" ");
+    report.AppendDec(static_cast<uint64_t>(rem / 3600), 2);
+    report.Append(":");
+    report.AppendDec(static_cast<uint64_t>(rem / 60 % 60), 2);
+    report.Append(":");
+    report.AppendDec(static_cast<uint64_t>(rem % 60), 2);
+    report.Append(".");
+    report.AppendDec(ns % 1000000000ULL / 1000, 6);
+    report.Append(" UTC");
+}
+
+char const* SignalName(int sig) {
+    switch (sig) {
+        case SIGSEGV:
+            return "SIGSEGV";
+        case SIGABRT:
+            return "SIGABRT";
+        case SIGBUS:
+            return "SIGBUS";
+        case SIGFPE:
+            return "SIGFPE";
+        default:
+            return "signal";
+    }
+}
+
+/**
+ * @brief 报告头：时间、线程 id、FATAL，格式与默认格式器的列顺序一致，便于 grep
+ */
+void BeginReport(CrashReport& report) {
+    report.Clear();
+    AppendUtcTime(report, ClockNS(CLOCK_REALTIME));
+    report.Append("\t");
+    report.AppendDec(static_cast<uint64_t>(::syscall(SYS_gettid)));
+    report.Append("\t[FATAL]\t[crash]\t");
+}
+
+/**
+ * @brief 追加调用栈，跳过崩溃处理自身的帧
+ * @details 有出错指令地址时从它所在的帧开始，否则跳过最内层的 skip 帧(本函数是第 0 帧)。
+ * backtrace_symbols_fd 是异步信号安全的：每帧写入预先创建的非阻塞管道，再读回报告
+ */
+__attribute__((noinline)) void AppendBacktrace(CrashReport& report, void* fault_pc, int skip) {
+    void* frames[kMaxFrames];
+    int count = backtrace(frames, kMaxFrames);
+    int first = std::min(skip, count);
+    for (int i = 0; fault_pc && i < count; ++i) {
+        if (frames[i] == fault_pc) {
+            first = i;
+            break;
+        }
+    }
+    report.Append("backtrace:\n");
+    for (int i = first; i < count; ++i) {
+        report.Append("    #");
+        report.AppendDec(static_cast<uint64_t>(i - first));
+        report.Append(" ");
+        if (g_pipe[1] >= 0) {
+            backtrace_symbols_fd(&frames[i], 1, g_pipe[1]);
+            report.AppendFrom(g_pipe[0]);
+        } else {
+            report.AppendHex(reinterpret_cast<uintptr_t>(frames[i]));
+            report.Append("\n");
+        }
+    }
+}
+
+/**
+ * @brief 写出报告并让所有注册对象写出数据、落盘
+ */
+void FlushCrashTargets(CrashReport const& report) {
+    if (g_options.write_stderr) {
+        WriteAll(STDERR_FILENO, report.Data(), report.Size());
+    }
+    uint64_t deadline = ClockNS(CLOCK_MONOTONIC) + g_options.drain_timeout_ms * 1000000ULL;
+    for (auto& slot : g_targets) {
+        if (CrashFlushable* target = slot.load(std::memory_order_acquire)) {
+            target->OnCrashDrain(deadline);
+        }
+    }
+    for (auto& slot : g_targets) {
+        if (CrashFlushable* target = slot.load(std::memory_order_acquire)) {
+            target->OnCrashFlush(report.Data(), report.Size());
+        }
+    }
+}
+
+/**
+ * @brief 成为处理崩溃的线程
+ * @return 成功返回 true；当前线程已经在处理(处理过程中再次出错，或 terminate 之后的 abort)返回 false；
+ * 其他线程正在处理时不返回，等待那个线程结束进程
+ */
+bool EnterCrash() {
+    pid_t tid = static_cast<pid_t>(::syscall(SYS_gettid));
+    pid_t expected = 0;
+    if (g_crash_tid.compare_exchange_strong(expected, tid)) {
+        return true;
+    }
+    if (expected == tid) {
+        return false;
+    }
+    while (true) {
+        pause();
+    }
+}
+
+/**
+ * @brief 恢复默认处理方式并重新触发信号
+ * @details 信号在处理函数中被阻塞，返回后才递送，进程按默认方式终止(保留退出码和 core dump)；
+ * 硬件异常(SIGSEGV 等)返回后重新执行出错指令，同样以默认方式终止
+ */
+void ReraiseDefault(int sig) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_DFL;
+    sigemptyset(&action.sa_mask);
+    sigaction(sig, &action, nullptr);
+    raise(sig);
+}
+
+void* FaultPC(void* context) {
+    auto* uc = static_cast<ucontext_t*>(context);
+#if defined(__x86_64__)
+    return reinterpret_cast<void*>(uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+    return reinterpret_cast<void*>(uc->uc_mcontext.pc);
+#else
+    static_cast<void>(uc);
+    return nullptr;
+#endif
+}
+
+void CrashSignalHandler(int sig, siginfo_t* info, void* context) {
+    int saved_errno = errno;
+    if (EnterCrash()) {
+        CrashReport& report = g_report;
+        BeginReport(report);
+        uint64_t fiber_id = 0;
+        size_t stack_size = 0;
+        if ((sig == SIGSEGV || sig == SIGBUS) &&
+            Fiber::IsStackOverflow(info->si_addr, &fiber_id, &stack_size)) {
+            // 出错地址在协程栈的保护页上，指明是哪个协程
+            report.Append("fiber ");
+            report.AppendDec(fiber_id);
+            report.Append(" stack overflow (");
+            report.AppendDec(stack_size);
+            report.Append(" byte stack), ");
+        }
+        report.Append("received ");
+        report.Append(SignalName(sig));
+        report.Append(" (signal ");
+        report.AppendDec(static_cast<uint64_t>(sig));
+        report.Append(", code ");
+        report.AppendDec(static_cast<uint64_t>(static_cast<uint32_t>(info->si_code)));
+        report.Append(")");
+        if (sig != SIGABRT) {
+            report.Append(" at address ");
+            report.AppendHex(reinterpret_cast<uintptr_t>(info->si_addr));
+        }
+        report.Append("\n");
+        AppendBacktrace(report, context ? FaultPC(context) : nullptr, 0);
+        FlushCrashTargets(report);
+    }
+    ReraiseDefault(sig);
+    errno = saved_errno;
+}
+
+/**
+ * @brief std::terminate 处理函数
+ * @details 不在信号上下文中，可以取出未捕获异常的类型和 what()；之后与信号走同样的写出流程，
+ * 最后 abort，SIGABRT 处理函数发现本线程已经处理过，直接按默认方式终止
+ */
+[[noreturn]] void CrashTerminateHandler() {
+    if (EnterCrash()) {
+        CrashReport& report = g_report;
+        BeginReport(report);
+        report.Append("std::terminate called");
+        if (std::exception_ptr ep = std::current_exception()) {
+            report.Append(" after throwing an instance of '");
+            int status = 0;
+            std::type_info* type = abi::__cxa_current_exception_type();
+            char* name = type ? abi::__cxa_demangle(type->name(), nullptr, nullptr, &status) : nullptr;
+            report.Append(name ? name : (type ? type->name() : "unknown"));
+            free(name);
+            report.Append("'");
+            try {
+                std::rethrow_exception(ep);
+            } catch (std::exception const& e) {
+                report.Append(": ");
+                report.Append(e.what());
+            } catch (...) {
+            }
+        }
+        report.Append("\n");
+        AppendBacktrace(report, nullptr, 2);  // 跳过本函数和 AppendBacktrace
+        FlushCrashTargets(report);
+    }
+    ReraiseDefault(SIGABRT);
+    std::abort();
+}
+
+}  // namespace
+
+bool RegisterCrashFlushable(CrashFlushable* target) {
+    for (auto& slot : g_targets) {
+        CrashFlushable* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, target, std::memory_order_acq_rel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UnregisterCrashFlushable(CrashFlushable* target) {
+    for (auto& slot : g_targets) {
+        CrashFlushable* expected = target;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+bool CrashTryLock(std::mutex& mtx, uint32_t timeout_ms) {
+    for (uint32_t i = 0;; ++i) {
+        if (mtx.try_lock()) {
+            return true;
+        }
+        if (i >= timeout_ms) {
+            return false;
+        }
+        SleepMS(1);
+    }
+}
+
+void InstallCrashHandler(CrashHandlerOptions const& options) {
+    if (g_installed.exchange(true)) {
+        return;
+    }
+    g_options = options;
+
+    // 预先调用一次 backtrace：首次调用会加载 libgcc 并分配内存，不能发生在信号处理函数中
+    void* frames[kMaxFrames];
+    backtrace(frames, kMaxFrames);
+    if (pipe2(g_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        g_pipe[0] = g_pipe[1] = -1;
+    }
+
+    if (options.handle_signals) {
+        stack_t stack;
+        memset(&stack, 0, sizeof(stack));
+        stack.ss_sp = g_alt_stack;
+        stack.ss_size = sizeof(g_alt_stack);
+        sigaltstack(&stack, nullptr);
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = CrashSignalHandler;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        for (int sig : kCrashSignals) {
+            sigaction(sig, &action, nullptr);
+        }
+    }
+    if (options.handle_terminate) {
+        std::set_terminate(CrashTerminateHandler);
+    }
+}
+
+std::string FormatBacktrace(int skip) {
+    void* frames[kMaxFrames];
+    int count = backtrace(frames, kMaxFrames);
+    char** symbols = backtrace_symbols(frames, count);
+    std::string out;
+    for (int i = skip + 1; i < count; ++i) {
+        if (!out.empty()) {
+            out += '\n';
+        }
+        out += "    #";
+        out += std::to_string(i - skip - 1);
+        out += ' ';
+        std::string_view symbol = symbols ? symbols[i] : "";
+        // 形如 "module(mangled+0x1a) [0x...]"，把括号中的符号名还原
+        size_t open = symbol.find('(');
+        size_t plus = symbol.find('+', open);
+        if (open != std::string_view::npos && plus != std::string_view::npos && plus > open + 1) {
+            std::string mangled{symbol.substr(open + 1, plus - open - 1)};
+            int status = 0;
+            char* name = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+            out.append(symbol.substr(0, open + 1));
+            out += status == 0 && name ? name : mangled;
+            out.append(symbol.substr(plus));
+            free(name);
+        } else if (!symbol.empty()) {
+            out.append(symbol);
+        } else {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%p", frames[i]);
+            out += buf;
+        }
+    }
+    free(symbols);
+    return out;
+}
+
+}  // namespace eva
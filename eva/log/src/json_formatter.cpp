@@ -0,0 +1,204 @@
+#include <log/json_formatter.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EVA_JSON_X86 1
+#endif
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+
+namespace eva {
+
+namespace {
+
+/**
+ * @brief 每个字节的转义方式：0 不转义，'u' 输出 \u00XX，其余为反斜杠后的字符
+ */
+constexpr std::array<char, 256> MakeJsonEscapeTable() {
+    std::array<char, 256> table{};
+    for (int c = 0; c < 0x20; ++c) {
+        table[c] = 'u';
+    }
+    table['\b'] = 'b';
+    table['\f'] = 'f';
+    table['\n'] = 'n';
+    table['\r'] = 'r';
+    table['\t'] = 't';
+    table['"'] = '"';
+    table['\\'] = '\\';
+    return table;
+}
+
+constexpr std::array<char, 256> kJsonEscape = MakeJsonEscapeTable();
+
+/**
+ * @brief 返回第一个需要转义的字节的下标，没有则返回 n
+ */
+size_t FindJsonEscapeScalar(char const* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (kJsonEscape[static_cast<unsigned char>(p[i])]) {
+            return i;
+        }
+    }
+    return n;
+}
+
+#ifdef EVA_JSON_X86
+
+// 每次比较 16 字节：'"'、'\\'，以及无符号意义下 <= 0x1F 的控制字符(min(v, 0x1F) == v)
+size_t FindJsonEscapeSse2(char const* p, size_t n) {
+    __m128i const quote = _mm_set1_epi8('"');
+    __m128i const backslash = _mm_set1_epi8('\\');
+    __m128i const ctrl_max = _mm_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+        __m128i hit =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                         _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl_max), v));
+        if (int mask = _mm_movemask_epi8(hit)) {
+            return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+    return i + FindJsonEscapeScalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) size_t FindJsonEscapeAvx2(char const* p, size_t n) {
+    __m256i const quote = _mm256_set1_epi8('"');
+    __m256i const backslash = _mm256_set1_epi8('\\');
+    __m256i const ctrl_max = _mm256_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrl_max), v));
+        if (uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit))) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    // 尾部不调用 FindJsonEscapeSse2：非 VEX 编码的 SSE 指令紧跟在 AVX 之后有状态切换的开销，
+    // 在这里用 VEX 编码的 128 位指令再扫一段
+    if (i + 16 <= n) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm256_castsi256_si128(quote)),
+                         _mm_cmpeq_epi8(v, _mm256_castsi256_si128(backslash))),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, _mm256_castsi256_si128(ctrl_max)), v));
+        if (int mask = _mm_movemask_epi8(hit)) {
+            return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        i += 16;
+    }
+    return i + FindJsonEscapeScalar(p + i, n - i);
+}
+
+#endif
+
+using FindJsonEscapeFn = size_t (*)(char const*, size_t);
+
+FindJsonEscapeFn SelectFindJsonEscape() {
+#ifdef EVA_JSON_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return FindJsonEscapeAvx2;
+    }
+    return FindJsonEscapeSse2;
+#else
+    return FindJsonEscapeScalar;
+#endif
+}
+
+void AppendJsonString(LogStream& stream, std::string_view str) {
+    stream.Append('"');
+    AppendJsonEscaped(stream, str);
+    stream.Append('"');
+}
+
+/**
+ * @brief 追加 ISO 8601 格式的 UTC 时间，精确到微秒
+ * @details 每个线程缓存最近一秒的 "YYYY-MM-DDTHH:MM:SS"，秒数变化时才调用 gmtime_r
+ */
+void AppendJsonTime(LogStream& stream, uint64_t time_ns) {
+    thread_local time_t t_seconds = -1;
+    thread_local char t_buf[32];
+    thread_local size_t t_len = 0;
+
+    time_t seconds = static_cast<time_t>(time_ns / 1000000000ULL);
+    if (seconds != t_seconds) {
+        tm tm;
+        gmtime_r(&seconds, &tm);
+        t_len = strftime(t_buf, sizeof(t_buf), "%Y-%m-%dT%H:%M:%S", &tm);
+        t_seconds = seconds;
+    }
+    stream.Append(t_buf, t_len);
+    stream.Append('.');
+    SubSecondFormatItem::Append(stream, time_ns, 6);
+    stream.Append('Z');
+}
+
+}  // namespace
+
+void AppendJsonEscaped(LogStream& stream, std::string_view str) {
+    static FindJsonEscapeFn const find_escape = SelectFindJsonEscape();
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    while (!str.empty()) {
+        size_t i = find_escape(str.data(), str.size());
+        stream.Append(str.data(), i);
+        if (i == str.size()) {
+            break;
+        }
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        char escape = kJsonEscape[c];
+        if (escape == 'u') {
+            char buf[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+            stream.Append(buf, sizeof(buf));
+        } else {
+            char buf[2] = {'\\', escape};
+            stream.Append(buf, sizeof(buf));
+        }
+        str.remove_prefix(i + 1);
+    }
+}
+
+// ---------------- JsonLogFormatter 类 ----------------
+
+void JsonLogFormatter::Format(LogStream& stream, LogEvent const& event) {
+    using namespace std::string_view_literals;
+    stream << "{\"time\":\""sv;
+    AppendJsonTime(stream, event.GetTimeNs());
+    stream << "\",\"level\":\""sv;
+    stream << LogLevel::ToStringView(event.GetLevel());
+    stream << "\",\"logger\":"sv;
+    AppendJsonString(stream, event.GetLoggerName());
+    stream << ",\"file\":"sv;
+    AppendJsonString(stream, event.GetFile() ? event.GetFile() : "");
+    stream << ",\"line\":"sv;
+    stream << event.GetLine();
+    stream << ",\"thread_id\":"sv;
+    stream << event.GetThreadId();
+    stream << ",\"thread_name\":"sv;
+    AppendJsonString(stream, event.GetThreadName());
+    stream << ",\"fiber_id\":"sv;
+    stream << event.GetFiberId();
+    stream << ",\"elapse_ms\":"sv;
+    stream << event.GetElapse();
+    stream << ",\"message\":"sv;
+    AppendJsonString(stream, event.GetContent());
+    event.ForEachField([&stream](LogEvent::Field const& field) {
+        stream.Append(',');
+        AppendJsonString(stream, field.key);
+        stream.Append(':');
+        if (field.quoted) {
+            AppendJsonString(stream, field.value);
+        } else {
+            stream << field.value;
+        }
+    });
+    stream << "}\n"sv;
+}
+
+}  // namespace eva
@@ -1,29 +1,165 @@
+#include <fcntl.h>
 #include <log/log.h>
+#include <log/static_formatter.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <cerrno>
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <set>
+#include <unordered_set>
 
 namespace eva {
 
+namespace {
+
+/**
+ * @brief 日志器名称驻留表
+ * @details 名称一旦驻留就不再释放，日志事件可以只保存 string_view 而不拷贝名称；
+ * 故意泄漏，保证静态析构阶段仍然可用
+ */
+std::string const* InternLoggerName(std::string const& name) {
+    static std::mutex* mtx = new std::mutex;
+    static auto* names = new std::unordered_set<std::string>;
+    std::lock_guard lk{*mtx};
+    return &*names->insert(name).first;
+}
+
+/**
+ * @brief 存活的文件输出地集合
+ * @details 挂在全局日志器上的 FileLogAppender 通常不会被析构，
+ * 进程正常退出时(atexit)由这里把它们缓冲区中的数据写出；故意泄漏，保证退出阶段仍然可用
+ */
+class FileAppenderRegistry {
+public:
+    static FileAppenderRegistry& Instance() {
+        static auto* registry = new FileAppenderRegistry;
+        return *registry;
+    }
+
+    void Add(FileLogAppender* appender) {
+        std::lock_guard lk{mtx_};
+        appenders_.push_back(appender);
+        if (!registered_) {
+            registered_ = true;
+            std::atexit([] { Instance().FlushAll(); });
+        }
+    }
+
+    void Remove(FileLogAppender* appender) {
+        std::lock_guard lk{mtx_};
+        appenders_.erase(std::remove(appenders_.begin(), appenders_.end(), appender),
+                         appenders_.end());
+    }
+
+    void FlushAll() {
+        std::lock_guard lk{mtx_};
+        for (FileLogAppender* appender : appenders_) {
+            appender->Flush();
+        }
+    }
+
+private:
+    std::mutex mtx_;
+    std::vector<FileLogAppender*> appenders_;
+    bool registered_{false};
+};
+
+}  // namespace
+
+/**
+ * @brief 线程局部的日志事件对象池(侵入式空闲链表)
+ * @details free_ 是平凡析构的线程局部变量，线程退出时由 reaper_ 的析构释放链表；
+ * 释放之后(其他线程局部对象析构时仍可能写日志)退化为直接 new/delete
+ */
+class LogEventPool {
+public:
+    static LogEvent* Acquire() {
+        if (free_) {
+            LogEvent* event = free_;
+            free_ = event->pool_next_;
+            return event;
+        }
+        // 取 reaper_ 的地址以触发其构造，保证线程退出时释放对象池
+        static_cast<void>(&reaper_);
+        return new LogEvent;
+    }
+
+    static void Release(LogEvent* event) {
+        if (reaped_) {
+            delete event;
+            return;
+        }
+        event->pool_next_ = free_;
+        free_ = event;
+    }
+
+private:
+    struct Reaper {
+        ~Reaper() {
+            while (free_) {
+                LogEvent* event = free_;
+                free_ = event->pool_next_;
+                delete event;
+            }
+            reaped_ = true;
+        }
+    };
+
+    static thread_local LogEvent* free_;
+    static thread_local bool reaped_;
+    static thread_local Reaper reaper_;
+};
+
+thread_local LogEvent* LogEventPool::free_ = nullptr;
+thread_local bool LogEventPool::reaped_ = false;
+thread_local LogEventPool::Reaper LogEventPool::reaper_;
+
 // ---------------- LogEvent 类 ----------------
-LogEvent::LogEvent(const std::string& logger_name, LogLevel::Level level, const char* file,
-                   int32_t line, int64_t elapse, uint32_t thread_id, uint64_t fiber_id,
-                   uint64_t time, const std::string& thread_name)
-    : level_(level),
-      file_(file),
-      line_(line),
-      elapse_(elapse),
-      thread_id_(thread_id),
-      fiber_id_(fiber_id),
-      time_(time),
-      thread_name_(thread_name),
-      logger_name_(logger_name) {}
+LogEvent::LogEvent(std::string_view logger_name, LogLevel::Level level, LogSite const& site,
+                   int64_t elapse, uint32_t thread_id, uint64_t fiber_id, uint64_t time_ns,
+                   std::string_view thread_name) {
+    Reset(logger_name, level, site, elapse, thread_id, fiber_id, time_ns, thread_name);
+}
+
+void LogEvent::Reset(std::string_view logger_name, LogLevel::Level level, LogSite const& site,
+                     int64_t elapse, uint32_t thread_id, uint64_t fiber_id, uint64_t time_ns,
+                     std::string_view thread_name) {
+    site_ = &site;
+    level_ = level;
+    elapse_ = elapse;
+    thread_id_ = thread_id;
+    fiber_id_ = fiber_id;
+    time_ns_ = time_ns;
+    logger_name_ = logger_name;
+    thread_name_ = thread_name;
+    ss_.Clear();
+    fields_.Clear();
+}
 
 void LogEvent::Printf(const char* fmt, ...) {
+    // 直接格式化进消息缓冲区：先按一个估计长度写，放不下再按实际长度重写一次
+    constexpr size_t kGuess = 256;
     va_list ap;
     va_start(ap, fmt);
-    vprintf(fmt, ap);
+    va_list retry;
+    va_copy(retry, ap);
+    char* p = ss_.Reserve(kGuess);
+    int n = vsnprintf(p, kGuess, fmt, ap);
+    if (n >= static_cast<int>(kGuess)) {
+        p = ss_.Reserve(n + 1);
+        vsnprintf(p, n + 1, fmt, retry);
+    }
+    if (n > 0) {
+        ss_.Commit(n);
+    }
+    va_end(retry);
     va_end(ap);
 }
 
@@ -70,6 +206,14 @@ void LogFormatter::Init() {
                 i++;
                 continue;
             } else {  // 模板字符，直接添加到patterns中，添加完成后，状态变为解析常规字符，%d特殊处理
+                // %ms %us %ns 是两个字符的模板项，优先匹配
+                if ((c == "m" || c == "u" || c == "n") && i + 1 < pattern_.size() &&
+                    pattern_[i + 1] == 's') {
+                    patterns.push_back(std::make_pair(1, c + "s"));
+                    parsing_string = true;
+                    i += 2;
+                    continue;
+                }
                 patterns.push_back(std::make_pair(1, c));
                 parsing_string = true;
 
@@ -119,13 +263,19 @@ void LogFormatter::Init() {
             XX(c, LoggerNameFormatItem),   // c:日志器名称
             XX(r, ElapseFormatItem),       // r:累计毫秒数
             XX(f, FileNameFormatItem),     // f:文件名
+            XX(b, BasenameFormatItem),     // b:不含目录的文件名
+            XX(M, FunctionFormatItem),     // M:函数名
             XX(l, LineFormatItem),         // l:行号
             XX(t, ThreadIdFormatItem),     // t:编程号
             XX(F, FiberIdFormatItem),      // F:协程号
             XX(N, ThreadNameFormatItem),   // N:线程名称
+            XX(k, FieldsFormatItem),       // k:结构化字段
             XX(%, PercentSignFormatItem),  // %:百分号
             XX(T, TabFormatItem),          // T:制表符
             XX(n, NewLineFormatItem),      // n:换行符
+            XX(ms, SubSecondFormatItem),   // ms:毫秒
+            XX(us, SubSecondFormatItem),   // us:微秒
+            XX(ns, SubSecondFormatItem),   // ns:纳秒
 #undef XX
         };
 
@@ -154,25 +304,82 @@ void LogFormatter::Init() {
     }
 }
 
-std::string LogFormatter::Format(LogEvent::ptr event) {
-    std::stringstream ss;
+void LogFormatter::Format(LogStream& stream, LogEvent const& event) {
     for (auto const& item : items_) {
-        item->Format(ss, event);
+        item->Format(stream, event);
     }
-    return ss.str();
 }
 
-std::ostream& LogFormatter::Format(std::ostream& os, LogEvent::ptr event) {
-    for (auto const& item : items_) {
-        item->Format(os, event);
+std::string LogFormatter::Format(LogEvent const& event) {
+    LogStream stream;
+    Format(stream, event);
+    return stream.Str();
+}
+
+std::ostream& LogFormatter::Format(std::ostream& os, LogEvent const& event) {
+    // 线程局部缓冲区，格式化完成后一次写入，避免逐项经过 ostream
+    thread_local LogStream t_stream;
+    t_stream.Clear();
+    Format(t_stream, event);
+    return os.write(t_stream.Data(), t_stream.Size());
+}
+
+// ---------------- 日期时间缓存 ----------------
+
+void AppendCachedDateTime(LogStream& stream, uintptr_t key, char const* format, time_t seconds) {
+    struct Entry {
+        uintptr_t key{0};
+        time_t seconds{-1};
+        size_t len{0};
+        char buf[64];
+    };
+    static constexpr size_t kEntries = 4;
+    thread_local Entry t_entries[kEntries];
+    thread_local size_t t_next_victim = 0;
+
+    for (auto& entry : t_entries) {
+        if (entry.key == key && entry.seconds == seconds) {
+            stream.Append(entry.buf, entry.len);
+            return;
+        }
+    }
+
+    // 未命中：优先复用同一 key 的槽位，否则轮流淘汰
+    Entry* slot = nullptr;
+    for (auto& entry : t_entries) {
+        if (entry.key == key) {
+            slot = &entry;
+            break;
+        }
+    }
+    if (!slot) {
+        slot = &t_entries[t_next_victim];
+        t_next_victim = (t_next_victim + 1) % kEntries;
     }
-    return os;
+
+    tm tm;
+    localtime_r(&seconds, &tm);
+    slot->key = key;
+    slot->seconds = seconds;
+    slot->len = strftime(slot->buf, sizeof(slot->buf), format, &tm);
+    stream.Append(slot->buf, slot->len);
 }
 
 // ---------------- LogAppender 类 ----------------
 
 LogAppender::LogAppender(LogFormatter::ptr default_formatter)
-    : default_formatter_(default_formatter) {}
+    : default_formatter_(default_formatter), active_formatter_(default_formatter_.get()) {}
+
+void LogAppender::SetFormatter(LogFormatter::ptr formatter) {
+    std::lock_guard lk{formatter_mtx_};
+    // 其他线程可能还在用旧格式器，不能在这里释放
+    if (formatter_) {
+        retired_formatters_.push_back(std::move(formatter_));
+    }
+    formatter_ = std::move(formatter);
+    active_formatter_.store(formatter_ ? formatter_.get() : default_formatter_.get(),
+                            std::memory_order_release);
+}
 
 // ---------------- StdoutLogAppender 类 ----------------
 
@@ -181,137 +388,580 @@ LogAppender::LogAppender(LogFormatter::ptr default_formatter)
 // 用一个默认构造函数的 LogFormatter 智能指针构造一个 LogAppender 基类对象
 //  Constructor for 'eva::StdoutLogAppender' must explicitly initialize the base class 'LogAppender'
 //  which does not have a default constructor
-StdoutLogAppender::StdoutLogAppender() : LogAppender(LogFormatter::ptr{new LogFormatter}) {}
+// 默认格式器使用编译期解析的默认模板
+StdoutLogAppender::StdoutLogAppender()
+    : LogAppender(LogFormatter::ptr{new DefaultStaticLogFormatter}) {}
 
-void StdoutLogAppender::Log(LogEvent::ptr event) {
-    if (formatter_) {
-        formatter_->Format(std::cout, event);
-    } else {
-        default_formatter_->Format(std::cout, event);
-    }
+void StdoutLogAppender::Log(LogEvent const& event) {
+    // NOTE: 格式化项不再输出 std::endl，这里显式刷新，保持逐行输出
+    ActiveFormatter().Format(std::cout, event).flush();
 }
 
 // ---------------- FileLogAppender 类 ----------------
 
-// LogFormatter 空构造函数意味着 default_formatter
-FileLogAppender::FileLogAppender(std::string const& filename)
-    : LogAppender(LogFormatter::ptr{new LogFormatter}), filename_(filename) {
-    Reopen();  // 重新打开？
+// 默认格式器使用编译期解析的默认模板
+FileLogAppender::FileLogAppender(std::string const& filename, FileDurabilityPolicy policy)
+    : LogAppender(LogFormatter::ptr{new DefaultStaticLogFormatter}),
+      filename_(filename),
+      policy_(policy) {
+    policy_.flush_bytes = std::max<size_t>(policy_.flush_bytes, 1);
+    pending_.reserve(kMaxPendingBuffers);
+    current_ = TakeBuffer();
+    {
+        std::lock_guard io{io_mtx_};
+        OpenFile();
+    }
     if (reopen_error_) {
         std::cout << "reopen file " << filename_ << " error" << std::endl;
     }
+    thread_ = std::thread{[this] { Run(); }};
+    FileAppenderRegistry::Instance().Add(this);
+    RegisterCrashFlushable(this);
 }
 
-void FileLogAppender::Log(LogEvent::ptr event) {
-    uint64_t now = event->GetTime();
-    // 如果一个日志事件距离上次写日志超过3秒，那就重新打开一次日志文件
-    if (now >= last_time_ + 3) {
-        Reopen();
-        if (reopen_error_) {
-            std::cout << "reopen file " << filename_ << " error" << std::endl;
+FileLogAppender::~FileLogAppender() {
+    UnregisterCrashFlushable(this);
+    FileAppenderRegistry::Instance().Remove(this);
+    {
+        std::lock_guard lk{mtx_};
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::lock_guard io{io_mtx_};
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void FileLogAppender::Log(LogEvent const& event) {
+    // 在锁外格式化
+    thread_local LogStream t_stream;
+    t_stream.Clear();
+    ActiveFormatter().Format(t_stream, event);
+
+    std::unique_lock lk{mtx_};
+    current_.append(t_stream.Data(), t_stream.Size());
+    if (event.GetLevel() >= std::min(policy_.sync_level, LogLevel::Level::FATAL)) {
+        // 高级别事件：调用线程立即提交并落盘后才返回
+        Commit(lk, true);
+        return;
+    }
+    if (current_.size() >= policy_.flush_bytes) {
+        pending_.push_back(std::move(current_));
+        current_ = TakeBuffer();
+        if (pending_.size() >= kMaxPendingBuffers) {
+            // 后台线程跟不上，调用方自己提交，限制内存占用
+            Commit(lk, false);
+        } else {
+            cv_.notify_one();
         }
-        last_time_ = now;
     }
-    if (reopen_error_) {
+}
+
+void FileLogAppender::Flush(bool sync) {
+    std::unique_lock lk{mtx_};
+    Commit(lk, sync);
+}
+
+bool FileLogAppender::Reopen() {
+    std::unique_lock lk{mtx_};
+    Commit(lk, false);
+    std::lock_guard io{io_mtx_};
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    return OpenFile();
+}
+
+void FileLogAppender::OnCrashFlush(char const* report, size_t len) noexcept {
+    // Commit 在 mtx_ 下取走缓冲区，拿到锁时 pending_ 和 current_ 中的数据一定还没写出；
+    // 再拿到 io_mtx_ 时也没有正在写出的批次(Commit 持有 io_mtx_ 直到写完)。
+    // 持锁的可能就是崩溃的线程，等不到锁时不加锁尽力写出，先写出正在写的批次的剩余部分
+    bool locked = CrashTryLock(mtx_, 100);
+    bool io_locked = CrashTryLock(io_mtx_, 100);
+    int fd = fd_;
+    if (fd >= 0) {
+        struct iovec iov[2 * kMaxPendingBuffers + 3];
+        int count = 0;
+        if (!io_locked) {
+            struct iovec const* inflight = inflight_.load(std::memory_order_acquire);
+            size_t inflight_count = inflight ? inflight_count_.load(std::memory_order_acquire) : 0;
+            for (size_t i = 0; i < inflight_count && i <= kMaxPendingBuffers; ++i) {
+                iov[count++] = inflight[i];
+            }
+        }
+        size_t pending = std::min(pending_.size(), kMaxPendingBuffers);
+        for (size_t i = 0; i < pending; ++i) {
+            iov[count++] = {pending_[i].data(), pending_[i].size()};
+        }
+        iov[count++] = {current_.data(), current_.size()};
+        iov[count++] = {const_cast<char*>(report), len};
+        // O_APPEND 下每次 writev 是一次原子追加，崩溃现场不再处理部分写
+        ::writev(fd, iov, count);
+        ::fsync(fd);
+    }
+    if (io_locked) {
+        io_mtx_.unlock();
+    }
+    if (locked) {
+        mtx_.unlock();
+    }
+}
+
+void FileLogAppender::Commit(std::unique_lock<std::mutex>& lk, bool sync) {
+    // 在持有 mtx_ 时取得 io_mtx_，保证各批数据按取出的顺序写入文件
+    std::string batch[kMaxPendingBuffers + 1];
+    size_t count = 0;
+    for (auto& buffer : pending_) {
+        batch[count++] = std::move(buffer);
+    }
+    pending_.clear();
+    if (!current_.empty()) {
+        batch[count++] = std::move(current_);
+        current_ = TakeBuffer();
+    }
+    if (count == 0 && !sync) {
         return;
     }
-    // 这里的🔒不确定
-    std::lock_guard lk{mtx_};
 
-    // 如果有自定义的 formatter
-    if (formatter_) {
-        if (!formatter_->Format(filestream_, event)) {
-            std::cout << "[ERROR] FileLogAppender::log() format error" << std::endl;
+    std::unique_lock io{io_mtx_};
+    lk.unlock();
+
+    // 一次 writev 提交整批数据，处理部分写
+    struct iovec iov[kMaxPendingBuffers + 1];
+    size_t first = 0;
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = batch[i].data();
+        iov[i].iov_len = batch[i].size();
+    }
+    while (fd_ >= 0 && first < count) {
+        inflight_count_.store(count - first, std::memory_order_relaxed);
+        inflight_.store(iov + first, std::memory_order_release);
+        ssize_t n = ::writev(fd_, iov + first, static_cast<int>(count - first));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cout << "[ERROR] FileLogAppender::Commit() writev error: " << strerror(errno)
+                      << std::endl;
+            break;
+        }
+        dirty_ = true;
+        while (first < count && static_cast<size_t>(n) >= iov[first].iov_len) {
+            n -= static_cast<ssize_t>(iov[first].iov_len);
+            ++first;
+        }
+        if (first < count) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + n;
+            iov[first].iov_len -= static_cast<size_t>(n);
         }
     }
-    // 默认 default_formatter
-    else {
-        if (!default_formatter_->Format(filestream_, event)) {
-            std::cout << "[ERROR] FileLogAppender::log() format error" << std::endl;
+    inflight_.store(nullptr, std::memory_order_release);
+    if (sync && dirty_ && fd_ >= 0) {
+        ::fdatasync(fd_);
+        dirty_ = false;
+    }
+    io.unlock();
+
+    // 缓冲区放回空闲列表复用，稳态下不再分配内存
+    lk.lock();
+    for (size_t i = 0; i < count; ++i) {
+        batch[i].clear();
+        if (spare_.size() < kMaxPendingBuffers) {
+            spare_.push_back(std::move(batch[i]));
         }
     }
 }
 
-bool FileLogAppender::Reopen() {
-    std::lock_guard lk{mtx_};
-    if (filestream_) {
-        filestream_.close();
+bool FileLogAppender::OpenFile() {
+    fd_ = ::open(filename_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    reopen_error_ = fd_ < 0 || fstat(fd_, &st) != 0;
+    if (!reopen_error_) {
+        dev_ = st.st_dev;
+        ino_ = st.st_ino;
     }
-    filestream_.open(filename_, std::ios::app);
-    reopen_error_ = !filestream_;
     return !reopen_error_;
 }
 
+std::string FileLogAppender::TakeBuffer() {
+    if (spare_.empty()) {
+        std::string buffer;
+        buffer.reserve(policy_.flush_bytes + 4096);  // 留出余量，最后一行超出阈值时不必扩容
+        return buffer;
+    }
+    std::string buffer{std::move(spare_.back())};
+    spare_.pop_back();
+    return buffer;
+}
+
+void FileLogAppender::Run() {
+    using Clock = std::chrono::steady_clock;
+    // 唤醒周期取各个时间间隔中最短的一个，至少每秒醒来一次检查文件是否被移走
+    uint32_t tick_ms = 1000;
+    for (uint32_t interval : {policy_.flush_interval_ms, policy_.fsync_interval_ms}) {
+        if (interval) {
+            tick_ms = std::min(tick_ms, interval);
+        }
+    }
+    Clock::time_point last_flush = Clock::now();
+    Clock::time_point last_fsync = last_flush;
+    Clock::time_point last_check = last_flush;
+
+    std::unique_lock lk{mtx_};
+    while (!stop_) {
+        cv_.wait_for(lk, std::chrono::milliseconds(tick_ms),
+                     [this] { return stop_ || !pending_.empty(); });
+        Clock::time_point now = Clock::now();
+        bool fsync_due = policy_.fsync_interval_ms &&
+                         now - last_fsync >= std::chrono::milliseconds(policy_.fsync_interval_ms);
+        bool flush_due = policy_.flush_interval_ms &&
+                         now - last_flush >= std::chrono::milliseconds(policy_.flush_interval_ms);
+        if (!pending_.empty() || flush_due || fsync_due) {
+            Commit(lk, fsync_due);
+            last_flush = now;
+            if (fsync_due) {
+                last_fsync = now;
+            }
+        }
+
+        if (now - last_check >= std::chrono::seconds(1)) {
+            // 文件被外部移走或删除时重新打开，代替原先每 3 秒关闭重开。
+            // 刷盘线程本来就至少每秒醒来一次，顺带检查即可，不借用 TimerManager：
+            // 写日志的进程不一定运行 IOManager，不能为此要求一个调度器
+            last_check = now;
+            struct stat st;
+            if (stat(filename_.c_str(), &st) != 0 || static_cast<uint64_t>(st.st_dev) != dev_ ||
+                static_cast<uint64_t>(st.st_ino) != ino_) {
+                lk.unlock();
+                Reopen();
+                lk.lock();
+            }
+        }
+    }
+    // 退出前写出剩余数据
+    Commit(lk, policy_.fsync_interval_ms != 0);
+}
+
 // ---------------- Logger 类 ----------------
 
 // TODO: 这里 create_time 后续再添加
-// 日志器的默认等级 INFO
-Logger::Logger(std::string const& name)
-    : name_(name), level_(LogLevel::Level::INFO), create_time_(GetElapsedMS()) {}
+// 日志器默认不设置级别，没有父日志器时有效级别为 INFO
+Logger::Logger(std::string const& name, Logger* parent)
+    : name_(InternLoggerName(name)),
+      parent_(parent),
+      limit_(LogLimitPolicy::None()),
+      appenders_(std::make_shared<AppenderList const>()),
+      state_(std::make_shared<State const>(State{LogLevel::Level::INFO, true,
+                                                 LogLimitPolicy::None(),
+                                                 std::make_shared<AppenderList const>()})),
+      effective_level_(LogLevel::Level::INFO),
+      effective_limit_(LogLimitPolicy::None()),
+      create_time_(GetElapsedMS()) {
+    if (parent_) {
+        std::lock_guard lk{TreeMutex()};
+        parent_->children_.push_back(this);
+        Refresh();
+    }
+}
+
+Logger::~Logger() {
+    if (parent_) {
+        std::lock_guard lk{TreeMutex()};
+        std::erase(parent_->children_, this);
+    }
+}
+
+std::mutex& Logger::TreeMutex() {
+    static std::mutex mtx;
+    return mtx;
+}
+
+void Logger::Refresh() {
+    StateSnapshot parent{parent_ ? parent_->state_.load(std::memory_order_acquire) : nullptr};
+    StateBatch batch;
+    Resolve(parent.get(), batch);
+    Publish(batch);
+}
+
+void Logger::Resolve(State const* parent, StateBatch& out) {
+    AppenderSnapshot own{appenders_.load(std::memory_order_acquire)};
+    AppenderSnapshot effective{own};
+    if (parent && additive_) {
+        AppenderSnapshot const& inherited = parent->appenders;
+        if (own->empty()) {
+            effective = inherited;  // 没有自己的 appender 时与父日志器共用快照
+        } else if (!inherited->empty()) {
+            auto merged{std::make_shared<AppenderList>(*own)};
+            for (auto const& appender : *inherited) {
+                if (std::find(own->begin(), own->end(), appender) == own->end()) {
+                    merged->push_back(appender);
+                }
+            }
+            effective = std::move(merged);
+        }
+    }
+    LogLevel::Level level = level_ ? *level_ : (parent ? parent->level : LogLevel::Level::INFO);
+    auto state{
+        std::make_shared<State const>(State{level, additive_, limit_, std::move(effective)})};
+    State const* resolved = state.get();
+    out.emplace_back(this, std::move(state));
+    for (Logger* child : children_) {
+        child->Resolve(resolved, out);
+    }
+}
+
+void Logger::Publish(StateBatch const& batch) {
+    for (auto const& [logger, state] : batch) {
+        logger->state_.store(state, std::memory_order_release);
+        logger->effective_level_.store(state->level, std::memory_order_relaxed);
+        logger->effective_limit_.store(state->limit, std::memory_order_relaxed);
+    }
+}
+
+void Logger::Reconfigure(std::vector<std::pair<Logger*, Settings>> const& batch) {
+    std::lock_guard lk{TreeMutex()};
+    for (auto const& [logger, settings] : batch) {
+        logger->level_ = settings.level;
+        logger->additive_ = settings.additive;
+        logger->limit_ = settings.limit;
+        logger->appenders_.store(std::make_shared<AppenderList const>(settings.appenders),
+                                 std::memory_order_release);
+    }
+    // 只从最上层的日志器开始计算，子孙随之计算；全部算好之后再发布
+    std::set<Logger*> changed;
+    for (auto const& entry : batch) {
+        changed.insert(entry.first);
+    }
+    StateBatch resolved;
+    for (Logger* logger : changed) {
+        bool covered = false;
+        for (Logger* parent = logger->parent_; parent && !covered; parent = parent->parent_) {
+            covered = changed.contains(parent);
+        }
+        if (!covered) {
+            StateSnapshot parent{logger->parent_
+                                     ? logger->parent_->state_.load(std::memory_order_acquire)
+                                     : nullptr};
+            logger->Resolve(parent.get(), resolved);
+        }
+    }
+    Publish(resolved);
+}
+
+void Logger::SetLevel(LogLevel::Level level) {
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    level_ = level;
+    Refresh();
+}
+
+void Logger::ClearLevel() {
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    level_.reset();
+    Refresh();
+}
+
+bool Logger::HasLevel() const {
+    std::lock_guard lk{TreeMutex()};
+    return level_.has_value();
+}
+
+void Logger::SetAdditive(bool additive) {
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    additive_ = additive;
+    Refresh();
+}
+
+void Logger::SetLimitPolicy(LogLimitPolicy policy) {
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    limit_ = policy;
+    Refresh();
+}
 
 void Logger::AddAppender(LogAppender::ptr appender) {
-    std::lock_guard lk{mtx_};  // NOTE: 加锁
-    appenders_.push_back(appender);
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    auto next{std::make_shared<AppenderList>(*appenders_.load(std::memory_order_acquire))};
+    next->push_back(std::move(appender));
+    appenders_.store(std::move(next), std::memory_order_release);
+    Refresh();
 }
 
 void Logger::DelAppender(LogAppender::ptr appender) {
-    std::lock_guard lk{mtx_};  // NOTE: 加锁
-    if (auto it{std::find(appenders_.begin(), appenders_.end(), appender)};
-        it != appenders_.end()) {
-        appenders_.erase(it);
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    AppenderSnapshot current{appenders_.load(std::memory_order_acquire)};
+    auto it{std::find(current->begin(), current->end(), appender)};
+    if (it == current->end()) {
+        return;
     }
+    auto next{std::make_shared<AppenderList>(*current)};
+    next->erase(next->begin() + (it - current->begin()));
+    appenders_.store(std::move(next), std::memory_order_release);
+    Refresh();
 }
 
 void Logger::ClearAppenders() {
-    std::lock_guard lk{mtx_};  // NOTE: 加锁
-    appenders_.clear();
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    appenders_.store(std::make_shared<AppenderList const>(), std::memory_order_release);
+    Refresh();
+}
+
+void Logger::SetAppenders(AppenderList appenders) {
+    std::lock_guard lk{TreeMutex()};  // NOTE: 加锁，只串行化写者
+    appenders_.store(std::make_shared<AppenderList const>(std::move(appenders)),
+                     std::memory_order_release);
+    Refresh();
 }
 
 /**
- * 调用Logger的所有appenders将日志写一遍，
- * Logger至少要有一个appender，否则没有输出
+ * 调用Logger的所有有效appenders将日志写一遍，
+ * 自己和祖先都没有appender时没有输出
+ * 只原子地取一次有效状态的快照，级别和 appender 来自同一次发布，
+ * 与并发的 Add/Del/Clear、祖先的修改和 Reconfigure 互不干扰，不加锁也不等待
  */
-void Logger::Log(LogEvent::ptr event) {
-    if (event->GetLevel() >= level_) {
-        for (auto const& appender : appenders_) {
-            appender->Log(event);
+void Logger::Log(LogEvent const& event) {
+    StateSnapshot state{state_.load(std::memory_order_acquire)};
+    if (event.GetLevel() < state->level) {
+        return;
+    }
+    for (auto const& appender : *state->appenders) {
+        appender->Log(event);
+    }
+}
+
+// ---------------- LogLimiter 类 ----------------
+
+namespace {
+
+// 限流只需要毫秒级精度，粗粒度单调时钟走 vDSO 且比 CLOCK_MONOTONIC 更便宜
+int64_t MonotonicCoarseNS() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+bool LogLimiter::Admit(LogLimitPolicy policy) {
+    switch (policy.kind) {
+        case LogLimitPolicy::Kind::EVERY_SEC: {
+            // GCRA 形式的令牌桶：只维护一个理论到达时间，每放行一条推后 1s/n，
+            // 理论到达时间领先当前时间不超过 1s 即桶中还有令牌
+            constexpr int64_t kWindowNS = 1000000000;
+            int64_t const interval = kWindowNS / policy.n;
+            int64_t const now = MonotonicCoarseNS();
+            int64_t next = next_ns_.load(std::memory_order_relaxed);
+            while (true) {
+                int64_t updated = std::max(next, now) + interval;
+                if (updated - now > kWindowNS) {
+                    return false;
+                }
+                if (next_ns_.compare_exchange_weak(next, updated, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
         }
+        case LogLimitPolicy::Kind::EVERY_N:
+            return count_.fetch_add(1, std::memory_order_relaxed) % policy.n == 0;
+        case LogLimitPolicy::Kind::BACKOFF: {
+            uint64_t count = count_.fetch_add(1, std::memory_order_relaxed);
+            if (count < policy.n) {
+                return true;
+            }
+            // 之后只在第 2n、4n、8n... 次(从 0 计)放行
+            uint64_t round = count / policy.n;
+            return count % policy.n == 0 && round >= 2 && (round & (round - 1)) == 0;
+        }
+        case LogLimitPolicy::Kind::NONE:
+            break;
+    }
+    return true;
+}
+
+void LogLimiter::ReportSuppressed(Logger& logger, LogLevel::Level level, LogSite const& site) {
+    // 多个线程同时放行时只有取到非零值的那个输出汇总
+    uint64_t suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    if (suppressed != 0) {
+        LogEventWrap{logger, level, site}.GetStream()
+            << "suppressed " << suppressed << " messages from this call site";
     }
 }
 
 // ---------------- LogEventWrap 类 ----------------
 
-LogEventWrap::LogEventWrap(Logger::ptr logger, LogEvent::ptr event)
-    : logger_(logger), event_(event) {}
+LogEventWrap::LogEventWrap(Logger& logger, LogLevel::Level level, LogSite const& site)
+    : logger_(logger), event_(LogEventPool::Acquire()) {
+    event_->Reset(logger.GetName(), level, site, GetElapsedMS() - logger.GetCreateTime(),
+                  GetThreadId(), GetFiberId(), GetCurrentTimeNS(), GetThreadName());
+}
 
 // NOTE: LogEventWrap 在析构时写日志
-LogEventWrap::~LogEventWrap() { logger_->Log(event_); }
+LogEventWrap::~LogEventWrap() {
+    if (event_->GetLevel() >= LogLevel::Level::FATAL) [[unlikely]] {
+        // FATAL 事件附带调用栈，跳过本函数这一帧
+        event_->GetStream() << "\nbacktrace:\n" << FormatBacktrace(1);
+    }
+    logger_.Log(*event_);
+    LogEventPool::Release(event_);
+}
 
 // ---------------- LoggerManager 类 ----------------
 LoggerManager::LoggerManager() {
     // 默认创建一个 root 日志器
-    root_.reset(new Logger{"root"});
+    root_ = GetLogger("root");
     // 为默认日志器创建一个 StdoutLogAppender
     root_->AddAppender(LogAppender::ptr{new StdoutLogAppender});
-    loggers_[root_->GetName()] = root_;
     Init();
 }
 
-// TODO: 没写 LoggerManager::Init
-void LoggerManager::Init() {}
+void LoggerManager::Init() {
+    if (char const* path = getenv("EVA_LOG_CONFIG"); path && *path) {
+        WatchConfig(path);
+    }
+}
+
+LoggerManager::Node const* LoggerManager::Find(size_t hash, std::string_view name) const {
+    for (Node const* node = buckets_[hash & (kBucketCount - 1)].load(std::memory_order_acquire);
+         node; node = node->next) {
+        if (node->hash == hash && node->logger->GetName() == name) {
+            return node;
+        }
+    }
+    return nullptr;
+}
 
 /**
- * 如果指定名称的日志器未找到，那会就新创建一个，但是新创建的Logger是不带Appender的，
- * 需要手动添加Appender
+ * 如果指定名称的日志器未找到，那会就新创建一个，新创建的Logger不带Appender，
+ * 输出到祖先的Appender
  */
-Logger::ptr LoggerManager::GetLogger(std::string const& name) {
-    std::lock_guard lk{mtx_};  // NOTE: 加锁
-    if (loggers_.count(name)) {
-        return loggers_[name];
-    }
-    Logger::ptr logger{new Logger{name}};
-    loggers_[name] = logger;
-    return logger;
+Logger::ptr const& LoggerManager::GetLogger(std::string_view name) {
+    size_t hash = std::hash<std::string_view>{}(name);
+    if (Node const* node = Find(hash, name)) {
+        return node->logger;  // 快速路径：无锁
+    }
+
+    // 在加锁前创建父日志器：父日志器可能落在同一个分片上
+    Logger* parent = nullptr;
+    if (size_t dot = name.rfind('.'); dot != std::string_view::npos) {
+        parent = GetLogger(name.substr(0, dot)).get();
+    } else if (name != "root") {
+        parent = GetLogger("root").get();
+    }
+
+    std::lock_guard lk{mtx_[hash & (kShardCount - 1)]};  // NOTE: 加锁，只在创建时
+    // 加锁后再查一次，可能已被其他线程创建
+    if (Node const* node = Find(hash, name)) {
+        return node->logger;
+    }
+    std::atomic<Node*>& bucket = buckets_[hash & (kBucketCount - 1)];
+    // 节点故意不释放：管理器本身也不析构，查找方可以一直持有引用
+    Node* node = new Node{hash, Logger::ptr{new Logger{std::string{name}, parent}},
+                          bucket.load(std::memory_order_relaxed)};
+    bucket.store(node, std::memory_order_release);
+    return node->logger;
 }
 
 }  // namespace eva
@@ -0,0 +1,415 @@
+#include <fcntl.h>
+#include <log/log_compressor.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+namespace eva {
+
+namespace {
+
+constexpr char kArchiveMagic[4] = {'E', 'V', 'A', 'Z'};
+constexpr char kIndexMagic[4] = {'E', 'V', 'A', 'X'};
+constexpr uint32_t kArchiveVersion = 1;
+constexpr size_t kHeaderSize = 12;  // magic + version + block_size
+constexpr size_t kFooterSize = 16;  // index_offset + block_count + magic
+
+// 索引项按内存布局原样写盘
+static_assert(sizeof(LogArchiveBlock) == 40, "LogArchiveBlock must have no padding");
+
+// ioprio_set(2) 没有 glibc 封装
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassIdle = 3;
+constexpr int kIoprioClassShift = 13;
+
+bool WriteAll(int fd, void const* data, size_t len) {
+    char const* p = static_cast<char const*>(data);
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ReadAll(int fd, void* data, size_t len, uint64_t offset) {
+    char* p = static_cast<char*>(data);
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, static_cast<off_t>(offset));
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool ParseDigits(std::string_view str, size_t pos, size_t len, int& value) {
+    value = 0;
+    for (size_t i = pos; i < pos + len; ++i) {
+        if (str[i] < '0' || str[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (str[i] - '0');
+    }
+    return true;
+}
+
+/**
+ * @brief 解析行首的时间，返回 UTC 秒，无法解析时返回 0
+ * @details 支持默认文本格式的 "YYYY-MM-DD HH:MM:SS"(本地时间)
+ * 和 JsonLogFormatter 的 {"time":"YYYY-MM-DDTHH:MM:SS(UTC)
+ */
+int64_t ParseLineTime(std::string_view line) {
+    constexpr std::string_view kJsonPrefix = "{\"time\":\"";
+    bool utc = line.starts_with(kJsonPrefix);
+    if (utc) {
+        line.remove_prefix(kJsonPrefix.size());
+    }
+    if (line.size() < 19 || line[4] != '-' || line[7] != '-' ||
+        (line[10] != ' ' && line[10] != 'T') || line[13] != ':' || line[16] != ':') {
+        return 0;
+    }
+    tm tm{};
+    if (!ParseDigits(line, 0, 4, tm.tm_year) || !ParseDigits(line, 5, 2, tm.tm_mon) ||
+        !ParseDigits(line, 8, 2, tm.tm_mday) || !ParseDigits(line, 11, 2, tm.tm_hour) ||
+        !ParseDigits(line, 14, 2, tm.tm_min) || !ParseDigits(line, 17, 2, tm.tm_sec)) {
+        return 0;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    time_t t = utc ? timegm(&tm) : mktime(&tm);
+    return t < 0 ? 0 : static_cast<int64_t>(t);
+}
+
+/**
+ * @brief 块内最后一行的起始位置(块以换行结尾时不算最后的空串)
+ */
+std::string_view LastLine(std::string_view block) {
+    size_t end = block.size();
+    if (end > 0 && block[end - 1] == '\n') {
+        --end;
+    }
+    size_t begin = block.rfind('\n', end == 0 ? 0 : end - 1);
+    begin = begin == std::string_view::npos ? 0 : begin + 1;
+    return block.substr(begin, end - begin);
+}
+
+uint64_t ThreadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+}  // namespace
+
+// ---------------- LogCompressor 类 ----------------
+
+LogCompressor::LogCompressor(LogCompressorOptions const& options) : options_(options) {
+    options_.level = std::clamp(options_.level, 1, 9);
+    options_.block_size = std::clamp<size_t>(options_.block_size, 4096, 64 << 20);
+    options_.threads = std::max<size_t>(options_.threads, 1);
+    if (!(options_.cpu_limit > 0 && options_.cpu_limit <= 1)) {
+        options_.cpu_limit = 1;
+    }
+    for (size_t i = 0; i < options_.threads; ++i) {
+        threads_.emplace_back([this] { Run(); });
+    }
+}
+
+LogCompressor::~LogCompressor() {
+    {
+        std::lock_guard lk{mtx_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+bool LogCompressor::Submit(std::string const& path, Callback done) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cout << "[ERROR] open " << path << " for compression error: " << strerror(errno)
+                  << std::endl;
+        return false;
+    }
+    if (!done) {
+        done = [path, suffix = options_.suffix](std::string const& output, bool ok) {
+            if (ok && ::rename(output.c_str(), (path + suffix).c_str()) == 0) {
+                ::unlink(path.c_str());
+            }
+        };
+    }
+    {
+        std::lock_guard lk{mtx_};
+        std::string output = path + options_.suffix + ".tmp" + std::to_string(next_id_++);
+        jobs_.push_back(Job{fd, std::move(output), std::move(done)});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void LogCompressor::Wait() {
+    std::unique_lock lk{mtx_};
+    idle_cv_.wait(lk, [this] { return jobs_.empty() && running_ == 0; });
+}
+
+void LogCompressor::Run() {
+    SetThreadName("log_compress");
+    if (options_.idle_priority) {
+        // Linux 上 pid 0 表示调用线程：只在 CPU 空闲时调度，IO 也排在最后
+        sched_param param{};
+        sched_setscheduler(0, SCHED_IDLE, &param);
+        syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift);
+    }
+    if (!options_.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : options_.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    std::unique_lock lk{mtx_};
+    while (true) {
+        cv_.wait(lk, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+            return;  // stop_ 且任务已处理完
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        ++running_;
+        lk.unlock();
+
+        bool ok = Compress(job.fd, job.output);
+        ::close(job.fd);
+        if (!ok) {
+            ::unlink(job.output.c_str());
+        }
+        job.done(job.output, ok);
+
+        lk.lock();
+        --running_;
+        if (jobs_.empty() && running_ == 0) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+bool LogCompressor::Compress(int fd, std::string const& output) {
+    int out = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        std::cout << "[ERROR] open " << output << " error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    char header[kHeaderSize];
+    uint32_t block_size = static_cast<uint32_t>(options_.block_size);
+    std::memcpy(header, kArchiveMagic, 4);
+    std::memcpy(header + 4, &kArchiveVersion, 4);
+    std::memcpy(header + 8, &block_size, 4);
+    bool ok = WriteAll(out, header, sizeof(header));
+
+    std::vector<LogArchiveBlock> blocks;
+    std::string raw(options_.block_size, '\0');
+    std::string compressed;
+    uint64_t read_offset = 0;  // 源文件读取位置
+    uint64_t raw_offset = 0;   // 当前块在源文件中的偏移
+    uint64_t out_offset = kHeaderSize;
+    size_t filled = 0;  // raw 中已读入的字节数
+    bool eof = false;
+    while (ok) {
+        while (!eof && filled < raw.size()) {
+            ssize_t n = pread(fd, raw.data() + filled, raw.size() - filled,
+                              static_cast<off_t>(read_offset));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ok = false;
+                break;
+            }
+            eof = n == 0;
+            filled += static_cast<size_t>(n);
+            read_offset += static_cast<uint64_t>(n);
+        }
+        if (!ok || filled == 0) {
+            break;
+        }
+
+        // 块在最后一个换行处截断，剩余部分留给下一块；整块没有换行时整块压缩
+        size_t len = filled;
+        if (!eof) {
+            size_t newline = std::string_view{raw.data(), filled}.rfind('\n');
+            if (newline != std::string_view::npos) {
+                len = newline + 1;
+            }
+        }
+
+        uint64_t cpu_begin = ThreadCpuNs();
+        uLongf compressed_size = compressBound(static_cast<uLong>(len));
+        compressed.resize(compressed_size);
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                      reinterpret_cast<Bytef const*>(raw.data()), static_cast<uLong>(len),
+                      options_.level) != Z_OK) {
+            ok = false;
+            break;
+        }
+        std::string_view block{raw.data(), len};
+        blocks.push_back(LogArchiveBlock{out_offset, raw_offset,
+                                         static_cast<uint32_t>(compressed_size),
+                                         static_cast<uint32_t>(len), ParseLineTime(block),
+                                         ParseLineTime(LastLine(block))});
+        ok = WriteAll(out, compressed.data(), compressed_size);
+        out_offset += compressed_size;
+        raw_offset += len;
+        std::memmove(raw.data(), raw.data() + len, filled - len);
+        filled -= len;
+
+        // 按本块消耗的 CPU 时间休眠，使 CPU 占用不超过 cpu_limit
+        if (options_.cpu_limit < 1) {
+            double used = static_cast<double>(ThreadCpuNs() - cpu_begin);
+            std::this_thread::sleep_for(std::chrono::nanoseconds{
+                static_cast<int64_t>(used * (1 - options_.cpu_limit) / options_.cpu_limit)});
+        }
+    }
+
+    if (ok) {
+        char footer[kFooterSize];
+        uint32_t count = static_cast<uint32_t>(blocks.size());
+        std::memcpy(footer, &out_offset, 8);
+        std::memcpy(footer + 8, &count, 4);
+        std::memcpy(footer + 12, kIndexMagic, 4);
+        ok = WriteAll(out, blocks.data(), blocks.size() * sizeof(LogArchiveBlock)) &&
+             WriteAll(out, footer, sizeof(footer)) && fdatasync(out) == 0;
+    }
+    if (!ok) {
+        std::cout << "[ERROR] compress to " << output << " error: " << strerror(errno)
+                  << std::endl;
+    }
+    ::close(out);
+    return ok;
+}
+
+// ---------------- LogArchiveReader 类 ----------------
+
+LogArchiveReader::~LogArchiveReader() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool LogArchiveReader::Open(std::string const& filename) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    blocks_.clear();
+    fd_ = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<uint64_t>(st.st_size) < kHeaderSize + kFooterSize) {
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+
+    char header[kHeaderSize];
+    char footer[kFooterSize];
+    uint32_t version = 0;
+    if (!ReadAll(fd_, header, sizeof(header), 0) ||
+        !ReadAll(fd_, footer, sizeof(footer), size - kFooterSize) ||
+        std::memcmp(header, kArchiveMagic, 4) != 0 ||
+        std::memcmp(footer + 12, kIndexMagic, 4) != 0) {
+        return false;
+    }
+    std::memcpy(&version, header + 4, 4);
+    if (version != kArchiveVersion) {
+        return false;
+    }
+
+    uint64_t index_offset = 0;
+    uint32_t count = 0;
+    std::memcpy(&index_offset, footer, 8);
+    std::memcpy(&count, footer + 8, 4);
+    if (index_offset + uint64_t{count} * sizeof(LogArchiveBlock) + kFooterSize != size) {
+        return false;
+    }
+    blocks_.resize(count);
+    if (!ReadAll(fd_, blocks_.data(), count * sizeof(LogArchiveBlock), index_offset)) {
+        blocks_.clear();
+        return false;
+    }
+    for (auto const& block : blocks_) {
+        if (block.offset + block.compressed_size > index_offset) {
+            blocks_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LogArchiveReader::ReadBlock(size_t index, std::string& out) {
+    if (index >= blocks_.size()) {
+        return false;
+    }
+    LogArchiveBlock const& block = blocks_[index];
+    std::string compressed(block.compressed_size, '\0');
+    if (!ReadAll(fd_, compressed.data(), compressed.size(), block.offset)) {
+        return false;
+    }
+    size_t begin = out.size();
+    out.resize(begin + block.raw_size);
+    uLongf raw_size = block.raw_size;
+    if (uncompress(reinterpret_cast<Bytef*>(out.data() + begin), &raw_size,
+                   reinterpret_cast<Bytef const*>(compressed.data()),
+                   static_cast<uLong>(compressed.size())) != Z_OK ||
+        raw_size != block.raw_size) {
+        out.resize(begin);
+        return false;
+    }
+    return true;
+}
+
+bool LogArchiveReader::ReadRange(int64_t from, int64_t to, std::string& out) {
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        LogArchiveBlock const& block = blocks_[i];
+        bool unknown = block.first_time == 0 || block.last_time == 0;
+        if (!unknown && (block.last_time < from || block.first_time > to)) {
+            continue;
+        }
+        if (!ReadBlock(i, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace eva
@@ -0,0 +1,749 @@
+#include <log/json_formatter.h>
+#include <log/log_config.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <toml++/toml.hpp>
+
+namespace eva {
+
+namespace {
+
+// 文件变化后等待这么久再加载，编辑器保存时的多次写入只触发一次加载
+constexpr int kDebounceMs = 50;
+// 被替换的 appender 延迟这么久再析构，保证正在使用旧快照的写日志线程已经返回
+constexpr uint64_t kRetireDelayMs = 1000;
+
+bool Fail(std::string& error, std::string const& where, std::string const& what) {
+    error = where + ": " + what;
+    return false;
+}
+
+bool CheckKeys(toml::table const& table, std::initializer_list<std::string_view> keys,
+               std::string const& where, std::string& error) {
+    for (auto&& [key, node] : table) {
+        if (std::find(keys.begin(), keys.end(), key.str()) == keys.end()) {
+            return Fail(error, where, "unknown key '" + std::string{key.str()} + "'");
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 读取可选的标量配置项，不存在时保留 out 的默认值
+ */
+template <typename T>
+bool GetValue(toml::table const& table, std::string_view key, T& out, std::string const& where,
+              std::string& error) {
+    toml::node const* node = table.get(key);
+    if (!node) {
+        return true;
+    }
+    std::optional<T> value = node->value<T>();
+    if (!value) {
+        return Fail(error, where + "." + std::string{key}, "wrong value type");
+    }
+    out = std::move(*value);
+    return true;
+}
+
+/**
+ * @brief 读取可选的非负整数配置项
+ */
+template <typename T>
+bool GetUnsigned(toml::table const& table, std::string_view key, T& out, std::string const& where,
+                 std::string& error) {
+    int64_t value = static_cast<int64_t>(out);
+    if (!GetValue(table, key, value, where, error)) {
+        return false;
+    }
+    if (value < 0 || static_cast<uint64_t>(value) > std::numeric_limits<T>::max()) {
+        return Fail(error, where + "." + std::string{key}, "value out of range");
+    }
+    out = static_cast<T>(value);
+    return true;
+}
+
+bool GetStrings(toml::table const& table, std::string_view key, std::vector<std::string>& out,
+                std::string const& where, std::string& error) {
+    toml::node const* node = table.get(key);
+    if (!node) {
+        return true;
+    }
+    toml::array const* array = node->as_array();
+    if (!array) {
+        return Fail(error, where + "." + std::string{key}, "expected an array of strings");
+    }
+    for (auto&& item : *array) {
+        std::optional<std::string> value = item.value<std::string>();
+        if (!value) {
+            return Fail(error, where + "." + std::string{key}, "expected an array of strings");
+        }
+        out.push_back(std::move(*value));
+    }
+    return true;
+}
+
+/**
+ * @brief 读取可选的枚举配置项，names 与 values 一一对应
+ */
+template <typename T>
+bool GetEnum(toml::table const& table, std::string_view key, T& out,
+             std::initializer_list<std::pair<std::string_view, T>> names, std::string const& where,
+             std::string& error) {
+    std::string name;
+    if (!table.get(key)) {
+        return true;
+    }
+    if (!GetValue(table, key, name, where, error)) {
+        return false;
+    }
+    for (auto const& [n, value] : names) {
+        if (n == name) {
+            out = value;
+            return true;
+        }
+    }
+    return Fail(error, where + "." + std::string{key}, "unknown value '" + name + "'");
+}
+
+bool GetLevel(toml::table const& table, std::string_view key, LogLevel::Level& out,
+              std::string const& where, std::string& error) {
+    std::string name;
+    if (!table.get(key)) {
+        return true;
+    }
+    if (!GetValue(table, key, name, where, error)) {
+        return false;
+    }
+    LogLevel::Level level = LogLevel::FromString(name);
+    if (level == LogLevel::Level::NOTSET) {
+        return Fail(error, where + "." + std::string{key}, "unknown level '" + name + "'");
+    }
+    out = level;
+    return true;
+}
+
+bool ParseAppender(toml::table const& table, LogAppenderConfig& config, std::string const& where,
+                   std::string& error) {
+    using Type = LogAppenderConfig::Type;
+    using Interval = RollingFileLogAppender::RollInterval;
+    using Overflow = AsyncLogAppender::OverflowPolicy;
+
+    if (!table.get("type")) {
+        return Fail(error, where, "missing 'type'");
+    }
+    if (!GetEnum(table, "type", config.type,
+                 {{"stdout", Type::STDOUT},
+                  {"file", Type::FILE},
+                  {"rolling", Type::ROLLING},
+                  {"async", Type::ASYNC}},
+                 where, error)) {
+        return false;
+    }
+    switch (config.type) {
+        case Type::STDOUT:
+            return CheckKeys(table, {"type", "pattern"}, where, error) &&
+                   GetValue(table, "pattern", config.pattern, where, error);
+        case Type::FILE:
+            return CheckKeys(table,
+                             {"type", "pattern", "path", "flush_bytes", "flush_interval_ms",
+                              "fsync_interval_ms", "sync_level"},
+                             where, error) &&
+                   GetValue(table, "pattern", config.pattern, where, error) &&
+                   GetValue(table, "path", config.path, where, error) &&
+                   GetUnsigned(table, "flush_bytes", config.durability.flush_bytes, where,
+                               error) &&
+                   GetUnsigned(table, "flush_interval_ms", config.durability.flush_interval_ms,
+                               where, error) &&
+                   GetUnsigned(table, "fsync_interval_ms", config.durability.fsync_interval_ms,
+                               where, error) &&
+                   GetLevel(table, "sync_level", config.durability.sync_level, where, error);
+        case Type::ROLLING:
+            return CheckKeys(table,
+                             {"type", "pattern", "path", "max_size", "interval", "max_files",
+                              "compress"},
+                             where, error) &&
+                   GetValue(table, "pattern", config.pattern, where, error) &&
+                   GetValue(table, "path", config.path, where, error) &&
+                   GetUnsigned(table, "max_size", config.max_size, where, error) &&
+                   GetEnum(table, "interval", config.interval,
+                           {{"none", Interval::NONE},
+                            {"hourly", Interval::HOURLY},
+                            {"daily", Interval::DAILY}},
+                           where, error) &&
+                   GetUnsigned(table, "max_files", config.max_files, where, error) &&
+                   GetValue(table, "compress", config.compress, where, error);
+        case Type::ASYNC:
+            return CheckKeys(table, {"type", "capacity", "overflow", "batch_size", "sinks"},
+                             where, error) &&
+                   GetUnsigned(table, "capacity", config.capacity, where, error) &&
+                   GetEnum(table, "overflow", config.overflow,
+                           {{"block", Overflow::BLOCK},
+                            {"drop_newest", Overflow::DROP_NEWEST},
+                            {"drop_oldest", Overflow::DROP_OLDEST}},
+                           where, error) &&
+                   GetUnsigned(table, "batch_size", config.batch_size, where, error) &&
+                   GetStrings(table, "sinks", config.sinks, where, error);
+    }
+    return true;
+}
+
+bool ParseLogger(toml::table const& table, LoggerConfig& config, std::string const& where,
+                 std::string& error) {
+    using Kind = LogLimitPolicy::Kind;
+
+    Kind kind{Kind::NONE};
+    uint32_t n{1};
+    LogLevel::Level level{LogLevel::Level::NOTSET};
+    if (!CheckKeys(table, {"level", "additive", "appenders", "limit", "limit_n"}, where, error) ||
+        !GetLevel(table, "level", level, where, error) ||
+        !GetValue(table, "additive", config.additive, where, error) ||
+        !GetStrings(table, "appenders", config.appenders, where, error) ||
+        !GetEnum(table, "limit", kind,
+                 {{"none", Kind::NONE},
+                  {"every_sec", Kind::EVERY_SEC},
+                  {"every_n", Kind::EVERY_N},
+                  {"backoff", Kind::BACKOFF}},
+                 where, error) ||
+        !GetUnsigned(table, "limit_n", n, where, error)) {
+        return false;
+    }
+    if (level != LogLevel::Level::NOTSET) {
+        config.level = level;
+    }
+    switch (kind) {
+        case Kind::EVERY_SEC:
+            config.limit = LogLimitPolicy::EverySecond(n);
+            break;
+        case Kind::EVERY_N:
+            config.limit = LogLimitPolicy::EveryN(n);
+            break;
+        case Kind::BACKOFF:
+            config.limit = LogLimitPolicy::Backoff(n);
+            break;
+        case Kind::NONE:
+            config.limit = LogLimitPolicy::None();
+            break;
+    }
+    return true;
+}
+
+/**
+ * @brief 按 table 中的每个子表调用 parse(子表, 名称, 位置)
+ */
+template <typename Parse>
+bool ForEachTable(toml::table const& root, std::string_view key, Parse parse, std::string& error) {
+    toml::node const* node = root.get(key);
+    if (!node) {
+        return true;
+    }
+    toml::table const* table = node->as_table();
+    if (!table) {
+        return Fail(error, std::string{key}, "expected a table");
+    }
+    for (auto&& [name, child] : *table) {
+        std::string where = std::string{key} + "." + std::string{name.str()};
+        toml::table const* child_table = child.as_table();
+        if (!child_table) {
+            return Fail(error, where, "expected a table");
+        }
+        if (!parse(*child_table, std::string{name.str()}, where)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 检查引用关系：日志器和 async 引用的 appender 存在、async 之间没有环、
+ * 文件路径不重复、async 不配置格式
+ */
+bool ValidateConfig(LogConfig const& config, std::string& error) {
+    using Type = LogAppenderConfig::Type;
+
+    std::set<std::string> paths;
+    for (auto const& [name, appender] : config.appenders) {
+        std::string where = "appenders." + name;
+        switch (appender.type) {
+            case Type::FILE:
+            case Type::ROLLING:
+                if (appender.path.empty()) {
+                    return Fail(error, where, "missing 'path'");
+                }
+                if (!paths.insert(appender.path).second) {
+                    return Fail(error, where, "path '" + appender.path + "' is used twice");
+                }
+                break;
+            case Type::ASYNC:
+                if (!appender.pattern.empty()) {
+                    return Fail(error, where, "async appender has no pattern, set it on sinks");
+                }
+                for (auto const& sink : appender.sinks) {
+                    if (!config.appenders.contains(sink)) {
+                        return Fail(error, where, "unknown sink '" + sink + "'");
+                    }
+                }
+                break;
+            case Type::STDOUT:
+                break;
+        }
+    }
+    for (auto const& [name, logger] : config.loggers) {
+        for (auto const& appender : logger.appenders) {
+            if (!config.appenders.contains(appender)) {
+                return Fail(error, "loggers." + name, "unknown appender '" + appender + "'");
+            }
+        }
+    }
+
+    // async 只能引用已经检查过、不会回到自身的 appender
+    std::map<std::string_view, int> state;  // 0 未访问，1 访问中，2 已完成
+    std::function<bool(std::string const&)> visit = [&](std::string const& name) {
+        int& s = state[name];
+        if (s != 0) {
+            return s == 2;
+        }
+        s = 1;
+        for (auto const& sink : config.appenders.at(name).sinks) {
+            if (!visit(sink)) {
+                return Fail(error, "appenders." + name, "sink cycle through '" + sink + "'");
+            }
+        }
+        state[name] = 2;
+        return true;
+    };
+    for (auto const& [name, appender] : config.appenders) {
+        if (!visit(name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 构建格式器，空模板返回 nullptr(使用 appender 的默认格式)
+ */
+bool NewFormatter(LogAppenderConfig const& config, LogFormatter::ptr& formatter,
+                  std::string const& where, std::string& error) {
+    formatter = nullptr;
+    if (config.pattern.empty()) {
+        return true;
+    }
+    if (config.pattern == "json") {
+        formatter = std::make_shared<JsonLogFormatter>();
+        return true;
+    }
+    formatter = std::make_shared<LogFormatter>(config.pattern);
+    if (formatter->IsError()) {
+        return Fail(error, where, "invalid pattern '" + config.pattern + "'");
+    }
+    return true;
+}
+
+LogAppender::ptr NewAppender(LogAppenderConfig const& config,
+                             std::vector<LogAppender::ptr> const& sinks) {
+    using Type = LogAppenderConfig::Type;
+    switch (config.type) {
+        case Type::FILE:
+            return std::make_shared<FileLogAppender>(config.path, config.durability);
+        case Type::ROLLING:
+            return std::make_shared<RollingFileLogAppender>(config.path, config.max_size,
+                                                            config.interval, config.max_files);
+        case Type::ASYNC: {
+            auto async{std::make_shared<AsyncLogAppender>(config.capacity, config.overflow,
+                                                          config.batch_size)};
+            for (auto const& sink : sinks) {
+                async->AddAppender(sink);
+            }
+            return async;
+        }
+        case Type::STDOUT:
+            break;
+    }
+    return std::make_shared<StdoutLogAppender>();
+}
+
+bool ReadFile(std::string const& path, std::string& text) {
+    std::ifstream in{path, std::ios::binary};
+    if (!in) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    text = ss.str();
+    return true;
+}
+
+bool ApplyConfigText(LoggerManager& manager, std::string const& path, std::string const& text) {
+    LogConfig config;
+    std::string error;
+    if (!ParseLogConfig(text, config, error)) {
+        std::cout << "[ERROR] log config " << path << " " << error << std::endl;
+        return false;
+    }
+    return manager.ApplyConfig(config);
+}
+
+}  // namespace
+
+bool LogAppenderConfig::SameOutput(LogAppenderConfig const& other) const {
+    LogAppenderConfig lhs{*this};
+    LogAppenderConfig rhs{other};
+    lhs.pattern.clear();
+    rhs.pattern.clear();
+    lhs.compress = rhs.compress = false;
+    return lhs == rhs;
+}
+
+bool ParseLogConfig(std::string_view text, LogConfig& config, std::string& error) {
+    config = LogConfig{};
+    toml::table root;
+    try {
+        root = toml::parse(text);
+    } catch (toml::parse_error const& e) {
+        error = "line " + std::to_string(e.source().begin.line) + ": " +
+                std::string{e.description()};
+        return false;
+    }
+    return CheckKeys(root, {"appenders", "loggers"}, "config", error) &&
+           ForEachTable(
+               root, "appenders",
+               [&](toml::table const& table, std::string const& name, std::string const& where) {
+                   return ParseAppender(table, config.appenders[name], where, error);
+               },
+               error) &&
+           ForEachTable(
+               root, "loggers",
+               [&](toml::table const& table, std::string const& name, std::string const& where) {
+                   return ParseLogger(table, config.loggers[name], where, error);
+               },
+               error);
+}
+
+// ---------------- LoggerManager 配置 ----------------
+
+struct LoggerManager::ConfigState {
+    /**
+     * @brief 已构建的 appender
+     */
+    struct Built {
+        LogAppenderConfig config;            // 构建时的配置
+        LogAppender::ptr appender;           // appender 对象
+        std::vector<LogAppender::ptr> sinks;  // async 的下游对象，下游被替换时 async 也要重建
+    };
+
+    /**
+     * @brief 被替换下来、等待析构的 appender
+     */
+    struct Retired {
+        uint64_t time_ms;                         // 被替换的时间
+        std::vector<LogAppender::ptr> appenders;  // 等待析构的 appender
+    };
+
+    /**
+     * @brief 析构替换时间早于 kRetireDelayMs 的 appender，force 时全部析构
+     * @details 写日志的线程取到旧快照后仍可能在调用旧 appender，
+     * 延迟析构保证最后一个引用在这里释放，后台线程的 join 和文件关闭不会落在写日志的线程上
+     */
+    void ReleaseRetired(bool force) {
+        uint64_t now = GetElapsedMS();
+        std::erase_if(retired, [&](Retired const& r) {
+            return force || now - r.time_ms >= kRetireDelayMs;
+        });
+    }
+
+    /**
+     * @brief 监视线程：等待目录中的 inotify 事件，去抖后内容有变化就重新加载
+     */
+    void Watch(LoggerManager& manager, std::string path, std::string text);
+
+    // 以下由 config_mtx_ 保护
+    std::map<std::string, Built> appenders;  // 当前配置的 appender
+    std::vector<std::string> loggers;        // 当前配置的日志器
+    Logger::AppenderSnapshot root_default;   // root 的初始 appender，配置中去掉 root 时恢复
+    std::vector<Retired> retired;            // 等待析构的 appender
+    LogCompressor::ptr compressor;           // 滚动文件共用的压缩器
+
+    // 以下由 watch_mtx 保护
+    std::mutex watch_mtx;
+    std::thread watcher;  // 监视线程
+    int stop_fd{-1};      // 通知监视线程退出的 eventfd
+};
+
+LoggerManager::ConfigState& LoggerManager::GetConfigState() {
+    std::call_once(config_once_, [this] {
+        // 与管理器一样不释放
+        config_state_ = new ConfigState;
+        config_state_->root_default = root_->GetAppenders();
+    });
+    return *config_state_;
+}
+
+bool LoggerManager::LoadConfig(std::string const& path) {
+    std::string text;
+    if (!ReadFile(path, text)) {
+        std::cout << "[ERROR] read log config " << path << " error: " << strerror(errno)
+                  << std::endl;
+        return false;
+    }
+    return ApplyConfigText(*this, path, text);
+}
+
+bool LoggerManager::ApplyConfig(LogConfig const& config) {
+    using Type = LogAppenderConfig::Type;
+
+    std::string error;
+    if (!ValidateConfig(config, error)) {
+        std::cout << "[ERROR] log config " << error << std::endl;
+        return false;
+    }
+
+    std::lock_guard lk{config_mtx_};  // NOTE: 只串行化配置的加载，写日志的线程不涉及
+    ConfigState& state = GetConfigState();
+    state.ReleaseRetired(false);
+
+    // 第一步：构建所有 appender 和格式器，此时还没有任何日志器能看到它们
+    std::map<std::string, ConfigState::Built> built;
+    std::map<std::string, LogFormatter::ptr> formatters;
+    std::set<LogAppender*> created;
+    std::function<bool(std::string const&)> build = [&](std::string const& name) {
+        if (built.contains(name)) {
+            return true;
+        }
+        LogAppenderConfig const& cfg = config.appenders.at(name);
+        std::string where = "appenders." + name;
+        std::vector<LogAppender::ptr> sinks;
+        for (auto const& sink : cfg.sinks) {
+            if (!build(sink)) {
+                return false;
+            }
+            sinks.push_back(built.at(sink).appender);
+        }
+        if (!NewFormatter(cfg, formatters[name], where, error)) {
+            return false;
+        }
+
+        auto old = state.appenders.find(name);
+        if (old != state.appenders.end() && old->second.config.SameOutput(cfg) &&
+            old->second.sinks == sinks) {
+            built[name] = ConfigState::Built{cfg, old->second.appender, std::move(sinks)};
+            return true;
+        }
+        if (cfg.type == Type::FILE || cfg.type == Type::ROLLING) {
+            // 映射文件在打开时会截掉预分配的尾部，同一路径上不能同时有两个对象
+            for (auto const& [old_name, old_built] : state.appenders) {
+                if (old_built.config.path == cfg.path &&
+                    (cfg.type == Type::ROLLING || old_built.config.type == Type::ROLLING)) {
+                    return Fail(error, where,
+                                "'" + cfg.path +
+                                    "' is open by a rolling appender, its output settings "
+                                    "cannot change while running");
+                }
+            }
+        }
+        LogAppender::ptr appender{NewAppender(cfg, sinks)};
+        created.insert(appender.get());
+        built[name] = ConfigState::Built{cfg, std::move(appender), std::move(sinks)};
+        return true;
+    };
+    for (auto const& [name, cfg] : config.appenders) {
+        if (!build(name)) {
+            std::cout << "[ERROR] log config " << error << std::endl;
+            return false;
+        }
+    }
+
+    // 第二步：算出每个日志器的完整设置，配置中去掉的日志器恢复为新建时的状态
+    std::vector<std::pair<Logger*, Logger::Settings>> batch;
+    for (auto const& [name, cfg] : config.loggers) {
+        Logger::Settings settings;
+        settings.level = cfg.level;
+        settings.additive = cfg.additive;
+        settings.limit = cfg.limit;
+        for (auto const& appender : cfg.appenders) {
+            settings.appenders.push_back(built.at(appender).appender);
+        }
+        batch.emplace_back(GetLogger(name).get(), std::move(settings));
+    }
+    for (auto const& name : state.loggers) {
+        if (config.loggers.contains(name)) {
+            continue;
+        }
+        Logger::ptr const& logger = GetLogger(name);
+        Logger::Settings settings;
+        if (logger == root_) {
+            settings.appenders = *state.root_default;
+        }
+        batch.emplace_back(logger.get(), std::move(settings));
+    }
+
+    // 压缩器有后台线程，在发布之前创建
+    for (auto const& [name, b] : built) {
+        if (b.config.type == Type::ROLLING && b.config.compress && !state.compressor) {
+            state.compressor = std::make_shared<LogCompressor>();
+        }
+    }
+
+    // 第三步：设置 appender 的格式器和压缩器。新建的 appender 还没有日志器能看到；
+    // 沿用的 appender 正在被写，格式器和压缩器都是一次原子替换，不阻塞写日志的线程
+    for (auto& [name, b] : built) {
+        bool is_new = created.contains(b.appender.get());
+        auto old = state.appenders.find(name);
+        if (is_new || old->second.config.pattern != b.config.pattern) {
+            b.appender->SetFormatter(formatters[name]);
+        }
+        if (b.config.type == Type::ROLLING &&
+            (is_new ? b.config.compress : old->second.config.compress != b.config.compress)) {
+            static_cast<RollingFileLogAppender&>(*b.appender)
+                .SetCompressor(b.config.compress ? state.compressor : nullptr);
+        }
+    }
+
+    // 第四步：替换所有日志器的设置。每个日志器的新有效状态都先算好，再逐个原子替换
+    Logger::Reconfigure(batch);
+
+    // 不再使用的 appender 延迟析构
+    ConfigState::Retired retired{GetElapsedMS(), {}};
+    for (auto const& [name, b] : state.appenders) {
+        auto it = built.find(name);
+        if (it == built.end() || it->second.appender != b.appender) {
+            retired.appenders.push_back(b.appender);
+        }
+    }
+    if (!retired.appenders.empty()) {
+        state.retired.push_back(std::move(retired));
+    }
+    state.appenders = std::move(built);
+    state.loggers.clear();
+    for (auto const& [name, cfg] : config.loggers) {
+        state.loggers.push_back(name);
+    }
+    return true;
+}
+
+bool LoggerManager::WatchConfig(std::string const& path) {
+    StopWatching();
+
+    // 加载失败时仍然开始监视，文件改正后自动加载
+    std::string text;
+    bool loaded = false;
+    if (!ReadFile(path, text)) {
+        std::cout << "[ERROR] read log config " << path << " error: " << strerror(errno)
+                  << std::endl;
+    } else {
+        loaded = ApplyConfigText(*this, path, text);
+    }
+
+    ConfigState& state = GetConfigState();
+    std::lock_guard lk{state.watch_mtx};
+    state.stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (state.stop_fd < 0) {
+        std::cout << "[ERROR] eventfd error: " << strerror(errno) << std::endl;
+        return false;
+    }
+    state.watcher = std::thread{[this, &state, path, text = std::move(text)]() mutable {
+        state.Watch(*this, std::move(path), std::move(text));
+    }};
+    return loaded;
+}
+
+void LoggerManager::StopWatching() {
+    ConfigState& state = GetConfigState();
+    std::lock_guard lk{state.watch_mtx};
+    if (!state.watcher.joinable()) {
+        return;
+    }
+    uint64_t one = 1;
+    ::write(state.stop_fd, &one, sizeof(one));
+    state.watcher.join();
+    ::close(state.stop_fd);
+    state.stop_fd = -1;
+}
+
+void LoggerManager::ConfigState::Watch(LoggerManager& manager, std::string path,
+                                       std::string text) {
+    SetThreadName("log_config");
+
+    // 监视目录而不是文件：编辑器和配置分发工具常用"写临时文件再重命名"的方式替换文件，
+    // 文件本身的 watch 会随旧 inode 失效
+    size_t slash = path.rfind('/');
+    std::string dir =
+        slash == std::string::npos ? "." : path.substr(0, std::max<size_t>(slash, 1));
+    std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 ||
+        inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        std::cout << "[ERROR] inotify watch " << dir << " error: " << strerror(errno) << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return;
+    }
+
+    pollfd fds[2] = {{fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+    alignas(inotify_event) char buf[4096];
+    bool pending = false;
+    auto deadline = std::chrono::steady_clock::now();
+    while (true) {
+        int timeout = static_cast<int>(kRetireDelayMs);
+        if (pending) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            timeout = static_cast<int>(std::max<int64_t>(left.count(), 0));
+        }
+        int n = poll(fds, 2, timeout);
+        if (n < 0 && errno != EINTR) {
+            std::cout << "[ERROR] poll log config watch error: " << strerror(errno) << std::endl;
+            break;
+        }
+        if (n > 0 && fds[1].revents) {
+            break;
+        }
+        if (n > 0 && (fds[0].revents & POLLIN)) {
+            ssize_t len;
+            while ((len = ::read(fd, buf, sizeof(buf))) > 0) {
+                for (char* p = buf; p < buf + len;) {
+                    auto* event = reinterpret_cast<inotify_event*>(p);
+                    std::string_view name{event->len ? event->name : ""};
+                    // "..data" 之类的名称是 Kubernetes ConfigMap 通过符号链接整体替换目录时的改名
+                    if ((event->mask & IN_Q_OVERFLOW) || name == base || name.starts_with("..")) {
+                        pending = true;
+                        deadline = std::chrono::steady_clock::now() +
+                                   std::chrono::milliseconds{kDebounceMs};
+                    }
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+        if (pending && std::chrono::steady_clock::now() >= deadline) {
+            pending = false;
+            std::string next;
+            // 内容没变(如只是 touch 或同内容覆盖)时不重新加载
+            if (ReadFile(path, next) && next != text) {
+                text = std::move(next);
+                ApplyConfigText(manager, path, text);
+            }
+        }
+        std::lock_guard lk{manager.config_mtx_};
+        ReleaseRetired(false);
+    }
+    ::close(fd);
+}
+
+}  // namespace eva
@@ -0,0 +1,362 @@
+#include <fcntl.h>
+#include <log/rolling_appender.h>
+#include <log/static_formatter.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace eva {
+
+namespace {
+
+size_t PageSize() {
+    static size_t const page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+/**
+ * @brief 返回文件中最后一个非零字节之后的偏移
+ * @details 崩溃时预分配的尾部来不及截掉，文件末尾会残留零字节，从后往前扫描找到有效数据的末尾
+ */
+uint64_t FindDataEnd(int fd, uint64_t size) {
+    char buf[64 * 1024];
+    uint64_t end = size;
+    while (end > 0) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(sizeof(buf), end));
+        if (pread(fd, buf, n, static_cast<off_t>(end - n)) != static_cast<ssize_t>(n)) {
+            return end;  // 读失败时保守地保留剩余内容
+        }
+        for (size_t i = n; i > 0; --i) {
+            if (buf[i - 1] != '\0') {
+                return end - n + i;
+            }
+        }
+        end -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief 计算 now 之后的下一个整点或本地零点
+ */
+time_t NextRollTime(time_t now, RollingFileLogAppender::RollInterval interval) {
+    struct tm tm;
+    localtime_r(&now, &tm);
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    if (interval == RollingFileLogAppender::RollInterval::HOURLY) {
+        tm.tm_hour += 1;
+    } else {
+        tm.tm_hour = 0;
+        tm.tm_mday += 1;
+    }
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+}  // namespace
+
+/**
+ * @details 轮换(Roll)与压缩完成回调都会改名历史文件，由 mtx 串行化。
+ * 锁顺序：appender 的 mtx_ 在前，ArchiveSet::mtx 在后；回调只持有后者
+ */
+struct RollingFileLogAppender::ArchiveSet {
+    std::mutex mtx;
+    std::string filename;
+    size_t max_files;
+    std::string suffix;  // 压缩文件后缀，未设置压缩器时为空
+
+    std::string Path(size_t index) const { return filename + "." + std::to_string(index); }
+
+    /**
+     * @brief 删除第 index 个历史文件(原始和压缩后的)
+     */
+    void Remove(size_t index) const {
+        unlink(Path(index).c_str());
+        if (!suffix.empty()) {
+            unlink((Path(index) + suffix).c_str());
+        }
+    }
+
+    /**
+     * @brief 第 from 个历史文件(原始和压缩后的)改为第 to 个
+     */
+    void Move(size_t from, size_t to) const {
+        rename(Path(from).c_str(), Path(to).c_str());
+        if (!suffix.empty()) {
+            rename((Path(from) + suffix).c_str(), (Path(to) + suffix).c_str());
+        }
+    }
+};
+
+// ---------------- RollingFileLogAppender 类 ----------------
+
+RollingFileLogAppender::RollingFileLogAppender(std::string const& filename,
+                                               uint64_t max_file_size, RollInterval interval,
+                                               size_t max_files, size_t chunk_size)
+    : LogAppender(LogFormatter::ptr{new DefaultStaticLogFormatter}),
+      filename_(filename),
+      max_file_size_(max_file_size),
+      interval_(interval),
+      max_files_(max_files),
+      archives_(std::make_shared<ArchiveSet>()) {
+    archives_->filename = filename;
+    archives_->max_files = max_files;
+    size_t page = PageSize();
+    chunk_size_ = std::max<size_t>((chunk_size + page - 1) / page * page, page);
+    time_t now = time(nullptr);
+    last_check_time_ = now;
+    if (!OpenFile(now)) {
+        std::cout << "open file " << filename_ << " error: " << strerror(errno) << std::endl;
+    }
+    RegisterCrashFlushable(this);
+}
+
+RollingFileLogAppender::~RollingFileLogAppender() {
+    UnregisterCrashFlushable(this);
+    CloseFile();
+}
+
+void RollingFileLogAppender::Log(LogEvent const& event) {
+    // 在锁外格式化
+    thread_local LogStream t_stream;
+    t_stream.Clear();
+    ActiveFormatter().Format(t_stream, event);
+
+    std::lock_guard lk{mtx_};
+    time_t now = event.GetTime();
+    if (now != last_check_time_) {
+        // 每秒最多一次 stat，代替原先每 3 秒关闭重开文件
+        last_check_time_ = now;
+        CheckExternalRotation(now);
+    }
+    if (!map_) {
+        ++dropped_;
+        return;
+    }
+
+    bool time_roll = interval_ != RollInterval::NONE && now >= next_roll_time_;
+    bool size_roll = max_file_size_ && written_ > 0 && written_ + t_stream.Size() > max_file_size_;
+    if (time_roll || size_roll) {
+        Roll(now);
+        if (!map_) {
+            ++dropped_;
+            return;
+        }
+    }
+    if (!Write(t_stream.Data(), t_stream.Size())) {
+        ++dropped_;
+    }
+}
+
+void RollingFileLogAppender::Flush() {
+    std::lock_guard lk{mtx_};
+    if (map_ && written_ > map_offset_) {
+        msync(map_, written_ - map_offset_, MS_ASYNC);
+    }
+}
+
+uint64_t RollingFileLogAppender::GetWrittenSize() {
+    std::lock_guard lk{mtx_};
+    return written_;
+}
+
+uint64_t RollingFileLogAppender::GetDroppedCount() {
+    std::lock_guard lk{mtx_};
+    return dropped_;
+}
+
+void RollingFileLogAppender::SetCompressor(LogCompressor::ptr compressor) {
+    // 不加 mtx_，替换压缩器不阻塞写日志的线程，从下一次滚动开始生效
+    std::lock_guard archive_lk{archives_->mtx};
+    if (compressor) {
+        archives_->suffix = compressor->GetSuffix();
+    }
+    compressor_.store(std::move(compressor), std::memory_order_release);
+}
+
+bool RollingFileLogAppender::OpenFile(time_t now) {
+    fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    dev_ = st.st_dev;
+    ino_ = st.st_ino;
+
+    // 崩溃恢复：去掉上次预分配但没写入的零字节，从有效数据末尾继续追加
+    written_ = FindDataEnd(fd_, static_cast<uint64_t>(st.st_size));
+    if (written_ != static_cast<uint64_t>(st.st_size)) {
+        ftruncate(fd_, static_cast<off_t>(written_));
+    }
+    allocated_ = written_;
+
+    if (interval_ != RollInterval::NONE) {
+        // 已有内容的文件按最后修改时间计算，跨周期重启后第一条日志就会触发滚动
+        next_roll_time_ = NextRollTime(written_ > 0 ? std::min(st.st_mtime, now) : now, interval_);
+    }
+    return MapWindow(written_ / PageSize() * PageSize());
+}
+
+void RollingFileLogAppender::CloseFile() {
+    if (map_) {
+        munmap(map_, chunk_size_);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ftruncate(fd_, static_cast<off_t>(written_));
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void RollingFileLogAppender::Roll(time_t now) {
+    CloseFile();
+    if (max_files_ == 0) {
+        unlink(filename_.c_str());
+    } else {
+        // filename.1 最新，filename.<max_files> 最旧
+        std::lock_guard archive_lk{archives_->mtx};
+        archives_->Remove(max_files_);
+        for (size_t i = max_files_ - 1; i > 0; --i) {
+            archives_->Move(i, i + 1);
+        }
+        rename(filename_.c_str(), archives_->Path(1).c_str());
+    }
+    LogCompressor::ptr compressor{compressor_.load(std::memory_order_acquire)};
+    if (compressor && max_files_ > 0) {
+        SubmitArchive(*compressor);
+    }
+    OpenFile(now);
+}
+
+void RollingFileLogAppender::SubmitArchive(LogCompressor& compressor) {
+    std::string path = archives_->Path(1);
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return;
+    }
+    // 压缩期间可能又发生了滚动，完成时按 inode 找到源文件当前的序号；源文件已被淘汰则丢弃结果
+    compressor.Submit(path, [archives = archives_, dev = st.st_dev, ino = st.st_ino](
+                                std::string const& output, bool ok) {
+        if (!ok) {
+            return;
+        }
+        std::lock_guard lk{archives->mtx};
+        for (size_t i = 1; i <= archives->max_files; ++i) {
+            std::string source = archives->Path(i);
+            struct stat st;
+            if (stat(source.c_str(), &st) == 0 && st.st_dev == dev && st.st_ino == ino) {
+                if (rename(output.c_str(), (source + archives->suffix).c_str()) == 0) {
+                    unlink(source.c_str());
+                    return;
+                }
+                break;
+            }
+        }
+        unlink(output.c_str());
+    });
+}
+
+void RollingFileLogAppender::CheckExternalRotation(time_t now) {
+    struct stat st;
+    if (map_ && stat(filename_.c_str(), &st) == 0 && static_cast<uint64_t>(st.st_dev) == dev_ &&
+        static_cast<uint64_t>(st.st_ino) == ino_) {
+        return;
+    }
+    // 文件被移走、删除，或之前打开/映射失败：收尾旧文件后在原路径重新打开
+    CloseFile();
+    OpenFile(now);
+}
+
+bool RollingFileLogAppender::Allocate(uint64_t end) {
+    if (allocated_ < end) {
+        // 真正分配磁盘块(而非稀疏文件)，避免磁盘满时写映射区触发 SIGBUS
+        if (posix_fallocate(fd_, static_cast<off_t>(allocated_),
+                            static_cast<off_t>(end - allocated_)) != 0) {
+            return false;
+        }
+        allocated_ = end;
+    }
+    return true;
+}
+
+bool RollingFileLogAppender::MapWindow(uint64_t offset) {
+    if (map_) {
+        munmap(map_, chunk_size_);
+        map_ = nullptr;
+    }
+    if (!Allocate(offset + chunk_size_)) {
+        return false;
+    }
+    void* addr = mmap(nullptr, chunk_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                      static_cast<off_t>(offset));
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+    map_ = static_cast<char*>(addr);
+    map_offset_ = offset;
+    return true;
+}
+
+void RollingFileLogAppender::OnCrashFlush(char const* report, size_t len) noexcept {
+    bool locked = CrashTryLock(mtx_, 100);
+    if (fd_ >= 0) {
+        // 截断后映射区超出文件末尾的部分不能再访问，进程马上就要退出，不再写映射区
+        uint64_t end = written_;
+        if (::ftruncate(fd_, static_cast<off_t>(end)) == 0) {
+            ::pwrite(fd_, report, len, static_cast<off_t>(end));
+        }
+        ::fsync(fd_);
+    }
+    if (locked) {
+        mtx_.unlock();
+    }
+}
+
+bool RollingFileLogAppender::Write(char const* data, size_t len) {
+    // 先把整行会用到的窗口都分配好磁盘块，磁盘满时整行丢弃，不会写出半行
+    uint64_t const start = written_;
+    uint64_t const windows = (start + len - map_offset_ + chunk_size_ - 1) / chunk_size_;
+    if (!Allocate(map_offset_ + windows * chunk_size_)) {
+        return false;
+    }
+    while (len > 0) {
+        uint64_t window_end = map_offset_ + chunk_size_;
+        if (written_ == window_end) {
+            if (!MapWindow(window_end)) {
+                // 映射失败时回退到行首，并把已拷贝的半行清零，
+                // 否则重新打开时 FindDataEnd 会把它当成有效数据
+                static char const kZeros[4096] = {};
+                for (uint64_t pos = start; pos < written_;) {
+                    size_t n = static_cast<size_t>(
+                        std::min<uint64_t>(sizeof(kZeros), written_ - pos));
+                    if (::pwrite(fd_, kZeros, n, static_cast<off_t>(pos)) <= 0) {
+                        break;
+                    }
+                    pos += n;
+                }
+                written_ = start;
+                return false;
+            }
+            window_end = map_offset_ + chunk_size_;
+        }
+        size_t n = static_cast<size_t>(std::min<uint64_t>(len, window_end - written_));
+        std::memcpy(map_ + (written_ - map_offset_), data, n);
+        written_ += n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+}  // namespace eva
@@ -5,4 +5,8 @@ target("log", function()
     add_includedirs("include", { public = true })
     add_deps("util")
     add_deps("fiber")
+    add_packages("zlib", { public = true })
+    add_packages("toml++")
+    -- 导出可执行文件中的符号，崩溃和 FATAL 日志的调用栈才能显示函数名
+    add_ldflags("-rdynamic", { public = true })
 end)
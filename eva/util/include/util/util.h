@@ -9,18 +9,19 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace eva {
 
 /**
  * @brief 获取线程id
+ * @details 每个线程首次调用时执行一次 gettid 系统调用，之后读取线程局部缓存；fork 后子进程会重新获取
  * @note 这里不要把pid_t和pthread_t混淆，关于它们之的区别可参考gettid(2)
  */
 pid_t GetThreadId();
 
 /**
- * @brief 获取协程id
- * @todo 桩函数，暂时返回0，等协程模块完善后再返回实际值
+ * @brief 获取协程id，见 Fiber::GetFiberId，线程从未使用协程时返回 0
  */
 uint64_t GetFiberId();
 
@@ -29,9 +30,23 @@ uint64_t GetFiberId();
  */
 uint64_t GetElapsedMS();
 
+/**
+ * @brief 获取当前 UTC 时间的纳秒数，参考clock_gettime(2)，使用CLOCK_REALTIME(走 vDSO，无系统调用)
+ */
+uint64_t GetCurrentTimeNS();
+
 /**
  * @brief 获取线程名称，参考pthread_getname_np(3)
+ * @details 每个线程首次调用时读取一次内核中的名称并驻留，之后返回线程局部缓存的驻留名称，
+ * 返回的 string_view 在整个进程生命周期内有效
+ * @note 绕过 SetThreadName 直接修改线程名(pthread_setname_np/prctl)不会更新缓存
+ */
+std::string_view GetThreadName();
+
+/**
+ * @brief 设置当前线程名称，同时更新线程局部缓存(驻留名称)和内核中的名称，参考pthread_setname_np(3)
+ * @note 内核限制线程名最长 15 个字符，超出部分被截断
  */
-std::string GetThreadName();
+void SetThreadName(std::string_view name);
 
 }  // namespace eva
@@ -1,7 +1,54 @@
 #include <util/util.h>
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
 namespace eva {
 
+namespace {
+
+/**
+ * @brief 线程身份的线程局部缓存(平凡类型，访问时无需构造检查)
+ */
+struct ThreadIdentity {
+    pid_t tid{0};               // 线程id，0 表示尚未获取
+    uint32_t name_len{0};       // 名称长度
+    char const* name{nullptr};  // 驻留的线程名称，nullptr 表示尚未缓存
+};
+
+thread_local ThreadIdentity t_identity;
+
+/**
+ * @brief 线程名称驻留表
+ * @details 名称一旦驻留就不再释放，日志事件可以只保存 string_view，跨线程(异步 appender)
+ * 或在线程退出后格式化也不会悬空；表的大小只与不同名称的个数有关。故意泄漏，保证静态析构阶段仍然可用
+ */
+std::string_view InternThreadName(std::string_view name) {
+    static std::mutex* mtx = new std::mutex;
+    static auto* names = new std::unordered_set<std::string>;
+    std::lock_guard lk{*mtx};
+    return *names->emplace(name).first;
+}
+
+void CacheThreadName(std::string_view name) {
+    std::string_view interned = InternThreadName(name);
+    t_identity.name = interned.data();
+    t_identity.name_len = static_cast<uint32_t>(interned.size());
+}
+
+/**
+ * @brief fork 后子进程中只剩调用 fork 的线程，其缓存的 tid 已失效
+ */
+void ResetThreadIdAfterFork() { t_identity.tid = 0; }
+
+[[maybe_unused]] int const s_atfork_registered =
+    pthread_atfork(nullptr, nullptr, ResetThreadIdAfterFork);
+
+}  // namespace
+
 uint64_t GetElapsedMS() {
     struct timespec ts = {0};
     // CLOCK_MONOTONIC_RAW 时钟不受NTP(网络时间协议)或其他系统时间调整影响
@@ -10,14 +57,36 @@ uint64_t GetElapsedMS() {
     return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
-pid_t GetThreadId() { return syscall(SYS_gettid); }
+uint64_t GetCurrentTimeNS() {
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+pid_t GetThreadId() {
+    if (__builtin_expect(t_identity.tid == 0, 0)) {
+        t_identity.tid = syscall(SYS_gettid);
+    }
+    return t_identity.tid;
+}
 
 uint64_t GetFiberId() { return Fiber::GetFiberId(); }
 
-std::string GetThreadName() {
-    char thread_name[16] = {0};
-    pthread_getname_np(pthread_self(), thread_name, 16);
-    return std::string(thread_name);
+std::string_view GetThreadName() {
+    if (__builtin_expect(t_identity.name == nullptr, 0)) {
+        char name[16]{};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        CacheThreadName({name, strnlen(name, sizeof(name) - 1)});
+    }
+    return {t_identity.name, t_identity.name_len};
+}
+
+void SetThreadName(std::string_view name) {
+    char buf[16]{};  // 与内核限制一致
+    size_t len = std::min(name.size(), sizeof(buf) - 1);
+    std::memcpy(buf, name.data(), len);
+    CacheThreadName({buf, len});
+    pthread_setname_np(pthread_self(), buf);
 }
 
 }  // namespace eva
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief 替换全局 operator new/delete，统计 operator new 的调用次数，
+ * 用来验证或度量日志路径上的堆分配
+ * @details 替换的分配函数不能是 inline 的，一个程序只能有一个源文件包含本头文件。
+ * 对齐版本(align_val_t)不替换，仍由标准库分配，不计入统计
+ */
+static std::atomic<uint64_t> g_allocs{0};
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size) { return ::operator new(size); }
+
+// operator new 被替换为 malloc，GCC 内联 delete 后看到 new 出来的指针交给 free，
+// 会误报 -Wmismatched-new-delete；这里 new 和 delete 本来就是配对的
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+#pragma GCC diagnostic pop
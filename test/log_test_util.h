@@ -0,0 +1,25 @@
+#pragma once
+
+#include <log/log.h>
+
+#include <string>
+
+#include "test_util.h"
+
+namespace eva::test {
+
+/**
+ * @brief 创建只有一个 appender 的日志器
+ * @param[in] pattern 非空时作为 appender 的格式
+ */
+inline Logger::ptr MakeLogger(std::string const& name, LogAppender::ptr appender,
+                              std::string const& pattern = "") {
+    Logger::ptr logger{new Logger{name}};
+    if (!pattern.empty()) {
+        appender->SetFormatter(LogFormatter::ptr{new LogFormatter{pattern}});
+    }
+    logger->AddAppender(appender);
+    return logger;
+}
+
+}  // namespace eva::test
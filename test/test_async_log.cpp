@@ -0,0 +1,140 @@
+#include <log/async_appender.h>
+#include <log/log.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 只计数不输出的 appender，可选地模拟慢速 I/O
+class CountingAppender : public eva::LogAppender {
+public:
+    using ptr = std::shared_ptr<CountingAppender>;
+
+    CountingAppender(bool slow = false)
+        : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}), slow_(slow) {}
+
+    void Log(eva::LogEvent const& event) override {
+        if (slow_ && count_ % 64 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        ++count_;
+    }
+
+    uint64_t GetCount() const { return count_.load(); }
+
+private:
+    bool slow_;
+    std::atomic<uint64_t> count_{0};
+};
+
+static int RunCase(eva::AsyncLogAppender::OverflowPolicy policy, char const* name) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20000;
+
+    auto sink{std::make_shared<CountingAppender>(true)};
+    auto async{std::make_shared<eva::AsyncLogAppender>(1024, policy)};
+    async->AddAppender(sink);
+
+    eva::Logger::ptr logger{new eva::Logger{name}};
+    logger->AddAppender(async);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([logger] {
+            for (int j = 0; j < kPerThread; ++j) {
+                EVA_LOG_INFO(logger) << "async msg " << j;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    async->Flush();
+
+    uint64_t total = kThreads * kPerThread;
+    uint64_t written = sink->GetCount();
+    uint64_t dropped = async->GetDroppedCount();
+    std::cout << name << ": written=" << written << " dropped=" << dropped
+              << " blocked=" << async->GetBlockedCount() << std::endl;
+
+    bool ok = written + dropped == total;
+    if (policy == eva::AsyncLogAppender::OverflowPolicy::BLOCK) {
+        ok = ok && dropped == 0;
+    }
+    if (!ok) {
+        std::cout << "[FAILED] " << name << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 记录每个线程最后写出的序号的 appender，消息格式为 "<线程> <序号>"
+class LastSeenAppender : public eva::LogAppender {
+public:
+    LastSeenAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override {
+        std::string content{event.GetContent()};
+        size_t space = content.find(' ');
+        int thread = std::stoi(content.substr(0, space));
+        last_[thread].store(std::stoi(content.substr(space + 1)));
+        // 慢速写出，让其他线程的事件在后台线程处理时入队
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+
+    int GetLast(int thread) const { return last_[thread].load(); }
+
+private:
+    std::atomic<int> last_[8] = {};
+};
+
+// 每个线程写一条后立即 Flush，返回时自己的这条一定已经写出，不受其他线程并发入队的影响
+static int TestFlushPrefix() {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 300;
+    auto sink{std::make_shared<LastSeenAppender>()};
+    auto async{std::make_shared<eva::AsyncLogAppender>(64)};
+    async->AddAppender(sink);
+    eva::Logger::ptr logger{new eva::Logger{"flush"}};
+    logger->AddAppender(async);
+
+    std::atomic<int> missing{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int j = 0; j < kPerThread; ++j) {
+                EVA_LOG_INFO(logger) << t << ' ' << j;
+                async->Flush();
+                missing += sink->GetLast(t) != j;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (missing.load() != 0) {
+        std::cout << "[FAILED] Flush returned before the caller's event was written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+    failed += RunCase(eva::AsyncLogAppender::OverflowPolicy::BLOCK, "block");
+    failed += RunCase(eva::AsyncLogAppender::OverflowPolicy::DROP_NEWEST, "drop_newest");
+    failed += RunCase(eva::AsyncLogAppender::OverflowPolicy::DROP_OLDEST, "drop_oldest");
+    failed += TestFlushPrefix();
+
+    // 异步写到标准输出
+    auto async{std::make_shared<eva::AsyncLogAppender>()};
+    async->AddAppender(std::make_shared<eva::StdoutLogAppender>());
+    eva::Logger::ptr logger{new eva::Logger{"async"}};
+    logger->AddAppender(async);
+    EVA_LOG_INFO(logger) << "hello from async appender";
+    EVA_LOG_ERROR(logger) << "error from async appender";
+
+    return failed;
+}
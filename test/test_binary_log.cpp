@@ -0,0 +1,113 @@
+#include <log/binary_log.h>
+#include <log/log.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int Expect(std::string const& actual, std::string const& expected) {
+    if (actual != expected) {
+        std::cout << "[FAILED] expected: " << expected << "actual:   " << actual;
+        return 1;
+    }
+    return 0;
+}
+
+// 生产者写满缓冲区等待时日志被关闭：丢弃记录并计数，不能一直等下去
+static int TestCloseWhileFull() {
+    char const* path = "/tmp/eva_test_binary_log_close.bin";
+    std::remove(path);
+    eva::Logger::ptr logger{new eva::Logger{"bin"}};
+    std::string big(800, 'x');
+    std::atomic<bool> stop{false};
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            while (!stop.load()) {
+                EVA_LOG_BIN_INFO(logger, "big %s", big);
+            }
+            finished.fetch_add(1);
+        });
+    }
+    for (int round = 0; round < 20; ++round) {
+        eva::BinaryLog::Open(path, 4096);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        eva::BinaryLog::Close();
+    }
+    stop.store(true);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (finished.load() != 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (finished.load() != 4) {
+        std::cout << "[FAILED] producer stuck after Close" << std::endl;
+        for (auto& t : threads) {
+            t.detach();
+        }
+        return 1;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return 0;
+}
+
+int main() {
+    char const* path = "/tmp/eva_test_binary_log.bin";
+    std::remove(path);
+
+    eva::Logger::ptr logger{new eva::Logger{"bin"}};
+    if (!eva::BinaryLog::Open(path, 64 * 1024)) {
+        return 1;
+    }
+
+    std::string name{"eva"};
+    EVA_LOG_BIN_INFO(logger, "value=%d pi=%.2f name=%s c=%c", 42, 3.14159, name, 'x');
+    EVA_LOG_BIN_ERROR(logger, "unsigned=%u hex=%#x width=[%5d] str=[%-6s]", 7u, 255, 3, "ab");
+    EVA_LOG_BIN_DEBUG(logger, "filtered out %d", 1);  // 低于日志器级别
+    EVA_LOG_BIN_WARN(logger, "no args, 100%% sure");
+
+    // 多线程写入，缓冲区多次回绕
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([logger, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                EVA_LOG_BIN_INFO(logger, "thread %d seq %d", t, i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    eva::BinaryLog::Close();
+
+    eva::BinaryLogReader reader;
+    if (!reader.Open(path)) {
+        std::cout << "[FAILED] open " << path << std::endl;
+        return 1;
+    }
+    eva::LogFormatter formatter{"%p [%c] %m%n"};
+    eva::LogEvent event;
+    std::vector<std::string> lines;
+    while (reader.Next(event)) {
+        lines.push_back(formatter.Format(event));
+    }
+
+    int failed = reader.IsCorrupted() ? 1 : 0;
+    if (lines.size() != 3 + kThreads * kPerThread) {
+        std::cout << "[FAILED] decoded " << lines.size() << " events" << std::endl;
+        return 1;
+    }
+    failed += Expect(lines[0], "INFO [bin] value=42 pi=3.14 name=eva c=x\n");
+    failed += Expect(lines[1], "ERROR [bin] unsigned=7 hex=0xff width=[    3] str=[ab    ]\n");
+    failed += Expect(lines[2], "WARN [bin] no args, 100% sure\n");
+    std::cout << "decoded " << lines.size() << " events, dropped " << eva::BinaryLog::GetDroppedCount()
+              << std::endl;
+    return failed + TestCloseWhileFull();
+}
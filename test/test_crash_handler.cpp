@@ -0,0 +1,252 @@
+#include <fiber/fiber.h>
+#include <log/async_appender.h>
+#include <log/crash_handler.h>
+#include <log/log.h>
+#include <log/rolling_appender.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "log_test_util.h"
+
+using namespace eva::test;
+
+/**
+ * @brief 在子进程中运行 body(其中进程应当崩溃)，返回终止子进程的信号，正常退出时返回 0
+ */
+static int RunCrashingChild(std::function<void()> const& body) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        eva::CrashHandlerOptions options;
+        options.write_stderr = false;
+        eva::InstallCrashHandler(options);
+        body();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+static eva::FileDurabilityPolicy BufferedPolicy() {
+    // 只按大小提交，崩溃前的日志全部停留在缓冲区中
+    eva::FileDurabilityPolicy policy;
+    policy.flush_bytes = 1 << 20;
+    policy.flush_interval_ms = 0;
+    return policy;
+}
+
+// 缓冲中的日志在 SIGSEGV 时写出，文件末尾是 FATAL 报告和调用栈
+static int TestSegvFlushesBuffer() {
+    std::string path = "/tmp/eva_test_crash_segv.log";
+    std::remove(path.c_str());
+    int sig = RunCrashingChild([&path] {
+        auto appender{std::make_shared<eva::FileLogAppender>(path, BufferedPolicy())};
+        eva::Logger::ptr logger{MakeLogger("crash", appender)};
+        for (int i = 0; i < 100; ++i) {
+            EVA_LOG_INFO(logger) << "before crash " << i;
+        }
+        volatile int* p = nullptr;
+        *p = 1;
+    });
+    if (sig != SIGSEGV) {
+        return Fail("child should die of SIGSEGV");
+    }
+    std::string data = ReadFile(path);
+    if (!Contains(data, "before crash 0") || !Contains(data, "before crash 99")) {
+        return Fail("buffered lines lost on SIGSEGV");
+    }
+    size_t report = data.find("[FATAL]\t[crash]\treceived SIGSEGV");
+    if (report == std::string::npos || report < data.find("before crash 99")) {
+        return Fail("crash report missing or before buffered lines");
+    }
+    if (!Contains(data.substr(report), "at address 0x0\n") ||
+        !Contains(data.substr(report), "backtrace:\n    #0 ")) {
+        return Fail("crash report missing fault address or backtrace");
+    }
+    return 0;
+}
+
+// 其他线程正在提交时崩溃：已取出、正在写出的批次也在报告之前写出，不丢行
+static int TestSegvDuringCommit() {
+    std::string path = "/tmp/eva_test_crash_commit.log";
+    std::remove(path.c_str());
+    int sig = RunCrashingChild([&path] {
+        eva::FileDurabilityPolicy policy;
+        policy.flush_bytes = 4096;
+        policy.flush_interval_ms = 0;
+        auto appender{std::make_shared<eva::FileLogAppender>(path, policy)};
+        eva::Logger::ptr logger{MakeLogger("crash", appender, "%m%n")};
+        std::thread writer{[logger] {
+            for (int i = 0;; ++i) {
+                EVA_LOG_INFO(logger) << "line " << i;
+            }
+        }};
+        writer.detach();
+        SleepMs(50);
+        volatile int* p = nullptr;
+        *p = 1;
+    });
+    if (sig != SIGSEGV) {
+        return Fail("child should die of SIGSEGV");
+    }
+    std::string data = ReadFile(path);
+    size_t report = data.find("[FATAL]\t[crash]\treceived SIGSEGV");
+    if (report == std::string::npos) {
+        return Fail("crash report missing");
+    }
+    std::istringstream in{data.substr(0, report)};
+    std::string line;
+    int expected = 0;
+    while (std::getline(in, line) && line.rfind("line ", 0) == 0) {
+        if (line != "line " + std::to_string(expected)) {
+            return Fail("lines lost or reordered before the crash report");
+        }
+        ++expected;
+    }
+    if (expected == 0) {
+        return Fail("no lines before the crash report");
+    }
+    return 0;
+}
+
+// 无限递归：g_recurse 始终为 true，只是让编译器看不出递归没有出口
+static volatile bool g_recurse = true;
+
+static int Recurse(int depth) {
+    volatile char buf[256];
+    buf[0] = static_cast<char>(depth);
+    if (!g_recurse) {
+        return buf[0];
+    }
+    return Recurse(depth + 1) + buf[0];
+}
+
+// 协程栈溢出：报告指明协程 id 和栈大小
+static int TestFiberOverflow() {
+    std::string path = "/tmp/eva_test_crash_fiber.log";
+    std::remove(path.c_str());
+    int sig = RunCrashingChild([&path] {
+        auto appender{std::make_shared<eva::FileLogAppender>(path, BufferedPolicy())};
+        eva::Logger::ptr logger{MakeLogger("crash", appender)};
+        auto fiber{std::make_shared<eva::Fiber>([] { Recurse(0); }, 64 * 1024)};
+        EVA_LOG_INFO(logger) << "overflow fiber " << fiber->GetId();
+        fiber->Resume();
+    });
+    if (sig != SIGSEGV) {
+        return Fail("fiber overflow should die of SIGSEGV");
+    }
+    std::string data = ReadFile(path);
+    size_t pos = data.find("overflow fiber ");
+    if (pos == std::string::npos) {
+        return Fail("fiber overflow log line lost");
+    }
+    std::string id = data.substr(pos + 15, data.find('\n', pos) - pos - 15);
+    if (!Contains(data, "[FATAL]\t[crash]\tfiber " + id +
+                            " stack overflow (65536 byte stack), received SIGSEGV")) {
+        return Fail("crash report should name the overflowed fiber");
+    }
+    return 0;
+}
+
+// 异步 appender 队列中的事件先交给下游，再由下游写出
+static int TestAbortDrainsAsync() {
+    std::string path = "/tmp/eva_test_crash_async.log";
+    std::remove(path.c_str());
+    int sig = RunCrashingChild([&path] {
+        auto async{std::make_shared<eva::AsyncLogAppender>()};
+        async->AddAppender(std::make_shared<eva::FileLogAppender>(path, BufferedPolicy()));
+        eva::Logger::ptr logger{MakeLogger("crash", async)};
+        for (int i = 0; i < 1000; ++i) {
+            EVA_LOG_INFO(logger) << "queued " << i;
+        }
+        abort();
+    });
+    if (sig != SIGABRT) {
+        return Fail("child should die of SIGABRT");
+    }
+    std::string data = ReadFile(path);
+    if (!Contains(data, "queued 999\n") || !Contains(data, "received SIGABRT")) {
+        return Fail("async events or report lost on SIGABRT");
+    }
+    return 0;
+}
+
+// 未捕获的异常：报告中有异常类型和 what()
+static int TestTerminate() {
+    std::string path = "/tmp/eva_test_crash_terminate.log";
+    std::remove(path.c_str());
+    int sig = RunCrashingChild([&path] {
+        auto appender{std::make_shared<eva::FileLogAppender>(path, BufferedPolicy())};
+        eva::Logger::ptr logger{MakeLogger("crash", appender)};
+        EVA_LOG_INFO(logger) << "before throw";
+        throw std::runtime_error("boom");
+    });
+    if (sig != SIGABRT) {
+        return Fail("terminate should end with SIGABRT");
+    }
+    std::string data = ReadFile(path);
+    if (!Contains(data, "before throw") ||
+        !Contains(data, "std::terminate called after throwing an instance of "
+                        "'std::runtime_error': boom") ||
+        Contains(data, "received SIGABRT")) {
+        return Fail("terminate report wrong");
+    }
+    return 0;
+}
+
+// 映射文件：截掉预分配的尾部后追加报告
+static int TestRollingTruncates() {
+    std::string path = "/tmp/eva_test_crash_rolling.log";
+    std::remove(path.c_str());
+    int sig = RunCrashingChild([&path] {
+        auto appender{std::make_shared<eva::RollingFileLogAppender>(path)};
+        eva::Logger::ptr logger{MakeLogger("crash", appender)};
+        EVA_LOG_INFO(logger) << "mapped line";
+        raise(SIGBUS);
+    });
+    if (sig != SIGBUS) {
+        return Fail("child should die of SIGBUS");
+    }
+    std::string data = ReadFile(path);
+    if (!Contains(data, "mapped line") || !Contains(data, "received SIGBUS") ||
+        data.find('\0') != std::string::npos || data.back() != '\n') {
+        return Fail("rolling file not truncated before report");
+    }
+    return 0;
+}
+
+// 正常写出的 FATAL 事件附带调用栈
+static int TestFatalBacktrace() {
+    std::string path = "/tmp/eva_test_crash_fatal.log";
+    std::remove(path.c_str());
+    {
+        auto appender{std::make_shared<eva::FileLogAppender>(path)};
+        eva::Logger::ptr logger{MakeLogger("crash", appender)};
+        EVA_LOG_ERROR(logger) << "plain error";
+        EVA_LOG_FATAL(logger) << "fatal error";
+    }
+    std::string data = ReadFile(path);
+    size_t fatal = data.find("fatal error\nbacktrace:\n    #0 ");
+    if (fatal == std::string::npos || Contains(data.substr(0, fatal), "backtrace:")) {
+        return Fail("FATAL event should carry a backtrace, ERROR should not");
+    }
+    return 0;
+}
+
+int main() {
+    if (TestSegvFlushesBuffer() || TestSegvDuringCommit() || TestFiberOverflow() ||
+        TestAbortDrainsAsync() || TestTerminate() || TestRollingTruncates() ||
+        TestFatalBacktrace()) {
+        return 1;
+    }
+    std::cout << "crash handler tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <fiber/fiber.h>
+#include <log/log.h>
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+// Resume/Yield 交替执行，状态按顺序变化
+static int TestResumeYield() {
+    std::vector<int> trace;
+    auto fiber{std::make_shared<eva::Fiber>([&] {
+        trace.push_back(1);
+        eva::Fiber::Yield();
+        trace.push_back(3);
+        eva::Fiber::Yield();
+        trace.push_back(5);
+    })};
+    if (fiber->GetState() != eva::Fiber::State::READY) {
+        return Fail("new fiber should be READY");
+    }
+    fiber->Resume();
+    trace.push_back(2);
+    if (fiber->GetState() != eva::Fiber::State::SUSPENDED) {
+        return Fail("yielded fiber should be SUSPENDED");
+    }
+    fiber->Resume();
+    trace.push_back(4);
+    fiber->Resume();
+    if (trace != std::vector<int>{1, 2, 3, 4, 5} || fiber->GetState() != eva::Fiber::State::TERM) {
+        return Fail("resume/yield order");
+    }
+
+    // 复用栈执行新的函数
+    bool reset_ran = false;
+    fiber->Reset([&] { reset_ran = true; });
+    fiber->Resume();
+    if (!reset_ran || fiber->GetState() != eva::Fiber::State::TERM) {
+        return Fail("reset fiber should run again");
+    }
+    return 0;
+}
+
+// GetFiberId 返回当前协程的 id，主协程也有 id
+static int TestFiberId() {
+    uint64_t main_id = eva::Fiber::GetFiberId();
+    uint64_t inner_id = 0;
+    uint64_t nested_id = 0;
+    uint64_t after_nested_id = 0;
+    eva::Fiber::ptr nested{new eva::Fiber{[&] { nested_id = eva::GetFiberId(); }}};
+    eva::Fiber::ptr fiber{new eva::Fiber{[&] {
+        inner_id = eva::GetFiberId();
+        nested->Resume();
+        after_nested_id = eva::GetFiberId();
+    }}};
+    fiber->Resume();
+    if (main_id == 0 || main_id != eva::Fiber::GetThis()->GetId() || inner_id != fiber->GetId() ||
+        nested_id != nested->GetId() || after_nested_id != fiber->GetId() ||
+        eva::GetFiberId() != main_id) {
+        return Fail("fiber id should follow the running fiber");
+    }
+
+    // 从未使用协程的线程返回 0
+    uint64_t other = 1;
+    std::thread{[&] { other = eva::GetFiberId(); }}.join();
+    if (other != 0) {
+        return Fail("thread without fibers should report id 0");
+    }
+    return 0;
+}
+
+// 协程函数抛出的异常由 Resume 重新抛出
+static int TestException() {
+    eva::Fiber::ptr fiber{new eva::Fiber{[] { throw std::runtime_error{"boom"}; }}};
+    try {
+        fiber->Resume();
+        return Fail("exception should propagate to Resume");
+    } catch (std::runtime_error const& e) {
+        if (std::string{e.what()} != "boom") {
+            return Fail("wrong exception");
+        }
+    }
+    if (fiber->GetState() != eva::Fiber::State::EXCEPT) {
+        return Fail("throwing fiber should be EXCEPT");
+    }
+    return 0;
+}
+
+// 被调用者保存的寄存器和浮点值在切换后保持不变
+static int TestRegisters() {
+    double sum = 0;
+    eva::Fiber::ptr fiber{new eva::Fiber{[&] {
+        for (int i = 0; i < 1000; ++i) {
+            sum += std::sqrt(static_cast<double>(i));
+            eva::Fiber::Yield();
+        }
+    }}};
+    double expected = 0;
+    for (int i = 0; i < 1000; ++i) {
+        expected += std::sqrt(static_cast<double>(i));
+        fiber->Resume();
+    }
+    fiber->Resume();
+    if (sum != expected || fiber->GetState() != eva::Fiber::State::TERM) {
+        return Fail("values across switches");
+    }
+    return 0;
+}
+
+// 协程在一个线程上让出，在另一个线程上恢复
+static int TestMigrate() {
+    std::atomic<int> steps{0};
+    eva::Fiber::ptr fiber{new eva::Fiber{[&] {
+        ++steps;
+        eva::Fiber::Yield();
+        ++steps;
+    }}};
+    std::thread{[&] { fiber->Resume(); }}.join();
+    std::thread{[&] { fiber->Resume(); }}.join();
+    if (steps != 2 || fiber->GetState() != eva::Fiber::State::TERM) {
+        return Fail("fiber should resume on another thread");
+    }
+    return 0;
+}
+
+// 只保留最后一行格式化结果的 appender
+class LastLineAppender : public eva::LogAppender {
+public:
+    LastLineAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter{"%F"}}) {}
+
+    void Log(eva::LogEvent const& event) override { last = ActiveFormatter().Format(event); }
+
+    std::string last;
+};
+
+// 日志中的协程号是当前协程的 id
+static int TestLogFiberId() {
+    eva::Logger::ptr logger{new eva::Logger{"fiber"}};
+    auto appender{std::make_shared<LastLineAppender>()};
+    logger->AddAppender(appender);
+    eva::Fiber::ptr fiber{new eva::Fiber{[&] { EVA_LOG_INFO(logger) << "in fiber"; }}};
+    fiber->Resume();
+    if (appender->last != std::to_string(fiber->GetId())) {
+        return Fail("log line should carry the fiber id");
+    }
+    return 0;
+}
+
+int main() {
+    uint64_t before = eva::Fiber::TotalFibers();
+    if (TestResumeYield() || TestFiberId() || TestException() || TestRegisters() ||
+        TestMigrate() || TestLogFiberId()) {
+        return 1;
+    }
+    // 只剩本线程的主协程
+    if (eva::Fiber::TotalFibers() != before + 1) {
+        return Fail("fibers leaked");
+    }
+    std::cout << "fiber tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <fiber/fiber.h>
+#include <fiber/io_manager.h>
+#include <fiber/stack.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+// 递归 depth 层，每层在栈上写入可校验的内容，到底后让出 yields 次；返回各层内容是否完好
+static bool Deep(int depth, int yields) {
+    volatile uint64_t buf[16];
+    for (int i = 0; i < 16; ++i) {
+        buf[i] = static_cast<uint64_t>(depth) * 31 + static_cast<uint64_t>(i);
+    }
+    bool ok = true;
+    if (depth == 0) {
+        for (int i = 0; i < yields; ++i) {
+            eva::Fiber::Yield();
+        }
+    } else {
+        ok = Deep(depth - 1, yields);
+    }
+    for (int i = 0; i < 16; ++i) {
+        ok = ok && buf[i] == static_cast<uint64_t>(depth) * 31 + static_cast<uint64_t>(i);
+    }
+    return ok;
+}
+
+// 无限递归，直到栈溢出；volatile 的 g_recurse 始终为 true，避免编译器判定为无出口的递归
+static volatile bool g_recurse = true;
+
+static int Recurse(int depth) {
+    volatile char buf[256];
+    buf[0] = static_cast<char>(depth);
+    if (!g_recurse) {
+        return buf[0];
+    }
+    return Recurse(depth + 1) + buf[0];
+}
+
+// 释放的栈在同一线程上直接复用，不再映射
+static int TestReuse() {
+    eva::FiberStack stack = eva::StackAllocator::Allocate(64 * 1024);
+    if (!stack.base || stack.size != 64 * 1024 || stack.guard == 0) {
+        return Fail("stack should have a guard page");
+    }
+    eva::StackAllocator::Deallocate(stack);
+    eva::FiberStack again = eva::StackAllocator::Allocate(64 * 1024);
+    if (again.base != stack.base) {
+        return Fail("freed stack should be reused");
+    }
+    eva::StackAllocator::Deallocate(again);
+
+    // 协程析构后栈回到空闲链表，创建再多协程也不增加映射
+    auto run = [] { std::make_shared<eva::Fiber>([] {})->Resume(); };
+    run();
+    size_t mapped = eva::StackAllocator::GetMappedCount();
+    for (int i = 0; i < 1000; ++i) {
+        run();
+    }
+    if (eva::StackAllocator::GetMappedCount() != mapped) {
+        return Fail("fiber churn should not map new stacks");
+    }
+    return 0;
+}
+
+static size_t ResidentPages(eva::FiberStack const& stack) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> vec(stack.size / page);
+    mincore(stack.base, stack.size, vec.data());
+    size_t resident = 0;
+    for (unsigned char v : vec) {
+        resident += v & 1;
+    }
+    return resident;
+}
+
+// Trim 归还缓存中栈的物理页，地址空间保留
+static int TestTrim() {
+    eva::FiberStack stack = eva::StackAllocator::Allocate(256 * 1024);
+    std::fill_n(static_cast<char*>(stack.base), stack.size, 1);
+    eva::StackAllocator::Deallocate(stack);
+    if (ResidentPages(stack) == 0) {
+        return Fail("hot stack should keep its pages");
+    }
+    eva::StackAllocator::Trim();
+    if (ResidentPages(stack) != 0) {
+        return Fail("trim should release stack pages");
+    }
+    eva::FiberStack again = eva::StackAllocator::Allocate(256 * 1024);
+    if (again.base != stack.base) {
+        return Fail("trimmed stack should be reused");
+    }
+    eva::StackAllocator::Deallocate(again);
+    return 0;
+}
+
+/**
+ * @brief 在子进程中让协程栈溢出，返回终止子进程的信号和标准错误的内容
+ */
+static int RunOverflowChild(bool shared, std::string& err, uint64_t& id) {
+    std::string path = "/tmp/eva_test_fiber_overflow.txt";
+    std::remove(path.c_str());
+    auto fiber{std::make_shared<eva::Fiber>([] { Recurse(0); }, 32 * 1024, shared)};
+    id = fiber->GetId();
+    pid_t pid = fork();
+    if (pid == 0) {
+        FILE* out = freopen(path.c_str(), "w", stderr);
+        static_cast<void>(out);
+        fiber->Resume();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    err = ReadFile(path);
+    return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+// 栈溢出触发保护页，FATAL 信息指明协程和栈大小，进程以 SIGSEGV 终止
+static int TestOverflow() {
+    std::string err;
+    uint64_t id = 0;
+    if (RunOverflowChild(false, err, id) != SIGSEGV) {
+        return Fail("overflow should die of SIGSEGV");
+    }
+    if (err.find("[FATAL] fiber " + std::to_string(id) + " stack overflow (32768 byte stack)") ==
+        std::string::npos) {
+        return Fail("overflow message should name the fiber");
+    }
+    if (RunOverflowChild(true, err, id) != SIGSEGV) {
+        return Fail("shared-stack overflow should die of SIGSEGV");
+    }
+    std::string expected = "[FATAL] fiber " + std::to_string(id) + " stack overflow (" +
+                           std::to_string(eva::Fiber::kSharedStackSize) + " byte stack)";
+    if (err.find(expected) == std::string::npos) {
+        return Fail("shared-stack overflow message should name the fiber");
+    }
+    return 0;
+}
+
+// 大量共享栈协程交替运行，栈深度各不相同，换入换出后栈内容完好，只用一个共享栈
+static int TestSharedStack() {
+    constexpr size_t kFibers = 20000;
+    constexpr int kYields = 3;
+    size_t mapped = eva::StackAllocator::GetMappedCount();
+    std::mt19937 rng{1};
+    std::vector<eva::Fiber::ptr> fibers;
+    std::vector<char> ok(kFibers, 0);
+    for (size_t i = 0; i < kFibers; ++i) {
+        int depth = static_cast<int>(rng() % 64);
+        fibers.push_back(std::make_shared<eva::Fiber>(
+            [&ok, i, depth] { ok[i] = Deep(depth, kYields); }, eva::Fiber::kDefaultStackSize,
+            true));
+    }
+    for (int round = 0; round <= kYields; ++round) {
+        for (auto& fiber : fibers) {
+            fiber->Resume();
+        }
+    }
+    for (size_t i = 0; i < kFibers; ++i) {
+        if (fibers[i]->GetState() != eva::Fiber::State::TERM || !ok[i]) {
+            return Fail("shared-stack fiber stack corrupted");
+        }
+    }
+    if (eva::StackAllocator::GetMappedCount() > mapped + 1) {
+        return Fail("shared-stack fibers should not map their own stacks");
+    }
+
+    // 共享栈协程中 Resume 独占栈的协程
+    bool inner_ran = false;
+    auto outer{std::make_shared<eva::Fiber>(
+        [&inner_ran] {
+            auto inner{std::make_shared<eva::Fiber>([&inner_ran] { inner_ran = Deep(8, 1); })};
+            inner->Resume();
+            eva::Fiber::Yield();
+            inner->Resume();
+        },
+        eva::Fiber::kDefaultStackSize, true)};
+    outer->Resume();
+    fibers[0]->Reset([] { Deep(16, 1); });
+    fibers[0]->Resume();
+    outer->Resume();
+    fibers[0]->Resume();
+    if (!inner_ran || outer->GetState() != eva::Fiber::State::TERM) {
+        return Fail("shared-stack fiber should resume exclusive fibers");
+    }
+    return 0;
+}
+
+// 调度器中的共享栈协程第一次运行后固定在那个工作线程上，休眠和让出后仍在原线程恢复
+static int TestSchedulerAffinity() {
+    constexpr int kTasks = 2000;
+    std::atomic<int> done{0};
+    std::atomic<int> moved{0};
+    std::atomic<int> corrupted{0};
+    {
+        eva::IOManager iom{4, "shared"};
+        iom.SetSharedStack(true);
+        iom.Start();
+        for (int i = 0; i < kTasks; ++i) {
+            iom.Schedule([&, i] {
+                int worker = eva::Scheduler::GetWorkerIndex();
+                bool intact = true;
+                auto check = [&intact] { intact = Deep(1, 0) && intact; };
+                for (int round = 0; round < 3; ++round) {
+                    eva::IOManager::SleepFor(static_cast<uint64_t>(i % 3));
+                    check();
+                    eva::Scheduler::Yield();
+                    if (eva::Scheduler::GetWorkerIndex() != worker) {
+                        moved.fetch_add(1);
+                    }
+                }
+                if (!eva::Fiber::GetThis()->IsSharedStack() || !intact) {
+                    corrupted.fetch_add(1);
+                }
+                done.fetch_add(1);
+            });
+        }
+        iom.Stop();
+    }
+    if (done.load() != kTasks) {
+        return Fail("not all shared-stack tasks finished");
+    }
+    if (moved.load() != 0) {
+        return Fail("shared-stack fiber migrated to another worker");
+    }
+    if (corrupted.load() != 0) {
+        return Fail("scheduler should run tasks on shared-stack fibers");
+    }
+    return 0;
+}
+
+// 同时存在的协程超过 vm.max_map_count 允许的带保护页的栈数，之后的栈没有保护页，分配不失败
+static int TestMapLimit() {
+    unsigned long max_maps = 0;
+    if (FILE* file = std::fopen("/proc/sys/vm/max_map_count", "r")) {
+        if (std::fscanf(file, "%lu", &max_maps) != 1) {
+            max_maps = 0;
+        }
+        std::fclose(file);
+    }
+    if (max_maps == 0 || max_maps > 262144) {
+        std::cout << "vm.max_map_count is " << max_maps << ", skip map limit test" << std::endl;
+        return 0;
+    }
+    size_t count = max_maps / 2 + 1024;
+    std::vector<eva::Fiber::ptr> fibers;
+    fibers.reserve(count);
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            fibers.push_back(std::make_shared<eva::Fiber>([] { eva::Fiber::Yield(); }, 16 * 1024));
+            fibers.back()->Resume();
+        }
+    } catch (std::bad_alloc const&) {
+        return Fail("stack allocation failed past the map count limit");
+    }
+    for (auto& fiber : fibers) {
+        fiber->Resume();
+        if (fiber->GetState() != eva::Fiber::State::TERM) {
+            return Fail("fiber on an unguarded stack did not finish");
+        }
+    }
+    fibers.clear();
+    // 释放之后带保护页的栈又可以分配
+    eva::FiberStack stack = eva::StackAllocator::Allocate(48 * 1024);
+    bool guarded = stack.guard != 0;
+    eva::StackAllocator::Deallocate(stack);
+    if (!guarded) {
+        return Fail("guard pages should come back after stacks are released");
+    }
+    return 0;
+}
+
+int main() {
+    if (TestReuse() || TestTrim() || TestOverflow() || TestSharedStack() ||
+        TestSchedulerAffinity() || TestMapLimit()) {
+        return 1;
+    }
+    std::cout << "fiber stack tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <log/log.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log_test_util.h"
+
+using namespace eva::test;
+
+static size_t CountLines(std::string const& data) {
+    size_t n = 0;
+    for (char c : data) {
+        n += c == '\n';
+    }
+    return n;
+}
+
+// 多线程组提交：所有行都写入，且每个线程内部的顺序不变
+static int TestGroupCommit() {
+    std::string path = "/tmp/eva_test_file_group.log";
+    std::remove(path.c_str());
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20000;
+    {
+        eva::FileDurabilityPolicy policy;
+        policy.flush_bytes = 16 * 1024;
+        auto appender{std::make_shared<eva::FileLogAppender>(path, policy)};
+        eva::Logger::ptr logger{MakeLogger("file", appender, "%m%n")};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([logger, t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    EVA_LOG_INFO(logger) << t << " " << i;
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    std::istringstream in{ReadFile(path)};
+    std::vector<int> next(kThreads, 0);
+    int t = 0;
+    int i = 0;
+    size_t lines = 0;
+    while (in >> t >> i) {
+        if (t < 0 || t >= kThreads || next[t] != i) {
+            return Fail("group commit reordered lines");
+        }
+        ++next[t];
+        ++lines;
+    }
+    if (lines != kThreads * kPerThread) {
+        return Fail("group commit lost lines");
+    }
+    return 0;
+}
+
+// sync_level 及以上(以及 FATAL)的事件返回前已经写入文件
+static int TestSyncLevel() {
+    std::string path = "/tmp/eva_test_file_sync.log";
+    std::remove(path.c_str());
+    eva::FileDurabilityPolicy policy;
+    policy.flush_interval_ms = 0;
+    policy.sync_level = eva::LogLevel::Level::ERROR;
+    auto appender{std::make_shared<eva::FileLogAppender>(path, policy)};
+    eva::Logger::ptr logger{MakeLogger("file", appender, "%m%n")};
+
+    EVA_LOG_INFO(logger) << "buffered";
+    if (!ReadFile(path).empty()) {
+        return Fail("info line was not buffered");
+    }
+    EVA_LOG_ERROR(logger) << "synced";
+    if (ReadFile(path) != "buffered\nsynced\n") {
+        return Fail("error line was not committed");
+    }
+
+    std::string fatal_path = "/tmp/eva_test_file_fatal.log";
+    std::remove(fatal_path.c_str());
+    eva::FileDurabilityPolicy fatal_policy;
+    fatal_policy.flush_interval_ms = 0;
+    auto fatal_appender{std::make_shared<eva::FileLogAppender>(fatal_path, fatal_policy)};
+    eva::Logger::ptr fatal_logger{MakeLogger("file", fatal_appender, "%m%n")};
+    EVA_LOG_WARN(fatal_logger) << "warn";
+    EVA_LOG_FATAL(fatal_logger) << "fatal";
+    // FATAL 事件的消息后附带调用栈
+    std::string fatal_data = ReadFile(fatal_path);
+    if (fatal_data.rfind("warn\nfatal\nbacktrace:\n", 0) != 0) {
+        return Fail("fatal line was not committed");
+    }
+    // 调用栈最后一帧后只有格式中的换行，没有空行
+    if (Contains(fatal_data, "\n\n")) {
+        return Fail("fatal backtrace should not end with an empty line");
+    }
+    return 0;
+}
+
+// 按时间间隔提交
+static int TestFlushInterval() {
+    std::string path = "/tmp/eva_test_file_interval.log";
+    std::remove(path.c_str());
+    eva::FileDurabilityPolicy policy;
+    policy.flush_interval_ms = 20;
+    auto appender{std::make_shared<eva::FileLogAppender>(path, policy)};
+    eva::Logger::ptr logger{MakeLogger("file", appender, "%m%n")};
+    EVA_LOG_INFO(logger) << "interval";
+    for (int i = 0; i < 100 && ReadFile(path).empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (ReadFile(path) != "interval\n") {
+        return Fail("interval flush");
+    }
+    return 0;
+}
+
+// 写系统调用次数：每 1000 条日志远少于 1000 次
+static int TestSyscalls() {
+    auto read_syscw = [] {
+        std::ifstream in{"/proc/self/io"};
+        std::string key;
+        uint64_t value = 0;
+        while (in >> key >> value) {
+            if (key == "syscw:") {
+                return value;
+            }
+        }
+        return uint64_t{0};
+    };
+    std::string path = "/tmp/eva_test_file_syscalls.log";
+    std::remove(path.c_str());
+    eva::FileDurabilityPolicy policy;
+    policy.flush_interval_ms = 0;
+    auto appender{std::make_shared<eva::FileLogAppender>(path, policy)};
+    eva::Logger::ptr logger{MakeLogger("file", appender, "%m%n")};
+
+    uint64_t before = read_syscw();
+    for (int i = 0; i < 10000; ++i) {
+        EVA_LOG_INFO(logger) << "syscall counting line " << i;
+    }
+    appender->Flush();
+    uint64_t syscalls = read_syscw() - before;
+    std::cout << "write syscalls for 10000 lines: " << syscalls << std::endl;
+    if (syscalls >= 100 || CountLines(ReadFile(path)) != 10000) {
+        return Fail("too many write syscalls");
+    }
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+    failed += TestGroupCommit();
+    failed += TestSyncLevel();
+    failed += TestFlushInterval();
+    if (access("/proc/self/io", R_OK) == 0) {
+        failed += TestSyscalls();
+    }
+    if (!failed) {
+        std::cout << "file appender tests passed" << std::endl;
+    }
+    return failed;
+}
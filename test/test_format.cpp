@@ -0,0 +1,104 @@
+#include <log/log.h>
+
+#include <string>
+
+struct Point {
+    int x;
+    int y;
+};
+
+// 通过 Formatter 特化接入 {} 格式化
+template <>
+struct eva::Formatter<Point> {
+    template <typename Stream>
+    static void Format(Stream& out, Point const& p, eva::FormatSpec const& spec) {
+        if (spec.type == 'x') {
+            eva::FormatTo(out, "({:x}, {:x})", p.x, p.y);
+        } else {
+            eva::FormatTo(out, "({}, {})", p.x, p.y);
+        }
+    }
+};
+
+// 只提供 std::ostream 输出运算符的类型
+struct Legacy {
+    int id;
+};
+
+std::ostream& operator<<(std::ostream& os, Legacy const& l) { return os << "legacy#" << l.id; }
+
+// 记录最后一条日志内容的 appender
+class CaptureAppender : public eva::LogAppender {
+public:
+    CaptureAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter{"%m"}}) {}
+
+    void Log(eva::LogEvent const& event) override { last_ = event.GetContent(); }
+
+    std::string const& GetLast() const { return last_; }
+
+private:
+    std::string last_;
+};
+
+static int g_failed = 0;
+
+template <typename... Args>
+static void Expect(std::string const& expected, eva::FormatString<Args...> fmt,
+                   Args const&... args) {
+    eva::LogStream stream;
+    eva::FormatTo(stream, fmt, args...);
+    if (stream.Str() != expected) {
+        std::cout << "[FAILED] format \"" << fmt.Get() << "\": expected \"" << expected
+                  << "\", got \"" << stream.Str() << "\"" << std::endl;
+        ++g_failed;
+    }
+}
+
+int main() {
+    std::string name{"eva"};
+    char const* null_str = nullptr;
+
+    Expect("no placeholders", "no placeholders");
+    Expect("a=1 b=-2 c=3", "a={} b={} c={}", 1, -2L, 3u);
+    Expect("ff FF 17 101 A", "{:x} {:X} {:o} {:b} {:c}", 255, 255, 15, 5, 65);
+    Expect("x 120", "{} {:d}", 'x', 'x');
+    Expect("true 0", "{} {:d}", true, false);
+    Expect("1.5 3.14 1.235e+04 2.50E-01", "{} {:.2f} {:.3e} {:.2E}", 1.5, 3.14159, 12346.0, 0.25);
+    Expect("0.1 1e+20", "{} {:g}", 0.1, 1e20);
+    Expect("eva eva lit ev (null)", "{} {} {} {:.2} {}", name, std::string_view{name}, "lit", name,
+           null_str);
+    Expect("{literal} {1}", "{{literal}} {{{}}}", 1);
+    Expect("(1, 2) (a, ff)", "{} {:x}", Point{1, 2}, Point{10, 255});
+    Expect("legacy#7", "{}", Legacy{7});
+    Expect("0x10", "{}", reinterpret_cast<void*>(0x10));
+
+    // 超出事件内联缓冲区的长消息
+    std::string long_text(1000, 'y');
+    Expect(long_text + "!", "{}!", long_text);
+
+    // 宏写入事件缓冲区，而不是标准输出
+    eva::Logger::ptr logger{new eva::Logger{"format"}};
+    auto capture{std::make_shared<CaptureAppender>()};
+    logger->AddAppender(capture);
+    EVA_LOG_FMT_INFO(logger, "user {} cost {:.2f}ms", name, 1.234);
+    if (capture->GetLast() != "user eva cost 1.23ms") {
+        std::cout << "[FAILED] EVA_LOG_FMT_INFO wrote \"" << capture->GetLast() << "\"" << std::endl;
+        ++g_failed;
+    }
+    EVA_LOG_FMT_WARN(logger, "plain");
+    if (capture->GetLast() != "plain") {
+        std::cout << "[FAILED] EVA_LOG_FMT_WARN without args" << std::endl;
+        ++g_failed;
+    }
+
+    // 以下写法都会在编译期报错：
+    //   EVA_LOG_FMT_INFO(logger, "{} {}", 1);        占位符多于参数
+    //   EVA_LOG_FMT_INFO(logger, "{}", 1, 2);        参数多于占位符
+    //   EVA_LOG_FMT_INFO(logger, "{:x}", "str");     类型说明与参数不匹配
+    //   EVA_LOG_FMT_INFO(logger, "{", 1);            花括号未闭合
+
+    if (!g_failed) {
+        std::cout << "format tests passed" << std::endl;
+    }
+    return g_failed;
+}
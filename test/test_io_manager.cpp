@@ -0,0 +1,410 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <fiber/io_manager.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+using Backend = eva::IOManager::Backend;
+
+static char const* BackendName(Backend backend) {
+    return backend == Backend::IO_URING ? "io_uring" : "epoll";
+}
+
+static bool WriteAll(eva::IOManager& iom, int fd, void const* buf, size_t len) {
+    auto const* p = static_cast<char const*>(buf);
+    while (len > 0) {
+        ssize_t n = iom.Write(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool ReadAll(eva::IOManager& iom, int fd, void* buf, size_t len) {
+    auto* p = static_cast<char*>(buf);
+    while (len > 0) {
+        ssize_t n = iom.Read(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 协程阻塞在 Read 上时工作线程继续执行其他任务，数据到达后协程恢复
+static int TestPipe(Backend backend) {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        return Fail("pipe2");
+    }
+    eva::IOManager iom{1, "pipe", backend};
+    std::atomic<bool> other_ran{false};
+    std::atomic<ssize_t> got{-2};
+    char buf[16] = {};
+    iom.Start();
+    iom.Schedule([&] { got = iom.Read(fds[0], buf, sizeof(buf)); });
+    iom.Schedule([&] { other_ran = true; });
+    if (!WaitFor([&] { return other_ran.load() && iom.GetPendingCount() == 1; })) {
+        return Fail("a fiber blocked in Read should not block its worker");
+    }
+    if (got != -2) {
+        return Fail("Read should wait for data");
+    }
+    if (write(fds[1], "hello", 5) != 5) {
+        return Fail("write");
+    }
+    iom.Stop();
+    if (got != 5 || memcmp(buf, "hello", 5) != 0) {
+        return Fail("Read should return the written data");
+    }
+    // 不在工作线程中调用时直接执行系统调用
+    char c;
+    if (iom.Read(fds[0], &c, 1) != -1 || errno != EAGAIN) {
+        return Fail("Read outside the scheduler should not block");
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return 0;
+}
+
+// 工作线程一直有任务时，它提交的请求也要送到内核，不能等到它空闲；
+// 另一个线程阻塞在等待事件中，不知道哪个线程先进入等待，每个线程都试一次
+static int TestBusyWorker(Backend backend) {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        return Fail("pipe2");
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<int> done{0};
+    std::atomic<int> spinners{0};
+    int failed = 0;
+    {
+        eva::IOManager iom{2, "busy", backend};
+        iom.Start();
+        for (int worker = 0; worker < 2 && !failed; ++worker) {
+            if (write(fds[1], "x", 1) != 1) {
+                return Fail("write");
+            }
+            // 等两个工作线程都空闲下来
+            SleepMs(20);
+            stop = false;
+            iom.Schedule(
+                [&] {
+                    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+                    while (!stop.load() && std::chrono::steady_clock::now() < deadline) {
+                        eva::Scheduler::Yield();
+                    }
+                    ++spinners;
+                },
+                worker);
+            iom.Schedule(
+                [&] {
+                    char c;
+                    done += iom.Read(fds[0], &c, 1) == 1;
+                },
+                worker);
+            if (!WaitFor([&] { return done.load() == worker + 1; }, 500)) {
+                failed = Fail("request from a busy worker was not submitted");
+            }
+            stop = true;
+            WaitFor([&] { return spinners.load() == worker + 1; });
+        }
+        iom.Stop();
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return failed;
+}
+
+// AddEvent 的回调、DelEvent 不触发、CancelEvent/CancelAll 触发并让等待的 IO 以 ECANCELED 失败
+static int TestEvents(Backend backend) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0) {
+        return Fail("socketpair");
+    }
+    eva::IOManager iom{2, "event", backend};
+    std::atomic<int> fired{0};
+    iom.Start();
+
+    if (!iom.AddEvent(fds[0], eva::IOManager::READ, [&] { fired.fetch_add(1); })) {
+        return Fail("AddEvent");
+    }
+    if (iom.AddEvent(fds[0], eva::IOManager::READ, [] {})) {
+        return Fail("one waiter per event");
+    }
+    if (!iom.DelEvent(fds[0], eva::IOManager::READ) || iom.GetPendingCount() != 0) {
+        return Fail("DelEvent");
+    }
+    if (write(fds[1], "x", 1) != 1) {
+        return Fail("write");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    if (fired != 0) {
+        return Fail("a deleted event should not fire");
+    }
+
+    // 已经可读：立即触发
+    iom.AddEvent(fds[0], eva::IOManager::READ, [&] { fired.fetch_add(1); });
+    if (!WaitFor([&] { return fired == 1; })) {
+        return Fail("a ready fd should fire its event");
+    }
+    char c;
+    if (read(fds[0], &c, 1) != 1) {
+        return Fail("read");
+    }
+
+    // 可写事件和取消
+    iom.AddEvent(fds[0], eva::IOManager::WRITE, [&] { fired.fetch_add(1); });
+    if (!WaitFor([&] { return fired == 2; })) {
+        return Fail("a writable fd should fire its event");
+    }
+    iom.AddEvent(fds[0], eva::IOManager::READ, [&] { fired.fetch_add(10); });
+    if (!iom.CancelEvent(fds[0], eva::IOManager::READ) ||
+        !WaitFor([&] { return fired == 12; })) {
+        return Fail("CancelEvent should fire the event");
+    }
+
+    std::atomic<int> read_errno{0};
+    std::atomic<bool> read_done{false};
+    iom.Schedule([&] {
+        char buf[8];
+        ssize_t n = iom.Read(fds[0], buf, sizeof(buf));
+        read_errno = n < 0 ? errno : 0;
+        read_done = true;
+    });
+    if (!WaitFor([&] { return iom.GetPendingCount() == 1; })) {
+        return Fail("Read should wait");
+    }
+    iom.CancelAll(fds[0]);
+    if (!WaitFor([&] { return read_done.load(); }) || read_errno != ECANCELED) {
+        return Fail("CancelAll should fail the pending Read with ECANCELED");
+    }
+
+    // 关闭后 fd 号被新的 socket 复用，之前的注册不影响新的等待
+    close(fds[0]);
+    close(fds[1]);
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0) {
+        return Fail("socketpair");
+    }
+    std::atomic<ssize_t> got{-2};
+    iom.Schedule([&] {
+        char buf[8];
+        got = iom.Read(fds[0], buf, sizeof(buf));
+    });
+    if (!WaitFor([&] { return iom.GetPendingCount() == 1; }) || write(fds[1], "y", 1) != 1 ||
+        !WaitFor([&] { return got != -2; }) || got != 1) {
+        return Fail("a reused fd should be waited on afresh");
+    }
+    iom.Stop();
+    close(fds[0]);
+    close(fds[1]);
+    return 0;
+}
+
+// 多个线程上大量 socketpair 之间来回传递数据
+static int TestPingPong(Backend backend) {
+    constexpr int kPairs = 256;
+    constexpr int kRounds = 200;
+    eva::IOManager iom{4, "pingpong", backend};
+    std::vector<int> fds(kPairs * 2);
+    for (int i = 0; i < kPairs; ++i) {
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, &fds[i * 2]) !=
+            0) {
+            return Fail("socketpair");
+        }
+    }
+    std::atomic<int> errors{0};
+    std::atomic<int> done{0};
+    iom.Start();
+    for (int i = 0; i < kPairs; ++i) {
+        int a = fds[i * 2];
+        int b = fds[i * 2 + 1];
+        iom.Schedule([&, a] {
+            for (uint64_t round = 0; round < kRounds; ++round) {
+                uint64_t reply = 0;
+                if (!WriteAll(iom, a, &round, sizeof(round)) ||
+                    !ReadAll(iom, a, &reply, sizeof(reply)) || reply != round + 1) {
+                    errors.fetch_add(1);
+                    return;
+                }
+            }
+            done.fetch_add(1);
+        });
+        iom.Schedule([&, b] {
+            for (int round = 0; round < kRounds; ++round) {
+                uint64_t value = 0;
+                if (!ReadAll(iom, b, &value, sizeof(value))) {
+                    errors.fetch_add(1);
+                    return;
+                }
+                ++value;
+                if (!WriteAll(iom, b, &value, sizeof(value))) {
+                    errors.fetch_add(1);
+                    return;
+                }
+            }
+        });
+    }
+    iom.Stop();
+    for (int fd : fds) {
+        close(fd);
+    }
+    if (errors != 0 || done != kPairs) {
+        return Fail("every pair should finish all rounds");
+    }
+    return 0;
+}
+
+// 回环 TCP 上同时保持 kConnections 个连接：服务端和客户端各在一个进程里，各用 4 个线程
+static int TestTcpConnections(Backend backend) {
+    constexpr int kConnections = 10240;
+    constexpr size_t kStackSize = 64 * 1024;
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), addrlen) != 0 ||
+        listen(listen_fd, SOMAXCONN) != 0 ||
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addrlen) != 0) {
+        return Fail("listen");
+    }
+
+    // 先 fork 再创建线程
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(listen_fd);
+        eva::IOManager iom{4, "client", backend};
+        std::atomic<int> ok{0};
+        iom.Start();
+        for (int i = 0; i < kConnections; ++i) {
+            iom.Schedule(std::make_shared<eva::Fiber>(
+                [&, i] {
+                    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                    uint32_t value = static_cast<uint32_t>(i);
+                    uint32_t reply = 0;
+                    char c;
+                    // 服务端回显后保持连接，所有连接建立后才关闭，Read 返回 0
+                    if (fd >= 0 &&
+                        iom.Connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                        WriteAll(iom, fd, &value, sizeof(value)) &&
+                        ReadAll(iom, fd, &reply, sizeof(reply)) && reply == value &&
+                        iom.Read(fd, &c, 1) == 0) {
+                        ok.fetch_add(1);
+                    }
+                    if (fd >= 0) {
+                        close(fd);
+                    }
+                },
+                kStackSize));
+        }
+        iom.Stop();
+        _exit(ok == kConnections ? 0 : 1);
+    }
+
+    eva::IOManager iom{4, "server", backend};
+    std::mutex mtx;
+    std::vector<int> conns;
+    std::atomic<int> echoed{0};
+    std::atomic<int> closed{0};
+    std::atomic<int> errors{0};
+    iom.Start();
+    iom.Schedule([&] {
+        for (int i = 0; i < kConnections; ++i) {
+            int fd = iom.Accept(listen_fd);
+            if (fd < 0) {
+                errors.fetch_add(1);
+                continue;
+            }
+            iom.Schedule(std::make_shared<eva::Fiber>(
+                [&, fd] {
+                    uint32_t value;
+                    char c;
+                    if (!ReadAll(iom, fd, &value, sizeof(value)) ||
+                        !WriteAll(iom, fd, &value, sizeof(value))) {
+                        errors.fetch_add(1);
+                    } else {
+                        {
+                            std::lock_guard lk{mtx};
+                            conns.push_back(fd);
+                        }
+                        echoed.fetch_add(1);
+                        // 等客户端关闭
+                        if (iom.Read(fd, &c, 1) != 0) {
+                            errors.fetch_add(1);
+                        }
+                    }
+                    close(fd);
+                    closed.fetch_add(1);
+                },
+                kStackSize));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    bool all_open = WaitFor([&] { return echoed + errors >= kConnections; }, 120000);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    // 所有连接此时都保持打开；关闭写端，客户端读到 EOF 后关闭连接
+    {
+        std::lock_guard lk{mtx};
+        for (int fd : conns) {
+            shutdown(fd, SHUT_WR);
+        }
+    }
+    iom.Stop();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(listen_fd);
+    if (!all_open || errors != 0 || echoed != kConnections || closed != kConnections) {
+        return Fail("server should hold all connections open and echo on each");
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return Fail("every client should connect, get its echo and see EOF");
+    }
+    std::cout << "  " << BackendName(backend) << ": " << kConnections
+              << " concurrent loopback connections echoed in " << elapsed << " ms" << std::endl;
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    for (Backend backend : {Backend::EPOLL, Backend::IO_URING}) {
+        if (backend == Backend::IO_URING &&
+            eva::IOManager{1, "probe", backend}.GetBackend() != Backend::IO_URING) {
+            std::cout << "io_uring is not available, skip" << std::endl;
+            continue;
+        }
+        failures += TestPipe(backend);
+        failures += TestBusyWorker(backend);
+        failures += TestEvents(backend);
+        failures += TestPingPong(backend);
+        failures += TestTcpConnections(backend);
+    }
+    if (failures == 0) {
+        std::cout << "io manager tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#include <log/json_formatter.h>
+#include <log/static_formatter.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+// 逐字节的参考实现
+static std::string ReferenceEscape(std::string_view str) {
+    std::string out;
+    for (unsigned char c : str) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out;
+}
+
+// 需要转义的字符出现在 SIMD 块内、块边界和尾部的各个位置
+static int TestEscape() {
+    char const specials[] = {'"', '\\', '\n', '\0', '\x1f', '\x7f', '\x80', '\xff', 'a'};
+    for (size_t len = 0; len <= 100; ++len) {
+        for (size_t pos = 0; pos < len; ++pos) {
+            for (char special : specials) {
+                std::string str(len, 'x');
+                str[pos] = special;
+                eva::LogStream stream;
+                eva::AppendJsonEscaped(stream, str);
+                if (stream.Str() != ReferenceEscape(str)) {
+                    return Fail("json escape");
+                }
+            }
+        }
+    }
+    std::string mixed = "中文 \"quoted\" back\\slash\ttab\x01" + std::string(300, 'y') + "\n";
+    eva::LogStream stream;
+    eva::AppendJsonEscaped(stream, mixed);
+    if (stream.Str() != ReferenceEscape(mixed)) {
+        return Fail("json escape mixed");
+    }
+    return 0;
+}
+
+static eva::LogEvent MakeEvent() {
+    // 2024-05-01T08:00:00.123456789Z，协程 id 超出 32 位
+    static constexpr eva::LogSite kSite{"dir/main.cpp", "main.cpp", "main", 42};
+    eva::LogEvent event{"json", eva::LogLevel::Level::WARN, kSite, 7, 1234, 1ull << 33,
+                        1714550400123456789ull, "worker"};
+    event.GetStream() << "say \"hi\"\n";
+    event.WithFields("user", "e\"va", "count", 3, "ratio", 0.5, "ok", true, "bad", NAN, "ch", 'x');
+    return event;
+}
+
+static int TestJsonFormatter() {
+    eva::JsonLogFormatter formatter;
+    std::string expected =
+        "{\"time\":\"2024-05-01T08:00:00.123456Z\",\"level\":\"WARN\",\"logger\":\"json\","
+        "\"file\":\"dir/main.cpp\",\"line\":42,\"thread_id\":1234,\"thread_name\":\"worker\","
+        "\"fiber_id\":8589934592,\"elapse_ms\":7,\"message\":\"say \\\"hi\\\"\\n\","
+        "\"user\":\"e\\\"va\",\"count\":3,\"ratio\":0.5,\"ok\":true,\"bad\":\"nan\","
+        "\"ch\":\"x\"}\n";
+    if (formatter.Format(MakeEvent()) != expected) {
+        return Fail("json formatter");
+    }
+    return 0;
+}
+
+// %k 在运行时解析和编译期解析的文本模板中输出 key=value
+static int TestTextFields() {
+    std::string expected = "say \"hi\"\n user=e\"va count=3 ratio=0.5 ok=true bad=nan ch=x";
+    eva::LogFormatter runtime{"%m %k"};
+    eva::StaticLogFormatter<"%m %k"> compiled;
+    eva::LogEvent event = MakeEvent();
+    if (runtime.IsError() || runtime.Format(event) != expected ||
+        compiled.Format(event) != expected) {
+        return Fail("%k text fields");
+    }
+    return 0;
+}
+
+// 事件复用时字段被清空
+static int TestMacro() {
+    struct CaptureAppender : eva::LogAppender {
+        CaptureAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter{"%m|%k"}}) {}
+        void Log(eva::LogEvent const& event) override { last = GetFormatter()->Format(event); }
+        std::string last;
+    };
+    eva::Logger::ptr logger{new eva::Logger{"kv"}};
+    auto capture{std::make_shared<CaptureAppender>()};
+    logger->AddAppender(capture);
+
+    std::string name = "eva";
+    EVA_LOG_KV_INFO(logger, "user", name, "cost_ms", 1.25) << "login ok";
+    if (capture->last != "login ok|user=eva cost_ms=1.25") {
+        return Fail("EVA_LOG_KV_INFO");
+    }
+    EVA_LOG_INFO(logger) << "plain";
+    if (capture->last != "plain|") {
+        return Fail("fields not cleared on reuse");
+    }
+    return 0;
+}
+
+int main() {
+    int failed = 0;
+    failed += TestEscape();
+    failed += TestJsonFormatter();
+    failed += TestTextFields();
+    failed += TestMacro();
+    if (!failed) {
+        std::cout << "json formatter tests passed" << std::endl;
+    }
+    return failed;
+}
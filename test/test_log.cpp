@@ -11,12 +11,12 @@ int main() {
 
     g_logger->SetLevel(eva::LogLevel::Level::WARN);
 
-    // EVA_LOG_FMT_FATAL(g_logger, "fatal %s:%d\n", __FILE__, __LINE__);
-    // EVA_LOG_FMT_ERROR(g_logger, "err %s:%d\n", __FILE__, __LINE__);
-    // EVA_LOG_FMT_INFO(g_logger, "info %s:%d\n", __FILE__, __LINE__);
-    // EVA_LOG_FMT_DEBUG(g_logger, "debug %s:%d\n", __FILE__, __LINE__);
+    // EVA_LOG_FMT_FATAL(g_logger, "fatal {}:{}", __FILE__, __LINE__);
+    // EVA_LOG_FMT_ERROR(g_logger, "err {}:{}", __FILE__, __LINE__);
+    // EVA_LOG_FMT_INFO(g_logger, "info {}:{}", __FILE__, __LINE__);
+    // EVA_LOG_FMT_DEBUG(g_logger, "debug {}:{}", __FILE__, __LINE__);
 
-    auto file_appender{std::make_shared<eva::FileLogAppender>("/home/sjj/eva/log.txt")};
+    auto file_appender{std::make_shared<eva::FileLogAppender>("/tmp/eva_test_log.txt")};
     g_logger->AddAppender(file_appender);
 
     EVA_LOG_FATAL(g_logger) << "fatal msg";
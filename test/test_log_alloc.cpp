@@ -0,0 +1,79 @@
+#include <log/async_appender.h>
+#include <log/log.h>
+
+#include <atomic>
+#include <string>
+
+#include "alloc_counter.h"
+
+// 只格式化不输出的 appender
+class NullAppender : public eva::LogAppender {
+public:
+    NullAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override {
+        thread_local eva::LogStream t_stream;
+        t_stream.Clear();
+        GetFormatter()->Format(t_stream, event);
+        bytes_ += t_stream.Size();
+    }
+
+private:
+    std::atomic<uint64_t> bytes_{0};
+};
+
+struct Point {
+    int x;
+    int y;
+};
+
+std::ostream& operator<<(std::ostream& os, Point const& p) {
+    return os << "(" << p.x << ", " << p.y << ")";
+}
+
+static std::string const g_long_text(600, 'x');  // 超出内联缓冲区，触发溢出
+
+static void LogLines(eva::Logger::ptr const& logger, int n) {
+    for (int i = 0; i < n; ++i) {
+        EVA_LOG_INFO(logger) << "short message " << i << " " << 3.14 << " " << Point{i, -i};
+        EVA_LOG_WARN(logger) << "long message " << g_long_text;
+    }
+}
+
+static int Check(char const* name, eva::Logger::ptr const& logger,
+                 eva::AsyncLogAppender* async = nullptr) {
+    LogLines(logger, 1000);  // 预热：对象池、溢出缓冲区、时区初始化
+    if (async) {
+        async->Flush();
+    }
+
+    uint64_t before = g_allocs.load();
+    LogLines(logger, 10000);
+    if (async) {
+        async->Flush();
+    }
+    uint64_t allocs = g_allocs.load() - before;
+
+    std::cout << name << ": " << allocs << " allocations for 20000 log lines" << std::endl;
+    return allocs == 0 ? 0 : 1;
+}
+
+int main() {
+    int failed = 0;
+
+    eva::Logger::ptr sync_logger{new eva::Logger{"sync"}};
+    sync_logger->AddAppender(std::make_shared<NullAppender>());
+    failed += Check("sync", sync_logger);
+
+    auto async{std::make_shared<eva::AsyncLogAppender>(
+        64, eva::AsyncLogAppender::OverflowPolicy::BLOCK)};
+    async->AddAppender(std::make_shared<NullAppender>());
+    eva::Logger::ptr async_logger{new eva::Logger{"async"}};
+    async_logger->AddAppender(async);
+    failed += Check("async", async_logger, async.get());
+
+    if (failed) {
+        std::cout << "[FAILED] log path allocates in steady state" << std::endl;
+    }
+    return failed;
+}
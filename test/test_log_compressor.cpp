@@ -0,0 +1,144 @@
+#include <log/log_compressor.h>
+#include <log/rolling_appender.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+static std::string const kDir = "/tmp/eva_test_compressor";
+
+// JSON 格式的行，时间从 base 开始每 10 行加 1 秒
+static std::string MakeLines(time_t base, int count) {
+    std::string text;
+    for (int i = 0; i < count; ++i) {
+        time_t t = base + i / 10;
+        tm tm;
+        gmtime_r(&t, &tm);
+        char buf[64];
+        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+        text += std::string{"{\"time\":\""} + buf + ".000000Z\",\"message\":\"line " +
+                std::to_string(i) + " of the compressor test\"}\n";
+    }
+    return text;
+}
+
+// 压缩后源文件被删除，每块可单独解压，按时间范围只解压部分块
+static int TestCompressFile() {
+    std::string path = kDir + "/plain.log";
+    std::remove((path + ".zlog").c_str());
+    time_t base = 1700000000;
+    std::string text = MakeLines(base, 5000);
+    std::ofstream{path, std::ios::binary} << text;
+
+    {
+        eva::LogCompressorOptions options;
+        options.block_size = 16 << 10;
+        options.cpu_limit = 0.5;
+        eva::LogCompressor compressor{options};
+        if (!compressor.Submit(path)) {
+            return Fail("submit");
+        }
+        compressor.Wait();
+    }
+    if (Exists(path) || !Exists(path + ".zlog")) {
+        return Fail("source not replaced by archive");
+    }
+
+    eva::LogArchiveReader reader;
+    if (!reader.Open(path + ".zlog")) {
+        return Fail("open archive");
+    }
+    auto const& blocks = reader.GetBlocks();
+    if (blocks.size() < 10) {
+        return Fail("expected many blocks");
+    }
+    std::string all;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        std::string block;
+        if (!reader.ReadBlock(i, block) || block.back() != '\n' ||
+            block != text.substr(blocks[i].raw_offset, blocks[i].raw_size)) {
+            return Fail("block decompress");
+        }
+        if (blocks[i].first_time < base || blocks[i].last_time < blocks[i].first_time) {
+            return Fail("block time index");
+        }
+        all += block;
+    }
+    if (all != text) {
+        return Fail("round trip");
+    }
+
+    std::string range;
+    int64_t from = base + 200;
+    int64_t to = base + 210;
+    if (!reader.ReadRange(from, to, range) || range.size() >= text.size() / 4 ||
+        range.find("line 2000 of") == std::string::npos ||
+        range.find("line 2109 of") == std::string::npos) {
+        return Fail("time range read");
+    }
+    return 0;
+}
+
+// 滚动出的历史文件被压缩，轮换和保留规则作用于压缩后的文件
+static int TestRollingCompression() {
+    std::string base = kDir + "/rolling.log";
+    for (int i = 0; i <= 4; ++i) {
+        std::string path = i == 0 ? base : base + "." + std::to_string(i);
+        std::remove(path.c_str());
+        std::remove((path + ".zlog").c_str());
+    }
+    auto compressor{std::make_shared<eva::LogCompressor>()};
+    {
+        eva::Logger::ptr logger{new eva::Logger{"rolling"}};
+        auto appender{std::make_shared<eva::RollingFileLogAppender>(
+            base, 8 << 10, eva::RollingFileLogAppender::RollInterval::NONE, 3, 4096)};
+        appender->SetFormatter(eva::LogFormatter::ptr{new eva::LogFormatter{"%m%n"}});
+        appender->SetCompressor(compressor);
+        logger->AddAppender(appender);
+        for (int i = 0; i < 2000; ++i) {
+            EVA_LOG_INFO(logger) << "rolling line " << i << " waiting to be compressed";
+        }
+    }
+    compressor->Wait();
+
+    for (int i = 1; i <= 3; ++i) {
+        std::string path = base + "." + std::to_string(i);
+        eva::LogArchiveReader reader;
+        std::string text;
+        if (Exists(path) || !reader.Open(path + ".zlog") || !reader.ReadRange(0, INT64_MAX, text) ||
+            text.empty() || text.back() != '\n') {
+            return Fail("rolled archive not compressed");
+        }
+    }
+    if (Exists(base + ".4") || Exists(base + ".4.zlog")) {
+        return Fail("compressed archive retention");
+    }
+    // 最新的历史文件紧接在当前文件之前
+    eva::LogArchiveReader reader;
+    std::string newest;
+    reader.Open(base + ".1.zlog");
+    reader.ReadRange(0, INT64_MAX, newest);
+    std::string current = ReadFile(base);
+    size_t first = std::stoul(current.substr(13));
+    if (newest.find("rolling line " + std::to_string(first - 1) + " ") == std::string::npos) {
+        return Fail("archive order");
+    }
+    return 0;
+}
+
+int main() {
+    mkdir(kDir.c_str(), 0755);
+    int failed = 0;
+    failed += TestCompressFile();
+    failed += TestRollingCompression();
+    if (!failed) {
+        std::cout << "log compressor tests passed" << std::endl;
+    }
+    return failed;
+}
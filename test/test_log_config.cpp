@@ -0,0 +1,238 @@
+#include <log/log.h>
+#include <log/log_config.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+static std::string const kDir = "/tmp/eva_test_log_config";
+
+static void WriteFile(std::string const& path, std::string const& text) {
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    out << text;
+}
+
+/**
+ * @brief 先写临时文件再重命名，模拟编辑器和配置分发工具的替换方式
+ */
+static void ReplaceFile(std::string const& path, std::string const& text) {
+    WriteFile(path + ".tmp", text);
+    std::rename((path + ".tmp").c_str(), path.c_str());
+}
+
+/**
+ * @brief 一个文件 appender 加一个日志器的配置，每条日志同步写出，不输出到 root
+ */
+static std::string FileConfig(std::string const& logger, std::string const& level,
+                              std::string const& path, std::string const& pattern) {
+    return "[appenders.out]\n"
+           "type = \"file\"\n"
+           "path = \"" + path + "\"\n"
+           "pattern = \"" + pattern + "\"\n"
+           "sync_level = \"debug\"\n"
+           "\n"
+           "[loggers.\"" + logger + "\"]\n"
+           "level = \"" + level + "\"\n"
+           "additive = false\n"
+           "appenders = [\"out\"]\n";
+}
+
+// 语法错误、未知键、引用错误、环和错误模板都整体拒绝
+static int TestRejectInvalid() {
+    eva::LogConfig config;
+    std::string error;
+    if (eva::ParseLogConfig("[appenders.a\ntype = \"stdout\"\n", config, error) ||
+        !Contains(error, "line ")) {
+        return Fail("syntax error should report a line");
+    }
+    if (eva::ParseLogConfig("[appenders.a]\ntype = \"stdout\"\ncolor = true\n", config, error) ||
+        !Contains(error, "appenders.a: unknown key 'color'")) {
+        return Fail("unknown key");
+    }
+    if (eva::ParseLogConfig("[loggers.a]\nlevel = \"loud\"\n", config, error) ||
+        eva::ParseLogConfig("[appenders.a]\ntype = \"file\"\nflush_bytes = -1\n", config, error)) {
+        return Fail("bad level or negative size");
+    }
+
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& logger = manager->GetLogger("cfg.reject");
+    auto check = [&](std::string const& text) {
+        return eva::ParseLogConfig(text, config, error) && !manager->ApplyConfig(config) &&
+               logger->GetLevel() == eva::LogLevel::Level::INFO;
+    };
+    if (!check("[loggers.\"cfg.reject\"]\nlevel = \"debug\"\nappenders = [\"missing\"]\n") ||
+        !check("[appenders.a]\ntype = \"async\"\nsinks = [\"b\"]\n"
+               "[appenders.b]\ntype = \"async\"\nsinks = [\"a\"]\n"
+               "[loggers.\"cfg.reject\"]\nlevel = \"debug\"\n") ||
+        !check("[appenders.a]\ntype = \"stdout\"\npattern = \"%q\"\n"
+               "[loggers.\"cfg.reject\"]\nlevel = \"debug\"\nappenders = [\"a\"]\n")) {
+        return Fail("invalid config should be rejected without side effects");
+    }
+    return 0;
+}
+
+// 加载配置；只改模板时复用 appender 并原地替换格式器，改路径时新建 appender
+static int TestLoadAndReuse() {
+    std::string config_path = kDir + "/reuse.toml";
+    std::string log_path = kDir + "/reuse.log";
+    std::string log_path2 = kDir + "/reuse2.log";
+    std::remove(log_path.c_str());
+    std::remove(log_path2.c_str());
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& logger = manager->GetLogger("cfg.reuse");
+
+    WriteFile(config_path, FileConfig("cfg.reuse", "debug", log_path, "v1 %p %m%n"));
+    if (!manager->LoadConfig(config_path) || logger->GetLevel() != eva::LogLevel::Level::DEBUG ||
+        logger->GetAppenders()->size() != 1) {
+        return Fail("load config");
+    }
+    eva::LogAppender::ptr appender = logger->GetAppenders()->at(0);
+    EVA_LOG_DEBUG(logger) << "first";
+
+    WriteFile(config_path, FileConfig("cfg.reuse", "warn", log_path, "v2 %p %m%n"));
+    if (!manager->LoadConfig(config_path) || logger->GetAppenders()->at(0) != appender ||
+        logger->GetLevel() != eva::LogLevel::Level::WARN) {
+        return Fail("pattern change should reuse the appender");
+    }
+    EVA_LOG_DEBUG(logger) << "filtered";
+    EVA_LOG_WARN(logger) << "second";
+    if (ReadFile(log_path) != "v1 DEBUG first\nv2 WARN second\n") {
+        return Fail("formatter should be swapped in place");
+    }
+
+    WriteFile(config_path, FileConfig("cfg.reuse", "warn", log_path2, "v2 %p %m%n"));
+    if (!manager->LoadConfig(config_path) || logger->GetAppenders()->at(0) == appender) {
+        return Fail("path change should build a new appender");
+    }
+    EVA_LOG_WARN(logger) << "third";
+    if (ReadFile(log_path2) != "v2 WARN third\n") {
+        return Fail("new appender output");
+    }
+
+    // 从配置中去掉的日志器恢复为默认状态
+    WriteFile(config_path, "[loggers.\"cfg.other\"]\nlevel = \"error\"\n");
+    if (!manager->LoadConfig(config_path) || logger->GetLevel() != eva::LogLevel::Level::INFO ||
+        !logger->GetAppenders()->empty() ||
+        manager->GetLogger("cfg.other")->GetLevel() != eva::LogLevel::Level::ERROR) {
+        return Fail("removed logger should be reset");
+    }
+    return 0;
+}
+
+// 监视文件：重命名替换和原地写入都会触发重新加载，错误的配置不生效
+static int TestWatch() {
+    std::string config_path = kDir + "/watch.toml";
+    std::string log_path = kDir + "/watch.log";
+    std::remove(log_path.c_str());
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& logger = manager->GetLogger("cfg.watch");
+
+    WriteFile(config_path, FileConfig("cfg.watch", "info", log_path, "%p %m%n"));
+    if (!manager->WatchConfig(config_path) || logger->GetLevel() != eva::LogLevel::Level::INFO) {
+        return Fail("watch should load the config");
+    }
+
+    ReplaceFile(config_path, FileConfig("cfg.watch", "debug", log_path, "%p %m%n"));
+    if (!WaitFor([&] { return logger->GetLevel() == eva::LogLevel::Level::DEBUG; })) {
+        return Fail("rename should trigger a reload");
+    }
+    WriteFile(config_path, FileConfig("cfg.watch", "error", log_path, "%p %m%n"));
+    if (!WaitFor([&] { return logger->GetLevel() == eva::LogLevel::Level::ERROR; })) {
+        return Fail("in-place write should trigger a reload");
+    }
+
+    WriteFile(config_path, "[loggers.\"cfg.watch\"\nlevel = \"debug\"\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds{300});
+    if (logger->GetLevel() != eva::LogLevel::Level::ERROR) {
+        return Fail("broken config should keep the old one");
+    }
+    WriteFile(config_path, FileConfig("cfg.watch", "warn", log_path, "%p %m%n"));
+    if (!WaitFor([&] { return logger->GetLevel() == eva::LogLevel::Level::WARN; })) {
+        return Fail("fixed config should be loaded");
+    }
+    manager->StopWatching();
+
+    WriteFile(config_path, FileConfig("cfg.watch", "debug", log_path, "%p %m%n"));
+    std::this_thread::sleep_for(std::chrono::milliseconds{300});
+    if (logger->GetLevel() != eva::LogLevel::Level::WARN) {
+        return Fail("stopped watcher should not reload");
+    }
+    return 0;
+}
+
+// 多个线程持续写日志时反复切换配置，每条日志完整地使用某一份配置
+static int TestConcurrentReload() {
+    std::string path_a = kDir + "/stress_a.log";
+    std::string path_b = kDir + "/stress_b.log";
+    std::remove(path_a.c_str());
+    std::remove(path_b.c_str());
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& logger = manager->GetLogger("cfg.stress");
+
+    eva::LogConfig configs[2];
+    std::string error;
+    if (!eva::ParseLogConfig(FileConfig("cfg.stress", "info", path_a, "A %m%n"), configs[0],
+                             error) ||
+        !eva::ParseLogConfig(FileConfig("cfg.stress", "info", path_a, "B %m%n"), configs[1],
+                             error)) {
+        return Fail("parse stress config");
+    }
+    // 第二份配置多一个 appender
+    configs[1].appenders["extra"] = configs[1].appenders["out"];
+    configs[1].appenders["extra"].path = path_b;
+    configs[1].loggers["cfg.stress"].appenders.push_back("extra");
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&logger, &stop, t] {
+            for (int i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                EVA_LOG_INFO(logger) << "t" << t << " " << i;
+            }
+        });
+    }
+    for (int i = 0; i < 100; ++i) {
+        if (!manager->ApplyConfig(configs[i % 2])) {
+            return Fail("apply stress config");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    stop = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (auto const& path : {path_a, path_b}) {
+        std::istringstream lines{ReadFile(path)};
+        size_t count = 0;
+        for (std::string line; std::getline(lines, line); ++count) {
+            if (line.size() < 5 || (line[0] != 'A' && line[0] != 'B') || line.substr(1, 3) != " t") {
+                std::cout << "bad line: " << line << std::endl;
+                return Fail("torn line during reload");
+            }
+        }
+        if (count == 0) {
+            return Fail("no output during reload");
+        }
+    }
+    return 0;
+}
+
+int main() {
+    mkdir(kDir.c_str(), 0755);
+    if (TestRejectInvalid() || TestLoadAndReuse() || TestWatch() || TestConcurrentReload()) {
+        return 1;
+    }
+    std::cout << "log config tests passed" << std::endl;
+    return 0;
+}
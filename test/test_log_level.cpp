@@ -0,0 +1,82 @@
+// 编译期只保留 INFO 及以上级别
+#define EVA_LOG_MIN_LEVEL 200
+
+#include <log/log.h>
+
+#include <atomic>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+// 只计数不输出的 appender
+class CountingAppender : public eva::LogAppender {
+public:
+    CountingAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override { ++count_; }
+
+    uint64_t GetCount() const { return count_.load(); }
+
+private:
+    std::atomic<uint64_t> count_{0};
+};
+
+static int g_evaluated = 0;
+
+static int SideEffect() { return ++g_evaluated; }
+
+int main() {
+    eva::Logger::ptr logger{new eva::Logger{"level"}};
+    auto appender{std::make_shared<CountingAppender>()};
+    logger->AddAppender(appender);
+    int failed = 0;
+
+    // 编译期丢弃：即使运行时级别放开到 DEBUG，DEBUG 语句也不输出，参数不求值
+    logger->SetLevel(eva::LogLevel::Level::DEBUG);
+    EVA_LOG_DEBUG(logger) << SideEffect();
+    EVA_LOG_FMT_DEBUG(logger, "{}", SideEffect());
+    if (appender->GetCount() != 0 || g_evaluated != 0) {
+        failed += Fail("compiled-out statement was evaluated");
+    }
+
+    // 运行时关闭：参数不求值
+    logger->SetLevel(eva::LogLevel::Level::ERROR);
+    EVA_LOG_INFO(logger) << SideEffect();
+    EVA_LOG_FMT_WARN(logger, "{}", SideEffect());
+    if (appender->GetCount() != 0 || g_evaluated != 0) {
+        failed += Fail("disabled statement was evaluated");
+    }
+
+    // 运行时开启
+    EVA_LOG_ERROR(logger) << SideEffect();
+    if (appender->GetCount() != 1 || g_evaluated != 1) {
+        failed += Fail("enabled statement was not logged");
+    }
+
+    // logger 表达式只求值一次
+    int logger_evaluated = 0;
+    auto get_logger = [&] {
+        ++logger_evaluated;
+        return logger;
+    };
+    EVA_LOG_FATAL(get_logger()) << "once";
+    if (logger_evaluated != 1 || appender->GetCount() != 2) {
+        failed += Fail("logger expression evaluated more than once");
+    }
+
+    // 宏用在不带花括号的 if 中不会吞掉外层的 else
+    bool took_else = false;
+    if (g_evaluated < 0)
+        EVA_LOG_ERROR(logger) << "unreachable";
+    else
+        took_else = true;
+    if (!took_else) {
+        failed += Fail("dangling else");
+    }
+
+    if (!failed) {
+        std::cout << "log level tests passed" << std::endl;
+    }
+    return failed;
+}
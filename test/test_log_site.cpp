@@ -0,0 +1,119 @@
+#include <log/async_appender.h>
+#include <log/log.h>
+#include <log/static_formatter.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+// 短文件名在编译期计算
+static_assert(std::string_view{eva::LogSite::Basename("a/b/c.cpp")} == "c.cpp");
+static_assert(std::string_view{eva::LogSite::Basename("c.cpp")} == "c.cpp");
+
+// 记录事件中调用点指针和格式化结果的 appender
+class SiteAppender : public eva::LogAppender {
+public:
+    SiteAppender()
+        : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter{"%b:%l %M %N %m"}}) {}
+
+    void Log(eva::LogEvent const& event) override {
+        std::lock_guard lk{mtx_};
+        sites.push_back(&event.GetSite());
+        lines.push_back(default_formatter_->Format(event));
+    }
+
+    std::vector<eva::LogSite const*> sites;
+    std::vector<std::string> lines;
+
+private:
+    std::mutex mtx_;
+};
+
+static int g_loop_line = 0;
+
+static void LogTwice(eva::Logger::ptr const& logger) {
+    g_loop_line = __LINE__ + 2;
+    for (int i = 0; i < 2; ++i) {
+        EVA_LOG_INFO(logger) << "loop " << i;
+    }
+}
+
+// 同一调用点的事件指向同一个静态描述符，格式器从描述符读取文件名、行号和函数名
+static int TestSiteDescriptor() {
+    eva::Logger::ptr logger{new eva::Logger{"site"}};
+    auto appender{std::make_shared<SiteAppender>()};
+    logger->AddAppender(appender);
+    eva::SetThreadName("site-main");
+
+    LogTwice(logger);
+    int line = __LINE__ + 1;
+    EVA_LOG_FMT_WARN(logger, "fmt {}", 1);
+
+    if (appender->sites.size() != 3 || appender->sites[0] != appender->sites[1] ||
+        appender->sites[0] == appender->sites[2]) {
+        return Fail("events of one call site should share a descriptor");
+    }
+    if (std::strcmp(appender->sites[0]->file, __FILE__) != 0 ||
+        appender->sites[0]->basename != appender->sites[0]->file + std::strlen(__FILE__) -
+                                            std::strlen("test_log_site.cpp")) {
+        return Fail("basename should point into the file path");
+    }
+    if (appender->lines[0] != "test_log_site.cpp:" + std::to_string(g_loop_line) +
+                                  " LogTwice site-main loop 0" ||
+        appender->lines[2] != "test_log_site.cpp:" + std::to_string(line) +
+                                  " TestSiteDescriptor site-main fmt 1") {
+        return Fail("runtime formatter site fields");
+    }
+
+    eva::StaticLogFormatter<"%b:%l %M %N %m"> static_formatter;
+    eva::LogEvent event{"site", eva::LogLevel::Level::INFO, *appender->sites[2], 0, 1, 0, 0,
+                        eva::GetThreadName()};
+    event.GetStream() << "static";
+    if (static_formatter.Format(event) !=
+        "test_log_site.cpp:" + std::to_string(line) + " TestSiteDescriptor site-main static") {
+        return Fail("static formatter site fields");
+    }
+
+    // 默认构造的事件指向空的未知调用点，格式化不会解引用空指针
+    if (eva::LogFormatter{"%f%b%M%l"}.Format(eva::LogEvent{}) != "0") {
+        return Fail("unknown site");
+    }
+    return 0;
+}
+
+// 线程名称是驻留的：线程退出后异步 appender 格式化的事件仍然有效
+static int TestInternedThreadName() {
+    eva::Logger::ptr logger{new eva::Logger{"site.async"}};
+    auto sink{std::make_shared<SiteAppender>()};
+    auto async{std::make_shared<eva::AsyncLogAppender>()};
+    async->AddAppender(sink);
+    logger->AddAppender(async);
+
+    std::thread{[&logger] {
+        eva::SetThreadName("short-lived");
+        EVA_LOG_INFO(logger) << "bye";
+        eva::SetThreadName("renamed");
+    }}.join();
+    async->Flush();
+
+    if (sink->lines.size() != 1 || sink->lines[0].find(" short-lived bye") == std::string::npos) {
+        return Fail("thread name should outlive its thread");
+    }
+    if (eva::GetThreadName().data() != eva::GetThreadName().data()) {
+        return Fail("thread name should be cached");
+    }
+    return 0;
+}
+
+int main() {
+    if (TestSiteDescriptor() || TestInternedThreadName()) {
+        return 1;
+    }
+    std::cout << "log site tests passed" << std::endl;
+    return 0;
+}
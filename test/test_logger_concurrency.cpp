@@ -0,0 +1,129 @@
+#include <log/log.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 只计数不输出的 appender
+class CountingAppender : public eva::LogAppender {
+public:
+    CountingAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override {
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t GetCount() const { return count_.load(); }
+
+private:
+    std::atomic<uint64_t> count_{0};
+};
+
+// 多个线程并发查找/创建同名日志器，必须得到同一个实例
+static int TestConcurrentLookup() {
+    constexpr int kThreads = 4;
+    constexpr int kNames = 200;
+    std::vector<std::vector<eva::Logger*>> seen(kThreads, std::vector<eva::Logger*>(kNames));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([i, &seen] {
+            for (int n = 0; n < kNames; ++n) {
+                std::string name = "lookup." + std::to_string((n + i * 7) % kNames);
+                seen[i][(n + i * 7) % kNames] = EVA_LOG_NAME(name).get();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (int n = 0; n < kNames; ++n) {
+        std::string name = "lookup." + std::to_string(n);
+        for (int i = 0; i < kThreads; ++i) {
+            if (seen[i][n] != seen[0][n] || seen[i][n]->GetName() != name) {
+                std::cout << "[FAILED] concurrent lookup returned different loggers" << std::endl;
+                return 1;
+            }
+        }
+    }
+    // 调用点缓存与直接查找得到同一个实例
+    if (EVA_LOGGER("lookup.0") != seen[0][0] || EVA_LOGGER("root") != EVA_LOG_ROOT().get()) {
+        std::cout << "[FAILED] cached logger mismatch" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 多个线程持续写日志，同时另一个线程反复增删/清空 appender
+int main() {
+    if (TestConcurrentLookup()) {
+        return 1;
+    }
+
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 200000;
+
+    eva::Logger::ptr logger{new eva::Logger{"concurrency"}};
+    auto stable{std::make_shared<CountingAppender>()};
+    logger->AddAppender(stable);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> churned{0};
+    std::vector<std::shared_ptr<CountingAppender>> transient;
+    std::thread writer{[&] {
+        uint64_t round = 0;
+        while (!done.load()) {
+            auto appender{std::make_shared<CountingAppender>()};
+            transient.push_back(appender);
+            logger->AddAppender(appender);
+            std::this_thread::yield();
+            if (++round % 16 == 0) {
+                // 清空后再把常驻 appender 放回去，这期间常驻 appender 可能漏掉少量日志
+                logger->ClearAppenders();
+                logger->AddAppender(stable);
+            } else {
+                logger->DelAppender(appender);
+            }
+            churned.fetch_add(1);
+        }
+    }};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([logger] {
+            for (int j = 0; j < kPerThread; ++j) {
+                EVA_LOG_INFO(logger) << "concurrent msg " << j;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    done.store(true);
+    writer.join();
+
+    uint64_t total = uint64_t{kThreads} * kPerThread;
+    uint64_t transient_count = 0;
+    for (auto const& appender : transient) {
+        transient_count += appender->GetCount();
+    }
+    std::cout << "logged=" << total << " stable=" << stable->GetCount()
+              << " transient=" << transient_count << " churned=" << churned.load() << std::endl;
+
+    int failed = 0;
+    if (stable->GetCount() > total || logger->GetAppenders()->size() != 1) {
+        std::cout << "[FAILED] inconsistent appender snapshot" << std::endl;
+        ++failed;
+    }
+
+    // 不再并发修改时，每条日志都必须送达
+    uint64_t before = stable->GetCount();
+    for (int j = 0; j < 1000; ++j) {
+        EVA_LOG_INFO(logger) << "quiescent msg " << j;
+    }
+    if (stable->GetCount() - before != 1000) {
+        std::cout << "[FAILED] lost events without concurrent reconfiguration" << std::endl;
+        ++failed;
+    }
+    return failed;
+}
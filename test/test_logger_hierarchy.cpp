@@ -0,0 +1,201 @@
+#include <log/log.h>
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+// 只计数不输出的 appender
+class CountingAppender : public eva::LogAppender {
+public:
+    CountingAppender() : LogAppender(eva::LogFormatter::ptr{new eva::LogFormatter}) {}
+
+    void Log(eva::LogEvent const& event) override { ++count_; }
+
+    uint64_t GetCount() const { return count_.load(); }
+
+private:
+    std::atomic<uint64_t> count_{0};
+};
+
+// 名称中的 '.' 决定父子关系，缺少的祖先一并创建
+static int TestTree() {
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger* leaf = manager->GetLogger("tree.net.http").get();
+    eva::Logger* net = manager->GetLogger("tree.net").get();
+    eva::Logger* tree = manager->GetLogger("tree").get();
+    if (leaf->GetParent() != net || net->GetParent() != tree ||
+        tree->GetParent() != manager->GetRoot().get() || manager->GetRoot()->GetParent()) {
+        return Fail("parent links");
+    }
+    return 0;
+}
+
+// 级别沿树继承，设置和清除都立即反映到所有子孙
+static int TestLevelInheritance() {
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& parent = manager->GetLogger("level");
+    eva::Logger::ptr const& child = manager->GetLogger("level.child");
+    eva::Logger::ptr const& grandchild = manager->GetLogger("level.child.grandchild");
+    if (child->HasLevel() || child->GetLevel() != eva::LogLevel::Level::INFO) {
+        return Fail("new logger should inherit root level");
+    }
+
+    parent->SetLevel(eva::LogLevel::Level::DEBUG);
+    if (child->GetLevel() != eva::LogLevel::Level::DEBUG ||
+        grandchild->GetLevel() != eva::LogLevel::Level::DEBUG ||
+        !grandchild->IsEnabled(eva::LogLevel::Level::DEBUG)) {
+        return Fail("level should propagate to descendants");
+    }
+
+    child->SetLevel(eva::LogLevel::Level::ERROR);
+    parent->SetLevel(eva::LogLevel::Level::WARN);
+    if (child->GetLevel() != eva::LogLevel::Level::ERROR ||
+        grandchild->GetLevel() != eva::LogLevel::Level::ERROR) {
+        return Fail("own level should shadow the parent");
+    }
+
+    child->ClearLevel();
+    parent->ClearLevel();
+    if (child->HasLevel() || grandchild->GetLevel() != eva::LogLevel::Level::INFO) {
+        return Fail("cleared level should inherit again");
+    }
+    return 0;
+}
+
+// appender 沿树继承，additive = false 截断继承，同一个 appender 只输出一次
+static int TestAppenderInheritance() {
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& parent = manager->GetLogger("app");
+    eva::Logger::ptr const& child = manager->GetLogger("app.child");
+    auto parent_out{std::make_shared<CountingAppender>()};
+    auto child_out{std::make_shared<CountingAppender>()};
+    parent->SetAdditive(false);
+    parent->AddAppender(parent_out);
+
+    EVA_LOG_INFO(child) << "inherited";
+    if (parent_out->GetCount() != 1 || child->GetAppenders()->size() != 0) {
+        return Fail("child should log to parent appenders");
+    }
+
+    child->AddAppender(child_out);
+    child->AddAppender(parent_out);
+    EVA_LOG_INFO(child) << "both";
+    if (child_out->GetCount() != 1 || parent_out->GetCount() != 2 ||
+        child->GetEffectiveAppenders()->size() != 2) {
+        return Fail("shared appender should log once");
+    }
+
+    child->DelAppender(parent_out);
+    child->SetAdditive(false);
+    EVA_LOG_INFO(child) << "own";
+    if (child_out->GetCount() != 2 || parent_out->GetCount() != 2) {
+        return Fail("non-additive child should not log to parent");
+    }
+
+    child->SetAdditive(true);
+    parent->ClearAppenders();
+    EVA_LOG_INFO(child) << "cleared";
+    if (child_out->GetCount() != 3 || parent_out->GetCount() != 2) {
+        return Fail("parent change should propagate");
+    }
+    return 0;
+}
+
+// 写日志的同时反复修改祖先，子孙的每条日志都写到某一份完整的 appender 集合上
+static int TestConcurrentChange() {
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger::ptr const& top = manager->GetLogger("deep");
+    top->SetAdditive(false);
+    std::string name{"deep"};
+    for (int i = 0; i < 16; ++i) {
+        name += ".n" + std::to_string(i);
+    }
+    eva::Logger::ptr const& leaf = manager->GetLogger(name);
+    auto out_a{std::make_shared<CountingAppender>()};
+    auto out_b{std::make_shared<CountingAppender>()};
+    top->AddAppender(out_a);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> logged{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                EVA_LOG_INFO(leaf) << "x";
+                logged.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int i = 0; i < 1000; ++i) {
+        top->SetAppenders({i % 2 ? out_a : out_b});
+        top->SetLevel(i % 2 ? eva::LogLevel::Level::INFO : eva::LogLevel::Level::DEBUG);
+    }
+    stop = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (out_a->GetCount() + out_b->GetCount() != logged.load()) {
+        return Fail("event lost or duplicated during tree change");
+    }
+    return 0;
+}
+
+// Reconfigure 整体替换父子两个日志器的设置，写日志的线程看不到只替换了一部分的状态
+static int TestReconfigure() {
+    auto* manager = eva::LoggerMgr::GetInstance();
+    eva::Logger* parent = manager->GetLogger("cfg").get();
+    eva::Logger* child = manager->GetLogger("cfg.child").get();
+    auto parent_a{std::make_shared<CountingAppender>()};
+    auto parent_b{std::make_shared<CountingAppender>()};
+    auto child_a{std::make_shared<CountingAppender>()};
+    auto child_b{std::make_shared<CountingAppender>()};
+    // A: 子日志器同时写到父日志器；B: 子日志器不写到父日志器
+    std::vector<std::pair<eva::Logger*, eva::Logger::Settings>> config_a{
+        {parent, {eva::LogLevel::Level::INFO, false, eva::LogLimitPolicy::None(), {parent_a}}},
+        {child, {std::nullopt, true, eva::LogLimitPolicy::None(), {child_a}}}};
+    std::vector<std::pair<eva::Logger*, eva::Logger::Settings>> config_b{
+        {parent, {eva::LogLevel::Level::DEBUG, false, eva::LogLimitPolicy::None(), {parent_b}}},
+        {child, {std::nullopt, false, eva::LogLimitPolicy::None(), {child_b}}}};
+    eva::Logger::Reconfigure(config_a);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> logged{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                EVA_LOG_INFO(child) << "x";
+                logged.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int i = 0; i < 1000; ++i) {
+        eva::Logger::Reconfigure(i % 2 ? config_a : config_b);
+    }
+    stop = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (parent_b->GetCount() != 0 || child_a->GetCount() != parent_a->GetCount()) {
+        return Fail("logger saw a half-applied config");
+    }
+    if (child_a->GetCount() + child_b->GetCount() != logged.load()) {
+        return Fail("event lost or duplicated during reconfigure");
+    }
+    return 0;
+}
+
+int main() {
+    if (TestTree() || TestLevelInheritance() || TestAppenderInheritance() ||
+        TestConcurrentChange() || TestReconfigure()) {
+        return 1;
+    }
+    std::cout << "logger hierarchy tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <log/rolling_appender.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+static std::string const kDir = "/tmp/eva_test_rolling";
+
+static void Cleanup(std::string const& base) {
+    std::remove(base.c_str());
+    for (int i = 1; i <= 8; ++i) {
+        std::remove((base + "." + std::to_string(i)).c_str());
+    }
+}
+
+static eva::LogEvent MakeEvent(uint64_t time_ns, char const* message) {
+    EVA_LOG_DEFINE_SITE(site);
+    eva::LogEvent event{"rolling", eva::LogLevel::Level::INFO, site, 0, 1, 1, time_ns, "main"};
+    event.GetStream() << message;
+    return event;
+}
+
+// 按大小滚动并只保留 max_files 个历史文件
+static int TestSizeRoll() {
+    std::string base = kDir + "/size.log";
+    Cleanup(base);
+    {
+        eva::Logger::ptr logger{new eva::Logger{"size"}};
+        auto appender{std::make_shared<eva::RollingFileLogAppender>(
+            base, 16 << 10, eva::RollingFileLogAppender::RollInterval::NONE, 3, 4096)};
+        appender->SetFormatter(eva::LogFormatter::ptr{new eva::LogFormatter{"%m%n"}});
+        logger->AddAppender(appender);
+        for (int i = 0; i < 5000; ++i) {
+            EVA_LOG_INFO(logger) << "line " << i << " of the size rolling test";
+        }
+    }
+    if (!Exists(base + ".3") || Exists(base + ".4")) {
+        return Fail("size roll retention");
+    }
+    for (auto const& path : {base, base + ".1", base + ".2", base + ".3"}) {
+        std::string data = ReadFile(path);
+        if (data.size() > (16 << 10) || data.find('\0') != std::string::npos ||
+            (!data.empty() && data.back() != '\n')) {
+            return Fail("rolled file is not clean");
+        }
+    }
+    // 最新的一行在当前文件末尾
+    std::string current = ReadFile(base);
+    if (current.find("line 4999 of") == std::string::npos) {
+        return Fail("last line missing");
+    }
+    return 0;
+}
+
+// 按整点滚动：直接构造跨小时的事件
+static int TestTimeRoll() {
+    std::string base = kDir + "/time.log";
+    Cleanup(base);
+    {
+        eva::RollingFileLogAppender appender{
+            base, 0, eva::RollingFileLogAppender::RollInterval::HOURLY, 5, 4096};
+        appender.SetFormatter(eva::LogFormatter::ptr{new eva::LogFormatter{"%m%n"}});
+        uint64_t now_ns = static_cast<uint64_t>(time(nullptr)) * 1000000000ull;
+        uint64_t hour_ns = 3600ull * 1000000000ull;
+        appender.Log(MakeEvent(now_ns, "hour 0"));
+        appender.Log(MakeEvent(now_ns + hour_ns, "hour 1"));
+        appender.Log(MakeEvent(now_ns + 2 * hour_ns, "hour 2"));
+    }
+    if (ReadFile(base) != "hour 2\n" || ReadFile(base + ".1") != "hour 1\n" ||
+        ReadFile(base + ".2") != "hour 0\n") {
+        return Fail("hourly roll");
+    }
+    return 0;
+}
+
+// 崩溃恢复：文件末尾残留的预分配零字节被截掉
+static int TestRecovery() {
+    std::string base = kDir + "/recover.log";
+    Cleanup(base);
+    {
+        std::ofstream out{base, std::ios::binary};
+        out << "before crash\n" << std::string(10000, '\0');
+    }
+    {
+        eva::RollingFileLogAppender appender{
+            base, 0, eva::RollingFileLogAppender::RollInterval::NONE, 1, 4096};
+        appender.SetFormatter(eva::LogFormatter::ptr{new eva::LogFormatter{"%m%n"}});
+        appender.Log(MakeEvent(static_cast<uint64_t>(time(nullptr)) * 1000000000ull, "after"));
+    }
+    if (ReadFile(base) != "before crash\nafter\n") {
+        return Fail("crash recovery");
+    }
+    return 0;
+}
+
+// 外部轮转：文件被移走后，下一秒的日志写到原路径的新文件
+static int TestExternalRotation() {
+    std::string base = kDir + "/external.log";
+    Cleanup(base);
+    {
+        eva::RollingFileLogAppender appender{
+            base, 0, eva::RollingFileLogAppender::RollInterval::NONE, 1, 4096};
+        appender.SetFormatter(eva::LogFormatter::ptr{new eva::LogFormatter{"%m%n"}});
+        uint64_t now_ns = static_cast<uint64_t>(time(nullptr)) * 1000000000ull;
+        appender.Log(MakeEvent(now_ns, "old file"));
+        std::rename(base.c_str(), (base + ".1").c_str());
+        appender.Log(MakeEvent(now_ns + 1000000000ull, "new file"));
+    }
+    if (ReadFile(base + ".1") != "old file\n" || ReadFile(base) != "new file\n") {
+        return Fail("external rotation");
+    }
+    return 0;
+}
+
+// 下一段窗口分配失败时整行丢弃，不留下半行，之后的日志照常写入
+static int TestWindowFailure() {
+    std::string base = kDir + "/window.log";
+    Cleanup(base);
+    // 文件大小上限设为一个窗口，跨窗口的行分配磁盘块时失败(EFBIG)
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit old_limit{};
+    getrlimit(RLIMIT_FSIZE, &old_limit);
+    rlimit limit{4096, old_limit.rlim_max};
+    setrlimit(RLIMIT_FSIZE, &limit);
+    {
+        eva::RollingFileLogAppender appender{
+            base, 0, eva::RollingFileLogAppender::RollInterval::NONE, 1, 4096};
+        appender.SetFormatter(eva::LogFormatter::ptr{new eva::LogFormatter{"%m%n"}});
+        uint64_t now_ns = static_cast<uint64_t>(time(nullptr)) * 1000000000ull;
+        appender.Log(MakeEvent(now_ns, "before"));
+        appender.Log(MakeEvent(now_ns, std::string(5000, 'x').c_str()));
+        appender.Log(MakeEvent(now_ns, "after"));
+    }
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    std::signal(SIGXFSZ, SIG_DFL);
+    if (ReadFile(base) != "before\nafter\n") {
+        return Fail("torn line after window failure");
+    }
+    return 0;
+}
+
+int main() {
+    mkdir(kDir.c_str(), 0755);
+    int failed = 0;
+    failed += TestSizeRoll();
+    failed += TestTimeRoll();
+    failed += TestRecovery();
+    failed += TestExternalRotation();
+    failed += TestWindowFailure();
+    if (!failed) {
+        std::cout << "rolling appender tests passed" << std::endl;
+    }
+    return failed;
+}
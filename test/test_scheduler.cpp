@@ -0,0 +1,226 @@
+#include <fiber/scheduler.h>
+
+#include <atomic>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+static void Spin(int n) {
+    for (int i = 0; i < n; ++i) {
+        asm volatile("");
+    }
+}
+
+// 一个任务在本地队列里提交大量任务，其他工作线程通过窃取分担
+static int TestStealing() {
+    constexpr int kTasks = 20000;
+    eva::Scheduler scheduler{4, "steal"};
+    std::atomic<int> done{0};
+    std::atomic<int> ran_on[4] = {};
+    scheduler.Start();
+    scheduler.Schedule([&] {
+        for (int i = 0; i < kTasks; ++i) {
+            eva::Scheduler::GetThis()->Schedule([&] {
+                Spin(2000);
+                ran_on[eva::Scheduler::GetWorkerIndex()].fetch_add(1);
+                done.fetch_add(1);
+            });
+        }
+    });
+    scheduler.Stop();
+    int workers_used = 0;
+    for (auto& n : ran_on) {
+        workers_used += n.load() > 0;
+    }
+    if (done != kTasks) {
+        return Fail("all tasks should run before Stop returns");
+    }
+    if (workers_used < 2) {
+        return Fail("idle workers should steal");
+    }
+    return 0;
+}
+
+// 固定到某个线程的任务只在该线程执行，从外部和工作线程中提交都是
+static int TestPinned() {
+    eva::Scheduler scheduler{4, "pin"};
+    std::atomic<int> wrong{0};
+    std::atomic<int> done{0};
+    scheduler.Start();
+    for (int i = 0; i < 1000; ++i) {
+        int thread = i % 4;
+        scheduler.Schedule(
+            [&, thread] {
+                wrong += eva::Scheduler::GetWorkerIndex() != thread;
+                ++done;
+                int next = (thread + 1) % 4;
+                eva::Scheduler::GetThis()->Schedule(
+                    [&, next] {
+                        wrong += eva::Scheduler::GetWorkerIndex() != next;
+                        ++done;
+                    },
+                    next);
+            },
+            thread);
+    }
+    scheduler.Stop();
+    if (done != 2000 || wrong != 0) {
+        return Fail("pinned tasks should run on their thread");
+    }
+    return 0;
+}
+
+// Scheduler::Yield 让出后会被再次调度，普通函数和协程都可以让出
+static int TestYield() {
+    eva::Scheduler scheduler{3, "yield"};
+    std::atomic<int> steps{0};
+    scheduler.Start();
+    for (int i = 0; i < 200; ++i) {
+        auto body = [&] {
+            for (int j = 0; j < 100; ++j) {
+                ++steps;
+                eva::Scheduler::Yield();
+            }
+        };
+        if (i % 2) {
+            scheduler.Schedule(body);
+        } else {
+            scheduler.Schedule(std::make_shared<eva::Fiber>(body));
+        }
+    }
+    scheduler.Stop();
+    if (steps != 200 * 100) {
+        return Fail("yielded fibers should be rescheduled");
+    }
+    return 0;
+}
+
+// 两个协程互相唤醒：提交对方后挂起，对方可能在本协程切换完成前就在其他线程上运行
+static int TestPingPong() {
+    constexpr int kRounds = 20000;
+    eva::Scheduler scheduler{4, "pingpong"};
+    std::atomic<int> count{0};
+    std::atomic<bool> finished{false};
+    eva::Fiber::ptr ping;
+    eva::Fiber::ptr pong;
+    auto body = [&](eva::Fiber::ptr& peer) {
+        return [&] {
+            while (count.fetch_add(1) < kRounds) {
+                eva::Scheduler::GetThis()->Schedule(peer);
+                eva::Fiber::Yield();
+            }
+            // 先结束的一方唤醒对方，让它也退出
+            if (!finished.exchange(true)) {
+                eva::Scheduler::GetThis()->Schedule(peer);
+            }
+        };
+    };
+    ping = std::make_shared<eva::Fiber>(body(pong));
+    pong = std::make_shared<eva::Fiber>(body(ping));
+    scheduler.Start();
+    scheduler.Schedule(ping);
+    scheduler.Stop();
+    if (count < kRounds || ping->GetState() != eva::Fiber::State::TERM ||
+        pong->GetState() != eva::Fiber::State::TERM) {
+        return Fail("ping-pong should finish");
+    }
+    return 0;
+}
+
+// Stop 等待嵌套提交的任务全部完成
+static void Fork(int depth, std::atomic<int>& leaves) {
+    if (depth == 0) {
+        ++leaves;
+        return;
+    }
+    for (int i = 0; i < 2; ++i) {
+        eva::Scheduler::GetThis()->Schedule([depth, &leaves] { Fork(depth - 1, leaves); });
+    }
+}
+
+static int TestNestedStop() {
+    eva::Scheduler scheduler{4, "fork"};
+    std::atomic<int> leaves{0};
+    scheduler.Start();
+    scheduler.Schedule([&] { Fork(14, leaves); });
+    scheduler.Stop();
+    if (leaves != 1 << 14) {
+        return Fail("Stop should wait for nested tasks");
+    }
+    return 0;
+}
+
+// 任务抛出异常不影响工作线程；启动前提交的任务在启动后执行
+static int TestExceptionAndEarlySubmit() {
+    eva::Scheduler scheduler{2, "except"};
+    std::atomic<int> done{0};
+    scheduler.Schedule([] { throw std::runtime_error{"expected test exception"}; });
+    scheduler.Schedule([&] { ++done; });
+    scheduler.Start();
+    scheduler.Schedule([&] { ++done; });
+    scheduler.Stop();
+    if (done != 2) {
+        return Fail("tasks after an exception should still run");
+    }
+    return 0;
+}
+
+// 协程在不同工作线程之间迁移，GetFiberId 仍然返回自己的 id
+static int TestFiberIdAcrossThreads() {
+    eva::Scheduler scheduler{4, "fid"};
+    std::atomic<int> wrong{0};
+    scheduler.Start();
+    for (int i = 0; i < 100; ++i) {
+        scheduler.Schedule(std::make_shared<eva::Fiber>([&] {
+            uint64_t id = eva::Fiber::GetThis()->GetId();
+            for (int j = 0; j < 50; ++j) {
+                eva::Scheduler::Yield();
+                wrong += eva::Fiber::GetFiberId() != id;
+            }
+        }));
+    }
+    scheduler.Stop();
+    if (wrong != 0) {
+        return Fail("fiber id should follow the fiber across threads");
+    }
+    return 0;
+}
+
+// 停止过程中任务接力固定到其他工作线程，Stop 等到最后一棒执行完
+static void Relay(eva::Scheduler* scheduler, int hops, std::atomic<int>& done) {
+    ++done;
+    if (hops > 0) {
+        int next = (eva::Scheduler::GetWorkerIndex() + 1) % 4;
+        scheduler->Schedule([=, &done] { Relay(scheduler, hops - 1, done); }, next);
+    }
+}
+
+static int TestPinnedDuringStop() {
+    constexpr int kHops = 64;
+    for (int round = 0; round < 300; ++round) {
+        eva::Scheduler scheduler{4, "relay"};
+        std::atomic<int> done{0};
+        scheduler.Start();
+        scheduler.Schedule([&] { Relay(&scheduler, kHops, done); });
+        scheduler.Stop();
+        if (done != kHops + 1) {
+            return Fail("worker exited while a task was pinned to it");
+        }
+    }
+    return 0;
+}
+
+int main() {
+    if (TestStealing() || TestPinned() || TestYield() || TestPingPong() || TestNestedStop() ||
+        TestExceptionAndEarlySubmit() || TestFiberIdAcrossThreads() || TestPinnedDuringStop()) {
+        return 1;
+    }
+    std::cout << "scheduler tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,367 @@
+#include <fcntl.h>
+#include <fiber/io_manager.h>
+#include <fiber/timer.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace eva::test;
+
+using Backend = eva::IOManager::Backend;
+
+static char const* BackendName(Backend backend) {
+    return backend == Backend::IO_URING ? "io_uring" : "epoll";
+}
+
+// 时间轮：随机的到期时间(含超出范围的)、随机取消、随机步长推进，每个节点恰好在到期的那次推进中返回
+static int TestWheelRandom() {
+    constexpr size_t kCount = 200000;
+    std::mt19937_64 rng{42};
+    uint64_t start = 1000;
+    eva::TimerWheel wheel{start};
+    std::vector<eva::TimerWheel::Node> nodes(kCount);
+    std::multiset<uint64_t> live;
+    for (auto& node : nodes) {
+        uint64_t range;
+        switch (rng() % 4) {
+            case 0: range = 64; break;
+            case 1: range = 1ULL << 16; break;
+            case 2: range = 1ULL << 30; break;
+            default: range = 1ULL << 40; break;  // 超出时间轮的范围
+        }
+        wheel.Insert(&node, start + rng() % range);
+        live.insert(node.expire);
+    }
+    // 取消四分之一
+    std::vector<bool> removed(kCount, false);
+    for (size_t i = 0; i < kCount; i += 4) {
+        wheel.Remove(&nodes[i]);
+        live.erase(live.find(nodes[i].expire));
+        removed[i] = true;
+    }
+    if (wheel.Size() != live.size()) {
+        return Fail("wheel size after remove");
+    }
+    size_t fired = 0;
+    uint64_t now = start;
+    while (!live.empty()) {
+        if (wheel.NextExpiry() > *live.begin()) {
+            return Fail("wheel next expiry is not a lower bound");
+        }
+        uint64_t step = rng() % 3 == 0 ? rng() % (1ULL << 34) : rng() % 5000;
+        uint64_t prev = now;
+        now += step;
+        uint64_t last = 0;
+        for (auto* node = wheel.Advance(now); node;) {
+            auto* next = static_cast<eva::TimerWheel::Node*>(node->next);
+            size_t index = static_cast<size_t>(node - nodes.data());
+            if (removed[index] || eva::TimerWheel::IsLinked(node)) {
+                return Fail("wheel returned a removed node");
+            }
+            if (node->expire > now || (node->expire <= prev && prev != start)) {
+                return Fail("wheel node expired at the wrong time");
+            }
+            if (node->expire < last) {
+                return Fail("wheel expired nodes out of order");
+            }
+            last = node->expire;
+            live.erase(live.find(node->expire));
+            ++fired;
+            node = next;
+        }
+        if (wheel.Size() != live.size()) {
+            return Fail("wheel size after advance");
+        }
+    }
+    if (fired != kCount - kCount / 4 || wheel.NextExpiry() != eva::TimerWheel::kNever) {
+        return Fail("wheel fired count");
+    }
+    return 0;
+}
+
+// 时间轮：每次推进到 NextExpiry，节点恰好在到期的刻度返回；重新插入已到期的节点在下一次推进时返回
+static int TestWheelExact() {
+    constexpr size_t kCount = 20000;
+    std::mt19937_64 rng{7};
+    eva::TimerWheel wheel{0};
+    std::vector<eva::TimerWheel::Node> nodes(kCount);
+    for (auto& node : nodes) {
+        wheel.Insert(&node, 1 + rng() % (1ULL << 30));
+    }
+    size_t fired = 0;
+    while (wheel.Size() != 0) {
+        uint64_t next = wheel.NextExpiry();
+        for (auto* node = wheel.Advance(next); node;) {
+            if (node->expire != wheel.GetNow()) {
+                return Fail("wheel node expired before or after its tick");
+            }
+            ++fired;
+            node = static_cast<eva::TimerWheel::Node*>(node->next);
+        }
+    }
+    if (fired != kCount) {
+        return Fail("wheel exact fired count");
+    }
+    eva::TimerWheel::Node node;
+    wheel.Insert(&node, wheel.GetNow());
+    if (wheel.NextExpiry() != wheel.GetNow() || wheel.Advance(wheel.GetNow()) != &node) {
+        return Fail("wheel due node");
+    }
+    return 0;
+}
+
+// 一次性、周期、取消、条件和重设定时器
+static int TestTimers(Backend backend) {
+    eva::IOManager iom{2, "timer", backend};
+    iom.Start();
+
+    auto begin = std::chrono::steady_clock::now();
+    std::atomic<int64_t> once_ms{-1};
+    iom.AddTimer(50, [&] {
+        once_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+    });
+    if (!WaitFor([&] { return once_ms.load() >= 0; })) {
+        return Fail("one-shot timer never fired");
+    }
+    if (once_ms.load() < 50) {
+        return Fail("one-shot timer fired early");
+    }
+
+    std::atomic<int> ticks{0};
+    auto recurring = iom.AddTimer(10, [&] { ++ticks; }, true);
+    if (!WaitFor([&] { return ticks.load() >= 5; })) {
+        return Fail("recurring timer");
+    }
+    if (!iom.CancelTimer(recurring) || iom.CancelTimer(recurring)) {
+        return Fail("cancel recurring timer");
+    }
+    SleepMs(20);
+    int stopped = ticks.load();
+    SleepMs(50);
+    if (ticks.load() != stopped) {
+        return Fail("recurring timer fired after cancel");
+    }
+
+    std::atomic<bool> fired{false};
+    auto cancelled = iom.AddTimer(30, [&] { fired = true; });
+    if (!iom.CancelTimer(cancelled)) {
+        return Fail("cancel pending timer");
+    }
+    auto token = std::make_shared<int>(0);
+    iom.AddConditionTimer(20, [&] { fired = true; }, token);
+    token.reset();
+    std::atomic<bool> kept{false};
+    auto alive = std::make_shared<int>(0);
+    iom.AddConditionTimer(20, [&] { kept = true; }, alive);
+    if (!WaitFor([&] { return kept.load(); })) {
+        return Fail("condition timer with a live condition never fired");
+    }
+    SleepMs(30);
+    if (fired.load()) {
+        return Fail("cancelled or orphaned timer fired");
+    }
+
+    // 重设推迟到期
+    begin = std::chrono::steady_clock::now();
+    once_ms = -1;
+    auto reset = iom.AddTimer(20, [&] {
+        once_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+    });
+    if (!iom.ResetTimer(reset, 100)) {
+        return Fail("reset timer");
+    }
+    if (!WaitFor([&] { return once_ms.load() >= 0; }) || once_ms.load() < 100) {
+        return Fail("reset timer fired at the wrong time");
+    }
+
+    // 等待线程按远处的定时器休眠时，新加入的更早的定时器要及时触发
+    auto far = iom.AddTimer(60000, [] {});
+    SleepMs(20);
+    begin = std::chrono::steady_clock::now();
+    once_ms = -1;
+    iom.AddTimer(10, [&] {
+        once_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - begin)
+                      .count();
+    });
+    if (!WaitFor([&] { return once_ms.load() >= 0; }, 2000)) {
+        return Fail("earlier timer did not wake the poller");
+    }
+    iom.CancelTimer(far);
+    if (iom.GetTimerCount() != 0) {
+        return Fail("timer count after cancel");
+    }
+    iom.Stop();
+    return 0;
+}
+
+// SleepFor 只挂起协程：单线程上大量协程同时休眠，总耗时接近最长的一次
+static int TestSleep(Backend backend) {
+    constexpr int kFibers = 10000;
+    eva::IOManager iom{1, "sleep", backend};
+    iom.Start();
+    std::atomic<int> early{0};
+    std::atomic<int> done{0};
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFibers; ++i) {
+        int ms = 10 + i % 191;
+        iom.Schedule([&, ms] {
+            auto start = std::chrono::steady_clock::now();
+            eva::IOManager::SleepFor(static_cast<uint64_t>(ms));
+            if (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ms)) {
+                ++early;
+            }
+            ++done;
+        });
+    }
+    // 休眠期间工作线程还能执行其他任务
+    std::atomic<bool> ran{false};
+    SleepMs(5);
+    iom.Schedule([&] { ran = true; });
+    if (!WaitFor([&] { return ran.load(); }, 100)) {
+        return Fail("sleeping fibers blocked the worker");
+    }
+    iom.Stop();
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    if (done.load() != kFibers || early.load() != 0) {
+        return Fail("fiber sleep");
+    }
+    if (elapsed > std::chrono::seconds(2)) {
+        return Fail("fiber sleeps were serialized");
+    }
+    // 不在工作线程中退化为线程休眠
+    auto start = std::chrono::steady_clock::now();
+    eva::IOManager::SleepFor(10);
+    if (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(10)) {
+        return Fail("thread sleep");
+    }
+    return 0;
+}
+
+// IO 超时：没有数据的读按时以 ETIMEDOUT 失败，之后 fd 还能正常使用
+static int TestIoTimeout(Backend backend) {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        return Fail("pipe");
+    }
+    eva::IOManager iom{2, "timeout", backend};
+    iom.Start();
+    std::atomic<int> result{0};
+    std::atomic<int> error{0};
+    std::atomic<int64_t> elapsed{0};
+    std::atomic<bool> done{false};
+    iom.Schedule([&] {
+        char buf[8];
+        auto start = std::chrono::steady_clock::now();
+        ssize_t n = iom.Read(fds[0], buf, sizeof(buf), 50);
+        error = n < 0 ? errno : 0;
+        elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+        // 超时之后，没有超时的读在数据到来时完成
+        result = static_cast<int>(iom.Read(fds[0], buf, sizeof(buf)));
+        done = true;
+    });
+    if (!WaitFor([&] { return elapsed.load() != 0; })) {
+        return Fail("read timeout never fired");
+    }
+    if (error.load() != ETIMEDOUT || elapsed.load() < 50) {
+        return Fail("read timeout");
+    }
+    SleepMs(10);
+    if (write(fds[1], "abc", 3) != 3) {
+        return Fail("write");
+    }
+    if (!WaitFor([&] { return done.load(); }) || result.load() != 3) {
+        return Fail("read after timeout");
+    }
+
+    // 数据在超时前到达：超时不生效
+    done = false;
+    iom.Schedule([&] {
+        char buf[8];
+        result = static_cast<int>(iom.Read(fds[0], buf, sizeof(buf), 1000));
+        done = true;
+    });
+    SleepMs(10);
+    if (write(fds[1], "hello", 5) != 5) {
+        return Fail("write");
+    }
+    if (!WaitFor([&] { return done.load(); }) || result.load() != 5) {
+        return Fail("read before timeout");
+    }
+    iom.Stop();
+    if (iom.GetTimerCount() != 0) {
+        return Fail("io timeout timers left behind");
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return 0;
+}
+
+// 大量定时器：添加后全部取消，池中的节点被复用
+static int TestManyTimers(Backend backend) {
+    constexpr size_t kCount = 1000000;
+    eva::IOManager iom{1, "many", backend};
+    iom.Start();
+    std::vector<eva::TimerManager::TimerId> ids;
+    ids.reserve(kCount);
+    std::mt19937_64 rng{1};
+    for (size_t i = 0; i < kCount; ++i) {
+        ids.push_back(iom.AddTimer(1000 + rng() % 3600000, [] {}));
+    }
+    if (iom.GetTimerCount() != kCount) {
+        return Fail("many timers count");
+    }
+    for (auto id : ids) {
+        if (!iom.CancelTimer(id)) {
+            return Fail("cancel many timers");
+        }
+    }
+    // 复用的节点换了代数，旧 id 失效
+    auto id = iom.AddTimer(1000, [] {});
+    if (id == ids.back() || iom.CancelTimer(ids.back()) || !iom.CancelTimer(id)) {
+        return Fail("timer id reuse");
+    }
+    iom.Stop();
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    failures += TestWheelRandom();
+    failures += TestWheelExact();
+    for (Backend backend : {Backend::EPOLL, Backend::IO_URING}) {
+        if (backend == Backend::IO_URING &&
+            eva::IOManager{1, "probe", backend}.GetBackend() != Backend::IO_URING) {
+            std::cout << "io_uring is not available, skip" << std::endl;
+            continue;
+        }
+        int before = failures;
+        failures += TestTimers(backend);
+        failures += TestSleep(backend);
+        failures += TestIoTimeout(backend);
+        failures += TestManyTimers(backend);
+        if (failures != before) {
+            std::cout << "backend: " << BackendName(backend) << std::endl;
+        }
+    }
+    if (failures == 0) {
+        std::cout << "timer tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace eva::test {
+
+/**
+ * @brief 输出失败原因，返回 1 作为测试函数的结果
+ */
+inline int Fail(char const* what) {
+    std::cout << "[FAILED] " << what << std::endl;
+    return 1;
+}
+
+/**
+ * @brief 读出整个文件，文件不存在时返回空串
+ */
+inline std::string ReadFile(std::string const& path) {
+    std::ifstream in{path, std::ios::binary};
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+inline bool Contains(std::string const& data, std::string const& str) {
+    return data.find(str) != std::string::npos;
+}
+
+inline bool Exists(std::string const& path) { return access(path.c_str(), F_OK) == 0; }
+
+inline void SleepMs(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+/**
+ * @brief 等待 pred 成立，最多 timeout_ms 毫秒
+ */
+template <typename Pred>
+bool WaitFor(Pred pred, int timeout_ms = 10000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace eva::test
@@ -3,3 +3,123 @@ target("test_log", function()
     add_files("test_log.cpp")
     add_deps("log")
 end)
+
+target("test_async_log", function()
+    set_kind("binary")
+    add_files("test_async_log.cpp")
+    add_deps("log")
+end)
+
+target("test_log_alloc", function()
+    set_kind("binary")
+    add_files("test_log_alloc.cpp")
+    add_deps("log")
+end)
+
+target("test_binary_log", function()
+    set_kind("binary")
+    add_files("test_binary_log.cpp")
+    add_deps("log")
+end)
+
+target("test_logger_concurrency", function()
+    set_kind("binary")
+    add_files("test_logger_concurrency.cpp")
+    add_deps("log")
+end)
+
+target("test_rolling_appender", function()
+    set_kind("binary")
+    add_files("test_rolling_appender.cpp")
+    add_deps("log")
+end)
+
+target("test_log_level", function()
+    set_kind("binary")
+    add_files("test_log_level.cpp")
+    add_deps("log")
+end)
+
+target("test_file_appender", function()
+    set_kind("binary")
+    add_files("test_file_appender.cpp")
+    add_deps("log")
+end)
+
+target("test_format", function()
+    set_kind("binary")
+    add_files("test_format.cpp")
+    add_deps("log")
+end)
+
+target("test_log_limit", function()
+    set_kind("binary")
+    add_files("test_log_limit.cpp")
+    add_deps("log")
+end)
+
+target("test_json_formatter", function()
+    set_kind("binary")
+    add_files("test_json_formatter.cpp")
+    add_deps("log")
+end)
+
+target("test_log_compressor", function()
+    set_kind("binary")
+    add_files("test_log_compressor.cpp")
+    add_deps("log")
+end)
+
+target("test_crash_handler", function()
+    set_kind("binary")
+    add_files("test_crash_handler.cpp")
+    add_deps("log")
+end)
+
+target("test_log_site", function()
+    set_kind("binary")
+    add_files("test_log_site.cpp")
+    add_deps("log")
+end)
+
+target("test_log_config", function()
+    set_kind("binary")
+    add_files("test_log_config.cpp")
+    add_deps("log")
+end)
+
+target("test_logger_hierarchy", function()
+    set_kind("binary")
+    add_files("test_logger_hierarchy.cpp")
+    add_deps("log")
+end)
+
+target("test_fiber", function()
+    set_kind("binary")
+    add_files("test_fiber.cpp")
+    add_deps("log")
+end)
+
+target("test_scheduler", function()
+    set_kind("binary")
+    add_files("test_scheduler.cpp")
+    add_deps("fiber")
+end)
+
+target("test_io_manager", function()
+    set_kind("binary")
+    add_files("test_io_manager.cpp")
+    add_deps("fiber")
+end)
+
+target("test_timer", function()
+    set_kind("binary")
+    add_files("test_timer.cpp")
+    add_deps("fiber")
+end)
+
+target("test_fiber_stack", function()
+    set_kind("binary")
+    add_files("test_fiber_stack.cpp")
+    add_deps("fiber")
+end)
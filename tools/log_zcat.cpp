@@ -0,0 +1,69 @@
+#include <log/log_compressor.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+// 分块压缩日志(.zlog)读取工具：解压全部内容，或只解压与时间范围有交集的块
+//
+// 用法：eva_logzcat [-l] [-f from] [-t to] <file>...
+static void Usage(char const* prog) {
+    std::cerr << "usage: " << prog << " [-l] [-f from] [-t to] <file>..." << std::endl
+              << "  -l       list the block index instead of decompressing" << std::endl
+              << "  -f from  only blocks ending at or after this UTC time (unix seconds)"
+              << std::endl
+              << "  -t to    only blocks starting at or before this UTC time (unix seconds)"
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    bool list = false;
+    int64_t from = 0;
+    int64_t to = INT64_MAX;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (std::strcmp(argv[i], "-l") == 0) {
+            list = true;
+        } else if (std::strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            from = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            to = std::atoll(argv[++i]);
+        } else {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+    if (i >= argc) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    int ret = 0;
+    for (; i < argc; ++i) {
+        eva::LogArchiveReader reader;
+        if (!reader.Open(argv[i])) {
+            std::cerr << "[ERROR] cannot open log archive: " << argv[i] << std::endl;
+            ret = 1;
+            continue;
+        }
+        if (list) {
+            std::cout << argv[i] << ": " << reader.GetBlocks().size() << " blocks" << std::endl;
+            for (auto const& block : reader.GetBlocks()) {
+                std::cout << "  raw_offset=" << block.raw_offset << " raw_size=" << block.raw_size
+                          << " compressed_size=" << block.compressed_size
+                          << " first_time=" << block.first_time
+                          << " last_time=" << block.last_time << std::endl;
+            }
+            continue;
+        }
+        std::string out;
+        if (!reader.ReadRange(from, to, out)) {
+            std::cerr << "[ERROR] corrupted block in " << argv[i] << std::endl;
+            ret = 1;
+        }
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+    return ret;
+}
@@ -0,0 +1,11 @@
+target("eva_logdecode", function()
+    set_kind("binary")
+    add_files("log_decode.cpp")
+    add_deps("log")
+end)
+
+target("eva_logzcat", function()
+    set_kind("binary")
+    add_files("log_zcat.cpp")
+    add_deps("log")
+end)
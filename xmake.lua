@@ -6,6 +6,26 @@ add_rules("plugin.compile_commands.autoupdate")
 add_rules("mode.debug", "mode.release")
 
 add_requires("toml++")
+add_requires("zlib")
+
+-- 编译期最低日志级别：低于该级别的 EVA_LOG_<级别> 语句在编译期被丢弃
+option("log_min_level", function()
+    set_default("notset")
+    set_showmenu(true)
+    set_values("notset", "debug", "info", "notice", "warn", "error", "crit", "alert", "fatal")
+    set_description("Strip log statements below this level at compile time")
+end)
+
+local log_level_values = {
+    notset = 0, debug = 100, info = 200, notice = 300, warn = 400,
+    error = 500, crit = 600, alert = 700, fatal = 800
+}
+local log_min_level = log_level_values[get_config("log_min_level") or "notset"]
+if log_min_level and log_min_level > 0 then
+    add_defines("EVA_LOG_MIN_LEVEL=" .. log_min_level)
+end
 
 includes("eva")
 includes("test")
+includes("bench")
+includes("tools")